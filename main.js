@@ -39,12 +39,8 @@ try {
 
     const ndiModule = require(path.join(nativeModulePath, 'ndi_wrapper.node'));
     ndi = new ndiModule.NdiWrapper();
+    // The NDI runtime itself is loaded on the first NDI call, not here.
     console.log('NDI Wrapper loaded successfully from:', nativeModulePath);
-    if (ndi.initialize()) {
-        console.log('NDI initialized');
-    } else {
-        console.error('Failed to initialize NDI');
-    }
 } catch (e) {
     console.error('Failed to load NDI wrapper:', e);
 }
@@ -747,6 +743,7 @@ function buildApplicationMenu(mode) {
                 { label: 'Points', type: 'radio', click: () => { if(mainWindow) mainWindow.webContents.send('render-settings-command', { setting: 'beamRenderMode', value: 'points' }); } },
                 { label: 'Lines', type: 'radio', click: () => { if(mainWindow) mainWindow.webContents.send('render-settings-command', { setting: 'beamRenderMode', value: 'lines' }); } },
                 { label: 'Points & Lines', type: 'radio', checked: true, click: () => { if(mainWindow) mainWindow.webContents.send('render-settings-command', { setting: 'beamRenderMode', value: 'both' }); } },
+                { label: 'Simulated Scanners', type: 'radio', click: () => { if(mainWindow) mainWindow.webContents.send('render-settings-command', { setting: 'beamRenderMode', value: 'galvo' }); } },
               ]
             },
             { type: 'separator' },
@@ -1137,50 +1134,118 @@ function createWindow() {
   });
 
   // NDI IPC Handlers
-  let ndiCaptureSettings = { width: 480, height: 480 };
+  // pooled: the capture thread writes frames straight into a fixed set of ArrayBuffers, recycled on frameDone. That
+  //   saves the addon's per-frame allocation and copy only: a pooled frame sent over IPC is still structured-cloned
+  //   into the renderer. sharedMemory, which takes precedence, is what keeps the pixels off IPC.
+  // frameSync: pull one clock-corrected frame per laser output frame (fps) instead of taking frames as the sender pushes them
+  // bandwidth: 'auto' pulls the sender's low-bandwidth proxy stream while the capture size is small enough for it
+  // crop: { x, y, width, height } in fractions of the source frame; only that region is read and scaled
+  // sharedMemory: frames stay in a shared-memory ring and the preload reads them; only a slot reference is sent over IPC.
+  //   On by default; the renderer turns it off for its sources when its preload could not load the addon.
+  // audio: analyse the source's embedded audio on the capture thread; frames then carry { low, mid, high, rms }
+  // threads: threads that split each frame's scaling and mask rows, the capture thread included; 0 picks one from the core count
+  const ndiDefaultCaptureSettings = { width: 480, height: 480, pooled: true, filter: 'nearest', analysis: 'none', threshold: 128, trace: false, frameSync: false, bandwidth: 'auto', crop: null, sharedMemory: true, audio: false, threads: 0 };
+  // Each NDI source has its own receiver in the addon, so every source keeps its own capture settings.
+  const ndiCaptureSettings = new Map();
   let ndiPerformanceData = { totalTime: 0, count: 0, lastReport: Date.now() };
-  let isRendererReadyForNdi = true;
+
+  const ndiSettingsFor = (sourceName) => {
+      if (!ndiCaptureSettings.has(sourceName)) ndiCaptureSettings.set(sourceName, { ...ndiDefaultCaptureSettings });
+      return ndiCaptureSettings.get(sourceName);
+  };
+
+  const ndiStartCapture = (sourceName) => {
+      const s = ndiSettingsFor(sourceName);
+      ndi.startCapture(sourceName, s.width, s.height, {
+          pooled: s.pooled,
+          filter: s.filter,
+          analysis: s.analysis,
+          threshold: s.threshold,
+          trace: s.trace,
+          frameSync: s.frameSync,
+          bandwidth: s.bandwidth,
+          crop: s.crop,
+          sharedMemory: s.sharedMemory,
+          audio: s.audio,
+          threads: s.threads
+      });
+  };
 
   ipcMain.handle('ndi-update-settings', (event, settings) => {
-      if (settings.width) ndiCaptureSettings.width = settings.width;
-      if (settings.height) ndiCaptureSettings.height = settings.height;
-      // Immediately update active capture resolution
-      if (ndi) {
-          ndi.startCapture(ndiCaptureSettings.width, ndiCaptureSettings.height);
-      }
+      if (!settings.source) return false;
+      const s = ndiSettingsFor(settings.source);
+      if (settings.width) s.width = settings.width;
+      if (settings.height) s.height = settings.height;
+      if (settings.filter) s.filter = settings.filter;
+      if (settings.analysis) s.analysis = settings.analysis;
+      if (typeof settings.threshold === 'number') s.threshold = settings.threshold;
+      if (settings.trace !== undefined) s.trace = settings.trace;
+      if (settings.frameSync !== undefined) s.frameSync = settings.frameSync;
+      if (settings.bandwidth) s.bandwidth = settings.bandwidth;
+      if (settings.crop !== undefined) s.crop = settings.crop;
+      if (settings.sharedMemory !== undefined) s.sharedMemory = !!settings.sharedMemory;
+      if (settings.audio !== undefined) s.audio = settings.audio;
+      if (Number.isInteger(settings.threads) && settings.threads >= 0) s.threads = settings.threads;
+      // Immediately update the running receiver; a no-op if it does not exist yet
+      if (ndi) ndiStartCapture(settings.source);
       return true;
   });
 
+  // { ndi, ndiVersion, ndiLibrary, ndiError, synthetic }; ndi is false when the runtime is not installed.
+  ipcMain.handle('ndi-get-capabilities', async () => {
+      if (!ndi) return { ndi: false, ndiVersion: null, ndiLibrary: null, ndiError: 'NDI wrapper not loaded', synthetic: false };
+      const capabilities = ndi.getCapabilities();
+      if (!capabilities.ndi) console.warn('NDI unavailable:', capabilities.ndiError);
+      return capabilities;
+  });
+
+  // The first call loads NDI and starts discovery on a native thread; this resolves with the cached
+  // list, waiting briefly only if the first scan has not settled yet. Empty without the runtime.
   ipcMain.handle('ndi-find-sources', async () => {
       if (!ndi) return [];
       return ndi.findSources();
   });
 
+  // Receivers are refcounted per source: every successful create must be paired with a destroy.
   ipcMain.handle('ndi-create-receiver', async (event, sourceName) => {
       if (!ndi) return false;
       const success = ndi.createReceiver(sourceName);
-      if (success) {
-          ndi.startCapture(ndiCaptureSettings.width, ndiCaptureSettings.height);
-          isRendererReadyForNdi = true; 
-      }
+      if (success) ndiStartCapture(sourceName);
       return success;
   });
 
-  ipcMain.handle('ndi-capture-video', async () => {
+  ipcMain.handle('ndi-capture-video', async (event, sourceName) => {
+      if (!ndi) return null;
+      return sourceName ? ndi.captureVideo(sourceName) : ndi.captureVideo();
+  });
+
+  // Newest native FFT of a source's audio, with the full spectrum; null until audio has arrived.
+  ipcMain.handle('ndi-get-audio', async (event, sourceName) => {
       if (!ndi) return null;
-      return ndi.captureVideo();
+      return sourceName ? ndi.getAudio(sourceName) : ndi.getAudio();
   });
 
-  ipcMain.handle('ndi-destroy-receiver', async () => {
+  ipcMain.handle('ndi-destroy-receiver', async (event, sourceName) => {
       if (!ndi) return;
-      ndi.stopCapture();
-      ndi.destroyReceiver();
-      isRendererReadyForNdi = true; 
-      ndiPerformanceData = { totalTime: 0, count: 0, lastReport: Date.now() };
+      if (sourceName) {
+          ndi.destroyReceiver(sourceName);
+      } else {
+          ndi.destroyReceiver();
+      }
+      if (ndi.getReceivers().length === 0) {
+          ndiPerformanceData = { totalTime: 0, count: 0, lastReport: Date.now() };
+      }
   });
 
-  ipcMain.on('ndi-renderer-ready', () => {
-      isRendererReadyForNdi = true;
+  // The renderer acknowledges each frame once its worker is done with it;
+  // the addon then pushes the newest pending frame of that source.
+  ipcMain.on('ndi-renderer-ready', (event, sourceName) => {
+      if (!ndi) return;
+      if (sourceName) {
+          ndi.frameDone(sourceName);
+      } else {
+          ndi.frameDone();
+      }
   });
 
   ipcMain.handle('get-desktop-audio-source-id', async () => {
@@ -1221,35 +1286,38 @@ function createWindow() {
   };
   setInterval(sendSystemStats, 2000); 
 
-  let ndiFlowControlTimeout = null;
-
-  const ndiCaptureLoop = async () => {
-      if (ndi && mainWindow && !mainWindow.isDestroyed() && isRendererReadyForNdi) {
-          const start = performance.now();
-          const frame = ndi.captureVideo(ndiCaptureSettings.width, ndiCaptureSettings.height); 
-          const end = performance.now();
-          if (frame) {
-              isRendererReadyForNdi = false; 
-              if (ndiFlowControlTimeout) clearTimeout(ndiFlowControlTimeout);
-              ndiFlowControlTimeout = setTimeout(() => { isRendererReadyForNdi = true; }, 200);
-              const duration = end - start;
-              ndiPerformanceData.totalTime += duration;
-              ndiPerformanceData.count++;
-              if (Date.now() - ndiPerformanceData.lastReport > 5000 && ndiPerformanceData.count > 0) {
-                  const avg = ndiPerformanceData.totalTime / ndiPerformanceData.count;
-                  console.log(`[NDI Performance] Avg Capture Time: ${avg.toFixed(2)}ms (over ${ndiPerformanceData.count} frames) @ ${frame.width}x${frame.height}`);
-                  mainWindow.webContents.send('ndi-telemetry', { avgCaptureTime: avg });
-                  ndiPerformanceData.totalTime = 0;
-                  ndiPerformanceData.count = 0;
-                  ndiPerformanceData.lastReport = Date.now();
-              }
-              mainWindow.webContents.send('ndi-frame', frame);
-          }
+  // Frames are pushed from the addon's capture threads. One frame in flight
+  // per source; an unacknowledged frame expires after 200 ms so a reloaded
+  // renderer cannot stall the stream.
+  const onNdiFrame = (frame) => {
+      if (!mainWindow || mainWindow.isDestroyed()) {
+          ndi.frameDone(frame.source);
+          return;
+      }
+      const start = performance.now();
+      mainWindow.webContents.send('ndi-frame', frame);
+      ndiPerformanceData.totalTime += performance.now() - start;
+      ndiPerformanceData.count++;
+      if (Date.now() - ndiPerformanceData.lastReport > 5000 && ndiPerformanceData.count > 0) {
+          const avg = ndiPerformanceData.totalTime / ndiPerformanceData.count;
+          const pool = ndi.getFramePoolStats();
+          const frameSync = ndi.getFrameSyncStats();
+          // Native counters and microsecond histograms from the capture threads, per 5 s window
+          const capture = ndi.getStats();
+          ndi.resetStats();
+          console.log(`[NDI Performance] Avg Delivery Time: ${avg.toFixed(2)}ms (over ${ndiPerformanceData.count} frames) @ ${frame.width}x${frame.height}, pool hits/misses: ${pool.hits}/${pool.misses}`);
+          console.log(`[NDI Capture] received ${capture.received}, dropped ${capture.dropped}, overwritten ${capture.overwritten}, unchanged ${capture.unchanged}, queue ${capture.queueDepth}, process p50/p99 ${capture.processUs.p50}/${capture.processUs.p99}us, latency p50 ${capture.latencyUs.p50}us`);
+          if (frameSync.enabled) console.log(`[NDI Frame Sync] pulled ${frameSync.pulled}, repeated ${frameSync.repeated}, dropped ${frameSync.dropped}`);
+          mainWindow.webContents.send('ndi-telemetry', { avgCaptureTime: avg, framePool: pool, frameSync, capture });
+          ndiPerformanceData.totalTime = 0;
+          ndiPerformanceData.count = 0;
+          ndiPerformanceData.lastReport = Date.now();
       }
-      const delay = isRendererReadyForNdi ? 2 : 16; 
-      setTimeout(ndiCaptureLoop, delay);
   };
-  ndiCaptureLoop();
+  if (ndi) ndi.onFrame(onNdiFrame, { maxInFlight: 1, ackTimeoutMs: 200 });
+  if (ndi) ndi.onSourcesChanged((sources) => {
+      if (mainWindow && !mainWindow.isDestroyed()) mainWindow.webContents.send('ndi-sources-changed', sources);
+  });
 }
 
 app.whenReady().then(async () => {
@@ -1265,6 +1333,8 @@ app.whenReady().then(async () => {
 
 app.on('window-all-closed', () => {
   if (ndi) {
+      ndi.offFrame();
+      ndi.offSourcesChanged();
       ndi.destroyReceiver();
   }
   if (process.platform !== 'darwin') {
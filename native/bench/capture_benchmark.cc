@@ -0,0 +1,138 @@
+// Drives the full capture path (source, scale/convert, analysis, tracing,
+// handoff to a consumer thread) on a synthetic 1080p source, without NDI,
+// and reports throughput and latency percentiles per output mode.
+//
+// Usage: capture_benchmark [frames] [synthetic source name]
+// The default source is unpaced, so the numbers are the capture thread's
+// ceiling; add fps=60 to the name to see latency at a real frame rate.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "capture_stats.h"
+#include "frame_receiver.h"
+#include "synthetic_frame_source.h"
+
+namespace {
+
+struct Case {
+  const char* name;
+  FrameAnalysis analysis;
+  bool trace;
+  bool pooled;
+};
+
+int64_t NowTicks() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count() * 10;
+}
+
+bool RunCase(const std::string& source_name, const SyntheticOptions& options, const Case& c, int frames) {
+  FrameReceiver receiver(source_name, std::make_unique<SyntheticFrameSource>(options));
+  receiver.SetTargetSize(480, 480);
+  receiver.SetAnalysis(c.analysis);
+  receiver.SetTrace(c.trace);
+  receiver.SetPooled(c.pooled);
+  if (!receiver.Connect()) {
+    std::printf("%s: source failed to open\n", c.name);
+    return false;
+  }
+
+  // The consumer stands in for the JS thread: woken per frame, it takes
+  // the newest one and measures how old it is.
+  std::mutex mutex;
+  std::condition_variable ready;
+  bool pending = false;
+  std::atomic<bool> done{false};
+  Histogram handoff_us;
+  uint64_t taken = 0;
+  receiver.set_on_frame([&] {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending = true;
+    }
+    ready.notify_one();
+  });
+  std::thread consumer([&] {
+    while (!done.load()) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait_for(lock, std::chrono::milliseconds(50), [&] { return pending; });
+        pending = false;
+      }
+      int64_t stamp = kNoTimestamp;
+      if (c.pooled) {
+        if (FrameSlab* slab = receiver.TakeSlab()) {
+          stamp = slab->timestamp;
+          receiver.frame_pool().Release(slab);
+        }
+      } else if (const CapturedFrame* frame = receiver.TakeFrame()) {
+        stamp = frame->timestamp;
+      }
+      if (stamp != kNoTimestamp) {
+        handoff_us.Record(static_cast<uint64_t>(std::max<int64_t>(NowTicks() - stamp, 0) / 10));
+        ++taken;
+      }
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  receiver.Start();
+  while (receiver.stats().received < static_cast<uint64_t>(frames)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  receiver.Stop();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  done = true;
+  ready.notify_one();
+  consumer.join();
+
+  CaptureStatsSnapshot stats = receiver.stats();
+  HistogramSnapshot handoff = handoff_us.Snapshot();
+  std::printf("%-14s %7.1f fps | process p50 %6llu p90 %6llu p99 %6llu us | handoff p50 %6llu p99 %6llu us | taken %llu/%llu\n",
+      c.name, stats.received / seconds,
+      static_cast<unsigned long long>(stats.process_us.Percentile(50)),
+      static_cast<unsigned long long>(stats.process_us.Percentile(90)),
+      static_cast<unsigned long long>(stats.process_us.Percentile(99)),
+      static_cast<unsigned long long>(handoff.Percentile(50)),
+      static_cast<unsigned long long>(handoff.Percentile(99)),
+      static_cast<unsigned long long>(taken), static_cast<unsigned long long>(stats.received));
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int frames = argc > 1 ? std::atoi(argv[1]) : 300;
+  std::string source_name = argc > 2 ? argv[2] : "synthetic:pattern=bars,size=1920x1080,fps=0";
+  if (frames <= 0) frames = 300;
+
+  SyntheticOptions options;
+  std::string error;
+  if (!ParseSyntheticSourceName(source_name, &options, &error)) {
+    std::fprintf(stderr, "%s: %s\n", source_name.c_str(), error.c_str());
+    return 1;
+  }
+
+  const Case cases[] = {
+    {"bgra copy", FrameAnalysis::kNone, false, false},
+    {"bgra pooled", FrameAnalysis::kNone, false, true},
+    {"luma (uyvy)", FrameAnalysis::kLuma, false, true},
+    {"edges (uyvy)", FrameAnalysis::kEdges, false, true},
+    {"trace (uyvy)", FrameAnalysis::kNone, true, true},
+  };
+
+  std::printf("%s -> 480x480, %d frames per mode, scaler backend %s\n", source_name.c_str(), frames, ScalerBackendName());
+  bool ok = true;
+  for (const Case& c : cases) ok = RunCase(source_name, options, c, frames) && ok;
+  return ok ? 0 : 1;
+}
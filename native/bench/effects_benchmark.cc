@@ -0,0 +1,88 @@
+// Times EffectsEngine on frames from 1k to 60k points with a typical
+// effect stack, run as one fused pass and as one pass per effect (how the
+// JS effects walked the frame).
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "effects_engine.h"
+#include "point_optimizer.h"
+
+namespace {
+
+std::vector<float> MakeFrame(size_t count) {
+  std::vector<float> points(count * kPointStride);
+  for (size_t i = 0; i < count; ++i) {
+    double angle = 2 * 3.14159265358979323846 * static_cast<double>(i) / static_cast<double>(count);
+    float* p = &points[i * kPointStride];
+    p[0] = static_cast<float>(0.8 * std::cos(angle * 7));
+    p[1] = static_cast<float>(0.8 * std::sin(angle * 5));
+    p[3] = p[4] = p[5] = 255.0f;
+  }
+  return points;
+}
+
+// Rotate, scale, translate, wave, rainbow and blanking, as effects.js
+// compiles them; |stages| gets where each stage starts.
+std::vector<double> MakeProgram(std::vector<size_t>* stages) {
+  const std::vector<std::vector<double>> list = {
+      {1, std::cos(0.3), std::sin(0.3)},
+      {2, 0.9, 0.9},
+      {3, 0.05, -0.05},
+      {8, 0, 0.05, 12, 1.7},
+      {5, 1.0, 0.2, 0.1},
+      {12, 6, 8},
+  };
+  std::vector<double> program;
+  for (const std::vector<double>& stage : list) {
+    stages->push_back(program.size());
+    program.insert(program.end(), stage.begin(), stage.end());
+  }
+  stages->push_back(program.size());
+  return program;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+  if (iterations <= 0) iterations = 200;
+  std::vector<size_t> bounds;
+  const std::vector<double> program = MakeProgram(&bounds);
+  EffectsEngine fused;
+  fused.Load(program.data(), program.size());
+  std::vector<EffectsEngine> passes(bounds.size() - 1);
+  for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+    passes[i].Load(program.data() + bounds[i], bounds[i + 1] - bounds[i]);
+  }
+
+  std::printf("%zu stages\n", fused.stages());
+  for (size_t count : {1000, 4000, 30000, 60000}) {
+    const std::vector<float> frame = MakeFrame(count);
+    std::vector<float> points = frame;
+    fused.Apply(points.data(), count);  // warm-up
+    double fused_us = 0.0;
+    double passes_us = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+      points = frame;
+      auto start = std::chrono::steady_clock::now();
+      fused.Apply(points.data(), count);
+      auto end = std::chrono::steady_clock::now();
+      fused_us += std::chrono::duration<double, std::micro>(end - start).count();
+
+      points = frame;
+      start = std::chrono::steady_clock::now();
+      for (const EffectsEngine& pass : passes) pass.Apply(points.data(), count);
+      end = std::chrono::steady_clock::now();
+      passes_us += std::chrono::duration<double, std::micro>(end - start).count();
+    }
+    fused_us /= iterations;
+    passes_us /= iterations;
+    std::printf("%6zu points: fused %8.1f us (%.2f ns per point), a pass per effect %8.1f us\n", count, fused_us,
+                fused_us * 1000.0 / static_cast<double>(count), passes_us);
+  }
+  return 0;
+}
@@ -0,0 +1,169 @@
+// Plays the bundled ILDA files through GalvoSimulator and scores what the
+// scanners would draw, with and without each optimizer stage, so optimizer
+// changes can be measured offline:
+//
+//   galvo_benchmark [frames per file] [ILDA directory]
+//
+// The directory defaults to src/ILDA-FILE-FORMAT-FILES, found from the
+// executable in build/Release.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "galvo_simulator.h"
+#include "path_planner.h"
+#include "point_optimizer.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+int16_t ReadInt16(const uint8_t* p) { return static_cast<int16_t>((p[0] << 8) | p[1]); }
+
+// Point frames of an ILDA file (formats 0, 1, 4 and 5) in the 8-float
+// layout, as ilda-parser.js reads them. Colour is left white: only
+// positions and blanking matter to the scanners.
+std::vector<std::vector<float>> ReadIlda(const fs::path& path, size_t max_frames) {
+  std::ifstream file(path, std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  std::vector<std::vector<float>> frames;
+  size_t offset = 0;
+  while (offset + 32 <= data.size() && frames.size() < max_frames) {
+    const uint8_t* header = &data[offset];
+    if (header[0] != 'I' || header[1] != 'L' || header[2] != 'D' || header[3] != 'A') {
+      ++offset;
+      continue;
+    }
+    const int format = header[7];
+    const size_t count = (header[24] << 8) | header[25];
+    size_t record = 0;
+    switch (format) {
+      case 0: record = 8; break;
+      case 1: record = 6; break;
+      case 2: record = 3; break;
+      case 4: record = 10; break;
+      case 5: record = 8; break;
+      default: offset += 32; continue;
+    }
+    if (offset + 32 + count * record > data.size()) break;
+    if (format != 2 && count > 0) {
+      const bool three_d = format == 0 || format == 4;
+      std::vector<float> points;
+      points.reserve(count * kPointStride);
+      for (size_t i = 0; i < count; ++i) {
+        const uint8_t* p = &data[offset + 32 + i * record];
+        const uint8_t status = p[three_d ? 6 : 4];
+        const float point[kPointStride] = {ReadInt16(p) / 32768.0f, ReadInt16(p + 2) / 32768.0f,
+                                           three_d ? ReadInt16(p + 4) / 32768.0f : 0.0f, 1.0f, 1.0f, 1.0f,
+                                           (status & 0x40) ? 1.0f : 0.0f, 0.0f};
+        points.insert(points.end(), point, point + kPointStride);
+        if (status & 0x80) break;
+      }
+      frames.push_back(std::move(points));
+    }
+    offset += 32 + count * record;
+  }
+  return frames;
+}
+
+struct Pipeline {
+  const char* name;
+  bool optimize;
+  bool corners;
+  bool reorder;
+  TraceScorer scorer;
+  size_t samples = 0;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t max_frames = argc > 1 ? static_cast<size_t>(std::atoi(argv[1])) : 20;
+  if (max_frames == 0) max_frames = 20;
+  fs::path directory = argc > 2 ? fs::path(argv[2])
+                                : fs::path(argv[0]).parent_path() / ".." / ".." / ".." / "src" / "ILDA-FILE-FORMAT-FILES";
+  std::error_code error;
+  if (!fs::is_directory(directory, error)) {
+    std::fprintf(stderr, "No ILDA directory at %s\n", directory.string().c_str());
+    return 1;
+  }
+
+  Pipeline pipelines[] = {
+    {"as authored", false, false, false, {}},
+    {"optimised, no corner dwell", true, false, false, {}},
+    {"optimised", true, true, false, {}},
+    {"reordered and optimised", true, true, true, {}},
+  };
+  PointOptimizer optimizer;
+  PathPlanner planner;
+  GalvoSimulator galvo;
+  std::vector<float> optimized;
+  std::vector<float> reordered;
+  std::vector<float> beam;
+  size_t files = 0;
+  size_t frames = 0;
+  double simulate_us = 0.0;
+  size_t simulated = 0;
+
+  for (const fs::directory_entry& entry : fs::recursive_directory_iterator(directory, error)) {
+    std::string extension = entry.path().extension().string();
+    if (!entry.is_regular_file() || (extension != ".ild" && extension != ".ILD")) continue;
+    std::vector<std::vector<float>> file_frames = ReadIlda(entry.path(), max_frames);
+    if (file_frames.empty()) continue;
+    ++files;
+    for (const std::vector<float>& frame : file_frames) {
+      ++frames;
+      const size_t count = frame.size() / kPointStride;
+      for (Pipeline& pipeline : pipelines) {
+        const float* samples = frame.data();
+        size_t total = count;
+        if (pipeline.optimize) {
+          if (pipeline.reorder) {
+            total = planner.Plan(samples, total, &reordered);
+            samples = reordered.data();
+          }
+          OptimizerOptions options;
+          if (!pipeline.corners) options.max_acceleration = 0.0;
+          optimizer.Configure(options);
+          total = optimizer.Optimize(samples, total, &optimized);
+          samples = optimized.data();
+        }
+        if (total == 0) continue;
+        // Frames repeat: one pass to settle, as the scanners would have
+        // drawn the frame before, then the scored one.
+        beam.resize(total * kPointStride);
+        galvo.Reset(samples + (total - 1) * kPointStride);
+        auto start = std::chrono::steady_clock::now();
+        galvo.Simulate(samples, total, beam.data());
+        auto end = std::chrono::steady_clock::now();
+        simulate_us += std::chrono::duration<double, std::micro>(end - start).count();
+        simulated += total;
+        galvo.Simulate(samples, total, beam.data());
+        pipeline.scorer.Add(samples, beam.data(), total);
+        pipeline.samples += total;
+      }
+    }
+  }
+
+  const GalvoOptions& model = galvo.options();
+  std::printf("%zu files, %zu frames; scanners at %.0f pps, %.0f Hz, %.0f%% overshoot\n", files, frames, model.pps,
+              model.bandwidth_hz, model.overshoot * 100.0);
+  std::printf("%-28s %9s %10s %10s %10s %10s %10s\n", "", "samples", "path err", "max err", "overshoot", "max over",
+              "bright cv");
+  for (const Pipeline& pipeline : pipelines) {
+    TraceScore score = pipeline.scorer.Result();
+    std::printf("%-28s %9zu %10.5f %10.5f %10.5f %10.5f %10.3f\n", pipeline.name, pipeline.samples, score.path_error,
+                score.max_path_error, score.overshoot, score.max_overshoot, score.brightness_variation);
+  }
+  if (simulated > 0) {
+    std::printf("simulation: %.2f ns per sample\n", simulate_us * 1000.0 / static_cast<double>(simulated));
+  }
+  return 0;
+}
@@ -0,0 +1,97 @@
+// Times PointOptimizer on frames from 1k to 60k points, the range where
+// optimizer.js used to give up (4000 points) and ILDA animations live, and
+// PathPlanner's segment reordering on the same frames.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "path_planner.h"
+#include "point_optimizer.h"
+
+namespace {
+
+// Closed shapes of 200 points on a circle, blanked jumps between them,
+// all moved by |shift|.
+std::vector<float> MakeFrame(size_t count, float shift = 0.0f) {
+  std::vector<float> points(count * kPointStride);
+  const size_t kShape = 200;
+  for (size_t i = 0; i < count; ++i) {
+    size_t shape = i / kShape;
+    double angle = 2 * 3.14159265358979323846 * static_cast<double>(i % kShape) / (kShape - 1);
+    float cx = static_cast<float>((shape * 37) % 17) / 8.5f - 1.0f;
+    float cy = static_cast<float>((shape * 53) % 13) / 6.5f - 1.0f;
+    float* p = &points[i * kPointStride];
+    p[0] = cx + 0.1f * static_cast<float>(std::cos(angle)) + shift;
+    p[1] = cy + 0.1f * static_cast<float>(std::sin(angle)) + shift;
+    p[2] = 0.0f;
+    p[3] = 1.0f;
+    p[4] = 0.5f;
+    p[5] = 0.25f;
+    p[6] = i % kShape == 0 ? 1.0f : 0.0f;
+    p[7] = 0.0f;
+  }
+  return points;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+  PointOptimizer optimizer;
+  std::vector<float> out;
+  for (size_t count : {1000, 4000, 30000, 60000}) {
+    std::vector<float> frame = MakeFrame(count);
+    size_t total = optimizer.Optimize(frame.data(), count, &out);  // warm-up sizes |out|
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) optimizer.Optimize(frame.data(), count, &out);
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    std::printf("%6zu points -> %6zu: %8.1f us per frame (%.2f ns per input point)\n", count, total, us,
+                us * 1000.0 / static_cast<double>(count));
+  }
+
+  // Reordering with the default budgets; the optimizer then has fewer
+  // blanked points to insert. A new frame every call (two frames in turn)
+  // pays for the search, an unchanged one only for the split and the copy
+  // out. Calls the time cap cut short, whose order depends on the machine's
+  // load, are counted; the run fails if the calls take longer than the cap
+  // on average.
+  PathPlanner planner;
+  std::vector<float> reordered;
+  const double budget_us = planner.options().budget_ms * 1000.0;
+  bool ok = true;
+  for (size_t count : {1000, 4000, 30000, 60000}) {
+    const std::vector<float> frames[2] = {MakeFrame(count), MakeFrame(count, 0.001f)};
+    size_t before = optimizer.Optimize(frames[0].data(), count, &out);
+    size_t planned = planner.Plan(frames[1].data(), count, &reordered);  // warm-up sizes |reordered|
+    double new_us = 0.0;
+    int timed_out = 0;
+    for (int i = 0; i < iterations; ++i) {
+      auto start = std::chrono::steady_clock::now();
+      planned = planner.Plan(frames[i & 1].data(), count, &reordered);
+      auto end = std::chrono::steady_clock::now();
+      new_us += std::chrono::duration<double, std::micro>(end - start).count();
+      timed_out += planner.stats().timed_out;
+    }
+    planned = planner.Plan(frames[0].data(), count, &reordered);
+    const PlanStats stats = planner.stats();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) planned = planner.Plan(frames[0].data(), count, &reordered);
+    auto end = std::chrono::steady_clock::now();
+    size_t after = optimizer.Optimize(reordered.data(), planned, &out);
+    new_us /= iterations;
+    std::printf(
+        "%6zu points, %4zu segments: reorder %7.1f us (%d timed out), unchanged %6.1f us, %6llu evaluations%s, "
+        "travel %.2f -> %.2f, optimised %zu -> %zu points%s\n",
+        count, stats.segments, new_us, timed_out,
+        std::chrono::duration<double, std::micro>(end - start).count() / iterations,
+        static_cast<unsigned long long>(stats.evaluations), stats.converged ? "" : " (all)", stats.travel_before,
+        stats.travel_after, before, after, new_us > budget_us ? "  FAIL: over the time cap" : "");
+    ok = ok && new_us <= budget_us;
+  }
+  return ok ? 0 : 1;
+}
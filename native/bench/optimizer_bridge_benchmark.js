@@ -0,0 +1,88 @@
+// Times optimizePoints() from src/utils/optimizer.js as the page calls it:
+// the frame crosses the context bridge into the preload, the addon's
+// PointOptimizer runs, and the result crosses back. structuredClone() stands
+// in for the bridge, which copies a typed array's whole buffer both ways.
+// Columns: the addon alone (pooled output, no copies), through the bridge
+// as src/preload.js does it (output sized by outputLength()), through the
+// bridge slicing the pooled output as the preload used to, and the JS
+// optimizer. Fails if the preload's way is slower than slicing.
+import { createRequire } from 'module';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+import { optimizePoints } from '../../src/utils/optimizer.js';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const require = createRequire(import.meta.url);
+const addon = require(path.join(__dirname, '..', 'build', 'Release', 'ndi_wrapper.node'));
+
+const iterations = Number(process.argv[2]) > 0 ? Number(process.argv[2]) : 200;
+const optimizer = new addon.PointOptimizer();
+
+// As optimizer_benchmark.cc: closed shapes of 200 points, blanked jumps
+// between them, all moved by |shift|.
+function makeFrame(count, shift = 0) {
+    const points = new Float32Array(count * 8);
+    for (let i = 0; i < count; i++) {
+        const shape = Math.floor(i / 200);
+        const angle = 2 * Math.PI * (i % 200) / 199;
+        const p = i * 8;
+        points[p] = ((shape * 37) % 17) / 8.5 - 1 + 0.1 * Math.cos(angle) + shift;
+        points[p + 1] = ((shape * 53) % 13) / 6.5 - 1 + 0.1 * Math.sin(angle) + shift;
+        points[p + 3] = 1;
+        points[p + 4] = 0.5;
+        points[p + 5] = 0.25;
+        points[p + 6] = i % 200 === 0 ? 1 : 0;
+    }
+    return points;
+}
+
+const preloaded = (points, options) => {
+    if (options) optimizer.configure(options);
+    return optimizer.optimize(points, new Float32Array(optimizer.outputLength(points)));
+};
+const sliced = (points, options) => {
+    if (options) optimizer.configure(options);
+    return optimizer.optimize(points).slice();
+};
+const bridged = (fn) => (points, options) => structuredClone(fn(structuredClone(points), options));
+
+// Microseconds per call, alternating two frames so a reordering search
+// runs every time: the mean of the fastest of five batches, as the copies
+// make single runs noisy.
+function time(frames, call) {
+    call(frames[1]);  // warm-up
+    const batch = Math.max(1, Math.ceil(iterations / 5));
+    let best = Infinity;
+    for (let round = 0; round < 5; round++) {
+        const start = process.hrtime.bigint();
+        for (let i = 0; i < batch; i++) call(frames[i & 1]);
+        best = Math.min(best, Number(process.hrtime.bigint() - start) / 1000 / batch);
+    }
+    return best;
+}
+
+let ok = true;
+for (const reorder of [false, true]) {
+    console.log(reorder ? 'with reorder:' : 'without reorder:');
+    for (const count of [1000, 4000, 30000, 60000]) {
+        const frames = [makeFrame(count), makeFrame(count, 0.001)];
+        const run = (api) => {
+            globalThis.electronAPI = api;
+            return time(frames, (points) => optimizePoints(points, { reorder }));
+        };
+        const native = time(frames, (points) => {
+            optimizer.configure({ reorder });
+            return optimizer.optimize(points);
+        });
+        const viaPreload = run({ optimizePoints: bridged(preloaded) });
+        const viaSlice = run({ optimizePoints: bridged(sliced) });
+        const js = reorder ? NaN : run(undefined);
+        const slower = count >= 30000 && viaPreload > viaSlice * 1.1;
+        console.log(`${String(count).padStart(6)} points: addon ${native.toFixed(1).padStart(7)} us, ` +
+            `preload ${viaPreload.toFixed(1).padStart(7)} us, sliced ${viaSlice.toFixed(1).padStart(7)} us` +
+            (reorder ? '' : `, js ${js.toFixed(1).padStart(8)} us`) + (slower ? '  FAIL: slower than slicing' : ''));
+        ok = ok && !slower;
+    }
+}
+process.exit(ok ? 0 : 1);
@@ -0,0 +1,43 @@
+// Runs the standalone native benchmarks built by `npm run build-native`,
+// then the ones that time the addon from Node. Extra arguments are passed
+// through, e.g. `npm run bench-native -- 500`.
+import { spawnSync } from 'child_process';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const buildDir = path.join(__dirname, '..', 'build', 'Release');
+const exe = process.platform === 'win32' ? '.exe' : '';
+
+const benchmarks = [
+    'scaler_benchmark',
+    'capture_benchmark',
+    'optimizer_benchmark',
+    'galvo_benchmark',
+    'effects_benchmark',
+];
+
+const scripts = [
+    'optimizer_bridge_benchmark.js',
+];
+
+const args = process.argv.slice(2);
+let failed = 0;
+for (const name of benchmarks) {
+    console.log(`--- ${name} ---`);
+    const result = spawnSync(path.join(buildDir, name + exe), args, { stdio: 'inherit' });
+    if (result.error) {
+        console.error(`Failed to run ${name}:`, result.error.message);
+        failed++;
+    } else if (result.status !== 0) {
+        failed++;
+    }
+}
+
+for (const name of scripts) {
+    console.log(`--- ${name} ---`);
+    const result = spawnSync(process.execPath, [path.join(__dirname, name), ...args], { stdio: 'inherit' });
+    if (result.error || result.status !== 0) failed++;
+}
+
+process.exit(failed === 0 ? 0 : 1);
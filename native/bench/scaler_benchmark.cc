@@ -0,0 +1,166 @@
+// Compares the capture-path downscalers at 1920x1080 -> 480x480 (and 4K)
+// using the same row stride layout NDI delivers, then times the row-parallel
+// stages (BGRA and UYVY scaling, luma and edge masks) on 1..N threads.
+// Exits non-zero if box is slower than nearest at 1920x1080 -> 480x480, the
+// bar for making it the receivers' default, unless it is within kReadMargin
+// of reading the source frame once: nearest only touches the source rows it
+// samples, less than half of them there, and where that beats a full read
+// of the frame no area average can match it.
+//
+// Usage: scaler_benchmark [iterations] [max threads]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "frame_analysis.h"
+#include "frame_scaler.h"
+#include "row_pool.h"
+
+namespace {
+
+struct Case {
+  int src_w;
+  int src_h;
+  int dst_w;
+  int dst_h;
+};
+
+std::vector<uint8_t> MakeTestFrame(int w, int h, int stride) {
+  std::vector<uint8_t> frame(static_cast<size_t>(stride) * h);
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      uint8_t* p = &frame[static_cast<size_t>(y) * stride + x * 4];
+      // Fine diagonal lines plus a gradient: the kind of content that aliases.
+      p[0] = static_cast<uint8_t>(((x + y) % 3 == 0) ? 255 : 0);
+      p[1] = static_cast<uint8_t>(x * 255 / w);
+      p[2] = static_cast<uint8_t>(y * 255 / h);
+      p[3] = 255;
+    }
+  }
+  return frame;
+}
+
+// A fused box pass runs at about 1.2x a plain read; the rest is for noise.
+constexpr double kReadMargin = 1.5;
+
+// Mean ms per call of the fastest of five batches, so the comparisons below
+// are not decided by a noisy neighbour.
+double TimeBatches(const std::function<void()>& call, int iterations) {
+  call();  // warm-up: builds span tables and faults in the destination
+  const int batch = std::max(1, iterations / 5);
+  double best = 0;
+  for (int round = 0; round < 5; ++round) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < batch; ++i) call();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count() / batch;
+    best = round == 0 ? ms : std::min(best, ms);
+  }
+  return best;
+}
+
+double TimeFilter(const std::vector<uint8_t>& src, const Case& c, int stride, ScaleFilter filter,
+                  std::vector<uint8_t>* dst, int iterations) {
+  return TimeBatches([&] {
+    ScaleBgra(src.data(), c.src_w, c.src_h, stride, dst->data(), c.dst_w, c.dst_h, filter);
+  }, iterations);
+}
+
+// Every source row copied into one row buffer that stays in L1: about the
+// least any filter reading the whole frame can cost.
+double TimeRead(const std::vector<uint8_t>& src, const Case& c, int stride, int iterations) {
+  std::vector<uint8_t> row(static_cast<size_t>(c.src_w) * 4);
+  volatile uint8_t sink = 0;
+  return TimeBatches([&] {
+    for (int y = 0; y < c.src_h; ++y) std::memcpy(row.data(), &src[static_cast<size_t>(y) * stride], row.size());
+    sink = sink + row[0];
+  }, iterations);
+}
+
+double TimeStage(const std::function<void()>& stage, int iterations) {
+  stage();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) stage();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// Per-frame cost of each capture stage against the thread count. The masks
+// run at the source size, the worst case a receiver can be asked for.
+void BenchThreads(int src_w, int src_h, int max_threads, int iterations) {
+  int stride = src_w * 4 + 64;
+  std::vector<uint8_t> src = MakeTestFrame(src_w, src_h, stride);
+  // The same bytes read as UYVY: twice the pixels per row, half the data.
+  int uyvy_w = src_w * 2;
+  std::vector<uint8_t> scaled(480 * 480 * 4);
+  std::vector<uint8_t> mask(static_cast<size_t>(src_w) * src_h);
+  AnalysisScratch scratch;
+
+  std::printf("\n%dx%d, ms per frame (speedup over 1 thread)\n", src_w, src_h);
+  std::printf("%-8s %-20s %-20s %-20s %-20s\n", "threads", "box bgra->480", "box uyvy->480", "luma mask", "edge mask");
+  double base[4] = {0, 0, 0, 0};
+  for (int threads = 1; threads <= max_threads; ++threads) {
+    RowPool pool(threads);
+    double ms[4] = {
+      TimeStage([&] { ScaleBgra(src.data(), src_w, src_h, stride, scaled.data(), 480, 480, ScaleFilter::kBox, &pool); }, iterations),
+      TimeStage([&] { ScaleUyvy(src.data(), uyvy_w, src_h, stride, scaled.data(), 480, 480, ScaleFilter::kBox, &pool); }, iterations),
+      TimeStage([&] { AnalyzeFrame(src.data(), src_w, src_h, stride, FrameAnalysis::kLuma, 128, &pool, &scratch, mask.data()); }, iterations),
+      TimeStage([&] { AnalyzeFrame(src.data(), src_w, src_h, stride, FrameAnalysis::kEdges, 64, &pool, &scratch, mask.data()); }, iterations),
+    };
+    std::printf("%-8d", threads);
+    for (int s = 0; s < 4; ++s) {
+      if (threads == 1) base[s] = ms[s];
+      char cell[32];
+      std::snprintf(cell, sizeof(cell), "%.3f (%.2fx)", ms[s], base[s] / ms[s]);
+      std::printf(" %-20s", cell);
+    }
+    std::printf("\n");
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+  int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  int max_threads = argc > 2 ? std::max(1, std::atoi(argv[2])) : std::min(cores, 16);
+  const Case cases[] = {
+    {1920, 1080, 480, 480},
+    {1920, 1080, 1280, 720},
+    {3840, 2160, 480, 480},
+  };
+
+  std::printf("Box filter backend: %s\n", ScalerBackendName());
+  bool box_ok = true;
+  for (const Case& c : cases) {
+    // NDI pads rows; use a stride wider than the image to match.
+    int stride = c.src_w * 4 + 64;
+    std::vector<uint8_t> src = MakeTestFrame(c.src_w, c.src_h, stride);
+    std::vector<uint8_t> dst(static_cast<size_t>(c.dst_w) * c.dst_h * 4);
+
+    double nearest = TimeFilter(src, c, stride, ScaleFilter::kNearest, &dst, iterations);
+    double box = TimeFilter(src, c, stride, ScaleFilter::kBox, &dst, iterations);
+    double bilinear = TimeFilter(src, c, stride, ScaleFilter::kBilinear, &dst, iterations);
+    double read = TimeRead(src, c, stride, iterations);
+    std::printf("%dx%d -> %dx%d: nearest %.3f ms, box %.3f ms (%.2fx), bilinear %.3f ms (%.2fx), frame read %.3f ms\n",
+        c.src_w, c.src_h, c.dst_w, c.dst_h,
+        nearest, box, nearest / box, bilinear, nearest / bilinear, read);
+    if (c.src_w == 1920 && c.dst_w == 480 && box > nearest && box > read * kReadMargin) box_ok = false;
+  }
+
+  // 4K frames are four times the work; keep the run about as long.
+  BenchThreads(1920, 1080, max_threads, std::max(1, iterations / 4));
+  BenchThreads(3840, 2160, max_threads, std::max(1, iterations / 16));
+  if (!box_ok) {
+    std::printf("\nFAIL: box is slower than nearest and than reading the frame at 1920x1080 -> 480x480\n");
+    return 1;
+  }
+  return 0;
+}
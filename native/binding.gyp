@@ -2,7 +2,7 @@
   "targets": [
     {
       "target_name": "ndi_wrapper",
-      "sources": [ "src/ndi_wrapper.cc" ],
+      "sources": [ "src/ndi_wrapper.cc", "src/point_optimizer.cc", "src/path_planner.cc", "src/galvo_simulator.cc", "src/effects_engine.cc", "src/frame_pool.cc", "src/frame_scaler.cc", "src/frame_analysis.cc", "src/row_pool.cc", "src/contour_tracer.cc", "src/frame_sync.cc", "src/bandwidth_policy.cc", "src/capture_stats.cc", "src/source_discovery.cc", "src/ndi_frame_source.cc", "src/synthetic_frame_source.cc", "src/frame_receiver.cc", "src/ndi_runtime.cc", "src/change_detector.cc", "src/shared_frame_ring.cc", "src/audio_analyzer.cc" ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
         "<(module_root_dir)/../sdk/NDI 6 SDK/Include"
@@ -16,11 +16,14 @@
           "AdditionalOptions": [ "/std:c++20" ]
         }
       },
+      "xcode_settings": {
+        "OTHER_CFLAGS": [ "-ffp-contract=off" ]
+      },
       "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-ffp-contract=off" ]
+        }],
         ['OS==\"win\"', {
-          "libraries": [
-            "<(module_root_dir)/../sdk/NDI 6 SDK/Libv6/x64/Processing.NDI.Lib.x64.lib"
-          ],
           "copies": [
             {
               "destination": "<(PRODUCT_DIR)",
@@ -29,8 +32,366 @@
               ]
             }
           ]
+        }],
+        ['OS==\"linux\"', {
+          "libraries": [ "-ldl", "-lrt" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "triple_buffer_stress",
+      "type": "executable",
+      "sources": [ "test/triple_buffer_stress.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "frame_scaler_test",
+      "type": "executable",
+      "sources": [ "test/frame_scaler_test.cc", "src/frame_scaler.cc", "src/row_pool.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "frame_analysis_test",
+      "type": "executable",
+      "sources": [ "test/frame_analysis_test.cc", "src/frame_analysis.cc", "src/row_pool.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "contour_tracer_test",
+      "type": "executable",
+      "sources": [ "test/contour_tracer_test.cc", "src/contour_tracer.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "frame_sync_test",
+      "type": "executable",
+      "sources": [ "test/frame_sync_test.cc", "src/frame_sync.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "bandwidth_policy_test",
+      "type": "executable",
+      "sources": [ "test/bandwidth_policy_test.cc", "src/bandwidth_policy.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "capture_stats_test",
+      "type": "executable",
+      "sources": [ "test/capture_stats_test.cc", "src/capture_stats.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "change_detector_test",
+      "type": "executable",
+      "sources": [ "test/change_detector_test.cc", "src/change_detector.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "audio_analyzer_test",
+      "type": "executable",
+      "sources": [ "test/audio_analyzer_test.cc", "src/audio_analyzer.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "shared_frame_ring_test",
+      "type": "executable",
+      "sources": [ "test/shared_frame_ring_test.cc", "src/shared_frame_ring.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }],
+        ['OS==\"linux\"', {
+          "libraries": [ "-lrt" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "frame_receiver_test",
+      "type": "executable",
+      "sources": [ "test/frame_receiver_test.cc", "src/frame_receiver.cc", "src/synthetic_frame_source.cc", "src/capture_stats.cc", "src/frame_scaler.cc", "src/frame_analysis.cc", "src/row_pool.cc", "src/contour_tracer.cc", "src/frame_pool.cc", "src/bandwidth_policy.cc", "src/change_detector.cc", "src/shared_frame_ring.cc", "src/audio_analyzer.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }],
+        ['OS==\"linux\"', {
+          "libraries": [ "-lrt" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "point_optimizer_test",
+      "type": "executable",
+      "sources": [ "test/point_optimizer_test.cc", "src/point_optimizer.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "path_planner_test",
+      "type": "executable",
+      "sources": [ "test/path_planner_test.cc", "src/path_planner.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "galvo_simulator_test",
+      "type": "executable",
+      "sources": [ "test/galvo_simulator_test.cc", "src/galvo_simulator.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "effects_engine_test",
+      "type": "executable",
+      "sources": [ "test/effects_engine_test.cc", "src/effects_engine.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "xcode_settings": {
+        "OTHER_CFLAGS": [ "-ffp-contract=off" ]
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread", "-ffp-contract=off" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "scaler_benchmark",
+      "type": "executable",
+      "sources": [ "bench/scaler_benchmark.cc", "src/frame_scaler.cc", "src/frame_analysis.cc", "src/row_pool.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "capture_benchmark",
+      "type": "executable",
+      "sources": [ "bench/capture_benchmark.cc", "src/frame_receiver.cc", "src/synthetic_frame_source.cc", "src/capture_stats.cc", "src/frame_scaler.cc", "src/frame_analysis.cc", "src/row_pool.cc", "src/contour_tracer.cc", "src/frame_pool.cc", "src/bandwidth_policy.cc", "src/change_detector.cc", "src/shared_frame_ring.cc", "src/audio_analyzer.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }],
+        ['OS==\"linux\"', {
+          "libraries": [ "-lrt" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "optimizer_benchmark",
+      "type": "executable",
+      "sources": [ "bench/optimizer_benchmark.cc", "src/point_optimizer.cc", "src/path_planner.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "galvo_benchmark",
+      "type": "executable",
+      "sources": [ "bench/galvo_benchmark.cc", "src/galvo_simulator.cc", "src/point_optimizer.cc", "src/path_planner.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread" ],
+          "ldflags": [ "-pthread" ]
+        }]
+      ]
+    },
+    {
+      "target_name": "effects_benchmark",
+      "type": "executable",
+      "sources": [ "bench/effects_benchmark.cc", "src/effects_engine.cc" ],
+      "include_dirs": [ "src" ],
+      "msvs_settings": {
+        "VCCLCompilerTool": {
+          "AdditionalOptions": [ "/std:c++20" ]
+        }
+      },
+      "xcode_settings": {
+        "OTHER_CFLAGS": [ "-ffp-contract=off" ]
+      },
+      "conditions": [
+        ['OS!=\"win\"', {
+          "cflags": [ "-pthread", "-ffp-contract=off" ],
+          "ldflags": [ "-pthread" ]
         }]
       ]
     }
   ]
-}
\ No newline at end of file
+}
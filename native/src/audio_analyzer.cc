@@ -0,0 +1,178 @@
+#include "audio_analyzer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+bool ValidFftSize(int size) {
+  return size >= AudioOptions::kMinFftSize && size <= AudioOptions::kMaxFftSize && (size & (size - 1)) == 0;
+}
+
+bool SameRange(const float* a, const float* b) { return a[0] == b[0] && a[1] == b[1]; }
+
+}  // namespace
+
+bool AudioOptions::operator==(const AudioOptions& other) const {
+  return fft_size == other.fft_size && smoothing == other.smoothing && min_db == other.min_db &&
+         max_db == other.max_db && SameRange(low_hz, other.low_hz) && SameRange(mid_hz, other.mid_hz) &&
+         SameRange(high_hz, other.high_hz) && peak == other.peak;
+}
+
+AudioAnalyzer::AudioAnalyzer() {
+  // Forces the first Configure to build the tables.
+  options_.fft_size = 0;
+  Configure(AudioOptions());
+}
+
+void AudioAnalyzer::Configure(const AudioOptions& requested) {
+  AudioOptions options = requested;
+  if (!ValidFftSize(options.fft_size)) options.fft_size = AudioOptions().fft_size;
+  options.smoothing = std::min(std::max(options.smoothing, 0.0f), 1.0f);
+  if (options == options_) return;
+  const bool resize = options.fft_size != options_.fft_size;
+  options_ = options;
+  if (!resize) return;
+
+  const int n = options_.fft_size;
+  const int half = n / 2;
+  history_.assign(n, 0.0f);
+  history_pos_ = 0;
+  window_.resize(n);
+  for (int i = 0; i < n; ++i) {
+    // Blackman, alpha 0.16, as the Web Audio spec defines it.
+    double x = static_cast<double>(i) / n;
+    window_[i] = static_cast<float>(0.42 - 0.5 * std::cos(2 * kPi * x) + 0.08 * std::cos(4 * kPi * x));
+  }
+  cos_.resize(half);
+  sin_.resize(half);
+  for (int i = 0; i < half; ++i) {
+    cos_[i] = static_cast<float>(std::cos(2 * kPi * i / n));
+    sin_[i] = static_cast<float>(-std::sin(2 * kPi * i / n));
+  }
+  int bits = 0;
+  while ((1 << bits) < n) ++bits;
+  bit_reverse_.resize(n);
+  for (int i = 0; i < n; ++i) {
+    uint32_t r = 0;
+    for (int b = 0; b < bits; ++b) r |= ((static_cast<uint32_t>(i) >> b) & 1u) << (bits - 1 - b);
+    bit_reverse_[i] = r;
+  }
+  re_.resize(n);
+  im_.resize(n);
+  smoothed_.assign(half, 0.0f);
+  spectrum_.assign(half, 0.0f);
+}
+
+void AudioAnalyzer::Reset() {
+  std::fill(history_.begin(), history_.end(), 0.0f);
+  history_pos_ = 0;
+  std::fill(smoothed_.begin(), smoothed_.end(), 0.0f);
+  std::fill(spectrum_.begin(), spectrum_.end(), 0.0f);
+  sample_rate_ = 0;
+  uint64_t sequence = bands_.sequence;
+  bands_ = AudioBands();
+  bands_.sequence = sequence;
+}
+
+void AudioAnalyzer::Process(const float* data, int channels, int samples, size_t channel_stride, int sample_rate,
+                            int64_t timestamp) {
+  if (!data || channels <= 0 || samples <= 0 || sample_rate <= 0) return;
+  if (sample_rate != sample_rate_) {
+    // The bins mean different frequencies now.
+    Reset();
+    sample_rate_ = sample_rate;
+  }
+  const size_t n = history_.size();
+  // Only the newest fft_size samples can reach the window.
+  int first = samples > static_cast<int>(n) ? samples - static_cast<int>(n) : 0;
+  const float scale = 1.0f / channels;
+  for (int i = first; i < samples; ++i) {
+    float sum = 0.0f;
+    for (int c = 0; c < channels; ++c) sum += data[c * channel_stride + i];
+    history_[history_pos_] = sum * scale;
+    history_pos_ = history_pos_ + 1 == n ? 0 : history_pos_ + 1;
+  }
+  bands_.timestamp = timestamp;
+  Analyze();
+  Publish();
+}
+
+void AudioAnalyzer::Analyze() {
+  const size_t n = history_.size();
+  const size_t half = n / 2;
+
+  // Oldest sample first, windowed, in bit-reversed order.
+  double square_sum = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    float sample = history_[(history_pos_ + i) % n];
+    square_sum += static_cast<double>(sample) * sample;
+    re_[bit_reverse_[i]] = sample * window_[i];
+    im_[bit_reverse_[i]] = 0.0f;
+  }
+  bands_.rms = static_cast<float>(std::sqrt(square_sum / n));
+
+  // Iterative radix-2 decimation in time.
+  for (size_t size = 2; size <= n; size <<= 1) {
+    const size_t step = n / size;
+    const size_t span = size / 2;
+    for (size_t start = 0; start < n; start += size) {
+      for (size_t k = 0; k < span; ++k) {
+        float wr = cos_[k * step];
+        float wi = sin_[k * step];
+        size_t a = start + k;
+        size_t b = a + span;
+        float tr = re_[b] * wr - im_[b] * wi;
+        float ti = re_[b] * wi + im_[b] * wr;
+        re_[b] = re_[a] - tr;
+        im_[b] = im_[a] - ti;
+        re_[a] += tr;
+        im_[a] += ti;
+      }
+    }
+  }
+
+  const float tau = options_.smoothing;
+  const float range = options_.max_db - options_.min_db;
+  const float norm = 1.0f / static_cast<float>(n);
+  for (size_t k = 0; k < half; ++k) {
+    float magnitude = std::sqrt(re_[k] * re_[k] + im_[k] * im_[k]) * norm;
+    smoothed_[k] = tau * smoothed_[k] + (1.0f - tau) * magnitude;
+    float value = 0.0f;
+    if (smoothed_[k] > 0.0f && range > 0.0f) {
+      float db = 20.0f * std::log10(smoothed_[k]);
+      value = std::min(std::max((db - options_.min_db) / range, 0.0f), 1.0f);
+    }
+    spectrum_[k] = value;
+  }
+
+  const float bin_hz = static_cast<float>(sample_rate_) / static_cast<float>(n);
+  auto band = [&](const float* hz) {
+    if (!(hz[0] >= 0.0f && hz[0] <= hz[1] && std::isfinite(hz[1]))) return 0.0f;
+    size_t begin = static_cast<size_t>(std::max(std::floor(hz[0] / bin_hz), 0.0f));
+    size_t end = static_cast<size_t>(std::min(std::floor(hz[1] / bin_hz) + 1.0f, static_cast<float>(half)));
+    if (begin >= end) return 0.0f;
+    float result = 0.0f;
+    for (size_t k = begin; k < end; ++k) result = options_.peak ? std::max(result, spectrum_[k]) : result + spectrum_[k];
+    return options_.peak ? result : result / static_cast<float>(end - begin);
+  };
+  bands_.low = band(options_.low_hz);
+  bands_.mid = band(options_.mid_hz);
+  bands_.high = band(options_.high_hz);
+  ++bands_.sequence;
+}
+
+void AudioAnalyzer::Publish() {
+  AudioLevels& levels = levels_.write_slot();
+  levels.bands = bands_;
+  levels.sample_rate = sample_rate_;
+  levels.spectrum.assign(spectrum_.begin(), spectrum_.end());
+  levels_.Publish();
+}
+
+const AudioLevels& AudioAnalyzer::Latest() {
+  levels_.Update();
+  return levels_.read_slot();
+}
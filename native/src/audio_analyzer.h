@@ -0,0 +1,98 @@
+#ifndef TRUELAZER_NATIVE_SRC_AUDIO_ANALYZER_H_
+#define TRUELAZER_NATIVE_SRC_AUDIO_ANALYZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "triple_buffer.h"
+
+// How AudioAnalyzer turns samples into levels. The defaults match the
+// renderer's WebAudio AnalyserNode and its FFT settings, so levels read the
+// same whichever side computed them.
+struct AudioOptions {
+  int fft_size = 2048;     // a power of two, kMinFftSize..kMaxFftSize
+  float smoothing = 0.8f;  // AnalyserNode.smoothingTimeConstant
+  float min_db = -100.0f;  // maps to 0
+  float max_db = -30.0f;   // maps to 1
+  float low_hz[2] = {20.0f, 250.0f};
+  float mid_hz[2] = {250.0f, 4000.0f};
+  float high_hz[2] = {4000.0f, 20000.0f};
+  bool peak = false;  // bands take their loudest bin instead of the mean
+
+  static constexpr int kMinFftSize = 32;
+  static constexpr int kMaxFftSize = 32768;
+  bool operator==(const AudioOptions& other) const;
+  bool operator!=(const AudioOptions& other) const { return !(*this == other); }
+};
+
+// Band levels in 0..1 as of one analysis.
+struct AudioBands {
+  float low = 0.0f;
+  float mid = 0.0f;
+  float high = 0.0f;
+  float rms = 0.0f;                // of the analysis window, before weighting
+  int64_t timestamp = INT64_MAX;   // of the newest audio frame, as kNoTimestamp
+  uint64_t sequence = 0;           // analyses so far; 0: no audio yet
+};
+
+struct AudioLevels {
+  AudioBands bands;
+  int sample_rate = 0;
+  std::vector<float> spectrum;  // fft_size / 2 bins in 0..1, smoothed
+};
+
+// Windowed FFT over the newest fft_size samples of a stream, run once per
+// incoming audio frame so levels follow the video they arrived with. As in
+// an AnalyserNode: Blackman window, magnitudes smoothed over time, then
+// mapped from [min_db, max_db] to 0..1. Bands average (or peak) the bins
+// from floor(lo / bin width) to floor(hi / bin width).
+//
+// Configure, Process and bands() belong to the producer (capture) thread.
+// Each analysis is published through a triple buffer, so one other thread
+// can read the newest levels and spectrum with Latest() without locking.
+class AudioAnalyzer {
+ public:
+  AudioAnalyzer();
+
+  // Rebuilds the tables when |options| differ from the current ones. An
+  // invalid fft_size falls back to the default.
+  void Configure(const AudioOptions& options);
+
+  // |channels| planes of |samples| floats, |channel_stride| floats apart,
+  // as NDI delivers them; mixed down to mono.
+  void Process(const float* data, int channels, int samples, size_t channel_stride, int sample_rate,
+               int64_t timestamp);
+
+  // Forgets the history; the next Process starts from silence.
+  void Reset();
+
+  // The newest analysis, on the producer thread.
+  const AudioBands& bands() const { return bands_; }
+
+  // Consumer side: the newest published analysis, sequence 0 until there
+  // is one. Stays valid until the next call.
+  const AudioLevels& Latest();
+
+ private:
+  void Analyze();
+  void Publish();
+
+  AudioOptions options_;
+  int sample_rate_ = 0;
+  std::vector<float> history_;  // ring of the newest fft_size samples
+  size_t history_pos_ = 0;
+  std::vector<float> window_;
+  std::vector<float> cos_;      // twiddles, fft_size / 2
+  std::vector<float> sin_;
+  std::vector<uint32_t> bit_reverse_;
+  std::vector<float> re_;
+  std::vector<float> im_;
+  std::vector<float> smoothed_;  // linear magnitudes, fft_size / 2
+  std::vector<float> spectrum_;  // 0..1
+  AudioBands bands_;
+
+  TripleBuffer<AudioLevels> levels_;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_AUDIO_ANALYZER_H_
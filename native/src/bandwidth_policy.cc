@@ -0,0 +1,44 @@
+#include "bandwidth_policy.h"
+
+#include <algorithm>
+
+bool ParseRecvBandwidth(const std::string& name, RecvBandwidth* bandwidth) {
+  if (name == "auto") {
+    *bandwidth = RecvBandwidth::kAuto;
+  } else if (name == "highest") {
+    *bandwidth = RecvBandwidth::kHighest;
+  } else if (name == "lowest") {
+    *bandwidth = RecvBandwidth::kLowest;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* RecvBandwidthName(RecvBandwidth bandwidth) {
+  switch (bandwidth) {
+    case RecvBandwidth::kHighest: return "highest";
+    case RecvBandwidth::kLowest: return "lowest";
+    case RecvBandwidth::kAuto:
+    default: return "auto";
+  }
+}
+
+bool BandwidthPolicy::Update(RecvBandwidth mode, int target_width, int target_height) {
+  if (mode == RecvBandwidth::kHighest) {
+    proxy_ = false;
+  } else if (mode == RecvBandwidth::kLowest) {
+    proxy_ = true;
+  } else if (target_width <= 0 || target_height <= 0) {
+    proxy_ = false;
+  } else {
+    int longest = std::max(target_width, target_height);
+    bool fits = proxy_size_ == 0 || longest <= proxy_size_;
+    proxy_ = fits && longest <= (proxy_ ? kLeaveProxy : kEnterProxy);
+  }
+  return proxy_;
+}
+
+void BandwidthPolicy::ObserveProxyFrame(int width, int height) {
+  proxy_size_ = std::max(width, height);
+}
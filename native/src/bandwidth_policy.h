@@ -0,0 +1,45 @@
+#ifndef TRUELAZER_NATIVE_SRC_BANDWIDTH_POLICY_H_
+#define TRUELAZER_NATIVE_SRC_BANDWIDTH_POLICY_H_
+
+#include <string>
+
+// Which of a sender's two streams an NDI receiver pulls. Senders publish a
+// full-resolution stream and a low-bandwidth proxy (typically 640x360 for
+// HD sources), so small capture targets never need the full one.
+enum class RecvBandwidth {
+  kAuto,     // pick from the target size, see BandwidthPolicy
+  kHighest,
+  kLowest,   // the proxy stream
+};
+
+bool ParseRecvBandwidth(const std::string& name, RecvBandwidth* bandwidth);
+const char* RecvBandwidthName(RecvBandwidth bandwidth);
+
+// Decides, per capture target, whether the proxy stream is enough. Each
+// switch reconnects the receiver, so auto mode uses hysteresis: it enters
+// the proxy only when the target's longer side is at most kEnterProxy and
+// leaves it only once that side exceeds kLeaveProxy.
+//
+// A sender's proxy may be smaller than usual. Once a proxy frame has been
+// seen, targets larger than it go back to the full stream and stay there
+// until they fit again.
+class BandwidthPolicy {
+ public:
+  static constexpr int kEnterProxy = 480;
+  static constexpr int kLeaveProxy = 640;
+
+  // Returns true if the receiver should use the proxy stream. Sizes <= 0
+  // mean source resolution, which always needs the full stream.
+  bool Update(RecvBandwidth mode, int target_width, int target_height);
+
+  // Records the size of a frame received on the proxy stream.
+  void ObserveProxyFrame(int width, int height);
+
+  bool proxy() const { return proxy_; }
+
+ private:
+  bool proxy_ = false;
+  int proxy_size_ = 0;  // longer side of the last proxy frame, 0 if unknown
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_BANDWIDTH_POLICY_H_
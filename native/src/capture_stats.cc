@@ -0,0 +1,108 @@
+#include "capture_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+uint64_t HistogramSnapshot::Percentile(double p) const {
+  if (count == 0) return 0;
+  uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * count));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t seen = 0;
+  for (int i = 0; i < kBuckets; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) return std::min(Histogram::BucketLimit(i), max);
+  }
+  return max;
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot& other) {
+  for (int i = 0; i < kBuckets; ++i) buckets[i] += other.buckets[i];
+  count += other.count;
+  sum += other.sum;
+  max = std::max(max, other.max);
+}
+
+int Histogram::BucketFor(uint64_t value) {
+  int bits = 0;
+  while (value) {
+    ++bits;
+    value >>= 1;
+  }
+  return std::min(bits, HistogramSnapshot::kBuckets - 1);
+}
+
+uint64_t Histogram::BucketLimit(int bucket) {
+  if (bucket >= HistogramSnapshot::kBuckets - 1) return UINT64_MAX;
+  return uint64_t{1} << bucket;
+}
+
+void Histogram::Record(uint64_t value) {
+  buckets_[BucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+HistogramSnapshot Histogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  for (int i = 0; i < HistogramSnapshot::kBuckets; ++i) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+  }
+  snapshot.count = count_.load(std::memory_order_relaxed);
+  snapshot.sum = sum_.load(std::memory_order_relaxed);
+  snapshot.max = max_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+void Histogram::Reset() {
+  for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+  count_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
+
+void CaptureStatsSnapshot::Merge(const CaptureStatsSnapshot& other) {
+  received += other.received;
+  dropped += other.dropped;
+  overwritten += other.overwritten;
+  unchanged += other.unchanged;
+  queue_depth += other.queue_depth;
+  max_queue_depth = std::max(max_queue_depth, other.max_queue_depth);
+  recv_wait_us.Merge(other.recv_wait_us);
+  process_us.Merge(other.process_us);
+  latency_us.Merge(other.latency_us);
+}
+
+void CaptureStats::SetQueueDepth(int depth) {
+  queue_depth_.store(depth, std::memory_order_relaxed);
+  if (depth > max_queue_depth_.load(std::memory_order_relaxed)) {
+    max_queue_depth_.store(depth, std::memory_order_relaxed);
+  }
+}
+
+CaptureStatsSnapshot CaptureStats::Snapshot() const {
+  CaptureStatsSnapshot snapshot;
+  snapshot.received = received_.load(std::memory_order_relaxed);
+  snapshot.dropped = dropped_.load(std::memory_order_relaxed);
+  snapshot.overwritten = overwritten_.load(std::memory_order_relaxed);
+  snapshot.unchanged = unchanged_.load(std::memory_order_relaxed);
+  snapshot.queue_depth = queue_depth_.load(std::memory_order_relaxed);
+  snapshot.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+  snapshot.recv_wait_us = recv_wait_us_.Snapshot();
+  snapshot.process_us = process_us_.Snapshot();
+  snapshot.latency_us = latency_us_.Snapshot();
+  return snapshot;
+}
+
+void CaptureStats::Reset() {
+  received_.store(0, std::memory_order_relaxed);
+  dropped_.store(0, std::memory_order_relaxed);
+  overwritten_.store(0, std::memory_order_relaxed);
+  unchanged_.store(0, std::memory_order_relaxed);
+  max_queue_depth_.store(queue_depth_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  recv_wait_us_.Reset();
+  process_us_.Reset();
+  latency_us_.Reset();
+}
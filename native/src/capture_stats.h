@@ -0,0 +1,89 @@
+#ifndef TRUELAZER_NATIVE_SRC_CAPTURE_STATS_H_
+#define TRUELAZER_NATIVE_SRC_CAPTURE_STATS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Telemetry a receiver's capture thread collects about itself. Recording is
+// a handful of relaxed atomic adds, so it stays on in release builds;
+// readers on other threads get a slightly torn but monotonic view.
+
+// Bucket counts of one histogram. Bucket 0 holds zero; bucket i > 0 holds
+// values in [2^(i-1), 2^i), and the last bucket everything above.
+struct HistogramSnapshot {
+  static constexpr int kBuckets = 32;
+  std::array<uint64_t, kBuckets> buckets{};
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+  double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+  // Upper edge of the bucket holding the |p|-th percentile (0..100), so
+  // estimates are at most a factor of two high. 0 when empty.
+  uint64_t Percentile(double p) const;
+  // Adds |other| in, e.g. to combine several receivers.
+  void Merge(const HistogramSnapshot& other);
+};
+
+// Lock-free log2 histogram of non-negative integers (here microseconds).
+class Histogram {
+ public:
+  static int BucketFor(uint64_t value);
+  // Exclusive upper edge of |bucket|.
+  static uint64_t BucketLimit(int bucket);
+
+  void Record(uint64_t value);
+  HistogramSnapshot Snapshot() const;
+  void Reset();
+
+ private:
+  std::array<std::atomic<uint64_t>, HistogramSnapshot::kBuckets> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+struct CaptureStatsSnapshot {
+  uint64_t received = 0;     // video frames taken from the SDK
+  uint64_t dropped = 0;      // frames the SDK dropped before we read them
+  uint64_t overwritten = 0;  // published frames replaced before JS took them
+  uint64_t unchanged = 0;    // published frames flagged as repeats, see ChangeDetector
+  int queue_depth = 0;       // frames waiting in the SDK, last sample
+  int max_queue_depth = 0;
+  HistogramSnapshot recv_wait_us;  // time blocked in capture per frame
+  HistogramSnapshot process_us;    // scale, convert, analyse and trace
+  HistogramSnapshot latency_us;    // sender timestamp to arrival
+
+  void Merge(const CaptureStatsSnapshot& other);
+};
+
+// Written by one capture thread, readable from any thread.
+class CaptureStats {
+ public:
+  void AddReceived() { received_.fetch_add(1, std::memory_order_relaxed); }
+  void AddDropped(uint64_t frames) { dropped_.fetch_add(frames, std::memory_order_relaxed); }
+  void AddOverwritten() { overwritten_.fetch_add(1, std::memory_order_relaxed); }
+  void AddUnchanged() { unchanged_.fetch_add(1, std::memory_order_relaxed); }
+  void SetQueueDepth(int depth);
+
+  Histogram& recv_wait_us() { return recv_wait_us_; }
+  Histogram& process_us() { return process_us_; }
+  Histogram& latency_us() { return latency_us_; }
+
+  CaptureStatsSnapshot Snapshot() const;
+  void Reset();
+
+ private:
+  std::atomic<uint64_t> received_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> overwritten_{0};
+  std::atomic<uint64_t> unchanged_{0};
+  std::atomic<int> queue_depth_{0};
+  std::atomic<int> max_queue_depth_{0};
+  Histogram recv_wait_us_;
+  Histogram process_us_;
+  Histogram latency_us_;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_CAPTURE_STATS_H_
@@ -0,0 +1,112 @@
+#include "change_detector.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Sum of absolute differences over |count| bytes.
+uint32_t Sad(const uint8_t* a, const uint8_t* b, int count) {
+  uint32_t sum = 0;
+  for (int i = 0; i < count; ++i) sum += static_cast<uint32_t>(a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]);
+  return sum;
+}
+
+}  // namespace
+
+bool ChangeDetector::Update(const uint8_t* data, int width, int height, int stride, int bytes_per_pixel, int threshold,
+                            std::vector<DirtyRect>* dirty) {
+  dirty->clear();
+  if (width <= 0 || height <= 0) return false;
+  threshold = std::max(threshold, 0);
+  const size_t row_bytes = static_cast<size_t>(width) * bytes_per_pixel;
+
+  if (width != width_ || height != height_ || bytes_per_pixel != bytes_per_pixel_) {
+    width_ = width;
+    height_ = height;
+    bytes_per_pixel_ = bytes_per_pixel;
+    tiles_x_ = (width + kTileSize - 1) / kTileSize;
+    tiles_y_ = (height + kTileSize - 1) / kTileSize;
+    reference_.resize(row_bytes * height);
+    for (int y = 0; y < height; ++y) std::memcpy(&reference_[y * row_bytes], data + static_cast<size_t>(y) * stride, row_bytes);
+    dirty->push_back(DirtyRect{0, 0, width, height});
+    return true;
+  }
+
+  // Tiles are compared a row of tiles at a time, so every source row is
+  // read once and in order.
+  tile_dirty_.assign(static_cast<size_t>(tiles_x_) * tiles_y_, 0);
+  sums_.resize(tiles_x_);
+  bool changed = false;
+  for (int ty = 0; ty < tiles_y_; ++ty) {
+    int y0 = ty * kTileSize;
+    int y1 = std::min(y0 + kTileSize, height);
+    std::fill(sums_.begin(), sums_.end(), 0u);
+    for (int y = y0; y < y1; ++y) {
+      const uint8_t* row = data + static_cast<size_t>(y) * stride;
+      const uint8_t* ref = &reference_[y * row_bytes];
+      for (int tx = 0; tx < tiles_x_; ++tx) {
+        int x0 = tx * kTileSize * bytes_per_pixel;
+        int x1 = std::min((tx + 1) * kTileSize, width) * bytes_per_pixel;
+        sums_[tx] += Sad(row + x0, ref + x0, x1 - x0);
+      }
+    }
+    for (int tx = 0; tx < tiles_x_; ++tx) {
+      uint32_t tile_bytes = static_cast<uint32_t>((std::min((tx + 1) * kTileSize, width) - tx * kTileSize) * bytes_per_pixel * (y1 - y0));
+      if (sums_[tx] <= static_cast<uint32_t>(threshold) * tile_bytes) continue;
+      tile_dirty_[ty * tiles_x_ + tx] = 1;
+      changed = true;
+      int x0 = tx * kTileSize * bytes_per_pixel;
+      int x1 = std::min((tx + 1) * kTileSize, width) * bytes_per_pixel;
+      for (int y = y0; y < y1; ++y) {
+        std::memcpy(&reference_[y * row_bytes + x0], data + static_cast<size_t>(y) * stride + x0, x1 - x0);
+      }
+    }
+  }
+  if (changed) MergeTiles(dirty);
+  return changed;
+}
+
+// Joins dirty tiles into horizontal runs, then stacks runs that span the
+// same columns on consecutive tile rows.
+void ChangeDetector::MergeTiles(std::vector<DirtyRect>* dirty) {
+  open_.clear();
+  for (int ty = 0; ty < tiles_y_; ++ty) {
+    next_open_.clear();
+    for (int tx = 0; tx < tiles_x_; ++tx) {
+      if (!tile_dirty_[ty * tiles_x_ + tx]) continue;
+      int run = tx;
+      while (run + 1 < tiles_x_ && tile_dirty_[ty * tiles_x_ + run + 1]) ++run;
+      DirtyRect rect;
+      rect.x = tx * kTileSize;
+      rect.y = ty * kTileSize;
+      rect.width = std::min((run + 1) * kTileSize, width_) - rect.x;
+      rect.height = std::min(rect.y + kTileSize, height_) - rect.y;
+      // Rects still open end on the previous tile row.
+      size_t index = dirty->size();
+      for (size_t i : open_) {
+        DirtyRect& above = (*dirty)[i];
+        if (above.x == rect.x && above.width == rect.width) {
+          above.height += rect.height;
+          index = i;
+          break;
+        }
+      }
+      if (index == dirty->size()) dirty->push_back(rect);
+      next_open_.push_back(index);
+      tx = run;
+    }
+    open_.swap(next_open_);
+  }
+
+  if (dirty->size() > kMaxDirtyRects) {
+    int left = width_, top = height_, right = 0, bottom = 0;
+    for (const DirtyRect& rect : *dirty) {
+      left = std::min(left, rect.x);
+      top = std::min(top, rect.y);
+      right = std::max(right, rect.x + rect.width);
+      bottom = std::max(bottom, rect.y + rect.height);
+    }
+    dirty->assign(1, DirtyRect{left, top, right - left, bottom - top});
+  }
+}
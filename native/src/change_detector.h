@@ -0,0 +1,57 @@
+#ifndef TRUELAZER_NATIVE_SRC_CHANGE_DETECTOR_H_
+#define TRUELAZER_NATIVE_SRC_CHANGE_DETECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A changed region of a frame, in pixels of the frame that was compared.
+struct DirtyRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// Finds what changed between consecutive frames of one stream, so static
+// sources (slides, logos, paused media) can skip the work of redrawing an
+// identical picture. Frames are split into kTileSize tiles; a tile is dirty
+// when its mean absolute difference against the reference exceeds the
+// threshold. Only dirty tiles are copied into the reference, so slow
+// drifts still add up to a change instead of creeping past unnoticed.
+//
+// Not thread-safe; one detector per capture thread.
+class ChangeDetector {
+ public:
+  static constexpr int kTileSize = 16;
+  // More rects than this collapse into their bounding box.
+  static constexpr size_t kMaxDirtyRects = 32;
+
+  // Compares |data| (|height| rows of |width| pixels, |bytes_per_pixel|
+  // bytes each, |stride| bytes apart) with the reference. Returns true if
+  // anything changed and fills |dirty| with the changed area, merged from
+  // tiles. The first frame, and any frame whose size or pixel size differs
+  // from the last, is dirty as a whole. |threshold| is in units of a
+  // single byte; 0 flags any difference.
+  bool Update(const uint8_t* data, int width, int height, int stride, int bytes_per_pixel, int threshold,
+              std::vector<DirtyRect>* dirty);
+
+  // Forgets the reference; the next frame counts as changed.
+  void Reset() { width_ = 0; }
+
+ private:
+  void MergeTiles(std::vector<DirtyRect>* dirty);
+
+  int width_ = 0;
+  int height_ = 0;
+  int bytes_per_pixel_ = 0;
+  int tiles_x_ = 0;
+  int tiles_y_ = 0;
+  std::vector<uint8_t> reference_;  // packed rows
+  std::vector<uint8_t> tile_dirty_;
+  std::vector<uint32_t> sums_;       // per tile of the current tile row
+  std::vector<size_t> open_;         // rects that may grow down a row
+  std::vector<size_t> next_open_;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_CHANGE_DETECTOR_H_
@@ -0,0 +1,343 @@
+#include "contour_tracer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+// Cell edges, clockwise from the top. A contour leaves a cell through one
+// edge and enters the neighbour through the opposite one.
+enum Edge { kTop = 0, kRight = 1, kBottom = 2, kLeft = 3 };
+
+// Past ~6 px of tolerance small rings collapse into slivers; dropping whole
+// contours looks better than that.
+constexpr int kMaxEpsilonSteps = 4;
+constexpr float kEpsilonGrowth = 1.6f;
+
+// Marching squares over the (width + 1) x (height + 1) cells whose corners are
+// pixels, with everything outside the frame treated as background so every
+// contour closes. Contours are walked with the foreground on the right.
+//
+// Works on a 0/1 copy of the mask with a one-pixel zero border, so cell
+// (cx, cy) has its top-left corner at padded pixel (cx, cy) and nothing needs
+// a bounds check.
+class MarchingSquares {
+ public:
+  MarchingSquares(const uint8_t* mask, int width, int height, std::vector<uint8_t>* padded)
+      : width_(width), height_(height), stride_(width + 2) {
+    padded->assign(static_cast<size_t>(stride_) * (height + 2), 0);
+    for (int y = 0; y < height; ++y) {
+      const uint8_t* src = mask + static_cast<size_t>(y) * width;
+      uint8_t* dst = padded->data() + static_cast<size_t>(y + 1) * stride_ + 1;
+      for (int x = 0; x < width; ++x) dst[x] = src[x] != 0;
+    }
+    bin_ = padded->data();
+  }
+
+  int cells_x() const { return width_ + 1; }
+  int cells_y() const { return height_ + 1; }
+
+  // Bitmask of the edges a contour leaves cell (cx, cy) through.
+  int Exits(int cx, int cy) const {
+    const uint8_t* top = bin_ + static_cast<size_t>(cy) * stride_ + cx;
+    const uint8_t* bottom = top + stride_;
+    bool tl = top[0], tr = top[1];
+    bool bl = bottom[0], br = bottom[1];
+    return (tr && !tl ? 1 << kTop : 0) | (br && !tr ? 1 << kRight : 0) |
+           (bl && !br ? 1 << kBottom : 0) | (tl && !bl ? 1 << kLeft : 0);
+  }
+
+  // Number of cells from (cx, cy) on that certainly have no exits because all
+  // their corners share one value. Checks eight corner columns at a time.
+  int UniformRun(int cx, int cy) const {
+    if (cx + 8 > stride_) return 0;
+    const uint8_t* top = bin_ + static_cast<size_t>(cy) * stride_ + cx;
+    uint64_t a, b;
+    std::memcpy(&a, top, 8);
+    std::memcpy(&b, top + stride_, 8);
+    const uint64_t kOnes = 0x0101010101010101ull;
+    return (a == b && (a == 0 || a == kOnes)) ? 7 : 0;
+  }
+
+  // Exit edge for a contour entering (cx, cy) through |entry|. Saddle cells
+  // keep their two foreground corners apart.
+  int ExitFor(int cx, int cy, int entry) const {
+    int exits = Exits(cx, cy);
+    if (exits == ((1 << kRight) | (1 << kLeft))) return entry == kTop ? kLeft : kRight;
+    if (exits == ((1 << kTop) | (1 << kBottom))) return entry == kRight ? kTop : kBottom;
+    for (int e = 0; e < 4; ++e) {
+      if (exits & (1 << e)) return e;
+    }
+    return -1;
+  }
+
+  // Foreground pixel on the right of an exit, used for the point colour.
+  static void ExitPixel(int cx, int cy, int edge, int* px, int* py) {
+    static const int kDx[4] = {0, 0, -1, -1};
+    static const int kDy[4] = {-1, 0, 0, -1};
+    *px = cx + kDx[edge];
+    *py = cy + kDy[edge];
+  }
+
+  // Exit midpoint in pixel coordinates.
+  static void ExitPoint(int cx, int cy, int edge, float* x, float* y) {
+    static const float kX[4] = {-0.5f, 0.0f, -0.5f, -1.0f};
+    static const float kY[4] = {-1.0f, -0.5f, 0.0f, -0.5f};
+    *x = static_cast<float>(cx) + kX[edge];
+    *y = static_cast<float>(cy) + kY[edge];
+  }
+
+ private:
+  const uint8_t* bin_;
+  int width_;
+  int height_;
+  int stride_;
+};
+
+struct ColorSource {
+  const uint8_t* mask;
+  const uint8_t* bgra;
+  int width;
+  int stride;
+
+  void At(int x, int y, TracePoint* p) const {
+    if (bgra) {
+      const uint8_t* px = bgra + static_cast<size_t>(y) * stride + x * 4;
+      p->r = px[2];
+      p->g = px[1];
+      p->b = px[0];
+    } else {
+      uint8_t c = mask[y * width + x];
+      p->r = static_cast<uint8_t>((c >> 5) * 255 / 7);
+      p->g = static_cast<uint8_t>(((c >> 2) & 7) * 255 / 7);
+      p->b = static_cast<uint8_t>((c & 3) * 255 / 3);
+    }
+  }
+};
+
+void ExtractOutlines(const uint8_t* mask, int width, int height, const ColorSource& colors,
+                     int min_length, TraceScratch* s, int* dropped) {
+  MarchingSquares squares(mask, width, height, &s->padded);
+  const int cells_x = squares.cells_x();
+  const int cells_y = squares.cells_y();
+  s->visited.assign(static_cast<size_t>(cells_x) * cells_y, 0);
+  s->outline.clear();
+  s->starts.clear();
+
+  for (int cy = 0; cy < cells_y; ++cy) {
+    for (int cx = 0; cx < cells_x; ++cx) {
+      int skip = squares.UniformRun(cx, cy);
+      if (skip) {
+        cx += skip - 1;
+        continue;
+      }
+      int exits = squares.Exits(cx, cy);
+      if (!exits) continue;
+      for (int start_edge = 0; start_edge < 4; ++start_edge) {
+        if (!(exits & (1 << start_edge))) continue;
+        if (s->visited[cy * cells_x + cx] & (1 << start_edge)) continue;
+
+        int begin = static_cast<int>(s->outline.size());
+        int x = cx, y = cy, edge = start_edge;
+        while (edge >= 0 && !(s->visited[y * cells_x + x] & (1 << edge))) {
+          s->visited[y * cells_x + x] |= static_cast<uint8_t>(1 << edge);
+          TracePoint p;
+          MarchingSquares::ExitPoint(x, y, edge, &p.x, &p.y);
+          int px, py;
+          MarchingSquares::ExitPixel(x, y, edge, &px, &py);
+          colors.At(px, py, &p);
+          s->outline.push_back(p);
+
+          if (edge == kTop) --y;
+          else if (edge == kRight) ++x;
+          else if (edge == kBottom) ++y;
+          else --x;
+          edge = squares.ExitFor(x, y, (edge + 2) % 4);
+        }
+
+        if (static_cast<int>(s->outline.size()) - begin < min_length) {
+          s->outline.resize(begin);
+          ++*dropped;
+        } else {
+          s->starts.push_back(begin);
+        }
+      }
+    }
+  }
+  s->starts.push_back(static_cast<int>(s->outline.size()));
+}
+
+float SegmentDistanceSq(const TracePoint& p, const TracePoint& a, const TracePoint& b) {
+  float dx = b.x - a.x, dy = b.y - a.y;
+  float len_sq = dx * dx + dy * dy;
+  float t = len_sq > 0.0f ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / len_sq : 0.0f;
+  t = std::clamp(t, 0.0f, 1.0f);
+  float ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+  return ex * ex + ey * ey;
+}
+
+// Douglas-Peucker over the closed ring ring[0, n). The ring is split
+// at the vertex farthest from its first vertex so both halves are open runs.
+void SimplifyRing(const TracePoint* ring, int n, float epsilon, TraceScratch* s) {
+  s->keep.assign(n + 1, 0);
+  // Index n is the ring's first vertex again.
+  auto at = [&](int i) -> const TracePoint& { return ring[i == n ? 0 : i]; };
+
+  int far = 0;
+  float far_dist = -1.0f;
+  for (int i = 1; i < n; ++i) {
+    float dx = ring[i].x - ring[0].x, dy = ring[i].y - ring[0].y;
+    float d = dx * dx + dy * dy;
+    if (d > far_dist) {
+      far_dist = d;
+      far = i;
+    }
+  }
+  s->keep[0] = s->keep[far] = s->keep[n] = 1;
+
+  const float eps_sq = epsilon * epsilon;
+  s->stack.clear();
+  s->stack.insert(s->stack.end(), {0, far, far, n});
+  while (!s->stack.empty()) {
+    int b = s->stack.back(); s->stack.pop_back();
+    int a = s->stack.back(); s->stack.pop_back();
+    int split = -1;
+    float max_dist = eps_sq;
+    for (int i = a + 1; i < b; ++i) {
+      float d = SegmentDistanceSq(at(i), at(a), at(b));
+      if (d > max_dist) {
+        max_dist = d;
+        split = i;
+      }
+    }
+    if (split < 0) continue;
+    s->keep[split] = 1;
+    s->stack.insert(s->stack.end(), {a, split, split, b});
+  }
+
+  for (int i = 0; i < n; ++i) {
+    if (s->keep[i]) s->simplified.push_back(ring[i]);
+  }
+}
+
+// Points emitted for the simplified contours: every ring is closed by
+// repeating its first vertex, and each one costs two blanked points.
+int SimplifyAll(float epsilon, TraceScratch* s) {
+  s->simplified.clear();
+  s->kept_starts.clear();
+  int total = 0;
+  int contours = static_cast<int>(s->starts.size()) - 1;
+  for (int c = 0; c < contours; ++c) {
+    int begin = s->starts[c];
+    s->kept_starts.push_back(static_cast<int>(s->simplified.size()));
+    SimplifyRing(&s->outline[begin], s->starts[c + 1] - begin, epsilon, s);
+    total += static_cast<int>(s->simplified.size()) - s->kept_starts.back() + 3;
+  }
+  s->kept_starts.push_back(static_cast<int>(s->simplified.size()));
+  return total;
+}
+
+// Outline points sit half a pixel outside the foreground, so contours along
+// the frame edge are clamped back into range.
+void AppendPoint(const TracePoint& p, bool blank, float sx, float sy, std::vector<float>* out) {
+  out->push_back(std::clamp(p.x * sx - 1.0f, -1.0f, 1.0f));
+  out->push_back(std::clamp(1.0f - p.y * sy, -1.0f, 1.0f));
+  out->push_back(0.0f);
+  out->push_back(blank ? 0.0f : p.r);
+  out->push_back(blank ? 0.0f : p.g);
+  out->push_back(blank ? 0.0f : p.b);
+  out->push_back(blank ? 1.0f : 0.0f);
+  out->push_back(0.0f);
+}
+
+}  // namespace
+
+TraceStats TraceContours(const uint8_t* mask, int width, int height,
+                         const uint8_t* bgra, int bgra_stride,
+                         const TraceOptions& options, TraceScratch* scratch,
+                         std::vector<float>* points) {
+  TraceStats stats;
+  points->clear();
+  if (width <= 0 || height <= 0 || options.max_points < 4) return stats;
+
+  ColorSource colors{mask, bgra, width, bgra_stride};
+  ExtractOutlines(mask, width, height, colors, std::max(options.min_length, 3), scratch, &stats.dropped);
+  int contours = static_cast<int>(scratch->starts.size()) - 1;
+  if (contours == 0) return stats;
+
+  // Loosen the tolerance until the frame fits, then drop the shortest rings.
+  float epsilon = std::max(options.epsilon, 0.1f);
+  int total = SimplifyAll(epsilon, scratch);
+  for (int step = 0; step < kMaxEpsilonSteps && total > options.max_points; ++step) {
+    epsilon *= kEpsilonGrowth;
+    total = SimplifyAll(epsilon, scratch);
+  }
+  stats.epsilon = epsilon;
+
+  std::vector<int>& order = scratch->order;
+  order.clear();
+  for (int c = 0; c < contours; ++c) order.push_back(c);
+  auto cost = [&](int c) { return scratch->kept_starts[c + 1] - scratch->kept_starts[c] + 3; };
+  if (total > options.max_points) {
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return scratch->starts[a + 1] - scratch->starts[a] > scratch->starts[b + 1] - scratch->starts[b];
+    });
+    int budget = options.max_points;
+    size_t kept = 0;
+    for (int c : order) {
+      if (cost(c) > budget) continue;
+      budget -= cost(c);
+      order[kept++] = c;
+    }
+    stats.dropped += static_cast<int>(order.size() - kept);
+    order.resize(kept);
+  }
+
+  // Nearest-neighbour ordering. Each ring is entered at its vertex closest to
+  // the beam and, being closed, also leaves from there.
+  const float sx = 2.0f / static_cast<float>(width);
+  const float sy = 2.0f / static_cast<float>(height);
+  const TracePoint* verts = scratch->simplified.data();
+  points->reserve(static_cast<size_t>(options.max_points) * 8);
+  TracePoint beam = verts[scratch->kept_starts[order.empty() ? 0 : order[0]]];
+  bool first = true;
+  for (size_t remaining = order.size(); remaining > 0; --remaining) {
+    size_t best_slot = 0;
+    int best_vertex = 0;
+    float best = std::numeric_limits<float>::max();
+    for (size_t slot = 0; slot < remaining; ++slot) {
+      int c = order[slot];
+      for (int i = scratch->kept_starts[c]; i < scratch->kept_starts[c + 1]; ++i) {
+        float dx = verts[i].x - beam.x, dy = verts[i].y - beam.y;
+        float d = dx * dx + dy * dy;
+        if (d < best) {
+          best = d;
+          best_slot = slot;
+          best_vertex = i;
+        }
+      }
+    }
+
+    int c = order[best_slot];
+    order[best_slot] = order[remaining - 1];
+    int begin = scratch->kept_starts[c];
+    int n = scratch->kept_starts[c + 1] - begin;
+
+    if (!first) AppendPoint(beam, true, sx, sy, points);
+    AppendPoint(verts[best_vertex], true, sx, sy, points);
+    for (int k = 0; k <= n; ++k) {
+      AppendPoint(verts[begin + (best_vertex - begin + k) % n], false, sx, sy, points);
+    }
+    beam = verts[best_vertex];
+    first = false;
+    ++stats.contours;
+  }
+
+  if (!first) {
+    AppendPoint(beam, true, sx, sy, points);
+    (*points)[points->size() - 1] = 1.0f;
+  }
+  return stats;
+}
@@ -0,0 +1,60 @@
+#ifndef TRUELAZER_NATIVE_SRC_CONTOUR_TRACER_H_
+#define TRUELAZER_NATIVE_SRC_CONTOUR_TRACER_H_
+
+#include <cstdint>
+#include <vector>
+
+// Turns a frame mask into a laser path: marching-squares outlines of the
+// non-zero regions, Douglas-Peucker simplification, then nearest-neighbour
+// ordering of the closed contours with blanked jumps between them.
+//
+// Points use the pipeline's 8-float layout (x, y, z, r, g, b, blank, last):
+// x/y in [-1, 1] with +y up, colours in 0..255, blank and last as 0/1.
+
+struct TraceOptions {
+  // Hard cap on emitted points, blanking included. The tracer first loosens
+  // the simplification tolerance and then drops the shortest contours.
+  int max_points = 2000;
+  // Douglas-Peucker tolerance in pixels.
+  float epsilon = 1.0f;
+  // Contours with fewer boundary steps than this are treated as noise.
+  int min_length = 8;
+};
+
+struct TraceStats {
+  int contours = 0;  // contours that made it into the path
+  int dropped = 0;   // contours removed as noise or to meet the budget
+  float epsilon = 0.0f;  // tolerance that was finally used
+};
+
+struct TracePoint {
+  float x;
+  float y;
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+};
+
+// Buffers reused between frames so tracing does not allocate in steady state.
+struct TraceScratch {
+  std::vector<uint8_t> padded;
+  std::vector<uint8_t> visited;
+  std::vector<TracePoint> outline;
+  std::vector<TracePoint> simplified;
+  std::vector<int> starts;        // contour offsets into outline
+  std::vector<int> kept_starts;   // contour offsets into simplified
+  std::vector<uint8_t> keep;
+  std::vector<int> stack;
+  std::vector<int> order;
+};
+
+// Traces |mask| (width * height, non-zero = foreground) into |points|, which
+// is resized to a multiple of 8 floats. Colours come from |bgra| at the
+// foreground pixel next to each outline point, or from the RGB332 mask value
+// when |bgra| is null.
+TraceStats TraceContours(const uint8_t* mask, int width, int height,
+                         const uint8_t* bgra, int bgra_stride,
+                         const TraceOptions& options, TraceScratch* scratch,
+                         std::vector<float>* points);
+
+#endif  // TRUELAZER_NATIVE_SRC_CONTOUR_TRACER_H_
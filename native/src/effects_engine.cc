@@ -0,0 +1,346 @@
+#include "effects_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "point_optimizer.h"
+
+namespace {
+
+constexpr size_t kBlock = 256;
+
+// std::trunc and std::floor through an integer conversion, which baseline
+// x86-64 has and the rounding instructions are not; beyond 2^52 every
+// double is whole already, and NaN falls through unchanged too.
+inline double Trunc(double value) {
+  if (!(std::fabs(value) < 4503599627370496.0)) return value;
+  return std::copysign(static_cast<double>(static_cast<int64_t>(value)), value);
+}
+
+inline double Floor(double value) {
+  double trunc = Trunc(value);
+  return trunc > value ? trunc - 1 : trunc;
+}
+
+// JS's Math.round: halves go up.
+inline double Round(double value) {
+  double floor = Floor(value);
+  return value - floor >= 0.5 ? floor + 1.0 : floor;
+}
+
+// fmod(value, period) for a power-of-two |period|, exactly, without
+// fmod's loop: the quotient and the multiple are exact, and so is the
+// difference, which keeps fmod's sign even when it is zero.
+inline double Wrap(double value, double period) {
+  return std::copysign(value - Trunc(value / period) * period, value);
+}
+
+// sin and cos from +, -, * and Floor only, so that detSin() and detCos()
+// in src/utils/effects.js, the same steps in the same order, give the
+// same bits; libm's and V8's can differ in the last one. |value| is
+// reduced by the nearest multiple k of pi/2, in three parts (the first
+// 33 bits long, so k times it is exact below 2^20), and the remainder,
+// within pi/4, goes through fdlibm's kernel polynomials.
+constexpr double kTwoOverPi = 6.36619772367581382433e-01;
+constexpr double kPiOver2Hi = 1.57079632673412561417e+00;
+constexpr double kPiOver2Mid = 6.07710050630396597660e-11;
+constexpr double kPiOver2Lo = 2.02226624879595063154e-21;
+
+inline double SinKernel(double r) {
+  const double z = r * r;
+  const double p = 8.33333333332248946124e-03 +
+                   z * (-1.98412698298579493134e-04 +
+                        z * (2.75573137070700676789e-06 +
+                             z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+  return r + z * r * (-1.66666666666666324348e-01 + z * p);
+}
+
+inline double CosKernel(double r) {
+  const double z = r * r;
+  const double p =
+      z * (4.16666666666666019037e-02 +
+           z * (-1.38888888888741095749e-03 +
+                z * (2.48015872894767294178e-05 +
+                     z * (-2.75573143513906633035e-07 +
+                          z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+  const double half = 0.5 * z;
+  const double w = 1.0 - half;
+  return w + (((1.0 - w) - half) + z * p);
+}
+
+// Sine (|cosine| false) or cosine of |value|; NaN for NaN and infinities.
+double SinCos(double value, bool cosine) {
+  const double k = Floor(value * kTwoOverPi + 0.5);
+  const double r = ((value - k * kPiOver2Hi) - k * kPiOver2Mid) - k * kPiOver2Lo;
+  // The quadrant, 0 to 3; cos(x) is sin(x + pi/2).
+  double quadrant = k - Floor(k / 4) * 4;
+  if (cosine) quadrant = quadrant == 3 ? 0 : quadrant + 1;
+  if (quadrant == 0) return SinKernel(r);
+  if (quadrant == 1) return CosKernel(r);
+  if (quadrant == 2) return -SinKernel(r);
+  return -CosKernel(r);
+}
+
+inline double Sin(double value) { return SinCos(value, false); }
+inline double Cos(double value) { return SinCos(value, true); }
+
+// Arguments each opcode takes, before any colours; -1 for unknown ones.
+int ArgumentCount(double op) {
+  if (!(op >= 1 && op <= static_cast<int>(EffectOp::kBlankAll)) || op != std::floor(op)) return -1;
+  switch (static_cast<int>(op)) {
+    case static_cast<int>(EffectOp::kRotate):
+    case static_cast<int>(EffectOp::kScale):
+    case static_cast<int>(EffectOp::kTranslate):
+    case static_cast<int>(EffectOp::kMove):
+    case static_cast<int>(EffectOp::kBlankEvery):
+      return 2;
+    case static_cast<int>(EffectOp::kFill):
+    case static_cast<int>(EffectOp::kRainbow):
+    case static_cast<int>(EffectOp::kWarp):
+    case static_cast<int>(EffectOp::kDistortion):
+      return 3;
+    case static_cast<int>(EffectOp::kGradient):
+    case static_cast<int>(EffectOp::kPalette):
+    case static_cast<int>(EffectOp::kWave):
+      return 4;
+    case static_cast<int>(EffectOp::kBlankAll):
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+// Channel of hslToRgb() at full saturation and half lightness, where its
+// p and q are exactly 0 and 1.
+inline double Hue(double t) {
+  if (t < 0) t += 1;
+  if (t > 1) t -= 1;
+  if (t < 1.0 / 6) return 6 * t;
+  if (t < 1.0 / 2) return 1;
+  if (t < 2.0 / 3) return (2.0 / 3 - t) * 6;
+  return 0;
+}
+
+}  // namespace
+
+// One block of the frame, split by channel; z and the last-point flag are
+// never touched by a stage and stay in the frame.
+struct EffectsEngine::Block {
+  float x[kBlock];
+  float y[kBlock];
+  float r[kBlock];
+  float g[kBlock];
+  float b[kBlock];
+  float blank[kBlock];
+  size_t count;
+};
+
+bool EffectsEngine::Load(const double* program, size_t length) {
+  stages_.clear();
+  colors_.clear();
+  size_t at = 0;
+  while (at < length) {
+    const double op = program[at];
+    const int arguments = ArgumentCount(op);
+    if (arguments < 0 || length - at - 1 < static_cast<size_t>(arguments) || stages_.size() == kMaxStages) {
+      stages_.clear();
+      colors_.clear();
+      return false;
+    }
+    Stage stage;
+    stage.op = static_cast<EffectOp>(static_cast<int>(op));
+    std::fill(stage.args, stage.args + 4, 0.0);
+    std::copy(program + at + 1, program + at + 1 + arguments, stage.args);
+    at += 1 + arguments;
+
+    bool valid = true;
+    if (stage.op == EffectOp::kGradient || stage.op == EffectOp::kPalette) {
+      const double n = stage.args[3];
+      valid = n >= 1 && n <= kMaxColors && n == std::floor(n) && (length - at) / 3 >= static_cast<size_t>(n);
+      if (valid) {
+        stage.colors = colors_.size() / 3;
+        stage.color_count = static_cast<size_t>(n);
+        colors_.insert(colors_.end(), program + at, program + at + stage.color_count * 3);
+        at += stage.color_count * 3;
+      }
+    } else if (stage.op == EffectOp::kWave) {
+      valid = stage.args[0] == 0 || stage.args[0] == 1;
+    }
+    if (!valid) {
+      stages_.clear();
+      colors_.clear();
+      return false;
+    }
+    stages_.push_back(stage);
+  }
+  return true;
+}
+
+// |first| is the block's index in the frame of |total| points, for the
+// stages that run along it.
+void EffectsEngine::Run(const Stage& stage, Block* block, size_t first, size_t total) const {
+  const double* a = stage.args;
+  const size_t count = block->count;
+  float* x = block->x;
+  float* y = block->y;
+  switch (stage.op) {
+    case EffectOp::kRotate:
+      for (size_t i = 0; i < count; ++i) {
+        const double px = x[i];
+        const double py = y[i];
+        x[i] = static_cast<float>(px * a[0] - py * a[1]);
+        y[i] = static_cast<float>(px * a[1] + py * a[0]);
+      }
+      break;
+    case EffectOp::kScale:
+      for (size_t i = 0; i < count; ++i) {
+        x[i] = static_cast<float>(x[i] * a[0]);
+        y[i] = static_cast<float>(y[i] * a[1]);
+      }
+      break;
+    case EffectOp::kTranslate:
+      for (size_t i = 0; i < count; ++i) {
+        x[i] = static_cast<float>(x[i] + a[0]);
+        y[i] = static_cast<float>(y[i] + a[1]);
+      }
+      break;
+    case EffectOp::kFill:
+      std::fill(block->r, block->r + count, static_cast<float>(a[0]));
+      std::fill(block->g, block->g + count, static_cast<float>(a[1]));
+      std::fill(block->b, block->b + count, static_cast<float>(a[2]));
+      break;
+    case EffectOp::kRainbow:
+      for (size_t i = 0; i < count; ++i) {
+        const double pos =
+            Wrap(static_cast<double>(first + i) / static_cast<double>(total) * a[0] + a[1] + a[2], 1.0);
+        block->r[i] = static_cast<float>(Round(Hue(pos + 1.0 / 3) * 255));
+        block->g[i] = static_cast<float>(Round(Hue(pos) * 255));
+        block->b[i] = static_cast<float>(Round(Hue(pos - 1.0 / 3) * 255));
+      }
+      break;
+    case EffectOp::kGradient:
+    case EffectOp::kPalette: {
+      const double* colors = &colors_[stage.colors * 3];
+      const size_t n = stage.color_count;
+      const bool wrap = stage.op == EffectOp::kPalette;
+      const double span = static_cast<double>(wrap ? n : n - 1);
+      for (size_t i = 0; i < count; ++i) {
+        double pos =
+            Wrap(static_cast<double>(first + i) / static_cast<double>(total) * a[0] + a[1] + a[2], 1.0);
+        // A negative offset wraps round, where the JS read before the
+        // colours and threw.
+        if (pos < 0) pos += 1;
+        const double scaled = pos * span;
+        const double floor = Floor(scaled);
+        const double factor = scaled - floor;
+        // pos can reach 1 (a tiny negative one, wrapped), which the palette
+        // reads as 0; NaN reads the first colour.
+        size_t from = floor >= 0 ? static_cast<size_t>(floor) : 0;
+        if (from >= n) from = 0;
+        size_t to = from + 1;
+        if (to == n) to = wrap ? 0 : from;
+        const double* c1 = colors + from * 3;
+        const double* c2 = colors + to * 3;
+        block->r[i] = static_cast<float>(Round(c1[0] + (c2[0] - c1[0]) * factor));
+        block->g[i] = static_cast<float>(Round(c1[1] + (c2[1] - c1[1]) * factor));
+        block->b[i] = static_cast<float>(Round(c1[2] + (c2[2] - c1[2]) * factor));
+      }
+      break;
+    }
+    case EffectOp::kWave: {
+      // a[0] picks the axis that is read; the other one bends.
+      float* along = a[0] == 0 ? x : y;
+      float* bent = a[0] == 0 ? y : x;
+      for (size_t i = 0; i < count; ++i) {
+        bent[i] = static_cast<float>(bent[i] + a[1] * Sin(along[i] * a[2] + a[3]));
+      }
+      break;
+    }
+    case EffectOp::kWarp: {
+      const double amount = a[0];
+      const double chaos = a[1];
+      const double t = a[2];
+      const double cos_t = Cos(t * chaos);
+      const double sin_t = Sin(t * chaos);
+      for (size_t i = 0; i < count; ++i) {
+        const double px = x[i];
+        const double py = y[i];
+        x[i] = static_cast<float>(px + Sin(std::fabs(py) * 10 * (1 + chaos) + t) * amount * cos_t);
+        y[i] = static_cast<float>(py + Cos(std::fabs(px) * 10 * (1 + chaos) + t) * amount * sin_t);
+      }
+      break;
+    }
+    case EffectOp::kDistortion: {
+      const double amount = a[0];
+      const double scale = a[1];
+      const double t = a[2];
+      for (size_t i = 0; i < count; ++i) {
+        const double px = x[i];
+        const double py = y[i];
+        const double noise_x = Sin(px * scale + t) * Cos(py * scale - t);
+        const double noise_y = Cos(px * scale - t) * Sin(py * scale + t);
+        x[i] = static_cast<float>(px + noise_x * amount);
+        y[i] = static_cast<float>(py + noise_y * amount);
+      }
+      break;
+    }
+    case EffectOp::kMove:
+      for (size_t i = 0; i < count; ++i) {
+        double value_x = Wrap(x[i] + a[0] + 1, 4.0);
+        if (value_x < 0) value_x += 4;
+        if (value_x > 2) value_x = 4 - value_x;
+        double value_y = Wrap(y[i] + a[1] + 1, 4.0);
+        if (value_y < 0) value_y += 4;
+        if (value_y > 2) value_y = 4 - value_y;
+        x[i] = static_cast<float>(value_x - 1);
+        y[i] = static_cast<float>(value_y - 1);
+      }
+      break;
+    case EffectOp::kBlankEvery:
+      if (a[1] >= 1 && a[1] <= 1 << 30 && a[1] == std::floor(a[1])) {
+        // Whole steps, as the sliders give: count round them.
+        const size_t step = static_cast<size_t>(a[1]);
+        size_t phase = first % step;
+        for (size_t i = 0; i < count; ++i) {
+          if (static_cast<double>(phase) >= a[0]) block->blank[i] = 1.0f;
+          if (++phase == step) phase = 0;
+        }
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          if (std::fmod(static_cast<double>(first + i), a[1]) >= a[0]) block->blank[i] = 1.0f;
+        }
+      }
+      break;
+    case EffectOp::kBlankAll:
+      std::fill(block->blank, block->blank + count, 1.0f);
+      break;
+  }
+}
+
+void EffectsEngine::Apply(float* points, size_t count) const {
+  if (stages_.empty()) return;
+  Block block;
+  for (size_t first = 0; first < count; first += kBlock) {
+    block.count = std::min(kBlock, count - first);
+    float* p = points + first * kPointStride;
+    for (size_t i = 0; i < block.count; ++i, p += kPointStride) {
+      block.x[i] = p[0];
+      block.y[i] = p[1];
+      block.r[i] = p[3];
+      block.g[i] = p[4];
+      block.b[i] = p[5];
+      block.blank[i] = p[6];
+    }
+    for (const Stage& stage : stages_) Run(stage, &block, first, count);
+    p = points + first * kPointStride;
+    for (size_t i = 0; i < block.count; ++i, p += kPointStride) {
+      p[0] = block.x[i];
+      p[1] = block.y[i];
+      p[3] = block.r[i];
+      p[4] = block.g[i];
+      p[5] = block.b[i];
+      p[6] = block.blank[i];
+    }
+  }
+}
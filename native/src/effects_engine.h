@@ -0,0 +1,69 @@
+#ifndef TRUELAZER_NATIVE_SRC_EFFECTS_ENGINE_H_
+#define TRUELAZER_NATIVE_SRC_EFFECTS_ENGINE_H_
+
+#include <cstddef>
+#include <vector>
+
+// The per-point stages of applyEffects() in src/utils/effects.js, which
+// resolves each effect's parameters for the frame (animation, time, colour
+// parsing) and compiles them into a program: a flat list of doubles, each
+// stage an opcode followed by its arguments.
+enum class EffectOp {
+  kRotate = 1,     // cos, sin
+  kScale = 2,      // x, y
+  kTranslate = 3,  // x, y
+  kFill = 4,       // r, g, b
+  // Colour along the frame: pos = ((i / count * spread + phase) + offset)
+  // mod 1, the fmod of JS's %.
+  kRainbow = 5,   // spread, phase, offset: hue pos at full saturation
+  kGradient = 6,  // spread, phase, offset, n, then n colours (r, g, b):
+                  // pos spans the colours once, not wrapping
+  kPalette = 7,   // as kGradient, wrapping from the last colour to the first
+  kWave = 8,      // axis (0: x bends y, 1: y bends x), amplitude, frequency, shift
+  kWarp = 9,      // amount, chaos, t
+  kDistortion = 10,  // amount, scale, t
+  kMove = 11,        // x offset, y offset; bounces inside -1..1
+  kBlankEvery = 12,  // interval, step: blanks where i mod step >= interval
+  kBlankAll = 13,
+};
+
+// Runs a compiled effect program over 8-float frames (see
+// point_optimizer.h) in one pass: the frame goes through in blocks small
+// enough to stay in L1, split into x, y, r, g, b and blanking arrays, and
+// every stage runs over a block before the next block is loaded. Each
+// stage rounds to float as the Float32Array between the JS effects did, so
+// it gives exactly what the JS ones do; binding.gyp builds it with
+// -ffp-contract=off, since a fused multiply-add rounds differently from
+// V8. Wave, warp and distortion use a sin and cos of their own that
+// effects.js repeats, as libm's and V8's can differ in the last bit. Not
+// thread-safe.
+class EffectsEngine {
+ public:
+  static constexpr size_t kMaxStages = 256;
+  static constexpr size_t kMaxColors = 256;  // per gradient stage
+
+  // Compiles |program| (|length| doubles). Returns false and runs nothing
+  // if it is malformed: an unknown opcode, missing arguments or too many
+  // stages or colours.
+  bool Load(const double* program, size_t length);
+  size_t stages() const { return stages_.size(); }
+
+  // Runs the loaded stages over |count| points in place.
+  void Apply(float* points, size_t count) const;
+
+ private:
+  struct Stage {
+    EffectOp op;
+    double args[4];
+    size_t colors = 0;  // first colour in colors_ (r, g, b each)
+    size_t color_count = 0;
+  };
+  struct Block;
+
+  void Run(const Stage& stage, Block* block, size_t first, size_t total) const;
+
+  std::vector<Stage> stages_;
+  std::vector<double> colors_;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_EFFECTS_ENGINE_H_
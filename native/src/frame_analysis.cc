@@ -0,0 +1,382 @@
+#include "frame_analysis.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "row_pool.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TL_ANALYSIS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// floor(sum / 9) for any 3x3 sum of bytes (<= 2295) as (sum * 7282) >> 16.
+constexpr uint32_t kNinthRecip = 7282;
+
+int SobelLimit(int threshold) {
+  // sqrt(m) / 4 > t  <=>  m > 16 * t^2, which keeps the comparison integral.
+  return 16 * threshold * threshold;
+}
+
+void LumaRowScalar(const uint8_t* bgra, int begin, int width, uint8_t* luma) {
+  for (int x = begin; x < width; ++x) {
+    const uint8_t* p = bgra + x * 4;
+    luma[x] = Luma(p[0], p[1], p[2]);
+  }
+}
+
+void LumaMaskRowScalar(const uint8_t* bgra, int begin, int width, int threshold, uint8_t* mask) {
+  for (int x = begin; x < width; ++x) {
+    const uint8_t* p = bgra + x * 4;
+    mask[x] = Luma(p[0], p[1], p[2]) > threshold ? PackRgb332(p[2], p[1], p[0]) : 0;
+  }
+}
+
+void UyvyLumaRowScalar(const uint8_t* uyvy, int begin, int width, uint8_t* luma) {
+  for (int x = begin; x < width; ++x) {
+    const uint8_t* p = uyvy + x * 4;
+    luma[x] = UyvyLuma(p[1], p[3]);
+  }
+}
+
+// Border pixels repeat the edge instead of reading zeros, so the frame outline
+// does not show up as an edge.
+void BlurRowScalar(const uint8_t* a, const uint8_t* b, const uint8_t* c, int begin, int end,
+                   int width, uint8_t* out) {
+  for (int x = begin; x < end; ++x) {
+    int l = std::max(x - 1, 0);
+    int r = std::min(x + 1, width - 1);
+    uint32_t sum = a[l] + a[x] + a[r] + b[l] + b[x] + b[r] + c[l] + c[x] + c[r];
+    out[x] = static_cast<uint8_t>((sum * kNinthRecip) >> 16);
+  }
+}
+
+void SobelMaskRowScalar(const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* bgra,
+                        int begin, int end, int limit, uint8_t* mask) {
+  for (int x = begin; x < end; ++x) {
+    int gx = (a[x + 1] + 2 * b[x + 1] + c[x + 1]) - (a[x - 1] + 2 * b[x - 1] + c[x - 1]);
+    int gy = (a[x - 1] + 2 * a[x] + a[x + 1]) - (c[x - 1] + 2 * c[x] + c[x + 1]);
+    const uint8_t* p = bgra + x * 4;
+    mask[x] = gx * gx + gy * gy > limit ? PackRgb332(p[2], p[1], p[0]) : 0;
+  }
+}
+
+// Marks pixels whose Sobel magnitude passes with 0xFF; colour comes later.
+void SobelKeepRowScalar(const uint8_t* a, const uint8_t* b, const uint8_t* c,
+                        int begin, int end, int limit, uint8_t* keep) {
+  for (int x = begin; x < end; ++x) {
+    int gx = (a[x + 1] + 2 * b[x + 1] + c[x + 1]) - (a[x - 1] + 2 * b[x - 1] + c[x - 1]);
+    int gy = (a[x - 1] + 2 * a[x] + a[x + 1]) - (c[x - 1] + 2 * c[x] + c[x + 1]);
+    keep[x] = gx * gx + gy * gy > limit ? 0xFF : 0;
+  }
+}
+
+// Replaces every marked byte of |mask| with the pixel's colour.
+void ColourUyvyRow(const uint8_t* uyvy, int width, uint8_t* mask) {
+  for (int x = 0; x < width; ++x) {
+    if (!mask[x]) continue;
+    const uint8_t* p = uyvy + x * 4;
+    mask[x] = PackUyvyRgb332(p[0], p[1], p[2], p[3]);
+  }
+}
+
+#if defined(TL_ANALYSIS_SSE2)
+// Luma of four BGRA pixels as i32 lanes.
+inline __m128i Luma4(__m128i px) {
+  const __m128i low_bytes = _mm_set1_epi32(0x00FF00FF);
+  __m128i br = _mm_and_si128(px, low_bytes);
+  __m128i ga = _mm_and_si128(_mm_srli_epi32(px, 8), low_bytes);
+  __m128i sum = _mm_add_epi32(_mm_madd_epi16(br, _mm_set1_epi32(29 | (77 << 16))),
+                              _mm_madd_epi16(ga, _mm_set1_epi32(150)));
+  return _mm_srli_epi32(sum, 8);
+}
+
+// PackRgb332 of four BGRA pixels as i32 lanes.
+inline __m128i Rgb332x4(__m128i px) {
+  __m128i r = _mm_and_si128(_mm_srli_epi32(px, 16), _mm_set1_epi32(0xE0));
+  __m128i g = _mm_and_si128(_mm_srli_epi32(px, 11), _mm_set1_epi32(0x1C));
+  __m128i b = _mm_and_si128(_mm_srli_epi32(px, 6), _mm_set1_epi32(0x03));
+  __m128i c = _mm_or_si128(_mm_or_si128(r, g), b);
+  __m128i black = _mm_cmpeq_epi32(c, _mm_setzero_si128());
+  return _mm_or_si128(c, _mm_and_si128(black, _mm_set1_epi32(kMaskDarkest)));
+}
+
+inline __m128i Widen8(const uint8_t* p) {
+  return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128());
+}
+
+void LumaRow(const uint8_t* bgra, int width, uint8_t* luma) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const __m128i* src = reinterpret_cast<const __m128i*>(bgra + x * 4);
+    __m128i l01 = _mm_packs_epi32(Luma4(_mm_loadu_si128(src)), Luma4(_mm_loadu_si128(src + 1)));
+    __m128i l23 = _mm_packs_epi32(Luma4(_mm_loadu_si128(src + 2)), Luma4(_mm_loadu_si128(src + 3)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(luma + x), _mm_packus_epi16(l01, l23));
+  }
+  LumaRowScalar(bgra, x, width, luma);
+}
+
+// UyvyLuma of four resampled UYVY pixels as i32 lanes.
+inline __m128i UyvyLuma4(__m128i px) {
+  const __m128i low_byte = _mm_set1_epi32(0xFF);
+  __m128i y0 = _mm_and_si128(_mm_srli_epi32(px, 8), low_byte);
+  __m128i y1 = _mm_srli_epi32(px, 24);
+  __m128i y = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(y0, y1), _mm_set1_epi32(1)), 1);
+  // The high halves of both operands are zero, so madd is a plain 32-bit
+  // product; SSE2 has no _mm_mullo_epi32.
+  __m128i scaled = _mm_madd_epi16(y, _mm_set1_epi32(298));
+  scaled = _mm_add_epi32(scaled, _mm_set1_epi32(128 - 16 * 298));
+  __m128i full = _mm_srai_epi32(scaled, 8);
+  // Lanes hold -19..296, which the 16-bit min/max clamp correctly.
+  full = _mm_max_epi16(full, _mm_setzero_si128());
+  return _mm_min_epi16(full, _mm_set1_epi32(255));
+}
+
+void UyvyLumaRow(const uint8_t* uyvy, int width, uint8_t* luma) {
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const __m128i* src = reinterpret_cast<const __m128i*>(uyvy + x * 4);
+    __m128i l01 = _mm_packs_epi32(UyvyLuma4(_mm_loadu_si128(src)), UyvyLuma4(_mm_loadu_si128(src + 1)));
+    __m128i l23 = _mm_packs_epi32(UyvyLuma4(_mm_loadu_si128(src + 2)), UyvyLuma4(_mm_loadu_si128(src + 3)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(luma + x), _mm_packus_epi16(l01, l23));
+  }
+  UyvyLumaRowScalar(uyvy, x, width, luma);
+}
+
+void LumaMaskRow(const uint8_t* bgra, int width, int threshold, uint8_t* mask) {
+  const __m128i limit = _mm_set1_epi32(threshold);
+  int x = 0;
+  for (; x + 16 <= width; x += 16) {
+    const __m128i* src = reinterpret_cast<const __m128i*>(bgra + x * 4);
+    __m128i c[4];
+    for (int i = 0; i < 4; ++i) {
+      __m128i px = _mm_loadu_si128(src + i);
+      c[i] = _mm_and_si128(_mm_cmpgt_epi32(Luma4(px), limit), Rgb332x4(px));
+    }
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(mask + x), packed);
+  }
+  LumaMaskRowScalar(bgra, x, width, threshold, mask);
+}
+
+void BlurRow(const uint8_t* a, const uint8_t* b, const uint8_t* c, int width, uint8_t* out) {
+  const __m128i recip = _mm_set1_epi16(static_cast<short>(kNinthRecip));
+  int x = 1;
+  for (; x + 9 <= width; x += 8) {
+    __m128i sum = _mm_setzero_si128();
+    for (int dx = -1; dx <= 1; ++dx) {
+      sum = _mm_add_epi16(sum, Widen8(a + x + dx));
+      sum = _mm_add_epi16(sum, Widen8(b + x + dx));
+      sum = _mm_add_epi16(sum, Widen8(c + x + dx));
+    }
+    __m128i blurred = _mm_mulhi_epu16(sum, recip);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(blurred, blurred));
+  }
+  BlurRowScalar(a, b, c, 0, 1, width, out);
+  BlurRowScalar(a, b, c, x, width, width, out);
+}
+
+// Sobel test for the eight pixels at |x|: all-ones i32 lanes where the
+// magnitude passes, pixels x..x+3 in |keep_lo| and x+4..x+7 in |keep_hi|.
+inline void SobelKeep8(const uint8_t* a, const uint8_t* b, const uint8_t* c, int x, __m128i limit4,
+                       __m128i* keep_lo, __m128i* keep_hi) {
+  __m128i a0 = Widen8(a + x - 1), a1 = Widen8(a + x), a2 = Widen8(a + x + 1);
+  __m128i b0 = Widen8(b + x - 1), b2 = Widen8(b + x + 1);
+  __m128i c0 = Widen8(c + x - 1), c1 = Widen8(c + x), c2 = Widen8(c + x + 1);
+  __m128i gx = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(a2, c2), _mm_slli_epi16(b2, 1)),
+                             _mm_add_epi16(_mm_add_epi16(a0, c0), _mm_slli_epi16(b0, 1)));
+  __m128i gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(a0, a2), _mm_slli_epi16(a1, 1)),
+                             _mm_add_epi16(_mm_add_epi16(c0, c2), _mm_slli_epi16(c1, 1)));
+  __m128i lo = _mm_unpacklo_epi16(gx, gy);
+  __m128i hi = _mm_unpackhi_epi16(gx, gy);
+  *keep_lo = _mm_cmpgt_epi32(_mm_madd_epi16(lo, lo), limit4);
+  *keep_hi = _mm_cmpgt_epi32(_mm_madd_epi16(hi, hi), limit4);
+}
+
+void SobelMaskRow(const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* bgra,
+                  int width, int limit, uint8_t* mask) {
+  const __m128i limit4 = _mm_set1_epi32(limit);
+  int x = 1;
+  for (; x + 9 <= width; x += 8) {
+    __m128i keep_lo, keep_hi;
+    SobelKeep8(a, b, c, x, limit4, &keep_lo, &keep_hi);
+
+    const __m128i* px = reinterpret_cast<const __m128i*>(bgra + x * 4);
+    __m128i col_lo = _mm_and_si128(keep_lo, Rgb332x4(_mm_loadu_si128(px)));
+    __m128i col_hi = _mm_and_si128(keep_hi, Rgb332x4(_mm_loadu_si128(px + 1)));
+    __m128i packed = _mm_packs_epi32(col_lo, col_hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(mask + x), _mm_packus_epi16(packed, packed));
+  }
+  SobelMaskRowScalar(a, b, c, bgra, x, width - 1, limit, mask);
+}
+
+void SobelKeepRow(const uint8_t* a, const uint8_t* b, const uint8_t* c, int width, int limit, uint8_t* keep) {
+  const __m128i limit4 = _mm_set1_epi32(limit);
+  int x = 1;
+  for (; x + 9 <= width; x += 8) {
+    __m128i keep_lo, keep_hi;
+    SobelKeep8(a, b, c, x, limit4, &keep_lo, &keep_hi);
+    __m128i packed = _mm_packs_epi32(keep_lo, keep_hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(keep + x), _mm_packs_epi16(packed, packed));
+  }
+  SobelKeepRowScalar(a, b, c, x, width - 1, limit, keep);
+}
+#else
+void LumaRow(const uint8_t* bgra, int width, uint8_t* luma) {
+  LumaRowScalar(bgra, 0, width, luma);
+}
+
+void LumaMaskRow(const uint8_t* bgra, int width, int threshold, uint8_t* mask) {
+  LumaMaskRowScalar(bgra, 0, width, threshold, mask);
+}
+
+void BlurRow(const uint8_t* a, const uint8_t* b, const uint8_t* c, int width, uint8_t* out) {
+  BlurRowScalar(a, b, c, 0, width, width, out);
+}
+
+void SobelMaskRow(const uint8_t* a, const uint8_t* b, const uint8_t* c, const uint8_t* bgra,
+                  int width, int limit, uint8_t* mask) {
+  SobelMaskRowScalar(a, b, c, bgra, 1, width - 1, limit, mask);
+}
+
+void UyvyLumaRow(const uint8_t* uyvy, int width, uint8_t* luma) {
+  UyvyLumaRowScalar(uyvy, 0, width, luma);
+}
+
+void SobelKeepRow(const uint8_t* a, const uint8_t* b, const uint8_t* c, int width, int limit, uint8_t* keep) {
+  SobelKeepRowScalar(a, b, c, 1, width - 1, limit, keep);
+}
+#endif
+
+void RunRows(RowPool* pool, int rows, const std::function<void(int, int)>& fn) {
+  if (pool) {
+    pool->Run(rows, fn);
+  } else {
+    fn(0, rows);
+  }
+}
+
+// Blurs scratch->luma into scratch->blurred.
+void BlurPlane(int width, int height, RowPool* pool, AnalysisScratch* scratch) {
+  const size_t w = static_cast<size_t>(width);
+  const uint8_t* luma = scratch->luma.data();
+  uint8_t* blurred = scratch->blurred.data();
+  RunRows(pool, height, [&](int begin, int end) {
+    for (int y = begin; y < end; ++y) {
+      const uint8_t* above = luma + std::max(y - 1, 0) * w;
+      const uint8_t* below = luma + std::min(y + 1, height - 1) * w;
+      BlurRow(above, luma + y * w, below, width, blurred + y * w);
+    }
+  });
+}
+
+}  // namespace
+
+bool ParseFrameAnalysis(const std::string& name, FrameAnalysis* mode) {
+  if (name == "none") {
+    *mode = FrameAnalysis::kNone;
+  } else if (name == "luma") {
+    *mode = FrameAnalysis::kLuma;
+  } else if (name == "edges") {
+    *mode = FrameAnalysis::kEdges;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* FrameAnalysisName(FrameAnalysis mode) {
+  switch (mode) {
+    case FrameAnalysis::kNone: return "none";
+    case FrameAnalysis::kLuma: return "luma";
+    case FrameAnalysis::kEdges: return "edges";
+  }
+  return "none";
+}
+
+void AnalyzeFrame(const uint8_t* bgra, int width, int height, int stride,
+                  FrameAnalysis mode, int threshold, RowPool* pool,
+                  AnalysisScratch* scratch, uint8_t* mask) {
+  if (width <= 0 || height <= 0) return;
+  threshold = std::clamp(threshold, 0, 255);
+  const size_t w = static_cast<size_t>(width);
+
+  if (mode == FrameAnalysis::kLuma) {
+    RunRows(pool, height, [&](int begin, int end) {
+      for (int y = begin; y < end; ++y) {
+        LumaMaskRow(bgra + static_cast<size_t>(y) * stride, width, threshold, mask + y * w);
+      }
+    });
+    return;
+  }
+
+  std::memset(mask, 0, w * height);
+  if (mode != FrameAnalysis::kEdges || width < 3 || height < 3) return;
+
+  scratch->luma.resize(w * height);
+  scratch->blurred.resize(w * height);
+  uint8_t* luma = scratch->luma.data();
+  uint8_t* blurred = scratch->blurred.data();
+
+  // Each pass reads its neighbours' rows from the previous one, so the passes
+  // are separate Run() calls rather than one fused stripe.
+  RunRows(pool, height, [&](int begin, int end) {
+    for (int y = begin; y < end; ++y) {
+      LumaRow(bgra + static_cast<size_t>(y) * stride, width, luma + y * w);
+    }
+  });
+  BlurPlane(width, height, pool, scratch);
+  int limit = SobelLimit(threshold);
+  RunRows(pool, height - 2, [&](int begin, int end) {
+    for (int y = begin + 1; y < end + 1; ++y) {
+      SobelMaskRow(blurred + (y - 1) * w, blurred + y * w, blurred + (y + 1) * w,
+                   bgra + static_cast<size_t>(y) * stride, width, limit, mask + y * w);
+    }
+  });
+}
+
+void AnalyzeUyvyFrame(const uint8_t* uyvy, int width, int height, int stride,
+                      FrameAnalysis mode, int threshold, RowPool* pool,
+                      AnalysisScratch* scratch, uint8_t* mask) {
+  if (width <= 0 || height <= 0) return;
+  threshold = std::clamp(threshold, 0, 255);
+  const size_t w = static_cast<size_t>(width);
+
+  if (mode == FrameAnalysis::kLuma) {
+    RunRows(pool, height, [&](int begin, int end) {
+      for (int y = begin; y < end; ++y) {
+        const uint8_t* row = uyvy + static_cast<size_t>(y) * stride;
+        uint8_t* out = mask + y * w;
+        UyvyLumaRow(row, width, out);
+        for (int x = 0; x < width; ++x) out[x] = out[x] > threshold ? 0xFF : 0;
+        ColourUyvyRow(row, width, out);
+      }
+    });
+    return;
+  }
+
+  std::memset(mask, 0, w * height);
+  if (mode != FrameAnalysis::kEdges || width < 3 || height < 3) return;
+
+  scratch->luma.resize(w * height);
+  scratch->blurred.resize(w * height);
+  uint8_t* luma = scratch->luma.data();
+  const uint8_t* blurred = scratch->blurred.data();
+
+  RunRows(pool, height, [&](int begin, int end) {
+    for (int y = begin; y < end; ++y) {
+      UyvyLumaRow(uyvy + static_cast<size_t>(y) * stride, width, luma + y * w);
+    }
+  });
+  BlurPlane(width, height, pool, scratch);
+  int limit = SobelLimit(threshold);
+  RunRows(pool, height - 2, [&](int begin, int end) {
+    for (int y = begin + 1; y < end + 1; ++y) {
+      SobelKeepRow(blurred + (y - 1) * w, blurred + y * w, blurred + (y + 1) * w, width, limit, mask + y * w);
+      ColourUyvyRow(uyvy + static_cast<size_t>(y) * stride, width, mask + y * w);
+    }
+  });
+}
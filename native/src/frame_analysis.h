@@ -0,0 +1,77 @@
+#ifndef TRUELAZER_NATIVE_SRC_FRAME_ANALYSIS_H_
+#define TRUELAZER_NATIVE_SRC_FRAME_ANALYSIS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RowPool;
+
+// Per-pixel front-end of the NDI laser generator, run on the capture thread so
+// JS receives one byte per pixel instead of the BGRA frame.
+enum class FrameAnalysis {
+  kNone,
+  // Luma above the threshold (the generator's "threshold" mode).
+  kLuma,
+  // 3x3 box blur, then Sobel magnitude above the threshold.
+  kEdges,
+};
+
+// Parses "none", "luma" or "edges". Returns false on anything else.
+bool ParseFrameAnalysis(const std::string& name, FrameAnalysis* mode);
+const char* FrameAnalysisName(FrameAnalysis mode);
+
+// Mask bytes are 0 for pixels that did not pass, otherwise the pixel colour as
+// RGB332 (rrrgggbb). Colours that quantise to 0 are sent as kMaskDarkest.
+constexpr uint8_t kMaskDarkest = 0x25;
+
+inline uint8_t PackRgb332(uint8_t r, uint8_t g, uint8_t b) {
+  uint8_t c = static_cast<uint8_t>((r & 0xE0) | ((g >> 3) & 0x1C) | (b >> 6));
+  return c ? c : kMaskDarkest;
+}
+
+// Luma uses the same BT.601 weights as the JS generator, in 8.8 fixed point.
+inline uint8_t Luma(uint8_t b, uint8_t g, uint8_t r) {
+  return static_cast<uint8_t>((b * 29 + g * 150 + r * 77) >> 8);
+}
+
+// UYVY frames, as resampled by ScaleUyvy(), hold one (U, Y0, V, Y1) group
+// per pixel. Luma is the mean of the two Y samples stretched from video range
+// (16..235) to 0..255, so the threshold slider keeps its meaning; being
+// BT.709 it differs from the BGRA weights only on saturated colours.
+inline uint8_t UyvyLuma(uint8_t y0, uint8_t y1) {
+  int y = (((y0 + y1 + 1) >> 1) - 16) * 298 + 128;
+  return static_cast<uint8_t>(std::clamp(y >> 8, 0, 255));
+}
+
+// BT.709 video-range YUV to RGB332, for the few pixels that pass the mask.
+inline uint8_t PackUyvyRgb332(uint8_t u, uint8_t y0, uint8_t v, uint8_t y1) {
+  int c = (((y0 + y1 + 1) >> 1) - 16) * 298 + 128;
+  int d = u - 128;
+  int e = v - 128;
+  auto to8 = [](int x) { return static_cast<uint8_t>(std::clamp(x >> 8, 0, 255)); };
+  return PackRgb332(to8(c + 459 * e), to8(c - 55 * d - 136 * e), to8(c + 541 * d));
+}
+
+// Planes reused between frames so the capture thread does not allocate.
+struct AnalysisScratch {
+  std::vector<uint8_t> luma;
+  std::vector<uint8_t> blurred;
+};
+
+// Writes a width * height mask for a BGRA/BGRX image. |stride| is in bytes.
+// Magnitudes use the JS scale (sqrt(gx^2 + gy^2) / 4), so the generator's
+// threshold slider means the same thing on both paths. Edge mode leaves the
+// one-pixel border empty. |pool| may be null to run on the calling thread.
+void AnalyzeFrame(const uint8_t* bgra, int width, int height, int stride,
+                  FrameAnalysis mode, int threshold, RowPool* pool,
+                  AnalysisScratch* scratch, uint8_t* mask);
+
+// Same as AnalyzeFrame() for a UYVY frame resampled by ScaleUyvy(). Only
+// pixels that pass are converted to colour.
+void AnalyzeUyvyFrame(const uint8_t* uyvy, int width, int height, int stride,
+                      FrameAnalysis mode, int threshold, RowPool* pool,
+                      AnalysisScratch* scratch, uint8_t* mask);
+
+#endif  // TRUELAZER_NATIVE_SRC_FRAME_ANALYSIS_H_
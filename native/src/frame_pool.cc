@@ -0,0 +1,148 @@
+#include "frame_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+FramePool::FramePool(size_t slab_count, size_t slab_bytes) : max_free_(slab_count) {
+  for (size_t i = 0; i < slab_count; ++i) {
+    auto slab = std::make_unique<FrameSlab>();
+    slab->storage = std::make_unique<uint8_t[]>(slab_bytes);
+    slab->data = slab->storage.get();
+    slab->capacity = slab_bytes;
+    free_.push_back(slab.get());
+    slabs_.push_back(std::move(slab));
+  }
+}
+
+FrameSlab* FramePool::Acquire(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Prefer the smallest free slab that fits so large slabs stay available
+  // when the target size changes mid-stream.
+  auto best = free_.end();
+  for (auto it = free_.begin(); it != free_.end(); ++it) {
+    if ((*it)->capacity >= bytes && (best == free_.end() || (*it)->capacity < (*best)->capacity)) {
+      best = it;
+    }
+  }
+
+  FrameSlab* slab = nullptr;
+  auto own = std::find_if(free_.begin(), free_.end(), [](const FrameSlab* s) { return s->storage != nullptr; });
+  if (best != free_.end()) {
+    slab = *best;
+    free_.erase(best);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+  } else if (own != free_.end()) {
+    // Resolution grew: recycle a free slab with a bigger allocation.
+    slab = *own;
+    free_.erase(own);
+    slab->storage = std::make_unique<uint8_t[]>(bytes);
+    slab->data = slab->storage.get();
+    slab->capacity = bytes;
+    misses_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    auto fresh = std::make_unique<FrameSlab>();
+    fresh->storage = std::make_unique<uint8_t[]>(bytes);
+    fresh->data = fresh->storage.get();
+    fresh->capacity = bytes;
+    slab = fresh.get();
+    slabs_.push_back(std::move(fresh));
+    misses_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  slab->size = bytes;
+  return slab;
+}
+
+void FramePool::Lend(FrameSlab* slab) {
+  slab->lease = shared_from_this();
+}
+
+void FramePool::Release(FrameSlab* slab) {
+  // Dropping the lease may destroy the pool, so it must happen after the
+  // mutex is released.
+  std::shared_ptr<FramePool> lease = std::move(slab->lease);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (slab->retired) {
+      Forget(slab);
+    } else if (!slab->storage || (adopted_ == 0 && free_.size() < max_free_)) {
+      free_.push_back(slab);
+    } else {
+      // Misses grew the pool past its steady-state size, or adopted memory
+      // replaced the pool's own; give the memory back.
+      Forget(slab);
+    }
+  }
+}
+
+void FramePool::Adopt(uint8_t* data, size_t capacity, int buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto slab = std::make_unique<FrameSlab>();
+  slab->data = data;
+  slab->buffer = buffer;
+  slab->capacity = capacity;
+  ++adopted_;
+  // Free slabs of the pool's own memory are superseded.
+  for (size_t i = free_.size(); i-- > 0;) {
+    if (free_[i]->storage) {
+      FrameSlab* own = free_[i];
+      free_.erase(free_.begin() + static_cast<std::ptrdiff_t>(i));
+      Forget(own);
+    }
+  }
+  free_.push_back(slab.get());
+  slabs_.push_back(std::move(slab));
+}
+
+void FramePool::RetireSmaller(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const std::unique_ptr<FrameSlab>& slab : slabs_) {
+    if (!slab->storage && slab->capacity < bytes) slab->retired = true;
+  }
+  for (size_t i = free_.size(); i-- > 0;) {
+    if (free_[i]->retired) {
+      FrameSlab* slab = free_[i];
+      free_.erase(free_.begin() + static_cast<std::ptrdiff_t>(i));
+      Forget(slab);
+    }
+  }
+}
+
+void FramePool::Retire(FrameSlab* slab) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    slab->retired = true;
+  }
+  Release(slab);
+}
+
+std::vector<int> FramePool::TakeRetired() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<int> retired;
+  retired.swap(retired_);
+  return retired;
+}
+
+// Drops |slab|, which is in no list; adopted memory is reported through
+// TakeRetired(). Called with mutex_ held.
+void FramePool::Forget(FrameSlab* slab) {
+  if (!slab->storage) {
+    retired_.push_back(slab->buffer);
+    --adopted_;
+  }
+  auto it = std::find_if(slabs_.begin(), slabs_.end(),
+      [slab](const std::unique_ptr<FrameSlab>& s) { return s.get() == slab; });
+  if (it != slabs_.end()) slabs_.erase(it);
+}
+
+FramePoolStats FramePool::stats() const {
+  FramePoolStats s;
+  s.hits = hits_.load(std::memory_order_relaxed);
+  s.misses = misses_.load(std::memory_order_relaxed);
+  s.copies = copies_.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  s.slabs = slabs_.size();
+  s.free_slabs = free_.size();
+  return s;
+}
@@ -0,0 +1,99 @@
+#ifndef TRUELAZER_NATIVE_SRC_FRAME_POOL_H_
+#define TRUELAZER_NATIVE_SRC_FRAME_POOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "audio_analyzer.h"
+#include "change_detector.h"
+
+class FramePool;
+
+// A preallocated block of pixel memory. The capture thread fills one slab per
+// frame; ownership then moves to the consumer until it hands the slab back to
+// its pool.
+struct FrameSlab {
+  uint8_t* data = nullptr;
+  // The pool's own allocation behind |data|; null for adopted memory.
+  std::unique_ptr<uint8_t[]> storage;
+  // The adopter's id for adopted memory (see FramePool::Adopt()), else -1.
+  int buffer = -1;
+  // An adopted slab the pool stops handing out once it is free again.
+  bool retired = false;
+  size_t capacity = 0;
+  size_t size = 0;
+  int width = 0;
+  int height = 0;
+  // Pixel layout tag, source timestamp and change flags set by the
+  // producer; the pool never looks at them.
+  int format = 0;
+  int64_t timestamp = 0;
+  bool unchanged = false;
+  std::vector<DirtyRect> dirty;
+  AudioBands audio;
+  // Keeps the pool alive while the slab is lent out, so a finalizer that runs
+  // after the owning NdiWrapper is gone still has somewhere to return to.
+  std::shared_ptr<FramePool> lease;
+};
+
+struct FramePoolStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t copies = 0;
+  size_t slabs = 0;
+  size_t free_slabs = 0;
+};
+
+// Thread-safe free list of FrameSlabs. Acquire() never blocks on JS: when no
+// free slab is large enough a new one is allocated and counted as a miss.
+//
+// The pool starts out with slabs of its own memory. A consumer that can only
+// hand out memory it allocated itself (a JS runtime whose ArrayBuffers cannot
+// wrap foreign memory) adopts its buffers instead; from then on the pool's
+// own slabs only carry frames too big for the adopted ones and are freed on
+// release, and adopted slabs are never reallocated.
+class FramePool : public std::enable_shared_from_this<FramePool> {
+ public:
+  FramePool(size_t slab_count, size_t slab_bytes);
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  FrameSlab* Acquire(size_t bytes);
+  void Release(FrameSlab* slab);
+
+  // Adds |capacity| bytes at |data|, which the caller keeps alive until
+  // TakeRetired() returns |buffer|, as a free slab.
+  void Adopt(uint8_t* data, size_t capacity, int buffer);
+  // Retires adopted slabs smaller than |bytes|, or |slab| itself.
+  void RetireSmaller(size_t bytes);
+  void Retire(FrameSlab* slab);
+  // Ids of retired slabs that are no longer in use; the pool has forgotten
+  // them and their memory may go.
+  std::vector<int> TakeRetired();
+
+  // Marks |slab| as owned by JS. The pool stays alive until Release().
+  void Lend(FrameSlab* slab);
+  void RecordCopy() { copies_.fetch_add(1, std::memory_order_relaxed); }
+
+  FramePoolStats stats() const;
+
+ private:
+  void Forget(FrameSlab* slab);
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<FrameSlab>> slabs_;
+  std::vector<FrameSlab*> free_;
+  std::vector<int> retired_;
+  size_t max_free_;
+  size_t adopted_ = 0;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> copies_{0};
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_FRAME_POOL_H_
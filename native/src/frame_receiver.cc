@@ -0,0 +1,393 @@
+#include "frame_receiver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+void CropSourceFrame(const CropRect& crop, SourceFrame* frame) {
+  if (crop.full()) return;
+  // UYVY columns come in pairs sharing one U and V.
+  int align = frame->layout == PixelLayout::kUyvy ? 2 : 1;
+  int bytes_per_pixel = frame->layout == PixelLayout::kUyvy ? 2 : 4;
+
+  auto span = [](float start, float length, int size, int align, int* offset, int* extent) {
+    int begin = static_cast<int>(std::floor(std::clamp(start, 0.0f, 1.0f) * size));
+    int end = static_cast<int>(std::ceil(std::clamp(start + length, 0.0f, 1.0f) * size));
+    begin -= begin % align;
+    end += (align - end % align) % align;
+    end = std::min(end, size);
+    if (end - begin < align) {
+      end = std::min(begin + align, size);
+      begin = std::max(end - align, 0);
+    }
+    *offset = begin;
+    *extent = end - begin;
+  };
+
+  int x, width, y, height;
+  span(crop.x, crop.width, frame->width, align, &x, &width);
+  span(crop.y, crop.height, frame->height, 1, &y, &height);
+  frame->data += static_cast<ptrdiff_t>(y) * frame->stride + static_cast<ptrdiff_t>(x) * bytes_per_pixel;
+  frame->width = width;
+  frame->height = height;
+}
+
+FrameReceiver::FrameReceiver(std::string source_name, std::unique_ptr<FrameSource> source)
+    : source_name_(std::move(source_name)),
+      source_(std::move(source)),
+      frame_pool_(std::make_shared<FramePool>(kFramePoolSlabs, 480 * 480 * 4)) {
+  for (int i = 0; i < 3; ++i) {
+    frames_.slot(i).data.reserve(1920 * 1080 * 4);
+  }
+}
+
+FrameReceiver::~FrameReceiver() {
+  Stop();
+  DropPendingSlab();
+}
+
+bool FrameReceiver::Connect() {
+  return source_->Open(Request());
+}
+
+void FrameReceiver::Start() {
+  if (!stop_thread_.load()) return;
+  stop_thread_ = false;
+  capture_thread_ = std::thread(&FrameReceiver::CaptureLoop, this);
+}
+
+void FrameReceiver::Stop() {
+  stop_thread_ = true;
+  if (capture_thread_.joinable()) {
+    capture_thread_.join();
+  }
+}
+
+void FrameReceiver::SetPooled(bool pooled) {
+  pooled_ = pooled;
+  if (!pooled) DropPendingSlab();
+}
+
+void FrameReceiver::SetShared(bool shared) {
+  shared_ = shared;
+  if (shared) DropPendingSlab();
+}
+
+bool FrameReceiver::HasPendingFrame() const {
+  return pooled_.load() && !shared_.load() ? pending_slab_.load() != nullptr : frames_.HasFresh();
+}
+
+const CapturedFrame* FrameReceiver::TakeFrame() {
+  if (!frames_.Update()) return nullptr;
+  return &frames_.read_slot();
+}
+
+void FrameReceiver::DropPendingSlab() {
+  FrameSlab* stale = pending_slab_.exchange(nullptr);
+  if (stale) frame_pool_->Release(stale);
+}
+
+FrameFormat FrameReceiver::OutputShape::format() const {
+  if (trace) return FrameFormat::kPath;
+  if (analysis == FrameAnalysis::kLuma) return FrameFormat::kLumaMask;
+  if (analysis == FrameAnalysis::kEdges) return FrameFormat::kEdgeMask;
+  return FrameFormat::kBgra;
+}
+
+bool FrameReceiver::PayloadInputs::operator==(const PayloadInputs& other) const {
+  return shape.width == other.shape.width && shape.height == other.shape.height &&
+         shape.filter == other.shape.filter && shape.analysis == other.shape.analysis &&
+         shape.threshold == other.shape.threshold && shape.trace == other.shape.trace &&
+         shape.uyvy == other.shape.uyvy && trace_options.max_points == other.trace_options.max_points &&
+         trace_options.epsilon == other.trace_options.epsilon && trace_options.min_length == other.trace_options.min_length;
+}
+
+CaptureRequest FrameReceiver::Request() const {
+  CaptureRequest request;
+  request.target_width = target_width_.load();
+  request.target_height = target_height_.load();
+  // The stream has to resolve the target within the crop, not across the
+  // whole frame.
+  CropRect region = crop();
+  if (request.target_width > 0 && region.width > 0.0f && region.width < 1.0f) {
+    request.target_width = static_cast<int>(std::ceil(request.target_width / region.width));
+  }
+  if (request.target_height > 0 && region.height > 0.0f && region.height < 1.0f) {
+    request.target_height = static_cast<int>(std::ceil(request.target_height / region.height));
+  }
+  // Masks and paths never need the full colour image.
+  request.accepts_uyvy = analysis_.load() != static_cast<int>(FrameAnalysis::kNone) || trace_.load();
+  request.bandwidth = bandwidth();
+  request.frame_sync_fps = std::min(frame_sync_fps_.load(), kMaxFrameSyncFps);
+  return request;
+}
+
+// Folds the source's dropped-frame count and queue depth into stats_.
+void FrameReceiver::SampleSource() {
+  last_sample_ = std::chrono::steady_clock::now();
+  uint64_t dropped = source_->dropped();
+  if (dropped > source_dropped_) {
+    stats_.AddDropped(dropped - source_dropped_);
+    source_dropped_ = dropped;
+  }
+  stats_.SetQueueDepth(source_->queue_depth());
+}
+
+// Sender timestamps are UTC in 100 ns units. The difference to our clock
+// includes any skew between the two machines; readings outside a minute
+// mean the source stamps something else and are ignored.
+void FrameReceiver::RecordLatency(const SourceFrame& frame) {
+  if (frame.timestamp == kNoTimestamp) return;
+  int64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count() * 10;
+  int64_t latency_us = (now - frame.timestamp) / 10;
+  if (latency_us >= 0 && latency_us < 60 * 1000000LL) stats_.latency_us().Record(static_cast<uint64_t>(latency_us));
+}
+
+FrameReceiver::OutputShape FrameReceiver::OutputShapeFor(const SourceFrame& frame) const {
+  OutputShape shape;
+  shape.width = target_width_.load();
+  shape.height = target_height_.load();
+  if (shape.width <= 0 || shape.height <= 0) {
+    shape.width = frame.width;
+    shape.height = frame.height;
+  }
+  shape.filter = static_cast<ScaleFilter>(filter_.load());
+  shape.analysis = static_cast<FrameAnalysis>(analysis_.load());
+  shape.threshold = threshold_.load();
+  shape.trace = trace_.load();
+  shape.uyvy = frame.layout == PixelLayout::kUyvy;
+  // Tracing needs a mask; plain thresholding is the generator's default.
+  if (shape.trace && shape.analysis == FrameAnalysis::kNone) shape.analysis = FrameAnalysis::kLuma;
+  return shape;
+}
+
+// Runs whatever has to happen before the payload size is known and returns
+// that size: scaling for the analysis modes, and tracing unless the frame
+// is the same as the last published one.
+size_t FrameReceiver::PrepareFrame(const SourceFrame& frame, const OutputShape& shape) {
+  size_t pixels = static_cast<size_t>(shape.width) * shape.height;
+  if (shape.analysis == FrameAnalysis::kNone) return pixels * 4;
+  ScaleForAnalysis(frame, shape);
+  DetectChanges(analysis_image_.data(), shape);
+  if (!shape.trace) return pixels;
+
+  if (!SameAsPublished()) {
+    trace_mask_.resize(pixels);
+    AnalyzeImage(shape, trace_mask_.data());
+    // UYVY paths take their colours from the RGB332 mask instead.
+    const uint8_t* bgra = shape.uyvy ? nullptr : analysis_image_.data();
+    TraceContours(trace_mask_.data(), shape.width, shape.height, bgra, shape.width * 4, inputs_.trace_options, &trace_scratch_, &trace_points_);
+  }
+  return trace_points_.size() * sizeof(float);
+}
+
+// Produces the payload into |dst|, which holds PrepareFrame()'s size.
+void FrameReceiver::WriteFrame(const SourceFrame& frame, const OutputShape& shape, uint8_t* dst) {
+  if (shape.trace) {
+    if (!trace_points_.empty()) std::memcpy(dst, trace_points_.data(), trace_points_.size() * sizeof(float));
+  } else if (shape.analysis == FrameAnalysis::kNone) {
+    ScaleBgra(frame.data, frame.width, frame.height, frame.stride, dst, shape.width, shape.height, shape.filter, Pool());
+    DetectChanges(dst, shape);
+  } else {
+    AnalyzeImage(shape, dst);
+  }
+}
+
+// Scales |frame| into analysis_image_, in the source layout.
+void FrameReceiver::ScaleForAnalysis(const SourceFrame& frame, const OutputShape& shape) {
+  analysis_image_.resize(static_cast<size_t>(shape.width) * shape.height * 4);
+  uint8_t* image = analysis_image_.data();
+  if (shape.uyvy) {
+    ScaleUyvy(frame.data, frame.width, frame.height, frame.stride, image, shape.width, shape.height, shape.filter, Pool());
+  } else {
+    ScaleBgra(frame.data, frame.width, frame.height, frame.stride, image, shape.width, shape.height, shape.filter, Pool());
+  }
+}
+
+// Writes the mask of analysis_image_ into |mask|.
+void FrameReceiver::AnalyzeImage(const OutputShape& shape, uint8_t* mask) {
+  const uint8_t* image = analysis_image_.data();
+  if (shape.uyvy) {
+    AnalyzeUyvyFrame(image, shape.width, shape.height, shape.width * 4, shape.analysis, shape.threshold, Pool(), &analysis_scratch_, mask);
+  } else {
+    AnalyzeFrame(image, shape.width, shape.height, shape.width * 4, shape.analysis, shape.threshold, Pool(), &analysis_scratch_, mask);
+  }
+}
+
+int FrameReceiver::threads() const {
+  int threads = threads_.load();
+  return threads > 0 ? threads : RowPool::DefaultThreads();
+}
+
+// The capture thread's row pool, created on first use and rebuilt when the
+// thread count changes.
+RowPool* FrameReceiver::Pool() {
+  int wanted = threads();
+  if (!row_pool_ || row_pool_->threads() != wanted) row_pool_ = std::make_unique<RowPool>(wanted);
+  return row_pool_.get();
+}
+
+// Compares the scaled frame, 4 bytes per pixel in either layout, with the
+// last one and sets image_unchanged_ and dirty_.
+void FrameReceiver::DetectChanges(const uint8_t* image, const OutputShape& shape) {
+  int threshold = change_threshold_.load();
+  if (threshold < 0) {
+    change_detector_.Reset();
+    image_unchanged_ = false;
+    dirty_.assign(1, DirtyRect{0, 0, shape.width, shape.height});
+    return;
+  }
+  // A layout switch changes every byte; start over rather than report it.
+  if (shape.uyvy != detected_uyvy_) change_detector_.Reset();
+  detected_uyvy_ = shape.uyvy;
+  image_unchanged_ = !change_detector_.Update(image, shape.width, shape.height, shape.width * 4, 4, threshold, &dirty_);
+}
+
+// Decides whether the frame just written repeats the last published one.
+// A picture that held still under new settings still changed as a whole.
+bool FrameReceiver::FinishChanges(const OutputShape& shape) {
+  bool unchanged = SameAsPublished();
+  if (!unchanged && dirty_.empty()) dirty_.assign(1, DirtyRect{0, 0, shape.width, shape.height});
+  published_inputs_ = inputs_;
+  published_ = true;
+  return unchanged;
+}
+
+// Writes the payload into the next ring slot and publishes a reference to
+// it through frames_. Returns false if no ring could be created, so the
+// caller can fall back to copying.
+bool FrameReceiver::PublishShared(const SourceFrame& source_frame, const OutputShape& shape, size_t size, bool* unchanged) {
+  if (!ring_ || ring_->capacity() < size) {
+    size_t capacity = (std::max(size, size_t{1}) + kRingCapacityStep - 1) / kRingCapacityStep * kRingCapacityStep;
+    if (ring_) capacity = std::max(capacity, static_cast<size_t>(ring_->capacity()) * 2);
+    // Readers keep their mapping of the old ring until they let it go.
+    ring_ = SharedFrameRing::Create(SharedFrameRing::UniqueName(), kRingSlots, static_cast<uint32_t>(capacity));
+    if (!ring_) return false;
+  }
+
+  uint32_t slot;
+  uint8_t* dst = ring_->BeginWrite(&slot);
+  WriteFrame(source_frame, shape, dst);
+  *unchanged = FinishChanges(shape);
+  RingFrameInfo info;
+  info.width = shape.width;
+  info.height = shape.height;
+  info.format = static_cast<int>(shape.format());
+  info.unchanged = *unchanged;
+  info.timestamp = source_frame.timestamp;
+  info.size = static_cast<uint32_t>(size);
+  uint64_t sequence = ring_->EndWrite(slot, info);
+
+  CapturedFrame& frame = frames_.write_slot();
+  frame.data.clear();
+  frame.width = shape.width;
+  frame.height = shape.height;
+  frame.format = shape.format();
+  frame.timestamp = source_frame.timestamp;
+  frame.unchanged = *unchanged;
+  frame.dirty = dirty_;
+  frame.shared.ring = ring_->name();
+  frame.shared.slot = slot;
+  frame.shared.sequence = sequence;
+  frame.shared.size = static_cast<uint32_t>(size);
+  frame.audio = CurrentAudio();
+  if (frames_.HasFresh()) stats_.AddOverwritten();
+  frames_.Publish();
+  return true;
+}
+
+// Publishes one received frame to whichever slot the mode uses.
+void FrameReceiver::Publish(const SourceFrame& source_frame) {
+  OutputShape shape = OutputShapeFor(source_frame);
+  // A UYVY frame still in flight from before the output switched to BGRA;
+  // the source switches before the next capture.
+  if (shape.uyvy && shape.analysis == FrameAnalysis::kNone) return;
+
+  auto start = std::chrono::steady_clock::now();
+  inputs_.shape = shape;
+  inputs_.trace_options.max_points = trace_max_points_.load();
+  inputs_.trace_options.epsilon = trace_epsilon_.load();
+  inputs_.trace_options.min_length = trace_min_length_.load();
+  size_t size = PrepareFrame(source_frame, shape);
+  bool unchanged;
+  if (shared_.load() && PublishShared(source_frame, shape, size, &unchanged)) {
+    // Only the reference went through frames_.
+  } else if (pooled_.load()) {
+    FrameSlab* slab = frame_pool_->Acquire(size);
+    WriteFrame(source_frame, shape, slab->data);
+    unchanged = FinishChanges(shape);
+    slab->width = shape.width;
+    slab->height = shape.height;
+    slab->format = static_cast<int>(shape.format());
+    slab->timestamp = source_frame.timestamp;
+    slab->unchanged = unchanged;
+    slab->dirty = dirty_;
+    slab->audio = CurrentAudio();
+
+    // The consumer never saw the previous frame; recycle it immediately.
+    FrameSlab* stale = pending_slab_.exchange(slab);
+    if (stale) {
+      frame_pool_->Release(stale);
+      stats_.AddOverwritten();
+    }
+  } else {
+    CapturedFrame& frame = frames_.write_slot();
+    frame.data.resize(size);
+    WriteFrame(source_frame, shape, frame.data.data());
+    unchanged = FinishChanges(shape);
+    frame.width = shape.width;
+    frame.height = shape.height;
+    frame.format = shape.format();
+    frame.timestamp = source_frame.timestamp;
+    frame.unchanged = unchanged;
+    frame.dirty = dirty_;
+    frame.shared = SharedFrameRef();
+    frame.audio = CurrentAudio();
+    if (frames_.HasFresh()) stats_.AddOverwritten();
+    frames_.Publish();
+  }
+  if (unchanged) stats_.AddUnchanged();
+  stats_.process_us().Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count()));
+
+  if (on_frame_) on_frame_();
+}
+
+void FrameReceiver::CaptureLoop() {
+  while (!stop_thread_) {
+    if (std::chrono::steady_clock::now() - last_sample_ >= std::chrono::milliseconds(kSampleIntervalMs)) SampleSource();
+
+    CaptureRequest request = Request();
+    if (audio_.load()) {
+      // Levels from before audio was switched off would be stale.
+      if (!audio_active_) audio_analyzer_.Reset();
+      audio_analyzer_.Configure(audio_options());
+      request.audio = &audio_analyzer_;
+    }
+    audio_active_ = request.audio != nullptr;
+
+    SourceFrame frame;
+    auto wait_start = std::chrono::steady_clock::now();
+    CaptureResult result = source_->Capture(request, kCaptureTimeoutMs, &frame);
+    if (result == CaptureResult::kError) break;
+    if (result != CaptureResult::kFrame) continue;
+
+    stats_.AddReceived();
+    // Paced captures sleep on our clock; that is not waiting on the source.
+    if (!frame.paced) {
+      stats_.recv_wait_us().Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - wait_start).count()));
+    }
+    // Frame-synced repeats age, so this is the age of what reaches the laser.
+    RecordLatency(frame);
+    // Publish only ever sees the region; Release needs the frame as lent.
+    SourceFrame region = frame;
+    CropSourceFrame(crop(), &region);
+    Publish(region);
+    source_->Release(&frame);
+  }
+  source_->Pause();
+}
@@ -0,0 +1,328 @@
+#ifndef TRUELAZER_NATIVE_SRC_FRAME_RECEIVER_H_
+#define TRUELAZER_NATIVE_SRC_FRAME_RECEIVER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "audio_analyzer.h"
+#include "bandwidth_policy.h"
+#include "capture_stats.h"
+#include "change_detector.h"
+#include "contour_tracer.h"
+#include "frame_analysis.h"
+#include "frame_pool.h"
+#include "frame_scaler.h"
+#include "frame_source.h"
+#include "frame_sync.h"
+#include "row_pool.h"
+#include "shared_frame_ring.h"
+#include "triple_buffer.h"
+
+// Payload layouts a receiver can publish.
+enum class FrameFormat {
+  kBgra,      // 4 bytes per pixel
+  kLumaMask,  // 1 byte per pixel, see frame_analysis.h
+  kEdgeMask,
+  kPath,      // traced laser points, 8 floats each, see contour_tracer.h
+};
+
+// Where a shared-memory frame's payload lives; see SharedFrameRing.
+struct SharedFrameRef {
+  std::string ring;
+  uint32_t slot = 0;
+  uint64_t sequence = 0;  // 0: the payload is in CapturedFrame::data
+  uint32_t size = 0;
+};
+
+struct CapturedFrame {
+  std::vector<uint8_t> data;
+  int width = 0;
+  int height = 0;
+  FrameFormat format = FrameFormat::kBgra;
+  int64_t timestamp = kNoTimestamp;  // the source frame's, see SourceFrame
+  // True when the scaled picture matched the previous frame's within the
+  // change threshold; |dirty| then is empty. Otherwise |dirty| lists the
+  // changed areas in capture-size pixels.
+  bool unchanged = false;
+  std::vector<DirtyRect> dirty;
+  SharedFrameRef shared;
+  // Band levels of the audio received up to this frame; sequence 0 when
+  // audio analysis is off or nothing has arrived.
+  AudioBands audio;
+};
+
+// The part of the source frame a receiver uses, in fractions of the source
+// size so the same rect holds on the full and the proxy stream. The default
+// is the whole frame.
+struct CropRect {
+  float x = 0.0f;
+  float y = 0.0f;
+  float width = 1.0f;
+  float height = 1.0f;
+
+  bool full() const { return x <= 0.0f && y <= 0.0f && x + width >= 1.0f && y + height >= 1.0f; }
+};
+
+// Narrows |frame| to |crop| without touching any pixels: data moves to the
+// first pixel of the region and width and height shrink, so everything
+// downstream reads only the region. UYVY regions widen to whole pixel
+// pairs. The region is clamped to the frame and is never empty.
+void CropSourceFrame(const CropRect& crop, SourceFrame* frame);
+
+// One frame source with its own capture thread, output settings and frame
+// slots, so several sources can be captured side by side without sharing
+// any per-frame state.
+//
+// Settings may be changed from any thread; the capture thread samples them
+// once per frame. The Take* calls are for a single consumer thread.
+class FrameReceiver {
+ public:
+  FrameReceiver(std::string source_name, std::unique_ptr<FrameSource> source);
+  ~FrameReceiver();
+  FrameReceiver(const FrameReceiver&) = delete;
+  FrameReceiver& operator=(const FrameReceiver&) = delete;
+
+  // Opens the source. Returns false if it cannot deliver.
+  bool Connect();
+
+  // True while the source delivers UYVY rather than BGRA.
+  bool uyvy() const { return source_->status().uyvy; }
+
+  const std::string& source_name() const { return source_name_; }
+
+  void Start();
+  void Stop();
+  bool running() const { return !stop_thread_.load(); }
+
+  // Sizes <= 0 mean "source resolution", or the crop's size within it.
+  void SetTargetSize(int width, int height) {
+    target_width_ = width;
+    target_height_ = height;
+  }
+  // Applied to every frame before it is scaled or analysed.
+  void SetCrop(const CropRect& crop) {
+    std::lock_guard<std::mutex> lock(crop_mutex_);
+    crop_ = crop;
+  }
+  CropRect crop() const {
+    std::lock_guard<std::mutex> lock(crop_mutex_);
+    return crop_;
+  }
+
+  // Which sender stream to pull; auto follows the target size.
+  void SetBandwidth(RecvBandwidth bandwidth) { bandwidth_ = static_cast<int>(bandwidth); }
+  RecvBandwidth bandwidth() const { return static_cast<RecvBandwidth>(bandwidth_.load()); }
+  // True while connected to the proxy stream.
+  bool proxy() const { return source_->status().proxy; }
+  void SetFilter(ScaleFilter filter) { filter_ = static_cast<int>(filter); }
+  ScaleFilter filter() const { return static_cast<ScaleFilter>(filter_.load()); }
+  void SetAnalysis(FrameAnalysis analysis) { analysis_ = static_cast<int>(analysis); }
+  void SetThreshold(int threshold) { threshold_ = threshold; }
+  // Threads, the capture thread included, that scaling and the luma/edge
+  // pass split their rows across; 0 picks RowPool::DefaultThreads().
+  void SetThreads(int threads) { threads_ = std::min(std::max(threads, 0), kMaxThreads); }
+  int threads() const;
+  // Mean per-byte difference a tile of the scaled frame must exceed to
+  // count as changed; negative turns detection off and every frame counts
+  // as changed as a whole. See ChangeDetector.
+  void SetChangeThreshold(int threshold) { change_threshold_ = threshold; }
+  void SetTrace(bool trace) { trace_ = trace; }
+  void SetTraceMaxPoints(int max_points) { trace_max_points_ = max_points; }
+  void SetTraceEpsilon(float epsilon) { trace_epsilon_ = epsilon; }
+  void SetTraceMinLength(int min_length) { trace_min_length_ = min_length; }
+
+  // Frame-sync mode: instead of publishing frames as the sender delivers
+  // them, pull one time-base corrected frame per tick at |fps|, the laser
+  // output rate. 0 goes back to push capture. Sources without a frame-sync
+  // keep their own rate.
+  void SetFrameSync(int fps) { frame_sync_fps_ = fps; }
+  int frame_sync() const { return frame_sync_fps_.load(); }
+  FrameSyncStats frame_sync_stats() const { return source_->frame_sync_stats(); }
+
+  // Audio analysis: audio that arrives with the video goes through an FFT
+  // on the capture thread (see AudioAnalyzer), and every published frame
+  // carries the band levels as of its arrival.
+  void SetAudio(bool enabled) { audio_ = enabled; }
+  bool audio() const { return audio_.load(); }
+  void SetAudioOptions(const AudioOptions& options) {
+    std::lock_guard<std::mutex> lock(audio_mutex_);
+    audio_options_ = options;
+  }
+  AudioOptions audio_options() const {
+    std::lock_guard<std::mutex> lock(audio_mutex_);
+    return audio_options_;
+  }
+  // The newest levels and spectrum; sequence 0 until audio has been
+  // analysed. For the consumer thread, like the Take* calls.
+  const AudioLevels& LatestAudio() { return audio_analyzer_.Latest(); }
+
+  // Capture telemetry since the receiver was created or last reset.
+  CaptureStatsSnapshot stats() const { return stats_.Snapshot(); }
+  void ResetStats() { stats_.Reset(); }
+
+  // Pooled mode publishes FrameSlabs instead of triple-buffer slots, so the
+  // receiver neither copies nor allocates per frame; see TakeSlab().
+  void SetPooled(bool pooled);
+  bool pooled() const { return pooled_.load(); }
+
+  // Shared-memory mode writes payloads into a SharedFrameRing that other
+  // processes can map, and TakeFrame() returns frames whose |shared| says
+  // where to read them instead of carrying |data|. Takes precedence over
+  // pooled mode.
+  void SetShared(bool shared);
+  bool shared() const { return shared_.load(); }
+
+  // Runs on the capture thread after every published frame. Set before
+  // Start().
+  void set_on_frame(std::function<void()> on_frame) { on_frame_ = std::move(on_frame); }
+
+  bool HasPendingFrame() const;
+  // Copy and shared mode: the newest frame, or null if nothing new was
+  // published. Stays valid until the next call.
+  const CapturedFrame* TakeFrame();
+  // Pooled mode: the newest slab, or null. The caller either lends it out
+  // through frame_pool() or releases it.
+  FrameSlab* TakeSlab() { return pending_slab_.exchange(nullptr); }
+  FramePool& frame_pool() { return *frame_pool_; }
+
+ private:
+  // What CaptureLoop publishes for one received frame. Settings are sampled
+  // once so a concurrent update cannot change the size mid-frame.
+  struct OutputShape {
+    int width;
+    int height;
+    ScaleFilter filter;
+    FrameAnalysis analysis;
+    int threshold;
+    bool trace;
+    bool uyvy;  // source layout, not output
+    FrameFormat format() const;
+  };
+
+  // Everything a payload depends on besides the picture itself.
+  struct PayloadInputs {
+    OutputShape shape;
+    TraceOptions trace_options;
+    bool operator==(const PayloadInputs& other) const;
+  };
+
+  CaptureRequest Request() const;
+  void SampleSource();
+  void RecordLatency(const SourceFrame& frame);
+  OutputShape OutputShapeFor(const SourceFrame& frame) const;
+  size_t PrepareFrame(const SourceFrame& frame, const OutputShape& shape);
+  void WriteFrame(const SourceFrame& frame, const OutputShape& shape, uint8_t* dst);
+  void ScaleForAnalysis(const SourceFrame& frame, const OutputShape& shape);
+  void AnalyzeImage(const OutputShape& shape, uint8_t* mask);
+  RowPool* Pool();
+  void DetectChanges(const uint8_t* image, const OutputShape& shape);
+  bool PublishShared(const SourceFrame& source_frame, const OutputShape& shape, size_t size, bool* unchanged);
+  bool FinishChanges(const OutputShape& shape);
+  bool SameAsPublished() const { return published_ && image_unchanged_ && inputs_ == published_inputs_; }
+  AudioBands CurrentAudio() const { return audio_active_ ? audio_analyzer_.bands() : AudioBands(); }
+  void DropPendingSlab();
+  void Publish(const SourceFrame& frame);
+  void CaptureLoop();
+
+  static constexpr int kCaptureTimeoutMs = 100;
+  const std::string source_name_;
+  const std::unique_ptr<FrameSource> source_;
+  std::atomic<int> bandwidth_{static_cast<int>(RecvBandwidth::kAuto)};
+
+  // The source's counters are polled from the capture thread, at most once
+  // per kSampleIntervalMs.
+  static constexpr int kSampleIntervalMs = 1000;
+  CaptureStats stats_;
+  uint64_t source_dropped_ = 0;
+  std::chrono::steady_clock::time_point last_sample_{};
+
+  std::thread capture_thread_;
+  std::atomic<bool> stop_thread_{true};
+  std::function<void()> on_frame_;
+
+  static constexpr int kMaxFrameSyncFps = 240;
+  std::atomic<int> frame_sync_fps_{0};
+
+  // Written only by capture_thread_, read only by the consumer.
+  TripleBuffer<CapturedFrame> frames_;
+
+  std::atomic<int> target_width_{480};
+  std::atomic<int> target_height_{480};
+  // Box reads every source pixel and is not yet as fast as nearest at
+  // 1080p -> 480 (scaler_benchmark checks), so it stays opt-in.
+  std::atomic<int> filter_{static_cast<int>(ScaleFilter::kNearest)};
+  mutable std::mutex crop_mutex_;
+  CropRect crop_;  // guarded by crop_mutex_
+
+  // Optional luma/edge pass. When enabled, frames carry a one-byte-per-pixel
+  // mask (see frame_analysis.h) instead of BGRA. The scratch buffers and the
+  // row pool belong to capture_thread_. analysis_image_ holds the scaled
+  // frame in the source layout, BGRA or resampled UYVY. The pool also
+  // stripes scaling, and is rebuilt when threads_ changes.
+  static constexpr int kMaxThreads = 16;
+  std::atomic<int> analysis_{static_cast<int>(FrameAnalysis::kNone)};
+  std::atomic<int> threshold_{128};
+  std::atomic<int> threads_{0};
+  std::vector<uint8_t> analysis_image_;
+  AnalysisScratch analysis_scratch_;
+  std::unique_ptr<RowPool> row_pool_;
+
+  // Optional contour tracing on top of the mask. Frames then carry the laser
+  // path itself, so neither pixels nor per-pixel work reach JS.
+  std::atomic<bool> trace_{false};
+  std::atomic<int> trace_max_points_{TraceOptions().max_points};
+  std::atomic<float> trace_epsilon_{TraceOptions().epsilon};
+  std::atomic<int> trace_min_length_{TraceOptions().min_length};
+  std::vector<uint8_t> trace_mask_;
+  std::vector<float> trace_points_;
+  TraceScratch trace_scratch_;
+
+  // Static-content detection on the scaled frame. A frame is unchanged when
+  // the picture and every input to the payload match the last published
+  // one; traced frames then reuse trace_points_ instead of tracing again.
+  static constexpr int kDefaultChangeThreshold = 2;
+  std::atomic<int> change_threshold_{kDefaultChangeThreshold};
+  ChangeDetector change_detector_;
+  bool detected_uyvy_ = false;
+  bool image_unchanged_ = false;
+  std::vector<DirtyRect> dirty_;
+  PayloadInputs inputs_{};
+  PayloadInputs published_inputs_{};
+  bool published_ = false;
+
+  // Audio analysis. The analyzer is fed and configured on the capture
+  // thread; only its published snapshots cross to the consumer.
+  std::atomic<bool> audio_{false};
+  mutable std::mutex audio_mutex_;
+  AudioOptions audio_options_;  // guarded by audio_mutex_
+  AudioAnalyzer audio_analyzer_;
+  bool audio_active_ = false;
+
+  // Pooled mode: the capture thread fills slabs from frame_pool_ and
+  // publishes the newest one through pending_slab_.
+  // One slab being written, one pending, two still referenced from JS.
+  static constexpr size_t kFramePoolSlabs = 4;
+  std::atomic<bool> pooled_{false};
+  std::shared_ptr<FramePool> frame_pool_;
+  std::atomic<FrameSlab*> pending_slab_{nullptr};
+
+  // Shared-memory mode: ring_ belongs to the capture thread and is replaced
+  // by a larger one when a payload outgrows it. One slot being written, one
+  // pending, two being read.
+  static constexpr uint32_t kRingSlots = 4;
+  static constexpr size_t kRingCapacityStep = 1 << 20;
+  std::atomic<bool> shared_{false};
+  std::unique_ptr<SharedFrameRing> ring_;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_FRAME_RECEIVER_H_
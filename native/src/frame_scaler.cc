@@ -0,0 +1,816 @@
+#include "frame_scaler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "row_pool.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TL_SCALER_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define TL_SCALER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang need per-function target attributes to emit AVX2 without building
+// the whole addon with -mavx2; MSVC accepts the intrinsics unconditionally.
+#if defined(TL_SCALER_X86) && !defined(_MSC_VER)
+#define TL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TL_TARGET_AVX2
+#endif
+
+namespace {
+
+enum class Backend { kScalar, kSse2, kAvx2, kNeon };
+
+bool CpuHasAvx2() {
+#if defined(TL_SCALER_X86) && defined(_MSC_VER)
+  int regs[4];
+  __cpuid(regs, 1);
+  bool osxsave = (regs[2] & (1 << 27)) != 0;
+  bool avx = (regs[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx) return false;
+  // The OS must save YMM state across context switches.
+  if ((_xgetbv(0) & 0x6) != 0x6) return false;
+  __cpuidex(regs, 7, 0);
+  return (regs[1] & (1 << 5)) != 0;
+#elif defined(TL_SCALER_X86)
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+Backend DetectBackend() {
+#if defined(TL_SCALER_X86)
+  return CpuHasAvx2() ? Backend::kAvx2 : Backend::kSse2;
+#elif defined(TL_SCALER_NEON)
+  return Backend::kNeon;
+#else
+  return Backend::kScalar;
+#endif
+}
+
+Backend ActiveBackend() {
+  static const Backend backend = DetectBackend();
+  return backend;
+}
+
+// Source span [begin, end) covered by each output column or row. Spans never
+// overlap and never go empty, so upscaling degrades to nearest-neighbour.
+struct Span {
+  int begin;
+  int end;
+  float inv_len;  // 1 / (end - begin), so the per-pixel average needs no divide.
+};
+
+void BuildSpans(int src_len, int dst_len, std::vector<Span>* spans) {
+  spans->resize(dst_len);
+  for (int i = 0; i < dst_len; ++i) {
+    int begin = static_cast<int>(static_cast<int64_t>(i) * src_len / dst_len);
+    int end = static_cast<int>(static_cast<int64_t>(i + 1) * src_len / dst_len);
+    begin = std::min(begin, src_len - 1);
+    end = std::max(end, begin + 1);
+    (*spans)[i] = {begin, end, 1.0f / static_cast<float>(end - begin)};
+  }
+}
+
+// --- Vertical pass: sum the source rows of one output row into a u16 row
+// accumulator. With at most 257 rows per span the sum cannot overflow. Each
+// chunk is summed over all rows in registers and stored once.
+
+constexpr int kMaxU16Area = 257;
+
+void SumRowsScalar(const uint8_t* src, size_t stride, int rows, uint16_t* acc, int n) {
+  for (int i = 0; i < n; ++i) {
+    uint16_t sum = 0;
+    for (int r = 0; r < rows; ++r) sum = static_cast<uint16_t>(sum + src[r * stride + i]);
+    acc[i] = sum;
+  }
+}
+
+#if defined(TL_SCALER_X86)
+void SumRowsSse2(const uint8_t* src, size_t stride, int rows, uint16_t* acc, int n) {
+  const __m128i zero = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    __m128i lo = zero;
+    __m128i hi = zero;
+    const uint8_t* p = src + i;
+    for (int r = 0; r < rows; ++r, p += stride) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      lo = _mm_add_epi16(lo, _mm_unpacklo_epi8(v, zero));
+      hi = _mm_add_epi16(hi, _mm_unpackhi_epi8(v, zero));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i + 8), hi);
+  }
+  SumRowsScalar(src + i, stride, rows, acc + i, n - i);
+}
+
+TL_TARGET_AVX2 void SumRowsAvx2(const uint8_t* src, size_t stride, int rows, uint16_t* acc, int n) {
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i lo = _mm256_setzero_si256();
+    __m256i hi = _mm256_setzero_si256();
+    const uint8_t* p = src + i;
+    for (int r = 0; r < rows; ++r, p += stride) {
+      lo = _mm256_add_epi16(lo, _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+      hi = _mm256_add_epi16(hi, _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16))));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i + 16), hi);
+  }
+  SumRowsScalar(src + i, stride, rows, acc + i, n - i);
+}
+
+// Even integer ratios: besides summing rows, add horizontally adjacent pixels
+// while widening (shuffle B0 B1 G0 G1 ... then multiply-add by one), so the
+// accumulator holds one entry per source pixel pair. |n| counts source bytes.
+TL_TARGET_AVX2 void SumRowPairsAvx2(const uint8_t* src, size_t stride, int rows, uint16_t* acc, int n) {
+  const __m256i pair_shuffle = _mm256_setr_epi8(
+      0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15,
+      0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+  const __m256i ones = _mm256_set1_epi8(1);
+  int i = 0;
+  for (; i + 32 <= n; i += 32) {
+    __m256i sum = _mm256_setzero_si256();
+    const uint8_t* p = src + i;
+    for (int r = 0; r < rows; ++r, p += stride) {
+      __m256i v = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), pair_shuffle);
+      sum = _mm256_add_epi16(sum, _mm256_maddubs_epi16(v, ones));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i / 2), sum);
+  }
+  for (; i + 8 <= n; i += 8) {
+    for (int c = 0; c < 4; ++c) {
+      uint16_t sum = 0;
+      for (int r = 0; r < rows; ++r) sum = static_cast<uint16_t>(sum + src[r * stride + i + c] + src[r * stride + i + 4 + c]);
+      acc[i / 2 + c] = sum;
+    }
+  }
+}
+#endif
+
+#if defined(TL_SCALER_NEON)
+void SumRowsNeon(const uint8_t* src, size_t stride, int rows, uint16_t* acc, int n) {
+  int i = 0;
+  for (; i + 16 <= n; i += 16) {
+    uint16x8_t lo = vdupq_n_u16(0);
+    uint16x8_t hi = vdupq_n_u16(0);
+    const uint8_t* p = src + i;
+    for (int r = 0; r < rows; ++r, p += stride) {
+      uint8x16_t v = vld1q_u8(p);
+      lo = vaddw_u8(lo, vget_low_u8(v));
+      hi = vaddw_u8(hi, vget_high_u8(v));
+    }
+    vst1q_u16(acc + i, lo);
+    vst1q_u16(acc + i + 8, hi);
+  }
+  SumRowsScalar(src + i, stride, rows, acc + i, n - i);
+}
+#endif
+
+// --- Horizontal pass: sum each column span of the accumulator (one BGRA
+// pixel = four u16 lanes) and divide by the box area.
+
+void ReduceRowScalar(const uint16_t* acc, const Span* spans, int count, int rows, uint8_t* dst) {
+  const float inv_rows = 1.0f / static_cast<float>(rows);
+  for (int x = 0; x < count; ++x) {
+    const Span& s = spans[x];
+    uint32_t sum[4] = {0, 0, 0, 0};
+    for (int sx = s.begin; sx < s.end; ++sx) {
+      const uint16_t* p = acc + sx * 4;
+      sum[0] += p[0];
+      sum[1] += p[1];
+      sum[2] += p[2];
+      sum[3] += p[3];
+    }
+    float inv = s.inv_len * inv_rows;
+    for (int c = 0; c < 4; ++c) {
+      dst[x * 4 + c] = static_cast<uint8_t>(sum[c] * inv + 0.5f);
+    }
+  }
+}
+
+#if defined(TL_SCALER_X86)
+// Fixed-point division by a box area: (sum + bias) * recip >> 16 matches
+// round(sum / area) to within one LSB for every sum a u16 lane can hold.
+struct Divisor {
+  uint16_t bias;
+  uint16_t recip;
+};
+
+struct DivisorTable {
+  Divisor entries[kMaxU16Area + 1];
+  constexpr DivisorTable() : entries() {
+    for (int area = 1; area <= kMaxU16Area; ++area) {
+      int recip = std::min(65535, (65536 + area / 2) / area);
+      entries[area] = {static_cast<uint16_t>(area > 1 ? area / 2 : 1), static_cast<uint16_t>(recip)};
+    }
+  }
+  constexpr const Divisor& operator[](int area) const { return entries[area]; }
+};
+
+constexpr DivisorTable kDivisors;
+
+inline __m128i Broadcast16(uint16_t value) {
+  return _mm_set1_epi16(static_cast<int16_t>(value));
+}
+
+// Sum of |len| accumulator pixels starting at |p|, in the low four u16 lanes.
+// Pixels are loaded two at a time and the halves folded together at the end.
+inline __m128i SumPixelsSse2(const uint16_t* p, int len) {
+  __m128i sum = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 2 <= len; i += 2) {
+    sum = _mm_add_epi16(sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 4)));
+  }
+  sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+  if (i < len) sum = _mm_add_epi16(sum, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + i * 4)));
+  return sum;
+}
+
+// Mixed span lengths (non-integer ratios). Two output pixels share a register.
+void ReduceRowSse2(const uint16_t* acc, const Span* spans, int count, int rows, uint8_t* dst) {
+  int x = 0;
+  for (; x + 2 <= count; x += 2) {
+    const Span& a = spans[x];
+    const Span& b = spans[x + 1];
+    int area_a = (a.end - a.begin) * rows;
+    int area_b = (b.end - b.begin) * rows;
+    if (area_a > kMaxU16Area || area_b > kMaxU16Area) break;
+    __m128i sums = _mm_unpacklo_epi64(SumPixelsSse2(acc + a.begin * 4, a.end - a.begin),
+                                      SumPixelsSse2(acc + b.begin * 4, b.end - b.begin));
+    __m128i bias = _mm_unpacklo_epi64(Broadcast16(kDivisors[area_a].bias), Broadcast16(kDivisors[area_b].bias));
+    __m128i recip = _mm_unpacklo_epi64(Broadcast16(kDivisors[area_a].recip), Broadcast16(kDivisors[area_b].recip));
+    __m128i avg = _mm_mulhi_epu16(_mm_adds_epu16(sums, bias), recip);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(avg, avg));
+  }
+  ReduceRowScalar(acc, spans + x, count - x, rows, dst + x * 4);
+}
+
+// Integer ratio: every span is K accumulator pixels wide and the loops fully
+// unroll. |area| is the number of source pixels behind each output pixel.
+template <int K>
+void ReduceUniformSse2(const uint16_t* acc, int count, int area, uint8_t* dst) {
+  const Divisor& d = kDivisors[area];
+  const __m128i bias = Broadcast16(d.bias);
+  const __m128i recip = Broadcast16(d.recip);
+  int x = 0;
+  for (; x + 2 <= count; x += 2) {
+    const uint16_t* p = acc + x * K * 4;
+    __m128i sums = _mm_unpacklo_epi64(SumPixelsSse2(p, K), SumPixelsSse2(p + K * 4, K));
+    __m128i avg = _mm_mulhi_epu16(_mm_adds_epu16(sums, bias), recip);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(avg, avg));
+  }
+  if (x < count) {
+    __m128i avg = _mm_mulhi_epu16(_mm_adds_epu16(SumPixelsSse2(acc + x * K * 4, K), bias), recip);
+    avg = _mm_packus_epi16(avg, avg);
+    std::memcpy(dst + x * 4, &avg, 4);
+  }
+}
+
+using UniformReduceFn = void (*)(const uint16_t*, int, int, uint8_t*);
+
+// 2:1, 4:1 and 8:1 ratios in one pass: each row's pixels are pair-summed
+// while widening and added across the span's rows in registers, then
+// divided and stored, eight output pixels per iteration. No row accumulator
+// goes through memory, which leaves the source read as the only real cost.
+// Matches SumRowPairsAvx2 + ReduceUniformSse2 byte for byte.
+template <int K>
+TL_TARGET_AVX2 void BoxRowsAvx2(const uint8_t* src, size_t stride, int rows, int count, int area, uint8_t* dst) {
+  static_assert(K == 2 || K == 4 || K == 8, "pair sums cover 2:1, 4:1 and 8:1 only");
+  const __m256i pair_shuffle = _mm256_setr_epi8(
+      0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15,
+      0, 4, 1, 5, 2, 6, 3, 7, 8, 12, 9, 13, 10, 14, 11, 15);
+  const __m256i ones = _mm256_set1_epi8(1);
+  const Divisor& d = kDivisors[area];
+  const __m256i bias = _mm256_set1_epi16(static_cast<int16_t>(d.bias));
+  const __m256i recip = _mm256_set1_epi16(static_cast<int16_t>(d.recip));
+  // Four pixel pairs per 128-bit lane: s[0]/s[1] cover source pixels 0-15,
+  // s[2]/s[3] 16-31 (4:1 and 8:1), s[4]-s[7] 32-63 (8:1).
+  int x = 0;
+  for (; x + 8 <= count; x += 8) {
+    __m256i s[8];
+    for (int i = 0; i < 8; ++i) s[i] = _mm256_setzero_si256();
+    const uint8_t* p = src + static_cast<size_t>(x) * K * 4;
+    for (int r = 0; r < rows; ++r, p += stride) {
+      const __m256i* v = reinterpret_cast<const __m256i*>(p);
+      for (int i = 0; i < K; ++i) {
+        s[i] = _mm256_add_epi16(s[i], _mm256_maddubs_epi16(_mm256_shuffle_epi8(_mm256_loadu_si256(v + i), pair_shuffle), ones));
+      }
+    }
+    __m256i out;
+    if (K == 8) {
+      // Each register is one output pixel: fold its pairs within each lane
+      // (pixels 0 1 | 0 1 for s[0], s[1]), then the lanes.
+      __m128i folded[4];
+      for (int i = 0; i < 4; ++i) {
+        __m256i a = _mm256_add_epi16(_mm256_unpacklo_epi64(s[2 * i], s[2 * i + 1]),
+                                     _mm256_unpackhi_epi64(s[2 * i], s[2 * i + 1]));
+        folded[i] = _mm_add_epi16(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+      }
+      __m256i lo = _mm256_set_m128i(folded[1], folded[0]);
+      __m256i hi = _mm256_set_m128i(folded[3], folded[2]);
+      lo = _mm256_mulhi_epu16(_mm256_adds_epu16(lo, bias), recip);
+      hi = _mm256_mulhi_epu16(_mm256_adds_epu16(hi, bias), recip);
+      // Lanes hold pixels 0 1 4 5 | 2 3 6 7.
+      out = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+    } else if (K == 2) {
+      // Pairs are the output pixels: 0-3 and 4-7, split across lanes.
+      __m256i lo = _mm256_mulhi_epu16(_mm256_adds_epu16(s[0], bias), recip);
+      __m256i hi = _mm256_mulhi_epu16(_mm256_adds_epu16(s[1], bias), recip);
+      out = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8);
+    } else {
+      // Adjacent pairs of two registers fold into pixels (0 2 | 1 3).
+      __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi64(s[0], s[1]), _mm256_unpackhi_epi64(s[0], s[1]));
+      __m256i hi = _mm256_add_epi16(_mm256_unpacklo_epi64(s[2], s[3]), _mm256_unpackhi_epi64(s[2], s[3]));
+      lo = _mm256_mulhi_epu16(_mm256_adds_epu16(lo, bias), recip);
+      hi = _mm256_mulhi_epu16(_mm256_adds_epu16(hi, bias), recip);
+      out = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(lo, hi), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), out);
+  }
+  for (; x < count; ++x) {
+    for (int c = 0; c < 4; ++c) {
+      uint32_t sum = 0;
+      for (int r = 0; r < rows; ++r) {
+        const uint8_t* p = src + r * stride + static_cast<size_t>(x) * K * 4 + c;
+        for (int k = 0; k < K; ++k) sum += p[k * 4];
+      }
+      dst[x * 4 + c] = static_cast<uint8_t>((std::min<uint32_t>(sum + d.bias, 65535) * d.recip) >> 16);
+    }
+  }
+}
+
+// Column tap table for spans of at most four pixels, any mix of lengths.
+// Each 128-bit lane of a load takes the 16 source bytes from one span's
+// start, which hold two spans of up to two pixels or one of up to four,
+// and a per-lane shuffle lines up each channel's pixels in pairs (zeroing
+// the ones past the span) for a multiply-add by one.
+struct ColumnTaps {
+  int src_w = 0;  // the widths it was built for
+  int dst_w = 0;
+  int span_pixels = 0;  // 2 or 4; 0 when some span is longer
+  int simd_count = 0;   // columns whose loads stay inside the row, in eights
+  std::vector<int32_t> window;   // byte offset of each lane's load, in use order
+  std::vector<uint8_t> shuffle;  // 16 bytes per lane
+  int rows[2] = {0, 0};          // the row count each divisor set is for
+  std::vector<uint16_t> bias[2];  // per column, once per channel
+  std::vector<uint16_t> recip[2];
+};
+
+// Kept across calls while the widths stay the same, as they do from frame
+// to frame.
+void BuildColumnTaps(const std::vector<Span>& spans, int src_w, ColumnTaps* taps) {
+  const int count = static_cast<int>(spans.size());
+  if (taps->src_w == src_w && taps->dst_w == count) return;
+  taps->src_w = src_w;
+  taps->dst_w = count;
+  int longest = 0;
+  for (const Span& s : spans) longest = std::max(longest, s.end - s.begin);
+  taps->span_pixels = longest <= 2 ? 2 : longest <= 4 ? 4 : 0;
+  taps->simd_count = 0;
+  taps->rows[0] = taps->rows[1] = 0;
+  if (!taps->span_pixels) return;
+  const int per_lane = taps->span_pixels == 2 ? 2 : 1;
+  taps->window.clear();
+  taps->shuffle.clear();
+  for (int x = 0; x + 8 <= count; x += 8) {
+    // Lanes in register order: two columns each, or with one column per
+    // lane, (x, x + 2) (x + 1, x + 3) so folding the halves gives x..x + 3.
+    static constexpr int kSingle[8] = {0, 2, 1, 3, 4, 6, 5, 7};
+    const size_t group = taps->window.size();
+    bool fits = true;
+    for (int lane = 0; lane < 8 / per_lane && fits; ++lane) {
+      const int first = x + (per_lane == 2 ? lane * 2 : kSingle[lane]);
+      const int base = spans[first].begin;
+      fits = base * 4 + 16 <= src_w * 4;
+      uint8_t bytes[16];
+      for (int j = 0; j < per_lane; ++j) {
+        const Span& s = spans[first + j];
+        for (int half = 0; half < 16 / per_lane; half += 8) {
+          for (int c = 0; c < 4; ++c) {
+            for (int k = 0; k < 2; ++k) {
+              const int pixel = s.begin - base + (half / 8) * 2 + k;
+              const bool used = s.begin + (half / 8) * 2 + k < s.end;
+              fits = fits && (!used || pixel < 4);
+              bytes[j * 8 + half + c * 2 + k] = used ? static_cast<uint8_t>(pixel * 4 + c) : 0x80;
+            }
+          }
+        }
+      }
+      taps->window.push_back(base * 4);
+      taps->shuffle.insert(taps->shuffle.end(), bytes, bytes + 16);
+    }
+    if (!fits) {
+      // Later columns only start further right; leave them to the tail.
+      taps->window.resize(group);
+      taps->shuffle.resize(group * 16);
+      break;
+    }
+    taps->simd_count = x + 8;
+  }
+}
+
+// Divisors for spans |rows| tall, cached for the two row counts a
+// downscale's spans alternate between; false if an area does not fit a u16
+// lane.
+bool ColumnDivisors(const std::vector<Span>& spans, int rows, ColumnTaps* taps,
+                    const uint16_t** bias, const uint16_t** recip) {
+  if (taps->span_pixels * rows > kMaxU16Area) return false;
+  const int slot = rows & 1;
+  if (taps->rows[slot] != rows) {
+    taps->bias[slot].resize(spans.size() * 4);
+    taps->recip[slot].resize(spans.size() * 4);
+    for (size_t x = 0; x < spans.size(); ++x) {
+      const Divisor& d = kDivisors[(spans[x].end - spans[x].begin) * rows];
+      std::fill_n(&taps->bias[slot][x * 4], 4, d.bias);
+      std::fill_n(&taps->recip[slot][x * 4], 4, d.recip);
+    }
+    taps->rows[slot] = rows;
+  }
+  *bias = taps->bias[slot].data();
+  *recip = taps->recip[slot].data();
+  return true;
+}
+
+// Any ratio whose spans are at most |P| pixels wide, in one pass like
+// BoxRowsAvx2: every source row is shuffled, pair-summed and added into
+// running sums held in registers, eight output pixels at a time, then
+// divided once per span. The columns past the tap table's are summed one
+// by one. Matches SumRowsAvx2 + ReduceRowSse2 byte for byte.
+template <int P>
+TL_TARGET_AVX2 void BoxTapsAvx2(const uint8_t* src, size_t stride, int rows, const std::vector<Span>& spans,
+                                const ColumnTaps& taps, const uint16_t* bias, const uint16_t* recip,
+                                uint8_t* dst) {
+  constexpr int kRegs = P == 2 ? 2 : 4;  // per eight output pixels
+  const __m256i ones = _mm256_set1_epi8(1);
+  const int32_t* window = taps.window.data();
+  const uint8_t* shuffle = taps.shuffle.data();
+  int x = 0;
+  for (; x < taps.simd_count; x += 8, window += kRegs * 2, shuffle += kRegs * 32) {
+    __m256i control[kRegs];
+    __m256i s[kRegs];
+    for (int j = 0; j < kRegs; ++j) {
+      control[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shuffle + j * 32));
+      s[j] = _mm256_setzero_si256();
+    }
+    const uint8_t* p = src;
+    for (int r = 0; r < rows; ++r, p += stride) {
+      for (int j = 0; j < kRegs; ++j) {
+        __m256i v = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + window[j * 2]))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + window[j * 2 + 1])), 1);
+        s[j] = _mm256_add_epi16(s[j], _mm256_maddubs_epi16(_mm256_shuffle_epi8(v, control[j]), ones));
+      }
+    }
+    __m256i lo = s[0];
+    __m256i hi = s[1];
+    if (P == 4) {
+      // Each lane holds one column as two pair sums; fold them.
+      lo = _mm256_add_epi16(_mm256_unpacklo_epi64(s[0], s[1]), _mm256_unpackhi_epi64(s[0], s[1]));
+      hi = _mm256_add_epi16(_mm256_unpacklo_epi64(s[kRegs - 2], s[kRegs - 1]),
+                            _mm256_unpackhi_epi64(s[kRegs - 2], s[kRegs - 1]));
+    }
+    lo = _mm256_mulhi_epu16(_mm256_adds_epu16(lo, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bias + x * 4))),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(recip + x * 4)));
+    hi = _mm256_mulhi_epu16(_mm256_adds_epu16(hi, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bias + x * 4 + 16))),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(recip + x * 4 + 16)));
+    // Lanes hold pixels 0 1 4 5 | 2 3 6 7.
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4),
+                        _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8));
+  }
+  for (; x < static_cast<int>(spans.size()); ++x) {
+    const Span& sx = spans[x];
+    for (int c = 0; c < 4; ++c) {
+      uint32_t sum = 0;
+      for (int r = 0; r < rows; ++r) {
+        const uint8_t* p = src + r * stride + c;
+        for (int i = sx.begin; i < sx.end; ++i) sum += p[i * 4];
+      }
+      dst[x * 4 + c] = static_cast<uint8_t>((std::min<uint32_t>(sum + bias[x * 4], 65535) * recip[x * 4]) >> 16);
+    }
+  }
+}
+
+UniformReduceFn UniformReduceSse2(int k) {
+  switch (k) {
+    case 1: return ReduceUniformSse2<1>;
+    case 2: return ReduceUniformSse2<2>;
+    case 3: return ReduceUniformSse2<3>;
+    case 4: return ReduceUniformSse2<4>;
+    case 5: return ReduceUniformSse2<5>;
+    case 6: return ReduceUniformSse2<6>;
+    case 8: return ReduceUniformSse2<8>;
+    default: return nullptr;
+  }
+}
+#endif
+
+#if defined(TL_SCALER_NEON)
+void ReduceRowNeon(const uint16_t* acc, const Span* spans, int count, int rows, uint8_t* dst) {
+  const float inv_rows = 1.0f / static_cast<float>(rows);
+  for (int x = 0; x < count; ++x) {
+    const Span& s = spans[x];
+    uint32x4_t sum = vdupq_n_u32(0);
+    for (int sx = s.begin; sx < s.end; ++sx) sum = vaddw_u16(sum, vld1_u16(acc + sx * 4));
+    float32x4_t avg = vmulq_n_f32(vcvtq_f32_u32(sum), s.inv_len * inv_rows);
+    uint16x4_t narrow = vqmovn_u32(vcvtq_u32_f32(vaddq_f32(avg, vdupq_n_f32(0.5f))));
+    uint8x8_t bytes = vqmovn_u16(vcombine_u16(narrow, narrow));
+    vst1_lane_u32(reinterpret_cast<uint32_t*>(dst + x * 4), vreinterpret_u32_u8(bytes), 0);
+  }
+}
+#endif
+
+struct BoxKernels {
+  void (*sum_rows)(const uint8_t*, size_t, int, uint16_t*, int);
+  void (*reduce)(const uint16_t*, const Span*, int, int, uint8_t*);
+};
+
+BoxKernels SelectBoxKernels() {
+  switch (ActiveBackend()) {
+#if defined(TL_SCALER_X86)
+    case Backend::kAvx2:
+      return {SumRowsAvx2, ReduceRowSse2};
+    case Backend::kSse2:
+      return {SumRowsSse2, ReduceRowSse2};
+#endif
+#if defined(TL_SCALER_NEON)
+    case Backend::kNeon:
+      return {SumRowsNeon, ReduceRowNeon};
+#endif
+    default:
+      return {SumRowsScalar, ReduceRowScalar};
+  }
+}
+
+// Tall spans would overflow the u16 accumulator; sum straight into u64.
+void ScaleBoxWide(const uint8_t* src, int src_stride, const std::vector<Span>& x_spans,
+                  const Span& y_span, uint8_t* dst) {
+  for (size_t x = 0; x < x_spans.size(); ++x) {
+    const Span& xs = x_spans[x];
+    uint64_t sum[4] = {0, 0, 0, 0};
+    for (int sy = y_span.begin; sy < y_span.end; ++sy) {
+      const uint8_t* row = src + static_cast<size_t>(sy) * src_stride;
+      for (int sx = xs.begin; sx < xs.end; ++sx) {
+        for (int c = 0; c < 4; ++c) sum[c] += row[sx * 4 + c];
+      }
+    }
+    uint64_t area = static_cast<uint64_t>(xs.end - xs.begin) * (y_span.end - y_span.begin);
+    for (int c = 0; c < 4; ++c) dst[x * 4 + c] = static_cast<uint8_t>((sum[c] + area / 2) / area);
+  }
+}
+
+// Output rows [y_begin, y_end). The spans are rebuilt per call on each
+// thread's own vectors, which costs far less than one output row.
+void ScaleBox(const uint8_t* src, int src_w, int src_h, int src_stride,
+              uint8_t* dst, int dst_w, int dst_h, int y_begin, int y_end) {
+  static thread_local std::vector<Span> x_spans;
+  static thread_local std::vector<Span> y_spans;
+  static thread_local std::vector<uint16_t> acc;
+  static const BoxKernels kernels = SelectBoxKernels();
+
+  BuildSpans(src_w, dst_w, &x_spans);
+  BuildSpans(src_h, dst_h, &y_spans);
+  const int row_values = src_w * 4;
+  acc.resize(row_values);
+
+  int uniform_k = src_w % dst_w == 0 ? src_w / dst_w : 0;
+#if defined(TL_SCALER_X86)
+  const bool avx2 = ActiveBackend() == Backend::kAvx2;
+  void (*fused)(const uint8_t*, size_t, int, int, int, uint8_t*) = nullptr;
+  if (avx2 && uniform_k == 2) fused = BoxRowsAvx2<2>;
+  if (avx2 && uniform_k == 4) fused = BoxRowsAvx2<4>;
+  if (avx2 && uniform_k == 8) fused = BoxRowsAvx2<8>;
+  // Other even ratios: the vertical pass pre-sums pixel pairs and the reduce
+  // only has half as many entries to fold.
+  bool pairs = avx2 && uniform_k % 2 == 0 && UniformReduceSse2(uniform_k / 2);
+  UniformReduceFn uniform_reduce = pairs ? UniformReduceSse2(uniform_k / 2) : UniformReduceSse2(uniform_k);
+  // Spans up to four pixels wide, whatever their mix: the tap table.
+  static thread_local ColumnTaps taps;
+  void (*tapped)(const uint8_t*, size_t, int, const std::vector<Span>&, const ColumnTaps&, const uint16_t*,
+                 const uint16_t*, uint8_t*) = nullptr;
+  if (avx2 && !fused) {
+    BuildColumnTaps(x_spans, src_w, &taps);
+    if (taps.span_pixels == 2) tapped = BoxTapsAvx2<2>;
+    if (taps.span_pixels == 4) tapped = BoxTapsAvx2<4>;
+  }
+#endif
+
+  for (int y = y_begin; y < y_end; ++y) {
+    const Span& ys = y_spans[y];
+    uint8_t* dst_row = dst + static_cast<size_t>(y) * dst_w * 4;
+    int rows = ys.end - ys.begin;
+    if (rows > kMaxU16Area) {
+      ScaleBoxWide(src, src_stride, x_spans, ys, dst_row);
+      continue;
+    }
+    const uint8_t* src_row = src + static_cast<size_t>(ys.begin) * src_stride;
+#if defined(TL_SCALER_X86)
+    int area = uniform_k * rows;
+    if (fused && area <= kMaxU16Area) {
+      fused(src_row, src_stride, rows, dst_w, area, dst_row);
+      continue;
+    }
+    const uint16_t* bias;
+    const uint16_t* recip;
+    if (tapped && ColumnDivisors(x_spans, rows, &taps, &bias, &recip)) {
+      tapped(src_row, src_stride, rows, x_spans, taps, bias, recip, dst_row);
+      continue;
+    }
+    if (uniform_reduce && area <= kMaxU16Area) {
+      if (pairs) {
+        SumRowPairsAvx2(src_row, src_stride, rows, acc.data(), row_values);
+      } else {
+        kernels.sum_rows(src_row, src_stride, rows, acc.data(), row_values);
+      }
+      uniform_reduce(acc.data(), dst_w, area, dst_row);
+      continue;
+    }
+#endif
+    kernels.sum_rows(src_row, src_stride, rows, acc.data(), row_values);
+    kernels.reduce(acc.data(), x_spans.data(), dst_w, rows, dst_row);
+  }
+}
+
+void ScaleNearest(const uint8_t* src, int src_w, int src_h, int src_stride,
+                  uint8_t* dst, int dst_w, int dst_h, int y_begin, int y_end) {
+  float scale_x = static_cast<float>(src_w) / dst_w;
+  float scale_y = static_cast<float>(src_h) / dst_h;
+
+  uint32_t* dst_ptr = reinterpret_cast<uint32_t*>(dst);
+  for (int y = y_begin; y < y_end; ++y) {
+    const uint32_t* src_row = reinterpret_cast<const uint32_t*>(src + static_cast<int>(y * scale_y) * src_stride);
+    for (int x = 0; x < dst_w; ++x) {
+      dst_ptr[y * dst_w + x] = src_row[static_cast<int>(x * scale_x)];
+    }
+  }
+}
+
+// Fixed-point (8.8) bilinear with pixel-centre alignment. Taps are clamped
+// so index + next always stays inside the image; next is 0 only for a
+// one-pixel-wide source.
+struct Tap {
+  int index;
+  int next;
+  int weight;  // Weight of index + next, out of 256.
+};
+
+void BuildTaps(int src_len, int dst_len, std::vector<Tap>* taps) {
+  taps->resize(dst_len);
+  float scale = static_cast<float>(src_len) / dst_len;
+  int last = std::max(0, src_len - 2);
+  for (int i = 0; i < dst_len; ++i) {
+    float pos = std::min(std::max(0.0f, (i + 0.5f) * scale - 0.5f), static_cast<float>(src_len - 1));
+    int index = std::min(static_cast<int>(pos), last);
+    int weight = static_cast<int>((pos - index) * 256.0f + 0.5f);
+    (*taps)[i] = {index, src_len > 1 ? 1 : 0, std::min(weight, 256)};
+  }
+}
+
+void BilinearRowScalar(const uint8_t* row0, const uint8_t* row1, const Tap* x_taps, int count,
+                       int wy, uint8_t* out) {
+  for (int x = 0; x < count; ++x) {
+    const Tap& tx = x_taps[x];
+    int i0 = tx.index * 4;
+    int i1 = i0 + tx.next * 4;
+    for (int c = 0; c < 4; ++c) {
+      int top = row0[i0 + c] * (256 - tx.weight) + row0[i1 + c] * tx.weight;
+      int bottom = row1[i0 + c] * (256 - tx.weight) + row1[i1 + c] * tx.weight;
+      out[x * 4 + c] = static_cast<uint8_t>((top * (256 - wy) + bottom * wy + 32768) >> 16);
+    }
+  }
+}
+
+#if defined(TL_SCALER_X86)
+// Both horizontal taps are adjacent, so one 8-byte load per row fetches them.
+// The vertical blend runs first on the two pixels, then the horizontal blend
+// folds the halves; each stage rounds back to 8 bits so u16 lanes suffice.
+void BilinearRowSse2(const uint8_t* row0, const uint8_t* row1, const Tap* x_taps, int count,
+                     int wy, uint8_t* out) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i round = _mm_set1_epi16(128);
+  const __m128i w_top = _mm_set1_epi16(static_cast<int16_t>(256 - wy));
+  const __m128i w_bottom = _mm_set1_epi16(static_cast<int16_t>(wy));
+  for (int x = 0; x < count; ++x) {
+    const Tap& tx = x_taps[x];
+    __m128i top = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row0 + tx.index * 4)), zero);
+    __m128i bottom = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row1 + tx.index * 4)), zero);
+    __m128i v = _mm_add_epi16(_mm_mullo_epi16(top, w_top), _mm_mullo_epi16(bottom, w_bottom));
+    v = _mm_srli_epi16(_mm_add_epi16(v, round), 8);
+    __m128i wx = _mm_set_epi16(
+        static_cast<int16_t>(tx.weight), static_cast<int16_t>(tx.weight), static_cast<int16_t>(tx.weight), static_cast<int16_t>(tx.weight),
+        static_cast<int16_t>(256 - tx.weight), static_cast<int16_t>(256 - tx.weight), static_cast<int16_t>(256 - tx.weight), static_cast<int16_t>(256 - tx.weight));
+    __m128i h = _mm_mullo_epi16(v, wx);
+    h = _mm_add_epi16(h, _mm_srli_si128(h, 8));
+    h = _mm_srli_epi16(_mm_add_epi16(h, round), 8);
+    h = _mm_packus_epi16(h, h);
+    std::memcpy(out + x * 4, &h, 4);
+  }
+}
+#endif
+
+void ScaleBilinear(const uint8_t* src, int src_w, int src_h, int src_stride,
+                   uint8_t* dst, int dst_w, int dst_h, int y_begin, int y_end) {
+  static thread_local std::vector<Tap> x_taps;
+  static thread_local std::vector<Tap> y_taps;
+  BuildTaps(src_w, dst_w, &x_taps);
+  BuildTaps(src_h, dst_h, &y_taps);
+
+  auto row_fn = BilinearRowScalar;
+#if defined(TL_SCALER_X86)
+  if (src_w > 1) row_fn = BilinearRowSse2;
+#endif
+
+  for (int y = y_begin; y < y_end; ++y) {
+    const Tap& ty = y_taps[y];
+    const uint8_t* row0 = src + static_cast<size_t>(ty.index) * src_stride;
+    const uint8_t* row1 = row0 + static_cast<size_t>(ty.next) * src_stride;
+    row_fn(row0, row1, x_taps.data(), dst_w, ty.weight, dst + static_cast<size_t>(y) * dst_w * 4);
+  }
+}
+
+}  // namespace
+
+bool ParseScaleFilter(const std::string& name, ScaleFilter* filter) {
+  if (name == "nearest") {
+    *filter = ScaleFilter::kNearest;
+  } else if (name == "box" || name == "area") {
+    *filter = ScaleFilter::kBox;
+  } else if (name == "bilinear") {
+    *filter = ScaleFilter::kBilinear;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* ScaleFilterName(ScaleFilter filter) {
+  switch (filter) {
+    case ScaleFilter::kBox: return "box";
+    case ScaleFilter::kBilinear: return "bilinear";
+    case ScaleFilter::kNearest:
+    default: return "nearest";
+  }
+}
+
+const char* ScalerBackendName() {
+  switch (ActiveBackend()) {
+    case Backend::kAvx2: return "avx2";
+    case Backend::kSse2: return "sse2";
+    case Backend::kNeon: return "neon";
+    case Backend::kScalar:
+    default: return "scalar";
+  }
+}
+
+void ScaleBgra(const uint8_t* src, int src_w, int src_h, int src_stride,
+               uint8_t* dst, int dst_w, int dst_h, ScaleFilter filter, RowPool* pool) {
+  if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0) return;
+
+  auto rows = [&](int begin, int end) {
+    if (src_w == dst_w && src_h == dst_h) {
+      size_t row_bytes = static_cast<size_t>(src_w) * 4;
+      for (int y = begin; y < end; ++y) {
+        std::memcpy(dst + y * row_bytes, src + static_cast<size_t>(y) * src_stride, row_bytes);
+      }
+      return;
+    }
+    switch (filter) {
+      case ScaleFilter::kBox:
+        ScaleBox(src, src_w, src_h, src_stride, dst, dst_w, dst_h, begin, end);
+        break;
+      case ScaleFilter::kBilinear:
+        ScaleBilinear(src, src_w, src_h, src_stride, dst, dst_w, dst_h, begin, end);
+        break;
+      case ScaleFilter::kNearest:
+      default:
+        ScaleNearest(src, src_w, src_h, src_stride, dst, dst_w, dst_h, begin, end);
+        break;
+    }
+  };
+  // Every output row depends only on its own source rows, so stripes of
+  // output rows split cleanly across threads.
+  if (pool && pool->threads() > 1) {
+    pool->Run(dst_h, rows);
+  } else {
+    rows(0, dst_h);
+  }
+}
+
+void ScaleUyvy(const uint8_t* src, int src_w, int src_h, int src_stride,
+               uint8_t* dst, int dst_w, int dst_h, ScaleFilter filter, RowPool* pool) {
+  // A macropixel is 4 bytes like a BGRA pixel, so the BGRA kernels apply
+  // unchanged; each output pixel's span then covers twice as many source
+  // pixels horizontally, which is what the target width asks for.
+  ScaleBgra(src, std::max(src_w / 2, 1), src_h, src_stride, dst, dst_w, dst_h, filter, pool);
+}
@@ -0,0 +1,41 @@
+#ifndef TRUELAZER_NATIVE_SRC_FRAME_SCALER_H_
+#define TRUELAZER_NATIVE_SRC_FRAME_SCALER_H_
+
+#include <cstdint>
+#include <string>
+
+class RowPool;
+
+enum class ScaleFilter {
+  kNearest,
+  // Area average: every source pixel contributes to exactly one output pixel.
+  // Removes the aliasing nearest-neighbour produces on text and fine lines.
+  kBox,
+  // 2x2 tap interpolation. Only anti-aliases ratios below 2:1.
+  kBilinear,
+};
+
+// Parses "nearest", "box"/"area" or "bilinear". Returns false on anything else.
+bool ParseScaleFilter(const std::string& name, ScaleFilter* filter);
+const char* ScaleFilterName(ScaleFilter filter);
+
+// Name of the SIMD path picked at runtime for the box filter: "avx2", "sse2",
+// "neon" or "scalar".
+const char* ScalerBackendName();
+
+// Resizes a 4-byte-per-pixel (BGRA/BGRX) image. |src_stride| is in bytes; the
+// destination is tightly packed (dst_w * 4 bytes per row). With |pool| the
+// output rows are split into stripes across its threads; the result is the
+// same byte for byte.
+void ScaleBgra(const uint8_t* src, int src_w, int src_h, int src_stride,
+               uint8_t* dst, int dst_w, int dst_h, ScaleFilter filter, RowPool* pool = nullptr);
+
+// Resizes a UYVY 4:2:2 image (U Y0 V Y1 per pixel pair) to one (U, Y0, V, Y1)
+// group per output pixel: Y0 and Y1 average the even and odd source columns
+// of the pixel's span, U and V its chroma. Reads half the bytes of a BGRA
+// frame. Horizontal luma detail is limited to source pairs, which only shows
+// when dst_w exceeds src_w / 2. See frame_analysis.h for consuming it.
+void ScaleUyvy(const uint8_t* src, int src_w, int src_h, int src_stride,
+               uint8_t* dst, int dst_w, int dst_h, ScaleFilter filter, RowPool* pool = nullptr);
+
+#endif  // TRUELAZER_NATIVE_SRC_FRAME_SCALER_H_
@@ -0,0 +1,87 @@
+#ifndef TRUELAZER_NATIVE_SRC_FRAME_SOURCE_H_
+#define TRUELAZER_NATIVE_SRC_FRAME_SOURCE_H_
+
+#include <cstdint>
+
+#include "bandwidth_policy.h"
+#include "frame_sync.h"
+
+class AudioAnalyzer;
+
+// Where a FrameReceiver gets its video from. The receiver owns the capture
+// thread and everything after a frame arrives (scaling, analysis, handoff);
+// a source only delivers raw frames. NdiFrameSource reads an NDI sender;
+// SyntheticFrameSource generates or replays frames without NDI, for tests
+// and benchmarks.
+
+enum class PixelLayout {
+  kBgra,  // 4 bytes per pixel; BGRX sources carry opaque alpha
+  kUyvy,  // 4:2:2, U Y0 V Y1 per pixel pair
+};
+
+constexpr int64_t kNoTimestamp = INT64_MAX;
+
+// One frame lent out by Capture(). |data| stays valid until Release().
+struct SourceFrame {
+  const uint8_t* data = nullptr;
+  int width = 0;
+  int height = 0;
+  int stride = 0;
+  PixelLayout layout = PixelLayout::kBgra;
+  int64_t timestamp = kNoTimestamp;  // when it was sent, UTC in 100 ns units
+  int frame_rate_n = 0;              // 0 if unknown
+  int frame_rate_d = 1;
+  bool paced = false;  // Capture() slept on our clock rather than waiting for the sender
+};
+
+// What the receiver currently wants; sampled before every Capture() so
+// setting changes take effect on the next frame.
+struct CaptureRequest {
+  int target_width = 0;  // <= 0: source resolution
+  int target_height = 0;
+  bool accepts_uyvy = false;  // the payload needs luma and sparse colour only
+  RecvBandwidth bandwidth = RecvBandwidth::kAuto;
+  int frame_sync_fps = 0;  // > 0: deliver one frame per tick at this rate
+  // Non-null: audio that arrives with the video goes through this, on the
+  // capture thread, before the frame it came with is returned.
+  AudioAnalyzer* audio = nullptr;
+};
+
+enum class CaptureResult {
+  kFrame,
+  kTimeout,  // nothing this time, try again
+  kError,    // the source is gone; the capture thread stops
+};
+
+// State a source reports about itself; readable from any thread.
+struct SourceStatus {
+  bool uyvy = false;   // asks its sender for UYVY
+  bool proxy = false;  // on the low-bandwidth stream
+};
+
+// All calls except status() and frame_sync_stats() come from the capture
+// thread, or from the owning thread before it starts.
+class FrameSource {
+ public:
+  virtual ~FrameSource() = default;
+
+  // Prepares the source for |request|. Returns false if it cannot deliver.
+  virtual bool Open(const CaptureRequest& request) = 0;
+
+  // Waits up to |timeout_ms| for the next frame.
+  virtual CaptureResult Capture(const CaptureRequest& request, int timeout_ms, SourceFrame* frame) = 0;
+  virtual void Release(SourceFrame* frame) = 0;
+
+  // Called when the capture thread exits; drops per-run state.
+  virtual void Pause() {}
+
+  // Frames lost before Capture() saw them, since Open(), and how many are
+  // waiting. Polled about once a second.
+  virtual uint64_t dropped() { return 0; }
+  virtual int queue_depth() { return 0; }
+
+  virtual SourceStatus status() const { return SourceStatus(); }
+  virtual FrameSyncStats frame_sync_stats() const { return FrameSyncStats(); }
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_FRAME_SOURCE_H_
@@ -0,0 +1,51 @@
+#include "frame_sync.h"
+
+void FrameSyncCounter::Add(int64_t timestamp, int64_t interval) {
+  pulled_.fetch_add(1, std::memory_order_relaxed);
+  if (has_last_) {
+    int64_t delta = timestamp - last_timestamp_;
+    if (delta == 0) {
+      repeated_.fetch_add(1, std::memory_order_relaxed);
+    } else if (interval > 0 && delta > 0) {
+      // Round to whole source frames so timestamp jitter is not counted.
+      int64_t advanced = (delta + interval / 2) / interval;
+      if (advanced > 1) dropped_.fetch_add(static_cast<uint64_t>(advanced - 1), std::memory_order_relaxed);
+    }
+  }
+  has_last_ = true;
+  last_timestamp_ = timestamp;
+}
+
+void FrameSyncCounter::Reset() {
+  has_last_ = false;
+  pulled_ = 0;
+  repeated_ = 0;
+  dropped_ = 0;
+}
+
+FrameSyncStats FrameSyncCounter::stats() const {
+  FrameSyncStats stats;
+  stats.pulled = pulled_.load(std::memory_order_relaxed);
+  stats.repeated = repeated_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void FramePacer::SetRate(int fps) {
+  if (fps == fps_) return;
+  fps_ = fps;
+  started_ = false;
+  period_ = fps > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(1000000000LL / fps))
+                    : Clock::duration::zero();
+}
+
+FramePacer::Clock::time_point FramePacer::Next(Clock::time_point now) {
+  if (!started_) {
+    started_ = true;
+    next_ = now;
+    return next_;
+  }
+  next_ += period_;
+  if (next_ + period_ < now) next_ = now;
+  return next_;
+}
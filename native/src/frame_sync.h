@@ -0,0 +1,61 @@
+#ifndef TRUELAZER_NATIVE_SRC_FRAME_SYNC_H_
+#define TRUELAZER_NATIVE_SRC_FRAME_SYNC_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Helpers for pulling video through an NDI frame-sync on the laser output
+// clock instead of receiving it on the sender's clock.
+
+struct FrameSyncStats {
+  uint64_t pulled = 0;    // frames handed out, one per output tick
+  uint64_t repeated = 0;  // ticks that got the same source frame again
+  uint64_t dropped = 0;   // source frames skipped between two ticks
+};
+
+// Classifies pulled frames by their source timestamps. Written by the
+// capture thread, readable from any thread.
+//
+// When the output rate is below the source rate some frames are skipped on
+// every tick by design; the counters report what happened, not whether it
+// was avoidable.
+class FrameSyncCounter {
+ public:
+  // |timestamp| and |interval| (the source frame duration) share a unit,
+  // e.g. the SDK's 100 ns ticks. An |interval| <= 0 means unknown, in which
+  // case only repeats are detected.
+  void Add(int64_t timestamp, int64_t interval);
+  void Reset();
+  FrameSyncStats stats() const;
+
+ private:
+  bool has_last_ = false;
+  int64_t last_timestamp_ = 0;
+  std::atomic<uint64_t> pulled_{0};
+  std::atomic<uint64_t> repeated_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+// Fixed-rate tick schedule. Ticks stay on a steady grid while the caller
+// keeps up; after a stall the grid restarts at the current time rather than
+// firing a burst of catch-up ticks.
+class FramePacer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Changing the rate restarts the grid.
+  void SetRate(int fps);
+  int rate() const { return fps_; }
+
+  // Returns when the next tick is due, given the current time.
+  Clock::time_point Next(Clock::time_point now);
+
+ private:
+  int fps_ = 0;
+  bool started_ = false;
+  Clock::duration period_{};
+  Clock::time_point next_{};
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_FRAME_SYNC_H_
@@ -0,0 +1,132 @@
+#include "galvo_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "point_optimizer.h"
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+inline bool Blanked(const float* p) { return p[6] > 0.5f; }
+
+// Damping ratio giving |overshoot| on a step response.
+double DampingRatio(double overshoot) {
+  if (!(overshoot > 0.0)) return 1.0;
+  if (overshoot >= 1.0) return 0.0;
+  double log = std::log(overshoot);
+  return -log / std::sqrt(kPi * kPi + log * log);
+}
+
+// Distance from (px, py) to the segment from a to b.
+double SegmentDistance(double px, double py, const float* a, const float* b) {
+  double dx = static_cast<double>(b[0]) - a[0];
+  double dy = static_cast<double>(b[1]) - a[1];
+  double ex = px - a[0];
+  double ey = py - a[1];
+  double squared = dx * dx + dy * dy;
+  if (squared > 0.0) {
+    double t = std::clamp((ex * dx + ey * dy) / squared, 0.0, 1.0);
+    ex -= t * dx;
+    ey -= t * dy;
+  }
+  return std::sqrt(ex * ex + ey * ey);
+}
+
+}  // namespace
+
+GalvoSimulator::GalvoSimulator(const GalvoOptions& options) { Configure(options); }
+
+void GalvoSimulator::Configure(const GalvoOptions& options) {
+  options_ = options;
+  const double omega = 2.0 * kPi * std::max(options.bandwidth_hz, 0.0);
+  omega_squared_ = omega * omega;
+  damping_ = 2.0 * DampingRatio(options.overshoot) * omega;
+  substeps_ = std::clamp(options.substeps, 1, GalvoOptions::kMaxSubsteps);
+  dt_ = options.pps > 0.0 ? 1.0 / (options.pps * substeps_) : 0.0;
+  max_velocity_ = options.max_velocity > 0.0 ? options.max_velocity : HUGE_VAL;
+  max_acceleration_ = options.max_acceleration > 0.0 ? options.max_acceleration : HUGE_VAL;
+}
+
+void GalvoSimulator::Reset(const float* point) {
+  x_ = Axis{point[0], 0.0};
+  y_ = Axis{point[1], 0.0};
+}
+
+// One integration step of |axis| towards |target|.
+inline void GalvoSimulator::Step(Axis* axis, double target) const {
+  double acceleration = omega_squared_ * (target - axis->position) - damping_ * axis->velocity;
+  acceleration = std::clamp(acceleration, -max_acceleration_, max_acceleration_);
+  axis->velocity = std::clamp(axis->velocity + acceleration * dt_, -max_velocity_, max_velocity_);
+  axis->position += axis->velocity * dt_;
+}
+
+void GalvoSimulator::Simulate(const float* points, size_t count, float* out) {
+  for (size_t i = 0; i < count; ++i) {
+    const float* p = points + i * kPointStride;
+    float* o = out + i * kPointStride;
+    const double tx = p[0];
+    const double ty = p[1];
+    // Each step is one long dependency chain; the axes interleave.
+    for (int s = 0; s < substeps_; ++s) {
+      Step(&x_, tx);
+      Step(&y_, ty);
+    }
+    if (o != p) std::memcpy(o + 2, p + 2, (kPointStride - 2) * sizeof(float));
+    o[0] = static_cast<float>(x_.position);
+    o[1] = static_cast<float>(y_.position);
+  }
+}
+
+void TraceScorer::Add(const float* ideal, const float* beam, size_t count) {
+  double heading_x = 0.0;
+  double heading_y = 0.0;
+  for (size_t i = 1; i < count; ++i) {
+    const float* target = ideal + i * kPointStride;
+    const float* from = target - kPointStride;
+    double dx = static_cast<double>(target[0]) - from[0];
+    double dy = static_cast<double>(target[1]) - from[1];
+    double length = std::sqrt(dx * dx + dy * dy);
+    // Held points keep the heading they arrived with.
+    if (length > 0.0) {
+      heading_x = dx / length;
+      heading_y = dy / length;
+    }
+    if (Blanked(target)) continue;
+
+    const float* at = beam + i * kPointStride;
+    double error = SegmentDistance(at[0], at[1], from, target);
+    error_sum_ += error;
+    error_max_ = std::max(error_max_, error);
+    double past = std::max((static_cast<double>(at[0]) - target[0]) * heading_x +
+                               (static_cast<double>(at[1]) - target[1]) * heading_y,
+                           0.0);
+    overshoot_sum_ += past;
+    overshoot_max_ = std::max(overshoot_max_, past);
+    double tx = static_cast<double>(at[0]) - at[-kPointStride];
+    double ty = static_cast<double>(at[1]) - at[1 - kPointStride];
+    double travel = std::sqrt(tx * tx + ty * ty);
+    travel_sum_ += travel;
+    travel_squared_sum_ += travel * travel;
+    ++samples_;
+  }
+}
+
+TraceScore TraceScorer::Result() const {
+  TraceScore score;
+  score.samples = samples_;
+  if (samples_ == 0) return score;
+  const double n = static_cast<double>(samples_);
+  score.path_error = error_sum_ / n;
+  score.max_path_error = error_max_;
+  score.overshoot = overshoot_sum_ / n;
+  score.max_overshoot = overshoot_max_;
+  const double mean = travel_sum_ / n;
+  if (mean > 0.0) {
+    double variance = std::max(travel_squared_sum_ / n - mean * mean, 0.0);
+    score.brightness_variation = std::sqrt(variance) / mean;
+  }
+  return score;
+}
@@ -0,0 +1,107 @@
+#ifndef TRUELAZER_NATIVE_SRC_GALVO_SIMULATOR_H_
+#define TRUELAZER_NATIVE_SRC_GALVO_SIMULATOR_H_
+
+#include <cstddef>
+
+// A pair of scanners, in the -1..1 coordinate space of the renderer's
+// frames. The defaults describe the same 30k scanner as OptimizerOptions,
+// so the optimizer is scored against the model it plans for.
+struct GalvoOptions {
+  double pps = 30000.0;  // DAC rate; each sample is held for 1 / pps
+  // Small-step bandwidth: the natural frequency of the closed loop, which
+  // steps small enough to stay clear of the limits below follow.
+  double bandwidth_hz = 3000.0;
+  // Overshoot of a small step, as a fraction of the step; sets the
+  // damping. 0 is critically damped.
+  double overshoot = 0.05;
+  // Large steps: the mirror cannot move or speed up faster than this,
+  // whatever the loop asks for. 0 leaves either unlimited.
+  double max_velocity = 2400.0;     // units per second
+  double max_acceleration = 2.5e7;  // units per second squared
+  int substeps = 8;                 // integration steps per sample, 1..kMaxSubsteps
+
+  static constexpr int kMaxSubsteps = 256;
+};
+
+// Second-order model of the x and y scanners, each on its own: the DAC
+// holds every sample for one period, the servo pulls the mirror towards it
+// with acceleration
+//
+//   a = w^2 (target - x) - 2 zeta w v,   w = 2 pi bandwidth_hz
+//
+// clamped to max_acceleration, and the velocity to max_velocity. Integrated
+// with semi-implicit Euler. simulateGalvo() in src/utils/galvo.js runs the
+// same model for the preview.
+//
+// Frames use the 8-float layout of point_optimizer.h. The state carries
+// over between Simulate calls, as the scanners do between frames. Not
+// thread-safe.
+class GalvoSimulator {
+ public:
+  explicit GalvoSimulator(const GalvoOptions& options = GalvoOptions());
+
+  void Configure(const GalvoOptions& options);
+  const GalvoOptions& options() const { return options_; }
+
+  // The mirrors at rest, pointing at |point|.
+  void Reset(const float* point);
+
+  // Plays |count| samples and writes where the beam is at the end of each
+  // into |out| (|count| points): the simulated position, with the sample's
+  // z, colour, blanking and last-point flag. |out| may be |points|.
+  void Simulate(const float* points, size_t count, float* out);
+
+ private:
+  struct Axis {
+    double position = 0.0;
+    double velocity = 0.0;
+  };
+
+  void Step(Axis* axis, double target) const;
+
+  GalvoOptions options_;
+  double omega_squared_ = 0.0;
+  double damping_ = 0.0;  // 2 zeta w
+  double dt_ = 0.0;
+  double max_velocity_ = 0.0;
+  double max_acceleration_ = 0.0;
+  int substeps_ = 1;
+  Axis x_;
+  Axis y_;
+};
+
+struct TraceScore {
+  size_t samples = 0;           // visible samples scored
+  double path_error = 0.0;      // mean distance from the line being drawn
+  double max_path_error = 0.0;
+  // How far the beam ran past the commanded point, along the direction the
+  // points were heading: mean (0 for samples it did not pass) and worst.
+  double overshoot = 0.0;
+  double max_overshoot = 0.0;
+  // Coefficient of variation of the distance the beam covers per visible
+  // sample. Lines are brighter where the beam is slower, so 0 is perfectly
+  // even brightness.
+  double brightness_variation = 0.0;
+};
+
+// Scores simulated traces against the samples that produced them, over
+// any number of frames.
+class TraceScorer {
+ public:
+  // |ideal| is the sample stream, |beam| its simulated trace, |count|
+  // points each.
+  void Add(const float* ideal, const float* beam, size_t count);
+  TraceScore Result() const;
+  void Reset() { *this = TraceScorer(); }
+
+ private:
+  size_t samples_ = 0;
+  double error_sum_ = 0.0;
+  double error_max_ = 0.0;
+  double overshoot_sum_ = 0.0;
+  double overshoot_max_ = 0.0;
+  double travel_sum_ = 0.0;
+  double travel_squared_sum_ = 0.0;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_GALVO_SIMULATOR_H_
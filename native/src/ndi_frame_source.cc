@@ -0,0 +1,201 @@
+#include "ndi_frame_source.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+#include "audio_analyzer.h"
+
+NdiFrameSource::NdiFrameSource(const NDIlib_v6* ndi, std::string source_name)
+    : ndi_(ndi), source_name_(std::move(source_name)) {}
+
+NdiFrameSource::~NdiFrameSource() {
+  DestroyRecv();
+}
+
+// Masks and paths only need luma plus the colour of a few pixels, so those
+// modes take UYVY straight from the decoder: half the bytes of BGRA and no
+// full-frame colour conversion. Senders with alpha still deliver BGRA.
+NDIlib_recv_color_format_e NdiFrameSource::ColorFormatFor(const CaptureRequest& request) {
+  return request.accepts_uyvy ? NDIlib_recv_color_format_UYVY_BGRA : NDIlib_recv_color_format_BGRX_BGRA;
+}
+
+bool NdiFrameSource::Open(const CaptureRequest& request) {
+  bool proxy = bandwidth_policy_.Update(request.bandwidth, request.target_width, request.target_height);
+  return CreateRecv(ColorFormatFor(request), proxy);
+}
+
+bool NdiFrameSource::CreateRecv(NDIlib_recv_color_format_e color, bool proxy) {
+  NDIlib_source_t source;
+  source.p_ndi_name = source_name_.c_str();
+
+  NDIlib_recv_create_v3_t recv_create_desc;
+  recv_create_desc.source_to_connect_to = source;
+  recv_create_desc.color_format = color;
+  recv_create_desc.bandwidth = proxy ? NDIlib_recv_bandwidth_lowest : NDIlib_recv_bandwidth_highest;
+  recv_create_desc.allow_video_fields = false;
+
+  recv_ = ndi_->recv_create_v3(&recv_create_desc);
+  sdk_dropped_ = 0;
+  recv_color_ = color;
+  recv_proxy_ = proxy;
+  return recv_ != nullptr;
+}
+
+// The frame-sync is bound to the receiver and must go first.
+void NdiFrameSource::DestroyRecv() {
+  DestroyFrameSync();
+  if (recv_) {
+    SampleDropped();
+    ndi_->recv_destroy(recv_);
+    recv_ = nullptr;
+  }
+}
+
+void NdiFrameSource::DestroyFrameSync() {
+  if (framesync_) {
+    ndi_->framesync_destroy(framesync_);
+    framesync_ = nullptr;
+  }
+}
+
+void NdiFrameSource::Pause() {
+  DestroyFrameSync();
+}
+
+void NdiFrameSource::SampleDropped() {
+  NDIlib_recv_performance_t total;
+  NDIlib_recv_performance_t dropped;
+  ndi_->recv_get_performance(recv_, &total, &dropped);
+  if (dropped.video_frames > sdk_dropped_) {
+    dropped_ += static_cast<uint64_t>(dropped.video_frames - sdk_dropped_);
+    sdk_dropped_ = dropped.video_frames;
+  }
+}
+
+uint64_t NdiFrameSource::dropped() {
+  if (recv_) SampleDropped();
+  return dropped_;
+}
+
+int NdiFrameSource::queue_depth() {
+  if (!recv_) return 0;
+  NDIlib_recv_queue_t queue;
+  ndi_->recv_get_queue(recv_, &queue);
+  return queue.video_frames;
+}
+
+SourceStatus NdiFrameSource::status() const {
+  SourceStatus status;
+  status.uyvy = recv_color_.load() == NDIlib_recv_color_format_UYVY_BGRA;
+  status.proxy = recv_proxy_.load();
+  return status;
+}
+
+void NdiFrameSource::Lend(SourceFrame* frame) {
+  frame->data = video_frame_.p_data;
+  frame->width = video_frame_.xres;
+  frame->height = video_frame_.yres;
+  frame->stride = video_frame_.line_stride_in_bytes;
+  // The formats we ask for only ever deliver UYVY, BGRA or BGRX.
+  frame->layout = video_frame_.FourCC == NDIlib_FourCC_type_UYVY ? PixelLayout::kUyvy : PixelLayout::kBgra;
+  frame->timestamp = video_frame_.timestamp != NDIlib_recv_timestamp_undefined ? video_frame_.timestamp : video_frame_.timecode;
+  frame->frame_rate_n = video_frame_.frame_rate_N;
+  frame->frame_rate_d = video_frame_.frame_rate_D;
+  frame->paced = lent_from_framesync_;
+}
+
+void NdiFrameSource::Analyze(const NDIlib_audio_frame_v2_t& audio_frame, AudioAnalyzer* audio) {
+  int64_t stamp = audio_frame.timestamp != NDIlib_recv_timestamp_undefined ? audio_frame.timestamp : audio_frame.timecode;
+  audio->Process(audio_frame.p_data, audio_frame.no_channels, audio_frame.no_samples,
+                 static_cast<size_t>(audio_frame.channel_stride_in_bytes) / sizeof(float), audio_frame.sample_rate, stamp);
+}
+
+// One tick's worth of audio, resampled by the frame-sync to follow our
+// clock just like the video.
+void NdiFrameSource::PullSyncedAudio(int fps, AudioAnalyzer* audio) {
+  NDIlib_audio_frame_v2_t audio_frame{};
+  // All zeros asks for the incoming format without taking samples.
+  ndi_->framesync_capture_audio(framesync_, &audio_frame, 0, 0, 0);
+  int sample_rate = audio_frame.sample_rate;
+  int channels = audio_frame.no_channels;
+  ndi_->framesync_free_audio(framesync_, &audio_frame);
+  if (sample_rate <= 0 || channels <= 0) return;
+
+  audio_frame = NDIlib_audio_frame_v2_t{};
+  ndi_->framesync_capture_audio(framesync_, &audio_frame, sample_rate, channels, (sample_rate + fps - 1) / fps);
+  if (audio_frame.p_data) Analyze(audio_frame, audio);
+  ndi_->framesync_free_audio(framesync_, &audio_frame);
+}
+
+// One output tick in frame-sync mode. The frame-sync always returns at
+// once, repeating or skipping source frames to follow our clock.
+CaptureResult NdiFrameSource::PullSynced(const CaptureRequest& request, SourceFrame* frame) {
+  if (!framesync_) {
+    framesync_ = ndi_->framesync_create(recv_);
+    frame_sync_counter_.Reset();
+  }
+  pacer_.SetRate(request.frame_sync_fps);
+  std::this_thread::sleep_until(pacer_.Next(FramePacer::Clock::now()));
+  if (request.audio) PullSyncedAudio(request.frame_sync_fps, request.audio);
+
+  ndi_->framesync_capture_video(framesync_, &video_frame_, NDIlib_frame_format_type_progressive);
+  // Nothing has been received yet.
+  if (!video_frame_.p_data) return CaptureResult::kTimeout;
+
+  int64_t stamp = video_frame_.timestamp != NDIlib_recv_timestamp_undefined ? video_frame_.timestamp : video_frame_.timecode;
+  int64_t interval = video_frame_.frame_rate_N > 0
+      ? static_cast<int64_t>(10000000) * video_frame_.frame_rate_D / video_frame_.frame_rate_N
+      : 0;
+  frame_sync_counter_.Add(stamp, interval);
+
+  lent_from_framesync_ = true;
+  Lend(frame);
+  return CaptureResult::kFrame;
+}
+
+CaptureResult NdiFrameSource::Capture(const CaptureRequest& request, int timeout_ms, SourceFrame* frame) {
+  NDIlib_recv_color_format_e color = ColorFormatFor(request);
+  bool proxy = bandwidth_policy_.Update(request.bandwidth, request.target_width, request.target_height);
+  if (recv_ && (color != recv_color_.load() || proxy != recv_proxy_.load())) DestroyRecv();
+  if (!recv_ && !CreateRecv(color, proxy)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    return CaptureResult::kTimeout;
+  }
+
+  if (request.frame_sync_fps > 0) return PullSynced(request, frame);
+  // Once bound to a frame-sync the receiver must not be read directly.
+  DestroyFrameSync();
+
+  // Audio frames interleave with video; analyse them as they come and
+  // keep waiting for the video frame within the same timeout.
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  NDIlib_audio_frame_v2_t audio_frame{};
+  NDIlib_frame_type_e frame_type;
+  for (;;) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    frame_type = ndi_->recv_capture_v2(recv_, &video_frame_, request.audio ? &audio_frame : nullptr, nullptr,
+                                       static_cast<uint32_t>(std::max<int64_t>(left, 0)));
+    if (frame_type != NDIlib_frame_type_audio) break;
+    Analyze(audio_frame, request.audio);
+    ndi_->recv_free_audio_v2(recv_, &audio_frame);
+    if (left <= 0) return CaptureResult::kTimeout;
+  }
+  if (frame_type == NDIlib_frame_type_error) return CaptureResult::kError;
+  if (frame_type != NDIlib_frame_type_video) return CaptureResult::kTimeout;
+
+  if (recv_proxy_.load()) bandwidth_policy_.ObserveProxyFrame(video_frame_.xres, video_frame_.yres);
+  lent_from_framesync_ = false;
+  Lend(frame);
+  return CaptureResult::kFrame;
+}
+
+void NdiFrameSource::Release(SourceFrame* frame) {
+  if (lent_from_framesync_) {
+    ndi_->framesync_free_video(framesync_, &video_frame_);
+  } else {
+    ndi_->recv_free_video_v2(recv_, &video_frame_);
+  }
+  frame->data = nullptr;
+}
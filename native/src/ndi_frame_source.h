@@ -0,0 +1,69 @@
+#ifndef TRUELAZER_NATIVE_SRC_NDI_FRAME_SOURCE_H_
+#define TRUELAZER_NATIVE_SRC_NDI_FRAME_SOURCE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <Processing.NDI.Lib.h>
+
+#include "bandwidth_policy.h"
+#include "frame_source.h"
+#include "frame_sync.h"
+
+// Frames from one NDI sender. Colour format and bandwidth are fixed when an
+// NDI receiver is created, so the source reconnects whenever the request
+// needs a different one. In frame-sync mode it pulls one time-base
+// corrected frame per tick on our clock instead of waiting for the sender.
+class NdiFrameSource : public FrameSource {
+ public:
+  // |ndi| is the loaded runtime; it must outlive the source.
+  NdiFrameSource(const NDIlib_v6* ndi, std::string source_name);
+  ~NdiFrameSource() override;
+  NdiFrameSource(const NdiFrameSource&) = delete;
+  NdiFrameSource& operator=(const NdiFrameSource&) = delete;
+
+  bool Open(const CaptureRequest& request) override;
+  CaptureResult Capture(const CaptureRequest& request, int timeout_ms, SourceFrame* frame) override;
+  void Release(SourceFrame* frame) override;
+  void Pause() override;
+
+  uint64_t dropped() override;
+  int queue_depth() override;
+
+  SourceStatus status() const override;
+  FrameSyncStats frame_sync_stats() const override { return frame_sync_counter_.stats(); }
+
+ private:
+  static NDIlib_recv_color_format_e ColorFormatFor(const CaptureRequest& request);
+  bool CreateRecv(NDIlib_recv_color_format_e color, bool proxy);
+  void DestroyRecv();
+  void DestroyFrameSync();
+  void SampleDropped();
+  CaptureResult PullSynced(const CaptureRequest& request, SourceFrame* frame);
+  void PullSyncedAudio(int fps, AudioAnalyzer* audio);
+  void Analyze(const NDIlib_audio_frame_v2_t& audio_frame, AudioAnalyzer* audio);
+  void Lend(SourceFrame* frame);
+
+  const NDIlib_v6* const ndi_;
+  const std::string source_name_;
+  NDIlib_recv_instance_t recv_ = nullptr;
+  std::atomic<NDIlib_recv_color_format_e> recv_color_{NDIlib_recv_color_format_BGRX_BGRA};
+  std::atomic<bool> recv_proxy_{false};
+  BandwidthPolicy bandwidth_policy_;
+
+  // The frame currently lent out, and who has to free it.
+  NDIlib_video_frame_v2_t video_frame_{};
+  bool lent_from_framesync_ = false;
+
+  NDIlib_framesync_instance_t framesync_ = nullptr;
+  FramePacer pacer_;
+  FrameSyncCounter frame_sync_counter_;
+
+  // The SDK counts drops per receiver instance; carried across reconnects.
+  uint64_t dropped_ = 0;
+  int64_t sdk_dropped_ = 0;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_NDI_FRAME_SOURCE_H_
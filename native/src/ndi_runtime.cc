@@ -0,0 +1,127 @@
+#include "ndi_runtime.h"
+
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace {
+
+using LoadFunction = const NDIlib_v6* (*)();
+
+#ifdef _WIN32
+constexpr char kSeparator = '\\';
+#else
+constexpr char kSeparator = '/';
+#endif
+
+// The directory this addon was loaded from, with a trailing separator.
+std::string ModuleDirectory() {
+  std::string path;
+#ifdef _WIN32
+  HMODULE module = nullptr;
+  if (GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                         reinterpret_cast<LPCSTR>(&LoadNdiRuntime), &module)) {
+    char buffer[MAX_PATH];
+    DWORD length = GetModuleFileNameA(module, buffer, MAX_PATH);
+    if (length > 0 && length < MAX_PATH) path.assign(buffer, length);
+  }
+#else
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(&LoadNdiRuntime), &info) && info.dli_fname) path = info.dli_fname;
+#endif
+  size_t slash = path.find_last_of("/\\");
+  return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+std::vector<std::string> Candidates() {
+  std::vector<std::string> candidates;
+  std::string module_dir = ModuleDirectory();
+  if (!module_dir.empty()) candidates.push_back(module_dir + NDILIB_LIBRARY_NAME);
+  if (const char* redist = std::getenv(NDILIB_REDIST_FOLDER)) {
+    std::string folder = redist;
+    if (!folder.empty()) {
+      if (folder.back() != '/' && folder.back() != '\\') folder += kSeparator;
+      candidates.push_back(folder + NDILIB_LIBRARY_NAME);
+    }
+  }
+  candidates.push_back(NDILIB_LIBRARY_NAME);
+  return candidates;
+}
+
+// Returns the library's load function, or null if |path| does not open or
+// is not an NDI runtime.
+LoadFunction Open(const std::string& path) {
+#ifdef _WIN32
+  HMODULE library = LoadLibraryExA(path.c_str(), nullptr, LOAD_WITH_ALTERED_SEARCH_PATH);
+  if (!library) return nullptr;
+  auto load = reinterpret_cast<LoadFunction>(GetProcAddress(library, "NDIlib_v6_load"));
+  if (!load) FreeLibrary(library);
+#else
+  void* library = dlopen(path.c_str(), RTLD_LOCAL | RTLD_LAZY);
+  if (!library) return nullptr;
+  auto load = reinterpret_cast<LoadFunction>(dlsym(library, "NDIlib_v6_load"));
+  if (!load) dlclose(library);
+#endif
+  return load;
+}
+
+NdiRuntime Load() {
+  NdiRuntime runtime;
+  for (const std::string& path : Candidates()) {
+    LoadFunction load = Open(path);
+    if (!load) continue;
+    runtime.lib = load();
+    if (runtime.lib) {
+      runtime.path = path;
+      return runtime;
+    }
+  }
+  runtime.error = std::string(NDILIB_LIBRARY_NAME) + " not found";
+  std::string url = NDILIB_REDIST_URL;
+  if (!url.empty()) runtime.error += "; the NDI runtime is available from " + url;
+  return runtime;
+}
+
+}  // namespace
+
+const NdiRuntime& LoadNdiRuntime() {
+  static std::once_flag once;
+  static NdiRuntime runtime;
+  std::call_once(once, [] { runtime = Load(); });
+  return runtime;
+}
+
+namespace {
+
+std::mutex& RefsMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+int refs = 0;  // guarded by RefsMutex()
+
+}  // namespace
+
+const NDIlib_v6* AcquireNdi() {
+  const NDIlib_v6* lib = LoadNdiRuntime().lib;
+  if (!lib) return nullptr;
+  std::lock_guard<std::mutex> lock(RefsMutex());
+  if (refs == 0 && !lib->initialize()) return nullptr;
+  ++refs;
+  return lib;
+}
+
+void ReleaseNdi() {
+  const NDIlib_v6* lib = LoadNdiRuntime().lib;
+  std::lock_guard<std::mutex> lock(RefsMutex());
+  if (!lib || refs == 0) return;
+  if (--refs == 0) lib->destroy();
+}
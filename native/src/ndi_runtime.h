@@ -0,0 +1,34 @@
+#ifndef TRUELAZER_NATIVE_SRC_NDI_RUNTIME_H_
+#define TRUELAZER_NATIVE_SRC_NDI_RUNTIME_H_
+
+#include <string>
+
+#include <Processing.NDI.Lib.h>
+
+// The NDI runtime, loaded through the SDK's dynamic-load table instead of
+// being linked. The addon then starts on machines without NDI installed,
+// and machines with it only pay for the load once NDI is actually used.
+struct NdiRuntime {
+  const NDIlib_v6* lib = nullptr;  // null when the runtime is unavailable
+  std::string path;                // the library that was loaded
+  std::string error;               // why it is unavailable
+};
+
+// Loads the runtime on the first call and returns the same result on every
+// later one. Safe to call from any thread. The library is never unloaded.
+//
+// Looks next to the addon first (where the build copies the redistributable
+// on Windows), then in the folder named by NDI_RUNTIME_DIR_V6, then on the
+// system search path.
+const NdiRuntime& LoadNdiRuntime();
+
+// NDIlib_initialize and NDIlib_destroy are process-wide, while the addon may
+// be loaded by several Node environments (worker threads) and instantiated
+// more than once in each. Every user acquires the library and releases it
+// when done; the first acquire initialises it and the last release destroys
+// it. AcquireNdi returns null, without taking a reference, when the runtime
+// is unavailable or fails to initialise. Both are safe from any thread.
+const NDIlib_v6* AcquireNdi();
+void ReleaseNdi();
+
+#endif  // TRUELAZER_NATIVE_SRC_NDI_RUNTIME_H_
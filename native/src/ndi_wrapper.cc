@@ -2,166 +2,398 @@
 #include <Processing.NDI.Lib.h>
 #include <vector>
 #include <string>
-#include <thread>
+#include <map>
 #include <mutex>
 #include <atomic>
-#include <condition_variable>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
 #include <iostream>
+#include <memory>
+
+#include "effects_engine.h"
+#include "frame_analysis.h"
+#include "frame_pool.h"
+#include "frame_scaler.h"
+#include "frame_receiver.h"
+#include "galvo_simulator.h"
+#include "ndi_frame_source.h"
+#include "ndi_runtime.h"
+#include "path_planner.h"
+#include "point_optimizer.h"
+#include "row_pool.h"
+#include "shared_frame_ring.h"
+#include "source_discovery.h"
+#include "synthetic_frame_source.h"
+
+namespace {
+
+Napi::Object HistogramToObject(Napi::Env env, const HistogramSnapshot& histogram) {
+  Napi::Object obj = Napi::Object::New(env);
+  obj.Set("count", Napi::Number::New(env, static_cast<double>(histogram.count)));
+  obj.Set("mean", Napi::Number::New(env, histogram.mean()));
+  obj.Set("max", Napi::Number::New(env, static_cast<double>(histogram.max)));
+  obj.Set("p50", Napi::Number::New(env, static_cast<double>(histogram.Percentile(50))));
+  obj.Set("p90", Napi::Number::New(env, static_cast<double>(histogram.Percentile(90))));
+  obj.Set("p99", Napi::Number::New(env, static_cast<double>(histogram.Percentile(99))));
+  // Trailing empty buckets are left out; bucket i > 0 covers [2^(i-1), 2^i).
+  int used = HistogramSnapshot::kBuckets;
+  while (used > 0 && histogram.buckets[used - 1] == 0) --used;
+  Napi::Array buckets = Napi::Array::New(env, used);
+  for (int i = 0; i < used; ++i) {
+    buckets.Set(static_cast<uint32_t>(i), Napi::Number::New(env, static_cast<double>(histogram.buckets[i])));
+  }
+  obj.Set("buckets", buckets);
+  return obj;
+}
+
+Napi::Array SourcesToArray(Napi::Env env, const std::vector<NdiSourceInfo>& sources) {
+  Napi::Array result = Napi::Array::New(env, sources.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("name", Napi::String::New(env, sources[i].name));
+    obj.Set("urlAddress", Napi::String::New(env, sources[i].url));
+    result.Set(static_cast<uint32_t>(i), obj);
+  }
+  return result;
+}
+
+// Resolves findSources() once discovery has something to report, waiting
+// on a libuv worker so the JS thread never blocks on the network.
+class FindSourcesWorker : public Napi::AsyncWorker {
+ public:
+  FindSourcesWorker(Napi::Env env, std::shared_ptr<SourceDiscovery> discovery, int timeout_ms)
+      : Napi::AsyncWorker(env, "NdiFindSources"),
+        deferred_(Napi::Promise::Deferred::New(env)),
+        discovery_(std::move(discovery)),
+        timeout_ms_(timeout_ms) {}
+
+  Napi::Promise promise() const { return deferred_.Promise(); }
+
+  void Execute() override {
+    if (discovery_) sources_ = discovery_->WaitForFirstScan(timeout_ms_);
+  }
+  void OnOK() override { deferred_.Resolve(SourcesToArray(Env(), sources_)); }
+  void OnError(const Napi::Error& error) override { deferred_.Reject(error.Value()); }
+
+ private:
+  Napi::Promise::Deferred deferred_;
+  std::shared_ptr<SourceDiscovery> discovery_;
+  int timeout_ms_;
+  std::vector<NdiSourceInfo> sources_;
+};
+
+}  // namespace
 
 class NdiWrapper : public Napi::ObjectWrap<NdiWrapper> {
  public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "NdiWrapper", {
       InstanceMethod("initialize", &NdiWrapper::Initialize),
+      InstanceMethod("getCapabilities", &NdiWrapper::GetCapabilities),
       InstanceMethod("findSources", &NdiWrapper::FindSources),
+      InstanceMethod("getSources", &NdiWrapper::GetSources),
+      InstanceMethod("onSourcesChanged", &NdiWrapper::OnSourcesChanged),
+      InstanceMethod("offSourcesChanged", &NdiWrapper::OffSourcesChanged),
       InstanceMethod("createReceiver", &NdiWrapper::CreateReceiver),
       InstanceMethod("captureVideo", &NdiWrapper::CaptureVideo),
+      InstanceMethod("onFrame", &NdiWrapper::OnFrame),
+      InstanceMethod("offFrame", &NdiWrapper::OffFrame),
+      InstanceMethod("frameDone", &NdiWrapper::FrameDone),
       InstanceMethod("destroyReceiver", &NdiWrapper::DestroyReceiver),
+      InstanceMethod("getReceivers", &NdiWrapper::GetReceivers),
       InstanceMethod("startCapture", &NdiWrapper::StartCapture),
-      InstanceMethod("stopCapture", &NdiWrapper::StopCapture)
+      InstanceMethod("stopCapture", &NdiWrapper::StopCapture),
+      InstanceMethod("getFramePoolStats", &NdiWrapper::GetFramePoolStats),
+      InstanceMethod("getFrameSyncStats", &NdiWrapper::GetFrameSyncStats),
+      InstanceMethod("getScalerInfo", &NdiWrapper::GetScalerInfo),
+      InstanceMethod("getStats", &NdiWrapper::GetStats),
+      InstanceMethod("getAudio", &NdiWrapper::GetAudio),
+      InstanceMethod("resetStats", &NdiWrapper::ResetStats)
     });
 
-    Napi::FunctionReference* constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
-    env.SetInstanceData(constructor);
-
     exports.Set("NdiWrapper", func);
     return exports;
   }
 
   NdiWrapper(const Napi::CallbackInfo& info) : Napi::ObjectWrap<NdiWrapper>(info) {
-    p_find_ = nullptr;
-    p_recv_ = nullptr;
-    stop_thread_ = true;
-    
-    write_idx_ = 0;
-    read_idx_ = -1;
-    new_frame_available_ = false;
-    
-    frame_width_ = 0;
-    frame_height_ = 0;
-    target_width_ = 480;
-    target_height_ = 480;
-
-    for (int i = 0; i < 3; ++i) {
-      buffers_[i].reserve(1920 * 1080 * 4);
-    }
+    max_in_flight_ = 1;
+    ack_timeout_ms_ = kDefaultAckTimeoutMs;
   }
 
   ~NdiWrapper() {
-    StopCaptureInternal();
-    if (p_find_) NDIlib_find_destroy(p_find_);
-    if (p_recv_) NDIlib_recv_destroy(p_recv_);
-    NDIlib_destroy();
+    // Stopped first: its thread calls into sources_callback_. Pending
+    // findSources() workers keep their own reference and resolve with the
+    // cached list.
+    if (discovery_) discovery_->Stop();
+    {
+      std::lock_guard<std::mutex> lock(sources_mutex_);
+      if (sources_callback_) sources_callback_.Abort();
+    }
+    for (auto& it : receivers_) it.second->receiver->Stop();
+    {
+      // Only reachable during environment teardown: a live subscription
+      // holds a strong reference to this object.
+      std::lock_guard<std::mutex> lock(subscription_mutex_);
+      if (subscription_) {
+        subscription_->owner = nullptr;
+        subscription_->callback.Abort();
+        subscription_ = nullptr;
+      }
+    }
+    receivers_.clear();
+    discovery_.reset();
+    // Other instances, here or in other worker threads, may still use NDI.
+    if (ndi_) ReleaseNdi();
   }
 
  private:
-  NDIlib_find_instance_t p_find_;
-  NDIlib_recv_instance_t p_recv_;
-
-  std::thread capture_thread_;
-  std::atomic<bool> stop_thread_;
-  
-  std::mutex buffer_mutex_;
-  std::vector<uint8_t> buffers_[3];
-  int write_idx_;
-  std::atomic<int> read_idx_;
-  std::atomic<bool> new_frame_available_;
-  
-  int frame_width_;
-  int frame_height_;
-  std::atomic<int> target_width_;
-  std::atomic<int> target_height_;
-
-  void StopCaptureInternal() {
-    stop_thread_ = true;
-    if (capture_thread_.joinable()) {
-      capture_thread_.join();
-    }
-  }
-
-  void CaptureLoop() {
-    while (!stop_thread_) {
-      if (!p_recv_) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        continue;
-      }
-
-      NDIlib_video_frame_v2_t video_frame;
-      NDIlib_frame_type_e frame_type = NDIlib_recv_capture_v2(p_recv_, &video_frame, nullptr, nullptr, 100);
-
-      if (frame_type == NDIlib_frame_type_video) {
-        int tw = target_width_.load();
-        int th = target_height_.load();
-
-        int next_write_idx = (write_idx_ + 1) % 3;
-        if (next_write_idx == read_idx_.load()) {
-          next_write_idx = (next_write_idx + 1) % 3;
-        }
+  // The NDI runtime is loaded and initialised on the first call that needs
+  // it, so startup never touches it and machines without it still get
+  // synthetic sources. Null until then, and for good if it is missing.
+  // Each instance holds one reference on the process-wide initialisation.
+  const NDIlib_v6* ndi_ = nullptr;
 
-        {
-          std::lock_guard<std::mutex> lock(buffer_mutex_);
-          std::vector<uint8_t>& current_buffer = buffers_[next_write_idx];
-          
-          if (tw > 0 && th > 0 && (video_frame.xres != tw || video_frame.yres != th)) {
-            current_buffer.resize(tw * th * 4);
-            float scale_x = static_cast<float>(video_frame.xres) / tw;
-            float scale_y = static_cast<float>(video_frame.yres) / th;
-
-            uint32_t* dst_ptr = reinterpret_cast<uint32_t*>(current_buffer.data());
-            const uint8_t* src_data = video_frame.p_data;
-            int line_stride = video_frame.line_stride_in_bytes;
-
-            for (int y = 0; y < th; ++y) {
-              const uint32_t* src_row = reinterpret_cast<const uint32_t*>(src_data + static_cast<int>(y * scale_y) * line_stride);
-              for (int x = 0; x < tw; ++x) {
-                dst_ptr[y * tw + x] = src_row[static_cast<int>(x * scale_x)];
-              }
-            }
-            frame_width_ = tw;
-            frame_height_ = th;
-          } else {
-            size_t size = video_frame.xres * video_frame.yres * 4;
-            current_buffer.assign(video_frame.p_data, video_frame.p_data + size);
-            frame_width_ = video_frame.xres;
-            frame_height_ = video_frame.yres;
-          }
-          
-          write_idx_ = next_write_idx;
-          read_idx_.store(next_write_idx);
-          new_frame_available_ = true;
-        }
+  const NDIlib_v6* Ndi() {
+    if (!ndi_) ndi_ = AcquireNdi();
+    return ndi_;
+  }
 
-        NDIlib_recv_free_video_v2(p_recv_, &video_frame);
-      } else if (frame_type == NDIlib_frame_type_error) {
-        break;
-      }
+  // Source discovery runs from the first source query on, and keeps the
+  // list warm from then. Changes are pushed through sources_callback_.
+  static constexpr int kDefaultFindTimeoutMs = 1000;
+  std::shared_ptr<SourceDiscovery> discovery_;
+  std::mutex sources_mutex_;
+  Napi::ThreadSafeFunction sources_callback_;  // guarded by sources_mutex_
+
+  // Leaves discovery_ null when NDI is unavailable.
+  void EnsureDiscovery() {
+    if (discovery_ || !Ndi()) return;
+    discovery_ = std::make_shared<SourceDiscovery>(ndi_);
+    discovery_->set_on_change([this](const std::vector<NdiSourceInfo>& sources) { NotifySourcesChanged(sources); });
+    discovery_->Start();
+  }
+
+  // Runs on the discovery thread.
+  void NotifySourcesChanged(const std::vector<NdiSourceInfo>& sources) {
+    std::lock_guard<std::mutex> lock(sources_mutex_);
+    if (!sources_callback_) return;
+    auto list = std::make_shared<std::vector<NdiSourceInfo>>(sources);
+    sources_callback_.NonBlockingCall([list](Napi::Env env, Napi::Function callback) {
+      callback.Call({SourcesToArray(env, *list)});
+    });
+  }
+
+  // One receiver per NDI source, shared by every caller that asked for it.
+  // Delivery bookkeeping lives next to the receiver so a slow consumer of
+  // one source never holds back another.
+  struct ReceiverEntry {
+    int refs = 0;
+    std::atomic<int> in_flight{0};
+    std::atomic<int64_t> last_push_ms{0};
+    std::unique_ptr<FrameReceiver> receiver;
+    // Pooled mode: the ArrayBuffers the capture thread writes frames into,
+    // by the id the frame pool knows them by, and the slabs over them that
+    // JS holds, oldest first. See CapturePooledVideo().
+    std::map<int, Napi::Reference<Napi::ArrayBuffer>> buffers;
+    std::deque<FrameSlab*> lent;
+    size_t buffer_bytes = 0;
+    int next_buffer = 0;
+
+    ~ReceiverEntry() {
+      // The capture thread goes first; it may be writing a slab.
+      receiver.reset();
+      for (FrameSlab* slab : lent) slab->lease->Release(slab);
     }
+  };
+  // Touched only on the JS thread. Entries are stable in memory, so capture
+  // threads may keep a pointer to theirs until the receiver is stopped.
+  std::map<std::string, std::unique_ptr<ReceiverEntry>> receivers_;
+
+  ReceiverEntry* FindEntry(const std::string& source) {
+    auto it = receivers_.find(source);
+    return it == receivers_.end() ? nullptr : it->second.get();
   }
 
+  // An optional leading source-name argument selects one receiver; without
+  // it a call applies to every receiver. Returns the index of the first
+  // argument after the name.
+  size_t SelectReceivers(const Napi::CallbackInfo& info, std::vector<ReceiverEntry*>* targets) {
+    if (info.Length() >= 1 && info[0].IsString()) {
+      ReceiverEntry* entry = FindEntry(info[0].As<Napi::String>().Utf8Value());
+      if (entry) targets->push_back(entry);
+      return 1;
+    }
+    for (auto& it : receivers_) targets->push_back(it.second.get());
+    return 0;
+  }
+
+  // Push delivery (onFrame). After each published frame a receiver's capture
+  // thread schedules one call into JS, but only while fewer than
+  // max_in_flight_ of its frames are unacknowledged. Frames arriving in the
+  // meantime just replace the pending one, so a slow consumer always gets
+  // the newest frame and the backlog never grows.
+  struct Subscription {
+    NdiWrapper* owner;
+    Napi::ThreadSafeFunction callback;
+  };
+  static constexpr int kDefaultAckTimeoutMs = 200;
+  std::mutex subscription_mutex_;
+  Subscription* subscription_ = nullptr;  // guarded by subscription_mutex_
+  std::atomic<int> max_in_flight_;
+  // A consumer that stops acknowledging (reloaded renderer, throwing
+  // handler) must not stall the stream; its frames expire after this long.
+  std::atomic<int> ack_timeout_ms_;
+
+  static int64_t NowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Called by the capture threads after publishing and by frameDone().
+  void PushFrame(ReceiverEntry* entry) {
+    std::lock_guard<std::mutex> lock(subscription_mutex_);
+    if (!subscription_) return;
+
+    int64_t now = NowMs();
+    if (entry->in_flight.load() >= max_in_flight_.load()) {
+      if (now - entry->last_push_ms.load() < ack_timeout_ms_.load()) return;
+      entry->in_flight = 0;
+    }
+    ++entry->in_flight;
+    entry->last_push_ms = now;
+
+    Subscription* sub = subscription_;
+    const std::string& source = entry->receiver->source_name();
+    sub->callback.NonBlockingCall([sub, source](Napi::Env env, Napi::Function callback) {
+      if (sub->owner) sub->owner->DeliverFrame(env, callback, sub, source);
+    });
+  }
+
+  void DeliverFrame(Napi::Env env, Napi::Function callback, Subscription* sub, const std::string& source) {
+    // Calls queued before a resubscribe belong to the old callback; the
+    // in-flight counts were reset when it was replaced. Calls for a
+    // destroyed receiver have nothing left to deliver.
+    if (sub != subscription_) return;
+    ReceiverEntry* entry = FindEntry(source);
+    if (!entry) return;
+
+    Napi::Value frame = TakeFrame(env, entry);
+    if (frame.IsNull()) {
+      // Another call already took it; nothing to acknowledge.
+      ReleaseInFlight(entry);
+      return;
+    }
+    callback.Call({frame});
+  }
+
+  static void ReleaseInFlight(ReceiverEntry* entry) {
+    int n = entry->in_flight.load();
+    while (n > 0 && !entry->in_flight.compare_exchange_weak(n, n - 1)) {
+    }
+  }
+
+  static void FinalizeSubscription(Napi::Env, Subscription* sub) {
+    if (sub->owner) sub->owner->Unref();
+    delete sub;
+  }
+
+  void Unsubscribe() {
+    Subscription* sub;
+    {
+      std::lock_guard<std::mutex> lock(subscription_mutex_);
+      sub = subscription_;
+      subscription_ = nullptr;
+    }
+    // Queued calls still drain; FinalizeSubscription runs after them.
+    if (sub) sub->callback.Release();
+    for (auto& it : receivers_) it.second->in_flight = 0;
+  }
+
+  // initialize(): loads NDI and starts discovery now rather than on first
+  // use. Returns false if NDI is unavailable.
   Napi::Value Initialize(const Napi::CallbackInfo& info) {
-    bool success = NDIlib_initialize();
-    return Napi::Boolean::New(info.Env(), success);
+    EnsureDiscovery();
+    return Napi::Boolean::New(info.Env(), ndi_ != nullptr);
+  }
+
+  // getCapabilities(): {ndi, ndiVersion, ndiLibrary, ndiError}. Loads the
+  // runtime if nothing has yet; synthetic sources are always available.
+  Napi::Value GetCapabilities(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const NdiRuntime& runtime = LoadNdiRuntime();
+    bool available = Ndi() != nullptr;
+    Napi::Object caps = Napi::Object::New(env);
+    caps.Set("ndi", Napi::Boolean::New(env, available));
+    caps.Set("ndiVersion", available ? Napi::Value(Napi::String::New(env, ndi_->version())) : env.Null());
+    caps.Set("ndiLibrary", available ? Napi::Value(Napi::String::New(env, runtime.path)) : env.Null());
+    std::string error = runtime.error;
+    if (runtime.lib && !available) error = "NDI is not supported on this CPU";
+    caps.Set("ndiError", error.empty() ? env.Null() : Napi::Value(Napi::String::New(env, error)));
+    caps.Set("synthetic", Napi::Boolean::New(env, true));
+    return caps;
   }
 
+  // findSources([{timeoutMs}]): a promise for the source list. The first
+  // call waits up to timeoutMs for discovery to settle; later calls resolve
+  // with the cached list at once. Resolves with [] without NDI.
   Napi::Value FindSources(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    if (!p_find_) {
-      p_find_ = NDIlib_find_create_v2();
+    int timeout_ms = kDefaultFindTimeoutMs;
+    if (info.Length() >= 1 && info[0].IsObject()) {
+      Napi::Value value = info[0].As<Napi::Object>().Get("timeoutMs");
+      if (value.IsNumber()) timeout_ms = value.As<Napi::Number>().Int32Value();
     }
+    if (timeout_ms < 0) {
+      Napi::RangeError::New(env, "timeoutMs must not be negative").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    EnsureDiscovery();
+    FindSourcesWorker* worker = new FindSourcesWorker(env, discovery_, timeout_ms);
+    Napi::Promise promise = worker->promise();
+    worker->Queue();
+    return promise;
+  }
 
-    uint32_t num_sources = 0;
-    const NDIlib_source_t* p_sources = NDIlib_find_get_current_sources(p_find_, &num_sources);
+  // getSources(): the cached list, without waiting.
+  Napi::Value GetSources(const Napi::CallbackInfo& info) {
+    EnsureDiscovery();
+    return SourcesToArray(info.Env(), discovery_ ? discovery_->sources() : std::vector<NdiSourceInfo>());
+  }
 
-    Napi::Array result = Napi::Array::New(env, num_sources);
-    for (uint32_t i = 0; i < num_sources; ++i) {
-      Napi::Object obj = Napi::Object::New(env);
-      obj.Set("name", Napi::String::New(env, p_sources[i].p_ndi_name));
-      result.Set(i, obj);
+  // onSourcesChanged(callback): calls callback(sources) whenever a source
+  // appears, disappears or changes address. Replaces any earlier callback.
+  // Does not keep the process alive, and does not start discovery.
+  Napi::Value OnSourcesChanged(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+      Napi::TypeError::New(env, "Function callback expected").ThrowAsJavaScriptException();
+      return env.Null();
     }
-    return result;
+    Napi::ThreadSafeFunction callback = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "NdiSources", 0, 1);
+    callback.Unref(env);
+    {
+      std::lock_guard<std::mutex> lock(sources_mutex_);
+      if (sources_callback_) sources_callback_.Release();
+      sources_callback_ = callback;
+    }
+    return env.Undefined();
   }
 
+  Napi::Value OffSourcesChanged(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(sources_mutex_);
+    if (sources_callback_) {
+      sources_callback_.Release();
+      sources_callback_ = Napi::ThreadSafeFunction();
+    }
+    return info.Env().Undefined();
+  }
+
+  // createReceiver(sourceName): connects to |sourceName|, or adds a
+  // reference if a receiver for it already exists. Every successful call
+  // must be paired with destroyReceiver(sourceName).
   Napi::Value CreateReceiver(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     if (info.Length() < 1 || !info[0].IsString()) {
@@ -170,82 +402,1148 @@ class NdiWrapper : public Napi::ObjectWrap<NdiWrapper> {
     }
 
     std::string source_name = info[0].As<Napi::String>().Utf8Value();
+    if (ReceiverEntry* existing = FindEntry(source_name)) {
+      ++existing->refs;
+      return Napi::Boolean::New(env, true);
+    }
 
-    StopCaptureInternal();
-
-    if (p_recv_) {
-      NDIlib_recv_destroy(p_recv_);
-      p_recv_ = nullptr;
+    // "synthetic:..." names a generated or replayed source instead of an
+    // NDI sender; see synthetic_frame_source.h.
+    std::unique_ptr<FrameSource> source;
+    if (IsSyntheticSourceName(source_name)) {
+      SyntheticOptions options;
+      std::string error;
+      if (!ParseSyntheticSourceName(source_name, &options, &error)) {
+        Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      source = std::make_unique<SyntheticFrameSource>(options);
+    } else {
+      if (!Ndi()) return Napi::Boolean::New(env, false);
+      source = std::make_unique<NdiFrameSource>(ndi_, source_name);
     }
 
-    NDIlib_source_t source;
-    source.p_ndi_name = source_name.c_str();
+    auto entry = std::make_unique<ReceiverEntry>();
+    entry->receiver = std::make_unique<FrameReceiver>(source_name, std::move(source));
+    if (!entry->receiver->Connect()) return Napi::Boolean::New(env, false);
 
-    NDIlib_recv_create_v3_t recv_create_desc;
-    recv_create_desc.source_to_connect_to = source;
-    recv_create_desc.color_format = NDIlib_recv_color_format_BGRX_BGRA;
-    recv_create_desc.bandwidth = NDIlib_recv_bandwidth_highest;
-    recv_create_desc.allow_video_fields = false;
+    ReceiverEntry* raw = entry.get();
+    entry->receiver->set_on_frame([this, raw]() { PushFrame(raw); });
+    entry->refs = 1;
+    receivers_.emplace(source_name, std::move(entry));
+    return Napi::Boolean::New(env, true);
+  }
 
-    p_recv_ = NDIlib_recv_create_v3(&recv_create_desc);
-    
-    return Napi::Boolean::New(env, p_recv_ != nullptr);
+  // destroyReceiver(sourceName) drops one reference and disconnects once
+  // the last one is gone; destroyReceiver() disconnects everything.
+  Napi::Value DestroyReceiver(const Napi::CallbackInfo& info) {
+    if (info.Length() >= 1 && info[0].IsString()) {
+      auto it = receivers_.find(info[0].As<Napi::String>().Utf8Value());
+      if (it != receivers_.end() && --it->second->refs <= 0) {
+        it->second->receiver->Stop();
+        receivers_.erase(it);
+      }
+    } else {
+      for (auto& it : receivers_) it.second->receiver->Stop();
+      receivers_.clear();
+    }
+    return info.Env().Undefined();
   }
 
+  Napi::Value GetReceivers(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Array result = Napi::Array::New(env, receivers_.size());
+    uint32_t i = 0;
+    for (auto& it : receivers_) {
+      Napi::Object obj = Napi::Object::New(env);
+      obj.Set("source", Napi::String::New(env, it.first));
+      obj.Set("refs", Napi::Number::New(env, it.second->refs));
+      obj.Set("running", Napi::Boolean::New(env, it.second->receiver->running()));
+      result.Set(i++, obj);
+    }
+    return result;
+  }
+
+  // startCapture([sourceName,] width, height, options)
   Napi::Value StartCapture(const Napi::CallbackInfo& info) {
-    if (!p_recv_) return Napi::Boolean::New(info.Env(), false);
-    
-    if (info.Length() >= 2 && info[0].IsNumber() && info[1].IsNumber()) {
-      target_width_ = info[0].As<Napi::Number>().Int32Value();
-      target_height_ = info[1].As<Napi::Number>().Int32Value();
+    Napi::Env env = info.Env();
+    std::vector<ReceiverEntry*> targets;
+    size_t arg = SelectReceivers(info, &targets);
+    if (targets.empty()) return Napi::Boolean::New(env, false);
+
+    if (info.Length() >= arg + 2 && info[arg].IsNumber() && info[arg + 1].IsNumber()) {
+      int width = info[arg].As<Napi::Number>().Int32Value();
+      int height = info[arg + 1].As<Napi::Number>().Int32Value();
+      for (ReceiverEntry* entry : targets) entry->receiver->SetTargetSize(width, height);
+    }
+
+    if (info.Length() >= arg + 3 && info[arg + 2].IsObject()) {
+      Napi::Object options = info[arg + 2].As<Napi::Object>();
+      if (options.Has("pooled")) {
+        bool pooled = options.Get("pooled").ToBoolean().Value();
+        for (ReceiverEntry* entry : targets) {
+          entry->receiver->SetPooled(pooled);
+          if (!pooled) DropBuffers(entry);
+        }
+      }
+      if (options.Has("sharedMemory")) {
+        // Frames then carry {shared: {ring, slot, sequence, size}} instead
+        // of data, for a SharedFrameReader in another process.
+        bool shared = options.Get("sharedMemory").ToBoolean().Value();
+        for (ReceiverEntry* entry : targets) entry->receiver->SetShared(shared);
+      }
+      if (options.Has("filter")) {
+        ScaleFilter filter;
+        Napi::Value value = options.Get("filter");
+        if (!value.IsString() || !ParseScaleFilter(value.As<Napi::String>().Utf8Value(), &filter)) {
+          Napi::TypeError::New(env, "filter must be 'nearest', 'box' or 'bilinear'").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        for (ReceiverEntry* entry : targets) entry->receiver->SetFilter(filter);
+      }
+      if (options.Has("bandwidth")) {
+        RecvBandwidth bandwidth;
+        Napi::Value value = options.Get("bandwidth");
+        if (!value.IsString() || !ParseRecvBandwidth(value.As<Napi::String>().Utf8Value(), &bandwidth)) {
+          Napi::TypeError::New(env, "bandwidth must be 'auto', 'highest' or 'lowest'").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        for (ReceiverEntry* entry : targets) entry->receiver->SetBandwidth(bandwidth);
+      }
+      if (options.Has("crop")) {
+        // {x, y, width, height} in fractions of the source frame, applied
+        // before scaling; null for the whole frame.
+        CropRect crop;
+        Napi::Value value = options.Get("crop");
+        if (value.IsObject()) {
+          Napi::Object rect = value.As<Napi::Object>();
+          float* fields[] = {&crop.x, &crop.y, &crop.width, &crop.height};
+          const char* names[] = {"x", "y", "width", "height"};
+          for (int i = 0; i < 4; ++i) {
+            Napi::Value field = rect.Get(names[i]);
+            if (field.IsNumber()) *fields[i] = field.As<Napi::Number>().FloatValue();
+          }
+          if (!(crop.x >= 0.0f && crop.y >= 0.0f && crop.width > 0.0f && crop.height > 0.0f &&
+                crop.x + crop.width <= 1.0f && crop.y + crop.height <= 1.0f)) {
+            Napi::RangeError::New(env, "crop must lie within the source frame, in fractions of its size").ThrowAsJavaScriptException();
+            return env.Null();
+          }
+        } else if (!value.IsNull() && !value.IsUndefined() && value.ToBoolean().Value()) {
+          Napi::TypeError::New(env, "crop must be an object or null").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        for (ReceiverEntry* entry : targets) entry->receiver->SetCrop(crop);
+      }
+      if (options.Has("analysis")) {
+        FrameAnalysis analysis;
+        Napi::Value value = options.Get("analysis");
+        if (!value.IsString() || !ParseFrameAnalysis(value.As<Napi::String>().Utf8Value(), &analysis)) {
+          Napi::TypeError::New(env, "analysis must be 'none', 'luma' or 'edges'").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        for (ReceiverEntry* entry : targets) entry->receiver->SetAnalysis(analysis);
+      }
+      if (options.Has("frameSync")) {
+        // Output rate in frames per second; false or 0 for push capture.
+        Napi::Value value = options.Get("frameSync");
+        int fps = value.IsNumber() ? value.As<Napi::Number>().Int32Value() : 0;
+        if (fps < 0) {
+          Napi::RangeError::New(env, "frameSync must be a frame rate or false").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        for (ReceiverEntry* entry : targets) entry->receiver->SetFrameSync(fps);
+      }
+      if (options.Has("changeThreshold")) {
+        // Mean per-byte difference that marks a tile as changed; false
+        // turns static-content detection off.
+        Napi::Value value = options.Get("changeThreshold");
+        int threshold = value.IsNumber() ? value.As<Napi::Number>().Int32Value() : -1;
+        if (value.IsNumber() && threshold < 0) {
+          Napi::RangeError::New(env, "changeThreshold must not be negative").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        for (ReceiverEntry* entry : targets) entry->receiver->SetChangeThreshold(threshold);
+      }
+      if (options.Has("threads")) {
+        // Threads that split each frame's rows, the capture thread
+        // included; 0 picks a default from the core count.
+        Napi::Value value = options.Get("threads");
+        int threads = value.IsNumber() ? value.As<Napi::Number>().Int32Value() : -1;
+        if (threads < 0) {
+          Napi::RangeError::New(env, "threads must be a non-negative integer").ThrowAsJavaScriptException();
+          return env.Null();
+        }
+        for (ReceiverEntry* entry : targets) entry->receiver->SetThreads(threads);
+      }
+      if (options.Has("threshold") && options.Get("threshold").IsNumber()) {
+        int threshold = options.Get("threshold").As<Napi::Number>().Int32Value();
+        for (ReceiverEntry* entry : targets) entry->receiver->SetThreshold(threshold);
+      }
+      if (options.Has("trace")) {
+        Napi::Value trace = options.Get("trace");
+        bool enabled = trace.IsObject() || trace.ToBoolean().Value();
+        for (ReceiverEntry* entry : targets) entry->receiver->SetTrace(enabled);
+        if (trace.IsObject()) {
+          Napi::Object trace_options = trace.As<Napi::Object>();
+          for (ReceiverEntry* entry : targets) {
+            if (trace_options.Get("maxPoints").IsNumber()) {
+              entry->receiver->SetTraceMaxPoints(trace_options.Get("maxPoints").As<Napi::Number>().Int32Value());
+            }
+            if (trace_options.Get("epsilon").IsNumber()) {
+              entry->receiver->SetTraceEpsilon(trace_options.Get("epsilon").As<Napi::Number>().FloatValue());
+            }
+            if (trace_options.Get("minLength").IsNumber()) {
+              entry->receiver->SetTraceMinLength(trace_options.Get("minLength").As<Napi::Number>().Int32Value());
+            }
+          }
+        }
+      }
+      if (options.Has("audio")) {
+        // true or {fftSize, smoothing, lowRange, midRange, highRange, peak}
+        // to analyse the source's audio; false to ignore it.
+        Napi::Value audio = options.Get("audio");
+        AudioOptions audio_options;
+        if (audio.IsObject() && !ParseAudioOptions(env, audio.As<Napi::Object>(), &audio_options)) return env.Null();
+        bool enabled = audio.IsObject() || audio.ToBoolean().Value();
+        for (ReceiverEntry* entry : targets) {
+          if (enabled) entry->receiver->SetAudioOptions(audio_options);
+          entry->receiver->SetAudio(enabled);
+        }
+      }
     }
 
-    if (stop_thread_) {
-      stop_thread_ = false;
-      capture_thread_ = std::thread(&NdiWrapper::CaptureLoop, this);
+    for (ReceiverEntry* entry : targets) entry->receiver->Start();
+    return Napi::Boolean::New(env, true);
+  }
+
+  // Fills |options| from a startCapture audio object; throws and returns
+  // false on bad values. Missing fields keep their defaults.
+  static bool ParseAudioOptions(Napi::Env env, Napi::Object audio, AudioOptions* options) {
+    Napi::Value fft_size = audio.Get("fftSize");
+    if (fft_size.IsNumber()) {
+      options->fft_size = fft_size.As<Napi::Number>().Int32Value();
+      int size = options->fft_size;
+      if (size < AudioOptions::kMinFftSize || size > AudioOptions::kMaxFftSize || (size & (size - 1)) != 0) {
+        Napi::RangeError::New(env, "audio.fftSize must be a power of two from 32 to 32768").ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+    Napi::Value smoothing = audio.Get("smoothing");
+    if (smoothing.IsNumber()) {
+      options->smoothing = smoothing.As<Napi::Number>().FloatValue();
+      if (!(options->smoothing >= 0.0f && options->smoothing <= 1.0f)) {
+        Napi::RangeError::New(env, "audio.smoothing must be between 0 and 1").ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+    const char* names[] = {"lowRange", "midRange", "highRange"};
+    float* ranges[] = {options->low_hz, options->mid_hz, options->high_hz};
+    for (int i = 0; i < 3; ++i) {
+      Napi::Value range = audio.Get(names[i]);
+      if (range.IsUndefined()) continue;
+      Napi::Value from = range.IsArray() ? range.As<Napi::Array>().Get(0u) : env.Undefined();
+      Napi::Value to = range.IsArray() ? range.As<Napi::Array>().Get(1u) : env.Undefined();
+      if (!from.IsNumber() || !to.IsNumber() ||
+          !(from.As<Napi::Number>().FloatValue() >= 0.0f && from.As<Napi::Number>().FloatValue() <= to.As<Napi::Number>().FloatValue() &&
+            std::isfinite(to.As<Napi::Number>().FloatValue()))) {
+        Napi::RangeError::New(env, std::string("audio.") + names[i] + " must be [fromHz, toHz]").ThrowAsJavaScriptException();
+        return false;
+      }
+      ranges[i][0] = from.As<Napi::Number>().FloatValue();
+      ranges[i][1] = to.As<Napi::Number>().FloatValue();
     }
-    return Napi::Boolean::New(info.Env(), true);
+    if (audio.Has("peak")) options->peak = audio.Get("peak").ToBoolean().Value();
+    return true;
   }
 
+  // stopCapture([sourceName])
   Napi::Value StopCapture(const Napi::CallbackInfo& info) {
-    StopCaptureInternal();
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    for (ReceiverEntry* entry : targets) entry->receiver->Stop();
     return info.Env().Undefined();
   }
 
+  // captureVideo([sourceName]): without a name, the first receiver that has
+  // a new frame.
   Napi::Value CaptureVideo(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    
-    if (!new_frame_available_.load()) return env.Null();
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    for (ReceiverEntry* entry : targets) {
+      Napi::Value frame = TakeFrame(env, entry);
+      if (!frame.IsNull()) return frame;
+    }
+    return env.Null();
+  }
 
-    int current_read_idx = read_idx_.load();
-    if (current_read_idx < 0) return env.Null();
+  // onFrame(callback, { maxInFlight = 1, ackTimeoutMs = 200 })
+  // Calls |callback| with each new frame of every receiver (the same object
+  // captureVideo() returns, tagged with its source) from the capture
+  // threads' side instead of being polled. A frame counts as in flight
+  // until frameDone(source) is called or ackTimeoutMs passes. Calling
+  // onFrame again replaces the callback.
+  Napi::Value OnFrame(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+      Napi::TypeError::New(env, "Function callback expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
 
-    Napi::Object obj = Napi::Object::New(env);
-    
+    int max_in_flight = 1;
+    int ack_timeout_ms = kDefaultAckTimeoutMs;
+    if (info.Length() >= 2 && info[1].IsObject()) {
+      Napi::Object options = info[1].As<Napi::Object>();
+      if (options.Get("maxInFlight").IsNumber()) {
+        max_in_flight = options.Get("maxInFlight").As<Napi::Number>().Int32Value();
+      }
+      if (options.Get("ackTimeoutMs").IsNumber()) {
+        ack_timeout_ms = options.Get("ackTimeoutMs").As<Napi::Number>().Int32Value();
+      }
+    }
+    if (max_in_flight < 1) {
+      Napi::RangeError::New(env, "maxInFlight must be at least 1").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    // Zero or less would count every frame as timed out, and nothing
+    // would ever be held back.
+    if (ack_timeout_ms < 1) {
+      Napi::RangeError::New(env, "ackTimeoutMs must be at least 1").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    Unsubscribe();
+    max_in_flight_ = max_in_flight;
+    ack_timeout_ms_ = ack_timeout_ms;
+
+    Subscription* sub = new Subscription{this, {}};
+    sub->callback = Napi::ThreadSafeFunction::New(env, info[0].As<Napi::Function>(), "NdiFrame", 0, 1,
+                                                  &NdiWrapper::FinalizeSubscription, sub);
+    // Queued calls dereference this object; keep it alive until the
+    // subscription is finalized.
+    Ref();
     {
-      std::lock_guard<std::mutex> lock(buffer_mutex_);
-      std::vector<uint8_t>& buffer = buffers_[current_read_idx];
-      obj.Set("width", Napi::Number::New(env, frame_width_));
-      obj.Set("height", Napi::Number::New(env, frame_height_));
-      obj.Set("data", Napi::Buffer<uint8_t>::Copy(env, buffer.data(), buffer.size()));
-    }
-    
-    new_frame_available_ = false;
+      std::lock_guard<std::mutex> lock(subscription_mutex_);
+      subscription_ = sub;
+    }
+    // Hand over frames that arrived before subscribing.
+    for (auto& it : receivers_) {
+      if (it.second->receiver->HasPendingFrame()) PushFrame(it.second.get());
+    }
+    return env.Undefined();
+  }
+
+  Napi::Value OffFrame(const Napi::CallbackInfo& info) {
+    Unsubscribe();
+    return info.Env().Undefined();
+  }
+
+  // frameDone([sourceName]): acknowledges one delivered frame; the newest
+  // pending frame of that source, if any, is pushed right away. In pooled
+  // mode the oldest frame's buffer goes back to the capture thread.
+  Napi::Value FrameDone(const Napi::CallbackInfo& info) {
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    for (ReceiverEntry* entry : targets) {
+      ReleaseInFlight(entry);
+      ReturnOldestSlab(entry);
+      if (entry->receiver->HasPendingFrame()) PushFrame(entry);
+    }
+    return info.Env().Undefined();
+  }
+
+  // Hands the newest frame to JS, or null if nothing new was published.
+  Napi::Value TakeFrame(Napi::Env env, ReceiverEntry* entry) {
+    FrameReceiver* receiver = entry->receiver.get();
+    if (receiver->pooled() && !receiver->shared()) return CapturePooledVideo(env, entry);
+
+    const CapturedFrame* frame = receiver->TakeFrame();
+    if (!frame) return env.Null();
+
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("source", Napi::String::New(env, receiver->source_name()));
+    obj.Set("width", Napi::Number::New(env, frame->width));
+    obj.Set("height", Napi::Number::New(env, frame->height));
+    SetFrameFormat(env, obj, frame->format);
+    SetFrameChanges(env, obj, frame->unchanged, frame->dirty);
+    SetFrameAudio(env, obj, frame->audio);
+    if (frame->shared.sequence != 0) {
+      // The payload stays in shared memory; see SharedFrameReader.
+      Napi::Object shared = Napi::Object::New(env);
+      shared.Set("ring", Napi::String::New(env, frame->shared.ring));
+      shared.Set("slot", Napi::Number::New(env, frame->shared.slot));
+      shared.Set("sequence", Napi::Number::New(env, static_cast<double>(frame->shared.sequence)));
+      shared.Set("size", Napi::Number::New(env, frame->shared.size));
+      obj.Set("shared", shared);
+      return obj;
+    }
+    obj.Set("data", CopyFrameData(env, frame->data.data(), frame->data.size(), frame->format));
     return obj;
   }
 
-  Napi::Value DestroyReceiver(const Napi::CallbackInfo& info) {
-    StopCaptureInternal();
-    if (p_recv_) {
-      NDIlib_recv_destroy(p_recv_);
-      p_recv_ = nullptr;
+  // unchanged: the payload repeats the previous frame's, so consumers may
+  // keep what they made from it. dirtyRects: the changed areas in capture
+  // pixels, [] when unchanged.
+  static void SetFrameChanges(Napi::Env env, Napi::Object obj, bool unchanged, const std::vector<DirtyRect>& dirty) {
+    obj.Set("unchanged", Napi::Boolean::New(env, unchanged));
+    Napi::Array rects = Napi::Array::New(env, dirty.size());
+    for (size_t i = 0; i < dirty.size(); ++i) {
+      Napi::Object rect = Napi::Object::New(env);
+      rect.Set("x", Napi::Number::New(env, dirty[i].x));
+      rect.Set("y", Napi::Number::New(env, dirty[i].y));
+      rect.Set("width", Napi::Number::New(env, dirty[i].width));
+      rect.Set("height", Napi::Number::New(env, dirty[i].height));
+      rects.Set(static_cast<uint32_t>(i), rect);
     }
+    obj.Set("dirtyRects", rects);
+  }
+
+  // "bgra" frames hold 4 bytes per pixel; "mask" frames hold one byte per
+  // pixel, 0 or an RGB332 colour, produced by the named analysis; "path"
+  // frames hold a Float32Array of laser points.
+  static void SetFrameFormat(Napi::Env env, Napi::Object obj, FrameFormat format) {
+    switch (format) {
+      case FrameFormat::kBgra:
+        obj.Set("format", Napi::String::New(env, "bgra"));
+        break;
+      case FrameFormat::kLumaMask:
+      case FrameFormat::kEdgeMask:
+        obj.Set("format", Napi::String::New(env, "mask"));
+        obj.Set("analysis", Napi::String::New(env, format == FrameFormat::kEdgeMask ? "edges" : "luma"));
+        break;
+      case FrameFormat::kPath:
+        obj.Set("format", Napi::String::New(env, "path"));
+        break;
+    }
+  }
+
+  // audio: {low, mid, high, rms, timestamp} in 0..1 as of this frame, only
+  // when the capture analyses audio and some has arrived.
+  static void SetFrameAudio(Napi::Env env, Napi::Object obj, const AudioBands& audio) {
+    if (audio.sequence == 0) return;
+    obj.Set("audio", AudioBandsToObject(env, audio));
+  }
+
+  static Napi::Object AudioBandsToObject(Napi::Env env, const AudioBands& audio) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("low", Napi::Number::New(env, audio.low));
+    obj.Set("mid", Napi::Number::New(env, audio.mid));
+    obj.Set("high", Napi::Number::New(env, audio.high));
+    obj.Set("rms", Napi::Number::New(env, audio.rms));
+    if (audio.timestamp != kNoTimestamp) obj.Set("timestamp", Napi::Number::New(env, static_cast<double>(audio.timestamp)));
+    return obj;
+  }
+
+  static Napi::Value CopyFrameData(Napi::Env env, const uint8_t* data, size_t size, FrameFormat format) {
+    if (format != FrameFormat::kPath) return Napi::Buffer<uint8_t>::Copy(env, data, size);
+    Napi::Float32Array points = Napi::Float32Array::New(env, size / sizeof(float));
+    std::memcpy(points.Data(), data, size);
+    return points;
+  }
+
+  // Pooled mode. Runtimes with a V8 memory cage (Electron >= 21) refuse
+  // ArrayBuffers over memory the addon allocated, so the receiver's frame
+  // pool adopts a fixed set of ArrayBuffers made here instead, kept alive by
+  // |buffers|, and the capture thread writes frames straight into them.
+  // A frame's data is a view of one; it stays untouched until frameDone()
+  // or until kLentFrames newer frames of the source have been taken, which
+  // is when a polling caller is done with it. It must be copied, not
+  // transferred, to keep it beyond that; sent over IPC it is copied
+  // anyway, which shared-memory mode avoids.
+  static constexpr int kPooledBuffers = 4;  // writing, pending, two in JS
+  static constexpr size_t kLentFrames = 2;
+
+  Napi::Value CapturePooledVideo(Napi::Env env, ReceiverEntry* entry) {
+    FrameReceiver* receiver = entry->receiver.get();
+    ForgetRetiredBuffers(entry);
+    FrameSlab* slab = receiver->TakeSlab();
+    if (!slab) return env.Null();
+
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("source", Napi::String::New(env, receiver->source_name()));
+    obj.Set("width", Napi::Number::New(env, slab->width));
+    obj.Set("height", Napi::Number::New(env, slab->height));
+    FrameFormat format = static_cast<FrameFormat>(slab->format);
+    SetFrameFormat(env, obj, format);
+    SetFrameChanges(env, obj, slab->unchanged, slab->dirty);
+    SetFrameAudio(env, obj, slab->audio);
+
+    FramePool& pool = receiver->frame_pool();
+    if (slab->buffer >= 0) {
+      if (entry->lent.size() >= kLentFrames) ReturnOldestSlab(entry);
+      pool.Lend(slab);
+      entry->lent.push_back(slab);
+      Napi::ArrayBuffer buffer = entry->buffers.at(slab->buffer).Value();
+      if (format == FrameFormat::kPath) {
+        obj.Set("data", Napi::Float32Array::New(env, slab->size / sizeof(float), buffer, 0));
+      } else {
+        obj.Set("data", Napi::Uint8Array::New(env, slab->size, buffer, 0));
+      }
+    } else {
+      // No adopted buffer holds this frame yet (the first one, or the size
+      // grew): copy it out once and grow the buffers for the next.
+      obj.Set("data", CopyFrameData(env, slab->data, slab->size, format));
+      pool.RecordCopy();
+      size_t bytes = slab->size;
+      pool.Release(slab);
+      // Traced paths vary in length from frame to frame.
+      EnsureBuffers(env, entry, format == FrameFormat::kPath ? bytes + bytes / 2 : bytes);
+    }
+    return obj;
+  }
+
+  // Replaces the receiver's buffers with kPooledBuffers of |bytes| unless
+  // they hold that much already. The old ones are dropped once the capture
+  // thread and JS are done with them.
+  static void EnsureBuffers(Napi::Env env, ReceiverEntry* entry, size_t bytes) {
+    if (bytes <= entry->buffer_bytes) return;
+    FramePool& pool = entry->receiver->frame_pool();
+    pool.RetireSmaller(bytes);
+    for (int i = 0; i < kPooledBuffers; ++i) {
+      Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, bytes);
+      int id = entry->next_buffer++;
+      entry->buffers.emplace(id, Napi::Persistent(buffer));
+      pool.Adopt(static_cast<uint8_t*>(buffer.Data()), bytes, id);
+    }
+    entry->buffer_bytes = bytes;
+    ForgetRetiredBuffers(entry);
+  }
+
+  static void DropBuffers(ReceiverEntry* entry) {
+    entry->receiver->frame_pool().RetireSmaller(SIZE_MAX);
+    entry->buffer_bytes = 0;
+    ForgetRetiredBuffers(entry);
+  }
+
+  static void ForgetRetiredBuffers(ReceiverEntry* entry) {
+    for (int id : entry->receiver->frame_pool().TakeRetired()) entry->buffers.erase(id);
+  }
+
+  // Gives the capture thread back the oldest frame JS was handed, unless its
+  // ArrayBuffer was detached (transferred) meanwhile and the memory is no
+  // longer ours to write.
+  static void ReturnOldestSlab(ReceiverEntry* entry) {
+    if (entry->lent.empty()) return;
+    FrameSlab* slab = entry->lent.front();
+    entry->lent.pop_front();
+    FramePool& pool = entry->receiver->frame_pool();
+    auto it = entry->buffers.find(slab->buffer);
+    if (it == entry->buffers.end() || it->second.Value().ByteLength() < slab->capacity) {
+      pool.Retire(slab);
+    } else {
+      pool.Release(slab);
+    }
+  }
+
+  // getFramePoolStats([sourceName]): without a name, summed over all
+  // receivers.
+  Napi::Value GetFramePoolStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    FramePoolStats stats;
+    for (ReceiverEntry* entry : targets) {
+      FramePoolStats s = entry->receiver->frame_pool().stats();
+      stats.hits += s.hits;
+      stats.misses += s.misses;
+      stats.copies += s.copies;
+      stats.slabs += s.slabs;
+      stats.free_slabs += s.free_slabs;
+    }
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+    obj.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    obj.Set("copies", Napi::Number::New(env, static_cast<double>(stats.copies)));
+    obj.Set("slabs", Napi::Number::New(env, static_cast<double>(stats.slabs)));
+    obj.Set("freeSlabs", Napi::Number::New(env, static_cast<double>(stats.free_slabs)));
+    return obj;
+  }
+
+  // getFrameSyncStats([sourceName]): without a name, summed over all
+  // receivers. Counters restart whenever a receiver enters frame-sync mode.
+  Napi::Value GetFrameSyncStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    FrameSyncStats stats;
+    bool enabled = false;
+    for (ReceiverEntry* entry : targets) {
+      FrameSyncStats s = entry->receiver->frame_sync_stats();
+      stats.pulled += s.pulled;
+      stats.repeated += s.repeated;
+      stats.dropped += s.dropped;
+      enabled = enabled || entry->receiver->frame_sync() > 0;
+    }
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("enabled", Napi::Boolean::New(env, enabled));
+    obj.Set("pulled", Napi::Number::New(env, static_cast<double>(stats.pulled)));
+    obj.Set("repeated", Napi::Number::New(env, static_cast<double>(stats.repeated)));
+    obj.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+    return obj;
+  }
+
+  // getScalerInfo([sourceName])
+  Napi::Value GetScalerInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    ScaleFilter filter = targets.empty() ? ScaleFilter::kNearest : targets.front()->receiver->filter();
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("filter", Napi::String::New(env, ScaleFilterName(filter)));
+    obj.Set("backend", Napi::String::New(env, ScalerBackendName()));
+    bool uyvy = !targets.empty() && targets.front()->receiver->uyvy();
+    obj.Set("colorFormat", Napi::String::New(env, uyvy ? "uyvy" : "bgra"));
+    bool proxy = !targets.empty() && targets.front()->receiver->proxy();
+    obj.Set("stream", Napi::String::New(env, proxy ? "proxy" : "full"));
+    int threads = targets.empty() ? RowPool::DefaultThreads() : targets.front()->receiver->threads();
+    obj.Set("threads", Napi::Number::New(env, threads));
+    return obj;
+  }
+  // getStats([sourceName]): capture telemetry collected on the capture
+  // threads, summed over all receivers unless one is named. Histograms are
+  // in microseconds: recvWaitUs (blocked in the SDK per frame, push capture
+  // only), processUs (scale/convert/analyse/trace) and latencyUs (sender
+  // timestamp to arrival, including clock skew between the machines).
+  Napi::Value GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    CaptureStatsSnapshot stats;
+    for (ReceiverEntry* entry : targets) stats.Merge(entry->receiver->stats());
+
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("received", Napi::Number::New(env, static_cast<double>(stats.received)));
+    obj.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+    obj.Set("overwritten", Napi::Number::New(env, static_cast<double>(stats.overwritten)));
+    obj.Set("unchanged", Napi::Number::New(env, static_cast<double>(stats.unchanged)));
+    obj.Set("queueDepth", Napi::Number::New(env, stats.queue_depth));
+    obj.Set("maxQueueDepth", Napi::Number::New(env, stats.max_queue_depth));
+    obj.Set("recvWaitUs", HistogramToObject(env, stats.recv_wait_us));
+    obj.Set("processUs", HistogramToObject(env, stats.process_us));
+    obj.Set("latencyUs", HistogramToObject(env, stats.latency_us));
+    return obj;
+  }
+
+  // getAudio([sourceName]): the newest analysis, {low, mid, high, rms,
+  // timestamp, sampleRate, spectrum: Float32Array}, or null before any
+  // audio arrived. Without a name, the first source that has some.
+  Napi::Value GetAudio(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    for (ReceiverEntry* entry : targets) {
+      const AudioLevels& levels = entry->receiver->LatestAudio();
+      if (levels.bands.sequence == 0) continue;
+      Napi::Object obj = AudioBandsToObject(env, levels.bands);
+      obj.Set("sampleRate", Napi::Number::New(env, levels.sample_rate));
+      Napi::Float32Array spectrum = Napi::Float32Array::New(env, levels.spectrum.size());
+      std::memcpy(spectrum.Data(), levels.spectrum.data(), levels.spectrum.size() * sizeof(float));
+      obj.Set("spectrum", spectrum);
+      return obj;
+    }
+    return env.Null();
+  }
+
+  Napi::Value ResetStats(const Napi::CallbackInfo& info) {
+    std::vector<ReceiverEntry*> targets;
+    SelectReceivers(info, &targets);
+    for (ReceiverEntry* entry : targets) entry->receiver->ResetStats();
     return info.Env().Undefined();
   }
+
+};
+
+// Reads frames that an NdiWrapper in another process published with
+// sharedMemory, given the {ring, slot, sequence, size} it sent along. Needs
+// no NDI runtime, so a renderer's preload can use it.
+class SharedFrameReader : public Napi::ObjectWrap<SharedFrameReader> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SharedFrameReader", {
+      InstanceMethod("read", &SharedFrameReader::Read),
+      InstanceMethod("close", &SharedFrameReader::Close)
+    });
+    exports.Set("SharedFrameReader", func);
+    return exports;
+  }
+
+  SharedFrameReader(const Napi::CallbackInfo& info) : Napi::ObjectWrap<SharedFrameReader>(info) {}
+
+ private:
+  // A receiver replaces its ring when a payload outgrows it, so only the
+  // newest few mappings are kept.
+  static constexpr size_t kMaxRings = 4;
+  std::vector<std::unique_ptr<SharedFrameRing>> rings_;  // oldest first
+
+  SharedFrameRing* RingNamed(const std::string& name) {
+    for (auto& ring : rings_) {
+      if (ring->name() == name) return ring.get();
+    }
+    std::unique_ptr<SharedFrameRing> ring = SharedFrameRing::Open(name);
+    if (!ring) return nullptr;
+    if (rings_.size() >= kMaxRings) rings_.erase(rings_.begin());
+    rings_.push_back(std::move(ring));
+    return rings_.back().get();
+  }
+
+  // read(shared): a Uint8Array, or a Float32Array for paths, holding the
+  // frame; null if it has been overwritten since or the ring is gone.
+  Napi::Value Read(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+      Napi::TypeError::New(env, "Shared frame reference expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Object shared = info[0].As<Napi::Object>();
+    Napi::Value ring_name = shared.Get("ring");
+    Napi::Value slot = shared.Get("slot");
+    Napi::Value sequence = shared.Get("sequence");
+    Napi::Value size = shared.Get("size");
+    if (!ring_name.IsString() || !slot.IsNumber() || !sequence.IsNumber() || !size.IsNumber()) {
+      Napi::TypeError::New(env, "Shared frame reference expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    SharedFrameRing* ring = RingNamed(ring_name.As<Napi::String>().Utf8Value());
+    if (!ring) return env.Null();
+
+    size_t bytes = static_cast<size_t>(size.As<Napi::Number>().Int64Value());
+    if (bytes > ring->capacity()) return env.Null();
+    Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, bytes);
+    RingFrameInfo frame;
+    if (!ring->Read(slot.As<Napi::Number>().Uint32Value(), static_cast<uint64_t>(sequence.As<Napi::Number>().Int64Value()),
+                    static_cast<uint8_t*>(buffer.Data()), bytes, &frame) || frame.size != bytes) {
+      return env.Null();
+    }
+    if (static_cast<FrameFormat>(frame.format) == FrameFormat::kPath) {
+      return Napi::Float32Array::New(env, bytes / sizeof(float), buffer, 0);
+    }
+    return Napi::Uint8Array::New(env, bytes, buffer, 0);
+  }
+
+  Napi::Value Close(const Napi::CallbackInfo& info) {
+    rings_.clear();
+    return info.Env().Undefined();
+  }
+};
+
+// PointOptimizer: the renderer's optimizePoints() on 8-float point buffers
+// (see point_optimizer.h), optionally after reordering the frame's segments
+// (see path_planner.h). Needs no NDI runtime.
+class OptimizerWrapper : public Napi::ObjectWrap<OptimizerWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "PointOptimizer", {
+      InstanceMethod("configure", &OptimizerWrapper::Configure),
+      InstanceMethod("outputLength", &OptimizerWrapper::OutputLength),
+      InstanceMethod("optimize", &OptimizerWrapper::Optimize)
+    });
+    exports.Set("PointOptimizer", func);
+    return exports;
+  }
+
+  // new PointOptimizer([options])
+  OptimizerWrapper(const Napi::CallbackInfo& info) : Napi::ObjectWrap<OptimizerWrapper>(info) {
+    if (info.Length() >= 1 && info[0].IsObject()) ApplyOptions(info.Env(), info[0].As<Napi::Object>());
+  }
+
+ private:
+  PointOptimizer optimizer_;
+  PathPlanner planner_;
+  bool reorder_ = false;
+  std::vector<float> reordered_;
+  // The points outputLength() last reordered and sized; optimize() on the
+  // same array straight after writes reordered_ without planning again.
+  const void* sized_points_ = nullptr;
+  size_t sized_bytes_ = 0;
+  size_t sized_count_ = 0;
+  size_t sized_floats_ = 0;
+  // Output buffer reused by optimize() calls without one of their own.
+  Napi::Reference<Napi::ArrayBuffer> pool_;
+
+  // { maxDistance, pathDwell, pps, maxVelocity, maxAcceleration,
+  // maxCornerDwell, reorder, reorderBudgetMs, reorderEvaluations, reverse };
+  // throws and returns false on bad values.
+  bool ApplyOptions(Napi::Env env, Napi::Object options) {
+    sized_points_ = nullptr;
+    OptimizerOptions parsed = optimizer_.options();
+    if (options.Has("maxDistance")) {
+      Napi::Value value = options.Get("maxDistance");
+      double distance = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1.0;
+      if (!std::isfinite(distance) || distance < 0.0) {
+        Napi::RangeError::New(env, "maxDistance must be a non-negative number").ThrowAsJavaScriptException();
+        return false;
+      }
+      parsed.max_distance = distance;
+    }
+    if (options.Has("pathDwell")) {
+      Napi::Value value = options.Get("pathDwell");
+      int dwell = value.IsNumber() ? value.As<Napi::Number>().Int32Value() : -1;
+      if (dwell < 0 || dwell > 256) {
+        Napi::RangeError::New(env, "pathDwell must be an integer from 0 to 256").ThrowAsJavaScriptException();
+        return false;
+      }
+      parsed.path_dwell = dwell;
+    }
+    if (options.Has("pps")) {
+      Napi::Value value = options.Get("pps");
+      double pps = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1.0;
+      if (!std::isfinite(pps) || pps <= 0.0) {
+        Napi::RangeError::New(env, "pps must be a positive number").ThrowAsJavaScriptException();
+        return false;
+      }
+      parsed.pps = pps;
+    }
+    if (options.Has("maxVelocity")) {
+      Napi::Value value = options.Get("maxVelocity");
+      double velocity = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1.0;
+      if (!std::isfinite(velocity) || velocity < 0.0) {
+        Napi::RangeError::New(env, "maxVelocity must be a non-negative number").ThrowAsJavaScriptException();
+        return false;
+      }
+      parsed.max_velocity = velocity;
+    }
+    if (options.Has("maxAcceleration")) {
+      Napi::Value value = options.Get("maxAcceleration");
+      double acceleration = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1.0;
+      if (!std::isfinite(acceleration) || acceleration < 0.0) {
+        Napi::RangeError::New(env, "maxAcceleration must be a non-negative number").ThrowAsJavaScriptException();
+        return false;
+      }
+      parsed.max_acceleration = acceleration;
+    }
+    if (options.Has("maxCornerDwell")) {
+      Napi::Value value = options.Get("maxCornerDwell");
+      int dwell = value.IsNumber() ? value.As<Napi::Number>().Int32Value() : -1;
+      if (dwell < 0 || dwell > OptimizerOptions::kMaxCornerDwell) {
+        Napi::RangeError::New(env, "maxCornerDwell must be an integer from 0 to 64").ThrowAsJavaScriptException();
+        return false;
+      }
+      parsed.max_corner_dwell = dwell;
+    }
+    PlannerOptions planner = planner_.options();
+    if (options.Has("reorderBudgetMs")) {
+      Napi::Value value = options.Get("reorderBudgetMs");
+      double budget = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1.0;
+      if (!std::isfinite(budget) || budget < 0.0) {
+        Napi::RangeError::New(env, "reorderBudgetMs must be a non-negative number").ThrowAsJavaScriptException();
+        return false;
+      }
+      planner.budget_ms = budget;
+    }
+    if (options.Has("reorderEvaluations")) {
+      Napi::Value value = options.Get("reorderEvaluations");
+      double evaluations = value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1.0;
+      if (!(evaluations >= 0.0 && evaluations <= 1e12) || evaluations != std::floor(evaluations)) {
+        Napi::RangeError::New(env, "reorderEvaluations must be a non-negative integer").ThrowAsJavaScriptException();
+        return false;
+      }
+      planner.max_evaluations = static_cast<uint64_t>(evaluations);
+    }
+    if (options.Has("reverse")) planner.reverse = options.Get("reverse").ToBoolean().Value();
+    if (options.Has("reorder")) reorder_ = options.Get("reorder").ToBoolean().Value();
+    optimizer_.Configure(parsed);
+    planner_.Configure(planner);
+    return true;
+  }
+
+  // The frame to optimise: |points| itself, or its reordered copy.
+  const float* Input(const Napi::Float32Array& points, size_t* count) {
+    *count = points.ElementLength() / kPointStride;
+    if (!reorder_) return points.Data();
+    *count = planner_.Plan(points.Data(), *count, &reordered_);
+    return reordered_.data();
+  }
+
+  static bool PointsArg(const Napi::CallbackInfo& info, Napi::Float32Array* points) {
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+      Napi::TypeError::New(info.Env(), "Float32Array of points expected").ThrowAsJavaScriptException();
+      return false;
+    }
+    *points = info[0].As<Napi::Float32Array>();
+    return true;
+  }
+
+  static bool Overlaps(const void* a, size_t a_bytes, const void* b, size_t b_bytes) {
+    const uint8_t* pa = static_cast<const uint8_t*>(a);
+    const uint8_t* pb = static_cast<const uint8_t*>(b);
+    return pa < pb + b_bytes && pb < pa + a_bytes;
+  }
+
+  // configure(options)
+  Napi::Value Configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+      Napi::TypeError::New(env, "Options object expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (!ApplyOptions(env, info[0].As<Napi::Object>())) return env.Null();
+    return env.Undefined();
+  }
+
+  // outputLength(points): floats optimize() writes for |points|, to size an
+  // output buffer. A reordered frame keeps its order between the two calls
+  // (see PathPlanner::Plan()), and optimize(points, output) straight after,
+  // on the same array, writes the frame sized here rather than reordering
+  // and sizing it again.
+  Napi::Value OutputLength(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Float32Array points;
+    if (!PointsArg(info, &points)) return env.Null();
+    size_t count = 0;
+    const float* input = Input(points, &count);
+    const size_t floats = optimizer_.Plan(input, count) * kPointStride;
+    sized_points_ = reorder_ ? points.Data() : nullptr;
+    sized_bytes_ = points.ElementLength() * sizeof(float);
+    sized_count_ = count;
+    sized_floats_ = floats;
+    return Napi::Number::New(env, static_cast<double>(floats));
+  }
+
+  // optimize(points[, output]): the optimised frame as a Float32Array. With
+  // |output|, which must hold outputLength(points) floats, the result is a
+  // view of its start; otherwise a view of a buffer this optimizer reuses,
+  // valid until its next optimize() call.
+  Napi::Value Optimize(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Float32Array points;
+    if (!PointsArg(info, &points)) return env.Null();
+    const size_t in_bytes = points.ElementLength() * sizeof(float);
+    const bool has_output = info.Length() >= 2 && !info[1].IsUndefined();
+    size_t count = 0;
+    const float* input = nullptr;
+    size_t floats = 0;
+    if (has_output && sized_points_ == points.Data() && sized_bytes_ == in_bytes) {
+      // reordered_ and the optimizer's plan are still those outputLength()
+      // made for these points.
+      input = reordered_.data();
+      count = sized_count_;
+      floats = sized_floats_;
+    } else {
+      input = Input(points, &count);
+      floats = optimizer_.Plan(input, count) * kPointStride;
+    }
+    sized_points_ = nullptr;
+    const size_t bytes = floats * sizeof(float);
+
+    if (has_output) {
+      if (!info[1].IsTypedArray() || info[1].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "output must be a Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      Napi::Float32Array output = info[1].As<Napi::Float32Array>();
+      if (output.ElementLength() < floats) {
+        Napi::RangeError::New(env, "output is smaller than outputLength(points)").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      if (Overlaps(output.Data(), bytes, points.Data(), in_bytes)) {
+        Napi::RangeError::New(env, "output must not overlap points").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      optimizer_.Write(input, count, output.Data());
+      return Napi::Float32Array::New(env, floats, output.ArrayBuffer(), output.ByteOffset());
+    }
+
+    // A detached pool (transferred to a worker) reads as empty; an input
+    // that is a view of the pool would be overwritten while being read.
+    Napi::ArrayBuffer pool = pool_.IsEmpty() ? Napi::ArrayBuffer() : pool_.Value();
+    if (pool.IsEmpty() || pool.ByteLength() < bytes || Overlaps(pool.Data(), pool.ByteLength(), points.Data(), in_bytes)) {
+      pool = Napi::ArrayBuffer::New(env, std::max<size_t>(bytes + bytes / 2, 4096));
+      pool_ = Napi::Persistent(pool);
+    }
+    optimizer_.Write(input, count, static_cast<float*>(pool.Data()));
+    return Napi::Float32Array::New(env, floats, pool, 0);
+  }
+};
+
+// GalvoSimulator: where the scanners would actually take the beam for an
+// 8-float sample stream (see galvo_simulator.h). Needs no NDI runtime.
+class GalvoWrapper : public Napi::ObjectWrap<GalvoWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "GalvoSimulator", {
+      InstanceMethod("configure", &GalvoWrapper::Configure),
+      InstanceMethod("simulate", &GalvoWrapper::Simulate)
+    });
+    exports.Set("GalvoSimulator", func);
+    return exports;
+  }
+
+  // new GalvoSimulator([options])
+  GalvoWrapper(const Napi::CallbackInfo& info) : Napi::ObjectWrap<GalvoWrapper>(info) {
+    if (info.Length() >= 1 && info[0].IsObject()) ApplyOptions(info.Env(), info[0].As<Napi::Object>());
+  }
+
+ private:
+  GalvoSimulator galvo_;
+
+  // Reads options[name] into |value| if present: a number in [min, max],
+  // above |min| too when |open| is set. Throws and returns false otherwise.
+  static bool ReadNumber(Napi::Env env, Napi::Object options, const char* name, double min, double max, bool open,
+                         const char* message, double* value) {
+    if (!options.Has(name)) return true;
+    Napi::Value item = options.Get(name);
+    double number = item.IsNumber() ? item.As<Napi::Number>().DoubleValue() : NAN;
+    if (!std::isfinite(number) || number < min || number > max || (open && number == min)) {
+      Napi::RangeError::New(env, message).ThrowAsJavaScriptException();
+      return false;
+    }
+    *value = number;
+    return true;
+  }
+
+  // { pps, bandwidthHz, overshoot, maxVelocity, maxAcceleration, substeps };
+  // throws and returns false on bad values.
+  bool ApplyOptions(Napi::Env env, Napi::Object options) {
+    GalvoOptions parsed = galvo_.options();
+    double substeps = parsed.substeps;
+    if (!ReadNumber(env, options, "pps", 0.0, HUGE_VAL, true, "pps must be a positive number", &parsed.pps) ||
+        !ReadNumber(env, options, "bandwidthHz", 0.0, HUGE_VAL, true, "bandwidthHz must be a positive number",
+                    &parsed.bandwidth_hz) ||
+        !ReadNumber(env, options, "overshoot", 0.0, 0.99, false, "overshoot must be a number from 0 to 0.99",
+                    &parsed.overshoot) ||
+        !ReadNumber(env, options, "maxVelocity", 0.0, HUGE_VAL, false, "maxVelocity must be a non-negative number",
+                    &parsed.max_velocity) ||
+        !ReadNumber(env, options, "maxAcceleration", 0.0, HUGE_VAL, false,
+                    "maxAcceleration must be a non-negative number", &parsed.max_acceleration) ||
+        !ReadNumber(env, options, "substeps", 1.0, GalvoOptions::kMaxSubsteps, false,
+                    "substeps must be an integer from 1 to 256", &substeps)) {
+      return false;
+    }
+    parsed.substeps = static_cast<int>(substeps);
+    galvo_.Configure(parsed);
+    return true;
+  }
+
+  // configure(options)
+  Napi::Value Configure(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+      Napi::TypeError::New(env, "Options object expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (!ApplyOptions(env, info[0].As<Napi::Object>())) return env.Null();
+    return env.Undefined();
+  }
+
+  // simulate(points[, output]): the beam's trace, one point per sample, as
+  // a new Float32Array or written into |output| (which may be |points|).
+  // Frames repeat, so the mirrors start at rest on the frame's last point.
+  Napi::Value Simulate(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+      Napi::TypeError::New(env, "Float32Array of points expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Float32Array points = info[0].As<Napi::Float32Array>();
+    const size_t count = points.ElementLength() / kPointStride;
+    Napi::Float32Array output;
+    if (info.Length() >= 2 && !info[1].IsUndefined()) {
+      if (!info[1].IsTypedArray() || info[1].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "output must be a Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      output = info[1].As<Napi::Float32Array>();
+      if (output.ElementLength() < count * kPointStride) {
+        Napi::RangeError::New(env, "output is smaller than points").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      // Written point by point after each is read, so only an exact alias
+      // is safe.
+      const float* in = points.Data();
+      const float* out = output.Data();
+      if (out != in && out < in + count * kPointStride && in < out + count * kPointStride) {
+        Napi::RangeError::New(env, "output must be points itself or not overlap it").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    } else {
+      output = Napi::Float32Array::New(env, count * kPointStride);
+    }
+    if (count > 0) {
+      galvo_.Reset(points.Data() + (count - 1) * kPointStride);
+      galvo_.Simulate(points.Data(), count, output.Data());
+    }
+    return output;
+  }
+};
+
+// EffectsEngine: the per-point stages of applyEffects(), compiled by
+// src/utils/effects.js into a program of doubles (see effects_engine.h).
+// Needs no NDI runtime.
+class EffectsWrapper : public Napi::ObjectWrap<EffectsWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "EffectsEngine", {
+      InstanceMethod("apply", &EffectsWrapper::Apply)
+    });
+    exports.Set("EffectsEngine", func);
+    return exports;
+  }
+
+  // new EffectsEngine()
+  EffectsWrapper(const Napi::CallbackInfo& info) : Napi::ObjectWrap<EffectsWrapper>(info) {}
+
+ private:
+  EffectsEngine engine_;
+
+  // apply(points, program[, output]): |points| run through the stages of
+  // |program| (a Float64Array), as a new Float32Array or written into
+  // |output| (which may be |points|).
+  Napi::Value Apply(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+      Napi::TypeError::New(env, "Float32Array of points expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (info.Length() < 2 || !info[1].IsTypedArray() ||
+        info[1].As<Napi::TypedArray>().TypedArrayType() != napi_float64_array) {
+      Napi::TypeError::New(env, "Float64Array program expected").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    Napi::Float32Array points = info[0].As<Napi::Float32Array>();
+    Napi::Float64Array program = info[1].As<Napi::Float64Array>();
+    const size_t floats = points.ElementLength() / kPointStride * kPointStride;
+    Napi::Float32Array output;
+    if (info.Length() >= 3 && !info[2].IsUndefined()) {
+      if (!info[2].IsTypedArray() || info[2].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array) {
+        Napi::TypeError::New(env, "output must be a Float32Array").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      output = info[2].As<Napi::Float32Array>();
+      if (output.ElementLength() < floats) {
+        Napi::RangeError::New(env, "output is smaller than points").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      const float* in = points.Data();
+      const float* out = output.Data();
+      if (out != in && out < in + floats && in < out + floats) {
+        Napi::RangeError::New(env, "output must be points itself or not overlap it").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    } else {
+      output = Napi::Float32Array::New(env, floats);
+    }
+    if (!engine_.Load(program.Data(), program.ElementLength())) {
+      Napi::RangeError::New(env, "Malformed effect program").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    if (output.Data() != points.Data()) std::memcpy(output.Data(), points.Data(), floats * sizeof(float));
+    engine_.Apply(output.Data(), floats / kPointStride);
+    return output;
+  }
 };
 
+// Runs once for every Node environment that loads the addon: the main
+// thread and each worker thread. All state hangs off the instances, apart
+// from the NDI runtime, which is refcounted (see AcquireNdi).
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
-  return NdiWrapper::Init(env, exports);
+  NdiWrapper::Init(env, exports);
+  SharedFrameReader::Init(env, exports);
+  OptimizerWrapper::Init(env, exports);
+  GalvoWrapper::Init(env, exports);
+  return EffectsWrapper::Init(env, exports);
 }
 
 NODE_API_MODULE(ndi_wrapper, InitAll)
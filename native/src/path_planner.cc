@@ -0,0 +1,321 @@
+#include "path_planner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "point_optimizer.h"
+
+namespace {
+
+// Moves must save at least this much travel, so rounding cannot make the
+// search cycle between equal orders.
+constexpr double kMinGain = 1e-9;
+
+inline bool Blanked(const float* p) { return p[6] > 0.5f; }
+
+inline double Distance(const float* a, const float* b) {
+  double dx = static_cast<double>(a[0]) - b[0];
+  double dy = static_cast<double>(a[1]) - b[1];
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+inline double SquaredDistance(const float* a, const float* b) {
+  double dx = static_cast<double>(a[0]) - b[0];
+  double dy = static_cast<double>(a[1]) - b[1];
+  return dx * dx + dy * dy;
+}
+
+int64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Writes a point at the position of |at| with the colour and blanking of
+// |look|, or blanked and black without one.
+inline float* Put(float* out, const float* at, const float* look) {
+  out[0] = at[0];
+  out[1] = at[1];
+  out[2] = at[2];
+  out[3] = look ? look[3] : 0.0f;
+  out[4] = look ? look[4] : 0.0f;
+  out[5] = look ? look[5] : 0.0f;
+  out[6] = look ? look[6] : 1.0f;
+  out[7] = 0.0f;
+  return out + kPointStride;
+}
+
+}  // namespace
+
+const float* PathPlanner::Entry(size_t k) const {
+  const Segment& s = segments_[tour_[k]];
+  return reversed_[tour_[k]] ? s.end : s.start;
+}
+
+const float* PathPlanner::Exit(size_t k) const {
+  const Segment& s = segments_[tour_[k]];
+  return reversed_[tour_[k]] ? s.start : s.end;
+}
+
+// Counts |evaluations| against the budget and returns true once the search
+// has to stop. The clock is read every 1024 evaluations or so.
+bool PathPlanner::Spend(uint64_t evaluations) {
+  if (stopped_) return true;
+  stats_.evaluations += evaluations;
+  if (stats_.evaluations >= options_.max_evaluations) {
+    stopped_ = true;
+  } else if (stats_.evaluations >= next_clock_check_) {
+    next_clock_check_ = stats_.evaluations + 1024;
+    if (NowNanos() >= deadline_) stopped_ = stats_.timed_out = true;
+  }
+  return stopped_;
+}
+
+void PathPlanner::Split(const float* points, size_t count) {
+  segments_.clear();
+  size_t i = 0;
+  while (i < count) {
+    if (Blanked(points + i * kPointStride)) {
+      ++i;
+      continue;
+    }
+    Segment s;
+    s.first = static_cast<uint32_t>(i);
+    while (i < count && !Blanked(points + i * kPointStride)) ++i;
+    s.last = static_cast<uint32_t>(i - 1);
+    s.anchor = s.first > 0 ? s.first - 1 : s.first;
+    const float* anchor = points + static_cast<size_t>(s.anchor) * kPointStride;
+    const float* last = points + static_cast<size_t>(s.last) * kPointStride;
+    s.start[0] = anchor[0];
+    s.start[1] = anchor[1];
+    s.end[0] = last[0];
+    s.end[1] = last[1];
+    segments_.push_back(s);
+  }
+}
+
+double PathPlanner::TourLength() const {
+  double length = 0.0;
+  const size_t n = tour_.size();
+  for (size_t k = 0; k < n; ++k) length += Distance(Exit(k), Entry(k + 1 < n ? k + 1 : 0));
+  return length;
+}
+
+// Greedy tour from the first segment: always the closest unvisited end.
+// Segments left when the budget runs out follow in source order.
+// Each step weighs every unvisited segment.
+void PathPlanner::NearestNeighbour() {
+  const size_t n = segments_.size();
+  visited_.assign(n, 0);
+  std::fill(reversed_.begin(), reversed_.end(), 0);
+  tour_.assign(1, 0);
+  visited_[0] = 1;
+  const float* at = segments_[0].end;
+  for (size_t step = 1; step < n; ++step) {
+    if (Spend(n - step)) break;
+    size_t best = n;
+    bool best_reversed = false;
+    double best_distance = std::numeric_limits<double>::infinity();
+    for (size_t s = 1; s < n; ++s) {
+      if (visited_[s]) continue;
+      double d = SquaredDistance(at, segments_[s].start);
+      if (d < best_distance) {
+        best = s;
+        best_distance = d;
+        best_reversed = false;
+      }
+      if (options_.reverse) {
+        d = SquaredDistance(at, segments_[s].end);
+        if (d < best_distance) {
+          best = s;
+          best_distance = d;
+          best_reversed = true;
+        }
+      }
+    }
+    if (best == n) break;  // only non-finite ends left
+    visited_[best] = 1;
+    reversed_[best] = best_reversed;
+    tour_.push_back(static_cast<uint32_t>(best));
+    at = best_reversed ? segments_[best].start : segments_[best].end;
+  }
+  for (size_t s = 1; s < n; ++s) {
+    if (!visited_[s]) tour_.push_back(static_cast<uint32_t>(s));
+  }
+}
+
+// Reverses tour stretches [i, j], flipping each segment in them, wherever
+// that shortens the two jumps at its ends.
+bool PathPlanner::TwoOpt() {
+  const size_t n = tour_.size();
+  bool improved = false;
+  for (size_t i = 1; i < n; ++i) {
+    // The jump into position i only changes when a move is made.
+    const float* a = Exit(i - 1);
+    const float* b = Entry(i);
+    double ab = Distance(a, b);
+    for (size_t j = i; j < n; ++j) {
+      if (Spend(1)) return improved;
+      const float* c = Exit(j);
+      const float* d = Entry(j + 1 < n ? j + 1 : 0);
+      double before = ab + Distance(c, d);
+      double after = Distance(a, c) + Distance(b, d);
+      if (after < before - kMinGain) {
+        std::reverse(tour_.begin() + i, tour_.begin() + j + 1);
+        for (size_t k = i; k <= j; ++k) reversed_[tour_[k]] ^= 1;
+        b = Entry(i);
+        ab = Distance(a, b);
+        improved = true;
+      }
+    }
+  }
+  return improved;
+}
+
+// Moves chains of one to three segments elsewhere in the tour, reversed if
+// that fits better.
+bool PathPlanner::OrOpt() {
+  const size_t n = tour_.size();
+  bool improved = false;
+  for (size_t length = 1; length <= 3; ++length) {
+    for (size_t i = 1; i + length <= n; ++i) {
+      if (Spend(1)) return improved;
+      const size_t last = i + length - 1;
+      const float* prev = Exit(i - 1);
+      const float* next = Entry(last + 1 < n ? last + 1 : 0);
+      const float* entry = Entry(i);
+      const float* exit = Exit(last);
+      double removed = Distance(prev, entry) + Distance(exit, next) - Distance(prev, next);
+      if (removed <= kMinGain) continue;
+      // Weighs every place the chain could go, both ways round.
+      if (Spend(options_.reverse ? 2 * n : n)) return improved;
+
+      size_t best = n;
+      bool best_reversed = false;
+      double best_added = removed - kMinGain;
+      for (size_t p = 0; p < n; ++p) {
+        if (p + 1 >= i && p <= last) continue;  // inside the chain or where it already is
+        const float* u = Exit(p);
+        const float* v = Entry(p + 1 < n ? p + 1 : 0);
+        double gap = Distance(u, v);
+        double added = Distance(u, entry) + Distance(exit, v) - gap;
+        if (added < best_added) {
+          best = p;
+          best_added = added;
+          best_reversed = false;
+        }
+        if (options_.reverse) {
+          added = Distance(u, exit) + Distance(entry, v) - gap;
+          if (added < best_added) {
+            best = p;
+            best_added = added;
+            best_reversed = true;
+          }
+        }
+      }
+      if (best == n) continue;
+
+      scratch_.assign(tour_.begin() + i, tour_.begin() + last + 1);
+      tour_.erase(tour_.begin() + i, tour_.begin() + last + 1);
+      size_t insert = (best > last ? best - length : best) + 1;
+      if (best_reversed) {
+        std::reverse(scratch_.begin(), scratch_.end());
+        for (uint32_t s : scratch_) reversed_[s] ^= 1;
+      }
+      tour_.insert(tour_.begin() + insert, scratch_.begin(), scratch_.end());
+      improved = true;
+    }
+  }
+  return improved;
+}
+
+void PathPlanner::Emit(const float* points, std::vector<float>* out) const {
+  size_t total = 0;
+  for (const Segment& s : segments_) total += s.last - s.first + 2;
+  out->resize(total * kPointStride);
+  float* dst = out->data();
+  for (uint32_t index : tour_) {
+    const Segment& s = segments_[index];
+    const float* anchor = points + static_cast<size_t>(s.anchor) * kPointStride;
+    const float* first = points + static_cast<size_t>(s.first) * kPointStride;
+    const float* last = points + static_cast<size_t>(s.last) * kPointStride;
+    if (!reversed_[index]) {
+      dst = Put(dst, anchor, nullptr);
+      size_t run = s.last - s.first + 1;
+      std::memcpy(dst, first, run * kPointStride * sizeof(float));
+      for (size_t k = 0; k < run; ++k) dst[k * kPointStride + 7] = 0.0f;
+      dst += run * kPointStride;
+      continue;
+    }
+    // Drawn from the end: every point takes the look of the point after it
+    // in source order, the line the beam now draws backwards into it.
+    dst = Put(dst, last, nullptr);
+    for (const float* p = last; p > first; p -= kPointStride) dst = Put(dst, p - kPointStride, p);
+    dst = Put(dst, anchor, first);
+  }
+  if (total > 0) out->back() = 1.0f;  // last-point flag
+}
+
+size_t PathPlanner::Write(const float* points, size_t count, std::vector<float>* out) const {
+  if (segments_.size() < 3) {
+    out->assign(points, points + count * kPointStride);
+    return count;
+  }
+  Emit(points, out);
+  return out->size() / kPointStride;
+}
+
+size_t PathPlanner::Plan(const float* points, size_t count, std::vector<float>* out) {
+  const int64_t start = NowNanos();
+  Split(points, count);
+  const size_t n = segments_.size();
+  // Compared bit for bit, so NaN ends match themselves; Segment has no
+  // padding.
+  if (planned_ && planned_segments_.size() == n &&
+      (n == 0 || std::memcmp(segments_.data(), planned_segments_.data(), n * sizeof(Segment)) == 0)) {
+    stats_.reused = true;
+    return Write(points, count, out);
+  }
+  planned_segments_ = segments_;
+  planned_ = true;
+
+  stats_ = PlanStats();
+  stats_.segments = n;
+  tour_.resize(n);
+  for (size_t s = 0; s < n; ++s) tour_[s] = static_cast<uint32_t>(s);
+  reversed_.assign(n, 0);
+  stats_.travel_before = TourLength();
+  if (n < 3) {
+    stats_.travel_after = stats_.travel_before;
+    stats_.converged = true;
+    return Write(points, count, out);
+  }
+
+  // Writing the frame out costs about twice reading it in, which is most
+  // of what has been spent so far; keep that much of the budget for it.
+  const int64_t budget = static_cast<int64_t>(std::max(options_.budget_ms, 0.0) * 1e6);
+  const int64_t now = NowNanos();
+  deadline_ = start + budget - 2 * (now - start);
+  next_clock_check_ = 0;
+  stopped_ = false;
+  NearestNeighbour();
+  // Authored frames are often ordered well already; start from whichever
+  // is shorter.
+  if (TourLength() > stats_.travel_before) {
+    for (size_t s = 0; s < n; ++s) tour_[s] = static_cast<uint32_t>(s);
+    std::fill(reversed_.begin(), reversed_.end(), 0);
+  }
+  for (;;) {
+    bool improved = options_.reverse && TwoOpt();
+    improved = OrOpt() || improved;
+    if (stopped_) break;
+    if (!improved) {
+      stats_.converged = true;
+      break;
+    }
+  }
+  stats_.travel_after = TourLength();
+  return Write(points, count, out);
+}
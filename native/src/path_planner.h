@@ -0,0 +1,107 @@
+#ifndef TRUELAZER_NATIVE_SRC_PATH_PLANNER_H_
+#define TRUELAZER_NATIVE_SRC_PATH_PLANNER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct PlannerOptions {
+  // Candidate moves the search may weigh, over the nearest-neighbour tour,
+  // 2-opt and Or-opt together; the best order found within them is used.
+  // Counting work rather than time gives a frame the same order however
+  // busy the machine is.
+  uint64_t max_evaluations = 50000;
+  // Cap on the whole call, for machines too slow for max_evaluations: the
+  // search then stops early enough to leave time to write the frame out,
+  // and the order depends on the machine's speed.
+  double budget_ms = 1.0;
+  // Whether segments may be drawn end to start.
+  bool reverse = true;
+};
+
+struct PlanStats {
+  size_t segments = 0;
+  // Blanked travel in the -1..1 space, the jump from the last segment back
+  // to the first included, since frames repeat.
+  double travel_before = 0.0;
+  double travel_after = 0.0;
+  uint64_t evaluations = 0;
+  bool converged = false;  // no move left to try within the budget
+  bool timed_out = false;  // budget_ms stopped the search, not max_evaluations
+  bool reused = false;     // the frame was unchanged; see Plan()
+};
+
+// Reorders the visible segments of a frame to shorten the blanked jumps
+// between them. Frames use the 8-float layout of point_optimizer.h.
+//
+// A segment is a run of visible points plus the blanked point before it,
+// where the line into the first visible point starts. Blanked points
+// between segments are otherwise dropped: they only describe travel, which
+// PointOptimizer regenerates for the new order. Each segment is written as
+// a blanked point at its start followed by its visible points. A reversed
+// segment keeps every line's colour, so each point takes the colour of the
+// point after it, as the mirror effect does.
+//
+// The first segment stays first and forwards, so consecutive frames of a
+// slowly changing animation start in the same place. Not thread-safe.
+class PathPlanner {
+ public:
+  explicit PathPlanner(const PlannerOptions& options = PlannerOptions()) : options_(options) {}
+
+  // The last frame's order is kept unless the options change; callers
+  // pass theirs with every frame.
+  void Configure(const PlannerOptions& options) {
+    planned_ = planned_ && options.max_evaluations == options_.max_evaluations &&
+               options.budget_ms == options_.budget_ms && options.reverse == options_.reverse;
+    options_ = options;
+  }
+  const PlannerOptions& options() const { return options_; }
+
+  // Writes the reordered frame of |count| points into |out| and returns its
+  // point count. Frames with fewer than three segments are copied as they
+  // are. A frame whose segments are those of the last one (a still, an
+  // animation that holds, or one that only changes colour) keeps the last
+  // one's order without a search, so one frame never changes order between
+  // calls, even if the time cap cut in.
+  size_t Plan(const float* points, size_t count, std::vector<float>* out);
+
+  const PlanStats& stats() const { return stats_; }
+
+ private:
+  struct Segment {
+    uint32_t anchor;  // blanked point before |first|, or |first| itself
+    uint32_t first;   // visible run [first, last]
+    uint32_t last;
+    float start[2];
+    float end[2];
+  };
+
+  void Split(const float* points, size_t count);
+  double TourLength() const;
+  void NearestNeighbour();
+  bool TwoOpt();
+  bool OrOpt();
+  void Emit(const float* points, std::vector<float>* out) const;
+  size_t Write(const float* points, size_t count, std::vector<float>* out) const;
+
+  // Where the beam enters and leaves the segment at tour position |k|.
+  const float* Entry(size_t k) const;
+  const float* Exit(size_t k) const;
+  bool Spend(uint64_t evaluations);
+
+  PlannerOptions options_;
+  PlanStats stats_;
+  std::vector<Segment> segments_;
+  std::vector<uint32_t> tour_;      // segment indices in drawing order
+  std::vector<uint8_t> reversed_;   // per segment
+  std::vector<uint8_t> visited_;
+  std::vector<uint32_t> scratch_;
+  int64_t deadline_ = 0;            // steady clock, in nanoseconds
+  uint64_t next_clock_check_ = 0;   // in evaluations
+  bool stopped_ = false;
+  // The segments tour_ and reversed_ were found for.
+  std::vector<Segment> planned_segments_;
+  bool planned_ = false;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_PATH_PLANNER_H_
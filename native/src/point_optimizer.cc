@@ -0,0 +1,153 @@
+#include "point_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+inline bool Blanked(const float* p) { return p[6] > 0.5f; }
+
+// Every lane of the point is stored, so runs of points are one contiguous
+// store stream of 32-byte points.
+inline float* Put(float* out, float x, float y, float z, float r, float g, float b, bool blanked) {
+  out[0] = x;
+  out[1] = y;
+  out[2] = z;
+  out[3] = r;
+  out[4] = g;
+  out[5] = b;
+  out[6] = blanked ? 1.0f : 0.0f;
+  out[7] = 0.0f;
+  return out + kPointStride;
+}
+
+// |n| blanked copies of the position of |p|.
+inline float* Dwell(float* out, const float* p, int n) {
+  const float point[kPointStride] = {p[0], p[1], p[2], 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+  for (int d = 0; d < n; ++d, out += kPointStride) std::memcpy(out, point, sizeof(point));
+  return out;
+}
+
+// Speed of the beam along a segment of |length| drawn in |steps| points:
+// what the points ask for, capped by the scanner's top speed.
+inline double SegmentSpeed(double length, uint32_t steps, double pps, double max_velocity) {
+  double spacing = steps > 1 ? length / steps : length;
+  return std::min(spacing * pps, max_velocity);
+}
+
+}  // namespace
+
+// Samples the scanner needs to turn from the segment (ax, ay) into (bx, by),
+// each with its interpolation steps. Matches cornerDwell() in optimizer.js.
+uint32_t PointOptimizer::CornerDwell(double ax, double ay, uint32_t steps_in, double bx, double by,
+                                     uint32_t steps_out) const {
+  const double la = std::sqrt(ax * ax + ay * ay);
+  const double lb = std::sqrt(bx * bx + by * by);
+  if (!(la > 0.0) || !(lb > 0.0)) return 0;  // a repeated point already holds
+  const double pps = options_.pps;
+  const double acceleration = options_.max_acceleration;
+  const double velocity = options_.max_velocity > 0.0 ? options_.max_velocity : HUGE_VAL;
+  const double vi = SegmentSpeed(la, steps_in, pps, velocity);
+  const double vo = SegmentSpeed(lb, steps_out, pps, velocity);
+  const double dvx = bx / lb * vo - ax / la * vi;
+  const double dvy = by / lb * vo - ay / la * vi;
+  const double samples = std::floor(std::sqrt(dvx * dvx + dvy * dvy) / acceleration * pps);
+  const double cap = std::clamp(options_.max_corner_dwell, 0, OptimizerOptions::kMaxCornerDwell);
+  return static_cast<uint32_t>(std::min(samples, cap));
+}
+
+size_t PointOptimizer::Plan(const float* points, size_t count) {
+  steps_.resize(count);
+  corners_.assign(count, 0);
+  held_ = false;
+  if (count == 0) return 0;
+  const bool corners = options_.max_acceleration > 0.0 && options_.pps > 0.0 && options_.max_corner_dwell > 0;
+  double max_distance = options_.max_distance;
+  if (options_.pps > 0.0 && options_.max_velocity > 0.0) max_distance = std::min(max_distance, options_.max_velocity / options_.pps);
+  const bool interpolate = max_distance > 0.0;
+  const double max_steps = static_cast<double>(OptimizerOptions::kMaxSteps);
+  // A corner between segments shorter than this turns within one sample:
+  // the velocity change is at most the sum of the two speeds.
+  const double corner_reach = options_.max_acceleration / (2.0 * options_.pps * options_.pps);
+  const double corner_squared = corner_reach * corner_reach * (1.0 - 1e-9);
+
+  // Most points are short moves; the squared length, with a little slack
+  // for rounding, rules them out before the exact length is taken.
+  const double near_squared = max_distance * max_distance * (1.0 - 1e-9);
+  const size_t dwell = static_cast<size_t>(std::max(options_.path_dwell, 0));
+  size_t total = count;
+  steps_[0] = 0;
+  double prev_dx = 0.0;
+  double prev_dy = 0.0;
+  double prev_squared = 0.0;
+  for (size_t i = 1; i < count; ++i) {
+    const float* curr = points + i * kPointStride;
+    const float* prev = curr - kPointStride;
+    const bool blanked = Blanked(curr);
+    if (blanked != Blanked(prev)) total += blanked ? dwell : dwell + 1;
+    double dx = static_cast<double>(curr[0]) - prev[0];
+    double dy = static_cast<double>(curr[1]) - prev[1];
+    double squared = dx * dx + dy * dy;
+    uint32_t steps = 0;
+    if (interpolate && !(squared <= near_squared)) {
+      double dist = std::sqrt(squared);
+      if (dist > max_distance) steps = static_cast<uint32_t>(std::min(std::floor(dist / max_distance), max_steps));
+      if (steps > 1) total += steps - 1;
+    }
+    steps_[i] = steps;
+    // The corner at |prev|, between two drawn segments.
+    if (corners && !(prev_squared < corner_squared && squared < corner_squared) && i >= 2 && !blanked &&
+        !Blanked(prev) && !Blanked(prev - kPointStride)) {
+      uint32_t hold = CornerDwell(prev_dx, prev_dy, steps_[i - 1], dx, dy, steps);
+      corners_[i - 1] = static_cast<uint8_t>(hold);
+      total += hold;
+      held_ = held_ || hold > 0;
+    }
+    prev_dx = dx;
+    prev_dy = dy;
+    prev_squared = squared;
+  }
+  return total;
+}
+
+void PointOptimizer::Write(const float* points, size_t count, float* out) const {
+  const int dwell = std::max(options_.path_dwell, 0);
+  for (size_t i = 0; i < count; ++i) {
+    const float* curr = points + i * kPointStride;
+    const float* prev = i > 0 ? curr - kPointStride : curr;
+    const bool blanked = Blanked(curr);
+    if (blanked != Blanked(prev)) out = blanked ? Dwell(out, prev, dwell) : Dwell(out, curr, dwell + 1);
+
+    const float r = blanked ? 0.0f : curr[3];
+    const float g = blanked ? 0.0f : curr[4];
+    const float b = blanked ? 0.0f : curr[5];
+    const uint32_t steps = steps_[i];
+    if (steps > 1) {
+      const double x = prev[0];
+      const double y = prev[1];
+      const double z = prev[2];
+      const double dx = curr[0] - x;
+      const double dy = curr[1] - y;
+      const double dz = curr[2] - z;
+      for (uint32_t s = 1; s < steps; ++s) {
+        double t = static_cast<double>(s) / steps;
+        out = Put(out, static_cast<float>(x + dx * t), static_cast<float>(y + dy * t), static_cast<float>(z + dz * t),
+                  r, g, b, blanked);
+      }
+    }
+    out = Put(out, curr[0], curr[1], curr[2], r, g, b, blanked);
+    if (held_) {
+      for (uint32_t h = corners_[i]; h > 0; --h, out += kPointStride) {
+        std::memcpy(out, out - kPointStride, kPointStride * sizeof(float));
+      }
+    }
+  }
+}
+
+size_t PointOptimizer::Optimize(const float* points, size_t count, std::vector<float>* out) {
+  size_t total = Plan(points, count);
+  out->resize(total * kPointStride);
+  Write(points, count, out->data());
+  return total;
+}
@@ -0,0 +1,83 @@
+#ifndef TRUELAZER_NATIVE_SRC_POINT_OPTIMIZER_H_
+#define TRUELAZER_NATIVE_SRC_POINT_OPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Floats per point in the renderer's frame buffers: x, y, z, r, g, b,
+// blanking (> 0.5 when blanked), last-point flag.
+constexpr int kPointStride = 8;
+
+struct OptimizerOptions {
+  // Jumps longer than this, in the -1..1 coordinate space, get evenly
+  // spaced intermediate points so the scanners never have to leap.
+  double max_distance = 0.08;
+  // Blanked points held where the beam switches between drawing and
+  // blanking, so the laser modulation lines up with the mirrors.
+  int path_dwell = 4;
+
+  // Scanner model, in -1..1 units at |pps| points per second: the mirrors'
+  // top speed and acceleration scaled to the coordinate space. At a visible
+  // corner the beam's velocity changes by |v_out - v_in|, which takes
+  // |v_out - v_in| / max_acceleration seconds, so the corner point is held
+  // for that many extra samples (at most max_corner_dwell). The speed into
+  // and out of a corner is the one the points ask for, the segment's length
+  // over its samples, capped by max_velocity; gentle curves and finely
+  // sampled shapes get no dwell. Lines and jumps are
+  // also split at max_velocity / pps where that is shorter than
+  // max_distance. A max_acceleration of 0 turns corner dwell off and a
+  // max_velocity of 0 leaves speed uncapped.
+  double pps = 30000.0;
+  double max_velocity = 2400.0;     // units per second: 0.08 per point at 30k
+  double max_acceleration = 2.5e7;  // units per second squared
+  int max_corner_dwell = 8;         // up to kMaxCornerDwell
+
+  // A single jump never gets more intermediate points than this, whatever
+  // the coordinates; only garbage input comes anywhere near it.
+  static constexpr uint32_t kMaxSteps = 1024;
+  // Upper bound for max_corner_dwell.
+  static constexpr int kMaxCornerDwell = 64;
+};
+
+// Native optimizePoints() from src/utils/optimizer.js, producing the same
+// floats for every frame size (the JS version passed frames of more than
+// 4000 points through untouched):
+//
+//  - entering a blanked run, path_dwell blanked points at the last visible
+//    point; leaving one, 1 + path_dwell blanked points at the first
+//    visible point;
+//  - a jump longer than max_distance split into floor(length /
+//    max_distance) steps, coloured like its end point;
+//  - blanked points black, and the last-point flag cleared;
+//  - visible corners held for the samples the scanner model needs to turn.
+//
+// Plan() walks the frame once to size the output, Write() fills it; the
+// interpolation runs in double like the JS it replaces. Not thread-safe.
+class PointOptimizer {
+ public:
+  explicit PointOptimizer(const OptimizerOptions& options = OptimizerOptions()) : options_(options) {}
+
+  void Configure(const OptimizerOptions& options) { options_ = options; }
+  const OptimizerOptions& options() const { return options_; }
+
+  // Returns how many points Write() will produce for |count| points.
+  size_t Plan(const float* points, size_t count);
+
+  // Writes the frame last passed to Plan() into |out|, which must hold
+  // Plan()'s result times kPointStride floats.
+  void Write(const float* points, size_t count, float* out) const;
+
+  // Plan() and Write() into |out|, grown as needed.
+  size_t Optimize(const float* points, size_t count, std::vector<float>* out);
+
+ private:
+  uint32_t CornerDwell(double ax, double ay, uint32_t steps_in, double bx, double by, uint32_t steps_out) const;
+
+  OptimizerOptions options_;
+  std::vector<uint32_t> steps_;   // per input point: interpolation steps, 0 for none
+  std::vector<uint8_t> corners_;  // per input point: extra copies held at a corner
+  bool held_ = false;             // any corner holds in the planned frame
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_POINT_OPTIMIZER_H_
@@ -0,0 +1,81 @@
+#include "row_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+void StripeBounds(int rows, int stripes, int index, int* begin, int* end) {
+  *begin = static_cast<int>(static_cast<int64_t>(rows) * index / stripes);
+  *end = static_cast<int>(static_cast<int64_t>(rows) * (index + 1) / stripes);
+}
+
+}  // namespace
+
+RowPool::RowPool(int threads) {
+  for (int i = 1; i < threads; ++i) {
+    workers_.emplace_back(&RowPool::WorkerLoop, this, i);
+  }
+}
+
+RowPool::~RowPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+int RowPool::DefaultThreads() {
+  int hardware = static_cast<int>(std::thread::hardware_concurrency());
+  return std::clamp(hardware / 2, 1, 4);
+}
+
+void RowPool::Run(int rows, const std::function<void(int, int)>& fn, int min_rows) {
+  if (rows <= 0) return;
+  int stripes = std::min(threads(), std::max(1, rows / std::max(1, min_rows)));
+  if (stripes == 1) {
+    fn(0, rows);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &fn;
+    job_rows_ = rows;
+    job_stripes_ = stripes;
+    pending_ = stripes - 1;
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  int begin, end;
+  StripeBounds(rows, stripes, 0, &begin, &end);
+  fn(begin, end);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return pending_ == 0; });
+  job_ = nullptr;
+}
+
+void RowPool::WorkerLoop(int index) {
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+    if (stop_) return;
+    seen = generation_;
+    // Workers past the stripe count sit this job out.
+    if (index >= job_stripes_) continue;
+
+    const std::function<void(int, int)>* job = job_;
+    int begin, end;
+    StripeBounds(job_rows_, job_stripes_, index, &begin, &end);
+    lock.unlock();
+    (*job)(begin, end);
+    lock.lock();
+    if (--pending_ == 0) done_.notify_one();
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef TRUELAZER_NATIVE_SRC_ROW_POOL_H_
+#define TRUELAZER_NATIVE_SRC_ROW_POOL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed pool that splits per-row image work into horizontal stripes.
+//
+// Run() hands one stripe to every worker, processes the first stripe on the
+// calling thread and returns once all stripes are done, so callers can chain
+// passes that depend on the previous pass's rows. Only one Run() may be in
+// flight at a time.
+class RowPool {
+ public:
+  // |threads| counts the calling thread, so 1 means no workers at all.
+  explicit RowPool(int threads);
+  ~RowPool();
+  RowPool(const RowPool&) = delete;
+  RowPool& operator=(const RowPool&) = delete;
+
+  int threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls fn(begin, end) for disjoint stripes covering [0, rows). Stripes are
+  // at least |min_rows| tall so small images do not pay for a wake-up.
+  void Run(int rows, const std::function<void(int, int)>& fn, int min_rows = 16);
+
+  // Half the hardware threads, capped at 4: the capture thread is one of them
+  // and the renderer and DAC threads need the rest.
+  static int DefaultThreads();
+
+ private:
+  void WorkerLoop(int index);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(int, int)>* job_ = nullptr;
+  int job_rows_ = 0;
+  int job_stripes_ = 0;
+  uint64_t generation_ = 0;
+  int pending_ = 0;
+  bool stop_ = false;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_ROW_POOL_H_
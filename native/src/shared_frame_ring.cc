@@ -0,0 +1,260 @@
+#include "shared_frame_ring.h"
+
+#include <cstring>
+#include <new>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring counters must be address-free");
+
+struct SharedFrameRing::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t slot_count;
+  uint32_t capacity;
+  uint64_t slot_stride;
+  std::atomic<uint64_t> latest;
+};
+
+// The frame info is read while the writer may be storing it, so it goes
+// through relaxed atomics; only the seqlock orders anything.
+struct SharedFrameRing::Slot {
+  std::atomic<uint64_t> state;  // seqlock, see the class comment
+  std::atomic<int32_t> width;
+  std::atomic<int32_t> height;
+  std::atomic<int32_t> format;
+  std::atomic<int32_t> unchanged;
+  std::atomic<int64_t> timestamp;
+  std::atomic<uint32_t> size;
+  uint32_t reserved;
+};
+
+namespace {
+
+constexpr uint32_t kMagic = 0x52464c54;  // "TLFR"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kAlign = 64;
+
+size_t AlignUp(size_t bytes) {
+  return (bytes + kAlign - 1) / kAlign * kAlign;
+}
+
+// The payload copy races the writer on purpose: copying it through atomics
+// would cost a frame's worth of single loads, and Read() throws the bytes
+// away whenever the seqlock shows the writer got in. ThreadSanitizer is told
+// as much.
+#if defined(__clang__) || defined(__GNUC__)
+__attribute__((no_sanitize("thread")))
+#endif
+void CopyPayload(uint8_t* dst, const uint8_t* src, size_t size) {
+  std::memcpy(dst, src, size);
+}
+
+#ifdef _WIN32
+std::string OsName(const std::string& name) {
+  return "Local\\" + name;
+}
+#else
+// POSIX names start with a slash; macOS allows 31 characters in all.
+std::string OsName(const std::string& name) {
+  return "/" + name;
+}
+#endif
+
+}  // namespace
+
+std::string SharedFrameRing::UniqueName() {
+  static std::atomic<uint32_t> counter{0};
+#ifdef _WIN32
+  unsigned long pid = GetCurrentProcessId();
+#else
+  unsigned long pid = static_cast<unsigned long>(getpid());
+#endif
+  return "tl-ndi-" + std::to_string(pid) + "-" + std::to_string(counter.fetch_add(1));
+}
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Create(const std::string& name, uint32_t slot_count, uint32_t capacity) {
+  if (slot_count == 0 || capacity == 0) return nullptr;
+  size_t slot_stride = AlignUp(sizeof(Slot)) + AlignUp(capacity);
+  size_t bytes = AlignUp(sizeof(Header)) + slot_stride * slot_count;
+
+#ifdef _WIN32
+  HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                      static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32),
+                                      static_cast<DWORD>(bytes & 0xffffffffu), OsName(name).c_str());
+  if (!mapping) return nullptr;
+  if (GetLastError() == ERROR_ALREADY_EXISTS) {
+    CloseHandle(mapping);
+    return nullptr;
+  }
+  void* base = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+  if (!base) {
+    CloseHandle(mapping);
+    return nullptr;
+  }
+#else
+  std::string os_name = OsName(name);
+  int fd = shm_open(os_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) return nullptr;
+  if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+    close(fd);
+    shm_unlink(os_name.c_str());
+    return nullptr;
+  }
+  void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    shm_unlink(os_name.c_str());
+    return nullptr;
+  }
+#endif
+
+  // Fresh mappings are zeroed, which is every slot's "never written" state.
+  Header* header = static_cast<Header*>(base);
+  header->magic = kMagic;
+  header->version = kVersion;
+  header->slot_count = slot_count;
+  header->capacity = capacity;
+  header->slot_stride = slot_stride;
+  new (&header->latest) std::atomic<uint64_t>(0);
+  std::unique_ptr<SharedFrameRing> ring(new SharedFrameRing(name, base, bytes, true));
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    Slot* slot = ring->slot_at(i);
+    new (&slot->state) std::atomic<uint64_t>(0);
+    new (&slot->width) std::atomic<int32_t>(0);
+    new (&slot->height) std::atomic<int32_t>(0);
+    new (&slot->format) std::atomic<int32_t>(0);
+    new (&slot->unchanged) std::atomic<int32_t>(0);
+    new (&slot->timestamp) std::atomic<int64_t>(0);
+    new (&slot->size) std::atomic<uint32_t>(0);
+  }
+#ifdef _WIN32
+  ring->handle_ = mapping;
+#endif
+  return ring;
+}
+
+std::unique_ptr<SharedFrameRing> SharedFrameRing::Open(const std::string& name) {
+#ifdef _WIN32
+  HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, OsName(name).c_str());
+  if (!mapping) return nullptr;
+  void* base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  MEMORY_BASIC_INFORMATION region;
+  size_t bytes = base && VirtualQuery(base, &region, sizeof(region)) ? region.RegionSize : 0;
+  if (!base || bytes < sizeof(Header)) {
+    if (base) UnmapViewOfFile(base);
+    CloseHandle(mapping);
+    return nullptr;
+  }
+#else
+  int fd = shm_open(OsName(name).c_str(), O_RDONLY, 0);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    return nullptr;
+  }
+  size_t bytes = static_cast<size_t>(st.st_size);
+  void* base = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return nullptr;
+#endif
+
+  std::unique_ptr<SharedFrameRing> ring(new SharedFrameRing(name, base, bytes, false));
+#ifdef _WIN32
+  ring->handle_ = mapping;
+#endif
+  const Header* header = static_cast<const Header*>(base);
+  size_t needed = AlignUp(sizeof(Header)) + header->slot_stride * header->slot_count;
+  if (header->magic != kMagic || header->version != kVersion || needed > bytes) return nullptr;
+  return ring;
+}
+
+SharedFrameRing::SharedFrameRing(std::string name, void* base, size_t bytes, bool owner)
+    : name_(std::move(name)), base_(base), bytes_(bytes), owner_(owner) {}
+
+SharedFrameRing::~SharedFrameRing() {
+#ifdef _WIN32
+  UnmapViewOfFile(base_);
+  if (handle_) CloseHandle(static_cast<HANDLE>(handle_));
+#else
+  munmap(base_, bytes_);
+  if (owner_) shm_unlink(OsName(name_).c_str());
+#endif
+}
+
+uint32_t SharedFrameRing::slot_count() const {
+  return static_cast<const Header*>(base_)->slot_count;
+}
+
+uint32_t SharedFrameRing::capacity() const {
+  return static_cast<const Header*>(base_)->capacity;
+}
+
+uint64_t SharedFrameRing::latest() const {
+  return static_cast<const Header*>(base_)->latest.load(std::memory_order_acquire);
+}
+
+SharedFrameRing::Slot* SharedFrameRing::slot_at(uint32_t index) const {
+  const Header* header = static_cast<const Header*>(base_);
+  uint8_t* slots = static_cast<uint8_t*>(base_) + AlignUp(sizeof(Header));
+  return reinterpret_cast<Slot*>(slots + header->slot_stride * index);
+}
+
+uint8_t* SharedFrameRing::BeginWrite(uint32_t* slot) {
+  *slot = static_cast<uint32_t>(next_sequence_ % slot_count());
+  Slot* target = slot_at(*slot);
+  target->state.store(next_sequence_ * 2 - 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  return reinterpret_cast<uint8_t*>(target) + AlignUp(sizeof(Slot));
+}
+
+uint64_t SharedFrameRing::EndWrite(uint32_t slot, const RingFrameInfo& info) {
+  Slot* target = slot_at(slot);
+  target->width.store(info.width, std::memory_order_relaxed);
+  target->height.store(info.height, std::memory_order_relaxed);
+  target->format.store(info.format, std::memory_order_relaxed);
+  target->unchanged.store(info.unchanged ? 1 : 0, std::memory_order_relaxed);
+  target->timestamp.store(info.timestamp, std::memory_order_relaxed);
+  target->size.store(info.size, std::memory_order_relaxed);
+  uint64_t sequence = next_sequence_++;
+  target->state.store(sequence * 2, std::memory_order_release);
+  static_cast<Header*>(base_)->latest.store(sequence, std::memory_order_release);
+  return sequence;
+}
+
+bool SharedFrameRing::Read(uint32_t slot, uint64_t sequence, uint8_t* dst, size_t dst_size, RingFrameInfo* info) const {
+  if (slot >= slot_count() || sequence == 0) return false;
+  const Slot* source = slot_at(slot);
+  uint64_t before = source->state.load(std::memory_order_acquire);
+  if (before != sequence * 2) return false;
+
+  RingFrameInfo copy;
+  copy.width = source->width.load(std::memory_order_relaxed);
+  copy.height = source->height.load(std::memory_order_relaxed);
+  copy.format = source->format.load(std::memory_order_relaxed);
+  copy.unchanged = source->unchanged.load(std::memory_order_relaxed) != 0;
+  copy.timestamp = source->timestamp.load(std::memory_order_relaxed);
+  copy.size = source->size.load(std::memory_order_relaxed);
+  if (copy.size > capacity() || copy.size > dst_size) return false;
+  CopyPayload(dst, reinterpret_cast<const uint8_t*>(source) + AlignUp(sizeof(Slot)), copy.size);
+
+  // The writer may have started on this slot while we copied. The fence
+  // keeps the loads above from sinking below the second state load, so if
+  // the state is unchanged none of them saw a store from a later frame.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (source->state.load(std::memory_order_relaxed) != before) return false;
+  if (info) *info = copy;
+  return true;
+}
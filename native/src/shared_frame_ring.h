@@ -0,0 +1,77 @@
+#ifndef TRUELAZER_NATIVE_SRC_SHARED_FRAME_RING_H_
+#define TRUELAZER_NATIVE_SRC_SHARED_FRAME_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// What a reader learns about a published frame besides its bytes.
+struct RingFrameInfo {
+  int width = 0;
+  int height = 0;
+  int format = 0;  // the producer's layout tag
+  bool unchanged = false;
+  int64_t timestamp = 0;
+  uint32_t size = 0;  // payload bytes
+};
+
+// Frames in named shared memory, so another process can read them straight
+// from the capture thread's output and only a slot index and sequence number
+// travel over IPC.
+//
+// The segment holds a header and |slot_count| slots of |capacity| bytes.
+// One writer fills the slots in turn; every published frame gets the next
+// sequence number. Each slot carries a seqlock (odd while being written,
+// twice the frame's sequence once published), so a reader can tell whether
+// the frame it was told about is still there and was not torn while it
+// copied. Readers never block the writer; a frame that was overwritten is
+// simply gone.
+class SharedFrameRing {
+ public:
+  // Creates and maps a new segment. Returns null if the name is taken or the
+  // OS refuses. The creator removes the name again when destroyed; readers
+  // that already mapped the segment keep it.
+  static std::unique_ptr<SharedFrameRing> Create(const std::string& name, uint32_t slot_count, uint32_t capacity);
+  // Maps an existing segment read-only. Returns null if it does not exist or
+  // is not a frame ring.
+  static std::unique_ptr<SharedFrameRing> Open(const std::string& name);
+  // A name no other ring on this machine uses: "tl-ndi-<pid>-<n>".
+  static std::string UniqueName();
+
+  ~SharedFrameRing();
+  SharedFrameRing(const SharedFrameRing&) = delete;
+  SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+  const std::string& name() const { return name_; }
+  uint32_t slot_count() const;
+  uint32_t capacity() const;
+
+  // Writer side, one thread. BeginWrite() claims the next slot and returns
+  // its payload; EndWrite() publishes it and returns its sequence number.
+  uint8_t* BeginWrite(uint32_t* slot);
+  uint64_t EndWrite(uint32_t slot, const RingFrameInfo& info);
+
+  // Reader side, any thread or process. Copies frame |sequence| from |slot|
+  // into |dst| and returns true if it was still there and fit in |dst_size|.
+  bool Read(uint32_t slot, uint64_t sequence, uint8_t* dst, size_t dst_size, RingFrameInfo* info) const;
+  // The newest published sequence number, 0 before the first frame.
+  uint64_t latest() const;
+
+ private:
+  struct Header;
+  struct Slot;
+
+  SharedFrameRing(std::string name, void* base, size_t bytes, bool owner);
+  Slot* slot_at(uint32_t index) const;
+
+  const std::string name_;
+  void* const base_;
+  const size_t bytes_;
+  const bool owner_;
+  void* handle_ = nullptr;  // the mapping object on Windows
+  uint64_t next_sequence_ = 1;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_SHARED_FRAME_RING_H_
@@ -0,0 +1,83 @@
+#include "source_discovery.h"
+
+#include <chrono>
+#include <utility>
+
+SourceDiscovery::~SourceDiscovery() {
+  Stop();
+}
+
+bool SourceDiscovery::Start() {
+  if (!stop_.load()) return true;
+  find_ = ndi_->find_create_v2(nullptr);
+  if (!find_) return false;
+  stop_ = false;
+  thread_ = std::thread(&SourceDiscovery::Loop, this);
+  return true;
+}
+
+void SourceDiscovery::Stop() {
+  {
+    // Under the lock so a waiter cannot miss the wakeup.
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  scanned_.notify_all();
+  if (thread_.joinable()) thread_.join();
+  if (find_) {
+    ndi_->find_destroy(find_);
+    find_ = nullptr;
+  }
+}
+
+std::vector<NdiSourceInfo> SourceDiscovery::sources() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sources_;
+}
+
+std::vector<NdiSourceInfo> SourceDiscovery::WaitForFirstScan(int timeout_ms) const {
+  std::unique_lock<std::mutex> lock(mutex_);
+  scanned_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return settled_ || stop_.load(); });
+  return sources_;
+}
+
+// Copies the SDK's list, whose strings only live until the next query.
+void SourceDiscovery::Refresh() {
+  uint32_t count = 0;
+  const NDIlib_source_t* found = ndi_->find_get_current_sources(find_, &count);
+  std::vector<NdiSourceInfo> list;
+  list.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    NdiSourceInfo info;
+    if (found[i].p_ndi_name) info.name = found[i].p_ndi_name;
+    if (found[i].p_url_address) info.url = found[i].p_url_address;
+    list.push_back(std::move(info));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    settled_ = true;
+    if (list == sources_) {
+      scanned_.notify_all();
+      return;
+    }
+    sources_ = list;
+  }
+  scanned_.notify_all();
+  if (on_change_) on_change_(list);
+}
+
+void SourceDiscovery::Loop() {
+  auto started = std::chrono::steady_clock::now();
+  bool settled = false;
+  while (!stop_) {
+    // Returns early when the set of sources changes.
+    if (ndi_->find_wait_for_sources(find_, kWaitMs)) {
+      Refresh();
+      settled = true;
+    } else if (!settled && std::chrono::steady_clock::now() - started >= std::chrono::milliseconds(kSettleMs)) {
+      Refresh();
+      settled = true;
+    }
+  }
+}
@@ -0,0 +1,73 @@
+#ifndef TRUELAZER_NATIVE_SRC_SOURCE_DISCOVERY_H_
+#define TRUELAZER_NATIVE_SRC_SOURCE_DISCOVERY_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <Processing.NDI.Lib.h>
+
+struct NdiSourceInfo {
+  std::string name;  // "MACHINE (Stream)"
+  std::string url;   // where the sender can be reached, may be empty
+
+  bool operator==(const NdiSourceInfo& other) const { return name == other.name && url == other.url; }
+};
+
+// Keeps a finder running on its own thread and caches the sources it sees,
+// so callers never poll the SDK themselves. The list is copied out of the
+// SDK on every change and can be read from any thread.
+class SourceDiscovery {
+ public:
+  using ChangeCallback = std::function<void(const std::vector<NdiSourceInfo>&)>;
+
+  // |ndi| is the loaded runtime; it must outlive the discovery.
+  explicit SourceDiscovery(const NDIlib_v6* ndi) : ndi_(ndi) {}
+  ~SourceDiscovery();
+  SourceDiscovery(const SourceDiscovery&) = delete;
+  SourceDiscovery& operator=(const SourceDiscovery&) = delete;
+
+  // Runs on the discovery thread with the new list whenever it changes.
+  // Set before Start().
+  void set_on_change(ChangeCallback on_change) { on_change_ = std::move(on_change); }
+
+  // Creates the finder and starts watching. Returns false if the SDK
+  // refuses; the list then stays empty.
+  bool Start();
+  void Stop();
+
+  std::vector<NdiSourceInfo> sources() const;
+
+  // Blocks until the first scan has settled, the discovery stops or
+  // |timeout_ms| passes, then returns the list. Meant for worker threads.
+  std::vector<NdiSourceInfo> WaitForFirstScan(int timeout_ms) const;
+
+ private:
+  // mDNS answers usually arrive within this long; a scan that has seen no
+  // change by then counts as settled with whatever it has.
+  static constexpr int kSettleMs = 1000;
+  static constexpr uint32_t kWaitMs = 250;
+
+  void Loop();
+  void Refresh();
+
+  const NDIlib_v6* const ndi_;
+  NDIlib_find_instance_t find_ = nullptr;
+  std::thread thread_;
+  std::atomic<bool> stop_{true};
+  ChangeCallback on_change_;
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable scanned_;
+  std::vector<NdiSourceInfo> sources_;
+  bool settled_ = false;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_SOURCE_DISCOVERY_H_
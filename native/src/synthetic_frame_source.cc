@@ -0,0 +1,291 @@
+#include "synthetic_frame_source.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+#include "audio_analyzer.h"
+
+namespace {
+
+constexpr int kToneSampleRate = 48000;
+
+uint8_t Clamp8(int v) {
+  return static_cast<uint8_t>(std::clamp(v, 0, 255));
+}
+
+// BT.709, video range: the matrix NDI senders use for HD.
+void BgraToUyvy(const uint8_t* bgra, size_t pixels, uint8_t* uyvy) {
+  for (size_t i = 0; i + 1 < pixels; i += 2, bgra += 8, uyvy += 4) {
+    int y[2];
+    int r = 0, g = 0, b = 0;
+    for (int k = 0; k < 2; ++k) {
+      int pb = bgra[k * 4], pg = bgra[k * 4 + 1], pr = bgra[k * 4 + 2];
+      y[k] = 16 + ((47 * pr + 157 * pg + 16 * pb + 128) >> 8);
+      r += pr;
+      g += pg;
+      b += pb;
+    }
+    // Chroma of the pair's average; r, g, b hold two pixels' worth.
+    int u = -26 * r - 87 * g + 112 * b;
+    int v = 112 * r - 102 * g - 10 * b;
+    uyvy[0] = Clamp8(128 + (u + (u >= 0 ? 256 : -256)) / 512);
+    uyvy[1] = Clamp8(y[0]);
+    uyvy[2] = Clamp8(128 + (v + (v >= 0 ? 256 : -256)) / 512);
+    uyvy[3] = Clamp8(y[1]);
+  }
+}
+
+void UyvyToBgra(const uint8_t* uyvy, size_t pixels, uint8_t* bgra) {
+  for (size_t i = 0; i + 1 < pixels; i += 2, uyvy += 4, bgra += 8) {
+    int d = uyvy[0] - 128;
+    int e = uyvy[2] - 128;
+    for (int k = 0; k < 2; ++k) {
+      int c = (uyvy[1 + k * 2] - 16) * 298 + 128;
+      bgra[k * 4] = Clamp8((c + 541 * d) >> 8);
+      bgra[k * 4 + 1] = Clamp8((c - 55 * d - 136 * e) >> 8);
+      bgra[k * 4 + 2] = Clamp8((c + 459 * e) >> 8);
+      bgra[k * 4 + 3] = 255;
+    }
+  }
+}
+
+int BytesPerPixel(PixelLayout layout) {
+  return layout == PixelLayout::kUyvy ? 2 : 4;
+}
+
+}  // namespace
+
+bool IsSyntheticSourceName(const std::string& name) {
+  return name.compare(0, sizeof(kSyntheticPrefix) - 1, kSyntheticPrefix) == 0;
+}
+
+bool ParseSyntheticSourceName(const std::string& name, SyntheticOptions* options, std::string* error) {
+  if (!IsSyntheticSourceName(name)) {
+    *error = "synthetic source names start with 'synthetic:'";
+    return false;
+  }
+  std::string rest = name.substr(sizeof(kSyntheticPrefix) - 1);
+  size_t pos = 0;
+  while (pos < rest.size()) {
+    size_t end = rest.find(',', pos);
+    if (end == std::string::npos) end = rest.size();
+    std::string item = rest.substr(pos, end - pos);
+    pos = end + 1;
+    if (item.empty()) continue;
+
+    size_t eq = item.find('=');
+    if (eq == std::string::npos) {
+      *error = "expected key=value, got '" + item + "'";
+      return false;
+    }
+    std::string key = item.substr(0, eq);
+    std::string value = item.substr(eq + 1);
+    if (key == "pattern") {
+      if (value != "bars" && value != "noise") {
+        *error = "pattern must be 'bars' or 'noise'";
+        return false;
+      }
+      options->pattern = value;
+    } else if (key == "file") {
+      options->file = value;
+    } else if (key == "layout") {
+      if (value != "bgra" && value != "uyvy") {
+        *error = "layout must be 'bgra' or 'uyvy'";
+        return false;
+      }
+      options->file_layout = value == "uyvy" ? PixelLayout::kUyvy : PixelLayout::kBgra;
+    } else if (key == "size") {
+      int w = 0, h = 0;
+      char tail = 0;
+      // UYVY pairs pixels, so widths are even.
+      if (std::sscanf(value.c_str(), "%dx%d%c", &w, &h, &tail) != 2 || w < 2 || h < 1 || w % 2 != 0) {
+        *error = "size must be WIDTHxHEIGHT with an even width";
+        return false;
+      }
+      options->width = w;
+      options->height = h;
+    } else if (key == "fps") {
+      char* parse_end = nullptr;
+      double fps = std::strtod(value.c_str(), &parse_end);
+      if (parse_end == value.c_str() || *parse_end != '\0' || fps < 0 || fps > 1000) {
+        *error = "fps must be between 0 and 1000";
+        return false;
+      }
+      options->fps = fps;
+    } else if (key == "tone") {
+      char* parse_end = nullptr;
+      double hz = std::strtod(value.c_str(), &parse_end);
+      if (parse_end == value.c_str() || *parse_end != '\0' || hz <= 0 || hz >= kToneSampleRate / 2) {
+        *error = "tone must be between 0 and 24000 Hz";
+        return false;
+      }
+      options->tone_hz = hz;
+    } else {
+      *error = "unknown key '" + key + "'";
+      return false;
+    }
+  }
+  return true;
+}
+
+SyntheticFrameSource::SyntheticFrameSource(SyntheticOptions options) : options_(std::move(options)) {}
+
+bool SyntheticFrameSource::Open(const CaptureRequest& request) {
+  if (frame_count_ == 0) {
+    if (!options_.file.empty()) {
+      if (!LoadFile()) return false;
+    } else {
+      RenderPattern();
+    }
+  }
+  // Convert up front so the first timed Capture() does not pay for it.
+  FramesIn(request.accepts_uyvy ? PixelLayout::kUyvy : PixelLayout::kBgra);
+  return true;
+}
+
+bool SyntheticFrameSource::LoadFile() {
+  std::ifstream in(options_.file, std::ios::binary);
+  if (!in) return false;
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  size_t frame_bytes = static_cast<size_t>(options_.width) * options_.height * BytesPerPixel(options_.file_layout);
+  frame_count_ = static_cast<int>(data.size() / frame_bytes);
+  if (frame_count_ == 0) return false;
+  // A trailing partial frame is ignored.
+  data.resize(frame_count_ * frame_bytes);
+  (options_.file_layout == PixelLayout::kUyvy ? uyvy_ : bgra_) = std::move(data);
+  return true;
+}
+
+// "bars" scrolls colour bars under a bouncing white box: flat areas, hard
+// edges and motion. "noise" is the worst case for edge detection and
+// tracing.
+void SyntheticFrameSource::RenderPattern() {
+  static const uint8_t kBars[8][3] = {
+      {235, 235, 235}, {16, 235, 235}, {235, 235, 16}, {16, 235, 16},
+      {235, 16, 235}, {16, 16, 235}, {235, 16, 16}, {16, 16, 16},
+  };
+  const int w = options_.width;
+  const int h = options_.height;
+  frame_count_ = std::max(options_.pattern_frames, 1);
+  size_t frame_bytes = static_cast<size_t>(w) * h * 4;
+  bgra_.assign(frame_bytes * frame_count_, 0);
+  uint32_t seed = 12345;
+  for (int f = 0; f < frame_count_; ++f) {
+    uint8_t* frame = &bgra_[f * frame_bytes];
+    int shift = f * w / frame_count_;
+    int box = std::max(std::min(w, h) / 6, 1);
+    int box_x = (w - box) * f / frame_count_;
+    int box_y = (h - box) / 2;
+    for (int y = 0; y < h; ++y) {
+      uint8_t* row = frame + static_cast<size_t>(y) * w * 4;
+      for (int x = 0; x < w; ++x) {
+        uint8_t* p = row + x * 4;
+        if (options_.pattern == "noise") {
+          seed = seed * 1664525u + 1013904223u;
+          p[0] = static_cast<uint8_t>(seed >> 24);
+          p[1] = static_cast<uint8_t>(seed >> 16);
+          p[2] = static_cast<uint8_t>(seed >> 8);
+        } else {
+          bool in_box = x >= box_x && x < box_x + box && y >= box_y && y < box_y + box;
+          const uint8_t* bar = kBars[((x + shift) % w) * 8 / w];
+          p[0] = in_box ? 255 : bar[2];
+          p[1] = in_box ? 255 : bar[1];
+          p[2] = in_box ? 255 : bar[0];
+        }
+        p[3] = 255;
+      }
+    }
+  }
+}
+
+// One frame's worth of the tone, continuing its phase; unpaced captures
+// count as 60 fps.
+void SyntheticFrameSource::PlayTone(double fps, AudioAnalyzer* audio) {
+  const int samples = static_cast<int>(kToneSampleRate / (fps > 0 ? fps : 60.0));
+  tone_.resize(static_cast<size_t>(samples) * 2);
+  const double two_pi = 2 * 3.14159265358979323846;
+  const double step = two_pi * options_.tone_hz / kToneSampleRate;
+  for (int i = 0; i < samples; ++i) {
+    float v = static_cast<float>(0.5 * std::sin(tone_phase_ + step * i));
+    tone_[i] = v;
+    tone_[samples + i] = v;
+  }
+  int64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count() * 10;
+  audio->Process(tone_.data(), 2, samples, samples, kToneSampleRate, timestamp);
+  tone_phase_ = std::fmod(tone_phase_ + step * samples, two_pi);
+}
+
+const std::vector<uint8_t>& SyntheticFrameSource::FramesIn(PixelLayout layout) {
+  size_t pixels = static_cast<size_t>(options_.width) * options_.height * frame_count_;
+  if (layout == PixelLayout::kUyvy && uyvy_.empty()) {
+    uyvy_.resize(pixels * 2);
+    BgraToUyvy(bgra_.data(), pixels, uyvy_.data());
+  } else if (layout == PixelLayout::kBgra && bgra_.empty()) {
+    bgra_.resize(pixels * 4);
+    UyvyToBgra(uyvy_.data(), pixels, bgra_.data());
+  }
+  return layout == PixelLayout::kUyvy ? uyvy_ : bgra_;
+}
+
+CaptureResult SyntheticFrameSource::Capture(const CaptureRequest& request, int timeout_ms, SourceFrame* frame) {
+  if (frame_count_ == 0) return CaptureResult::kError;
+
+  // A frame-sync request paces delivery at the output rate instead.
+  double fps = request.frame_sync_fps > 0 ? request.frame_sync_fps : options_.fps;
+  if (fps > 0) {
+    Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    Clock::time_point now = Clock::now();
+    if (!started_) {
+      started_ = true;
+      next_due_ = now;
+    }
+    if (next_due_ > now) {
+      Clock::time_point limit = now + std::chrono::milliseconds(timeout_ms);
+      if (next_due_ > limit) {
+        std::this_thread::sleep_until(limit);
+        return CaptureResult::kTimeout;
+      }
+      std::this_thread::sleep_until(next_due_);
+    }
+    next_due_ += period;
+    // After a stall, restart the grid rather than bursting to catch up.
+    if (next_due_ + period < Clock::now()) next_due_ = Clock::now();
+  }
+
+  if (request.audio && options_.tone_hz > 0) PlayTone(fps, request.audio);
+
+  PixelLayout layout = request.accepts_uyvy ? PixelLayout::kUyvy : PixelLayout::kBgra;
+  const std::vector<uint8_t>& frames = FramesIn(layout);
+  delivering_uyvy_ = layout == PixelLayout::kUyvy;
+  int stride = options_.width * BytesPerPixel(layout);
+  frame->data = frames.data() + static_cast<size_t>(next_frame_) * stride * options_.height;
+  frame->width = options_.width;
+  frame->height = options_.height;
+  frame->stride = stride;
+  frame->layout = layout;
+  frame->timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count() * 10;
+  frame->frame_rate_n = fps > 0 ? static_cast<int>(fps * 1000 + 0.5) : 0;
+  frame->frame_rate_d = 1000;
+  frame->paced = request.frame_sync_fps > 0;
+  next_frame_ = (next_frame_ + 1) % frame_count_;
+  return CaptureResult::kFrame;
+}
+
+void SyntheticFrameSource::Release(SourceFrame* frame) {
+  frame->data = nullptr;
+}
+
+SourceStatus SyntheticFrameSource::status() const {
+  SourceStatus status;
+  status.uyvy = delivering_uyvy_.load();
+  return status;
+}
@@ -0,0 +1,72 @@
+#ifndef TRUELAZER_NATIVE_SRC_SYNTHETIC_FRAME_SOURCE_H_
+#define TRUELAZER_NATIVE_SRC_SYNTHETIC_FRAME_SOURCE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "frame_source.h"
+
+// Settings of a SyntheticFrameSource, usually parsed from a source name
+// such as "synthetic:pattern=bars,size=1920x1080,fps=60" or
+// "synthetic:file=clip.uyvy,size=1280x720,layout=uyvy".
+struct SyntheticOptions {
+  std::string pattern = "bars";  // "bars" or "noise"; ignored with a file
+  std::string file;              // raw frames back to back, replayed in a loop
+  PixelLayout file_layout = PixelLayout::kBgra;
+  int width = 1920;
+  int height = 1080;
+  double fps = 60;  // 0 delivers frames as fast as they are taken
+  int pattern_frames = 8;  // distinct pattern frames rendered up front
+  double tone_hz = 0;      // > 0: a 48 kHz stereo sine comes with every frame
+};
+
+constexpr char kSyntheticPrefix[] = "synthetic:";
+
+bool IsSyntheticSourceName(const std::string& name);
+// Parses comma-separated key=value pairs after kSyntheticPrefix. Keys:
+// pattern, file, layout (bgra|uyvy, of the file), size (WxH), fps and
+// tone (Hz).
+// Returns false and explains why in |error| on bad input.
+bool ParseSyntheticSourceName(const std::string& name, SyntheticOptions* options, std::string* error);
+
+// Generates moving test patterns or replays raw frame files at a fixed
+// rate, without NDI, so the capture path can be tested and benchmarked
+// anywhere. Frames are prepared in Open() and converted once to UYVY or
+// BGRA on demand, so Capture() costs nothing but the pacing; like an NDI
+// sender, it delivers UYVY whenever the request accepts it.
+class SyntheticFrameSource : public FrameSource {
+ public:
+  explicit SyntheticFrameSource(SyntheticOptions options);
+
+  bool Open(const CaptureRequest& request) override;
+  CaptureResult Capture(const CaptureRequest& request, int timeout_ms, SourceFrame* frame) override;
+  void Release(SourceFrame* frame) override;
+
+  SourceStatus status() const override;
+
+  int frame_count() const { return frame_count_; }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  bool LoadFile();
+  void RenderPattern();
+  void PlayTone(double fps, AudioAnalyzer* audio);
+  const std::vector<uint8_t>& FramesIn(PixelLayout layout);
+
+  const SyntheticOptions options_;
+  int frame_count_ = 0;
+  int next_frame_ = 0;
+  std::vector<uint8_t> bgra_;  // frame_count_ frames each, built lazily
+  std::vector<uint8_t> uyvy_;
+  std::atomic<bool> delivering_uyvy_{false};
+  Clock::time_point next_due_{};
+  bool started_ = false;
+  std::vector<float> tone_;  // planar, one frame's worth
+  double tone_phase_ = 0;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_SYNTHETIC_FRAME_SOURCE_H_
@@ -0,0 +1,53 @@
+#ifndef TRUELAZER_NATIVE_SRC_TRIPLE_BUFFER_H_
+#define TRUELAZER_NATIVE_SRC_TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+
+// Wait-free single-producer/single-consumer triple buffer.
+//
+// The writer owns the back slot and the reader owns the front slot; the third
+// ("middle") slot is exchanged atomically between them. The middle index
+// carries a fresh bit so the reader can tell whether the writer published
+// something since its last Update(). Neither side ever waits on the other, and
+// the writer can never overwrite the slot the reader is looking at.
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Writer side. Fill write_slot(), then Publish() to make it the newest frame.
+  T& write_slot() { return slots_[back_]; }
+  void Publish() {
+    back_ = middle_.exchange(static_cast<uint8_t>(back_ | kFreshBit), std::memory_order_acq_rel) & kIndexMask;
+  }
+
+  // Reader side. Returns true and swaps in the newest frame if one was
+  // published since the last call; read_slot() stays valid until then.
+  bool Update() {
+    if (!HasFresh()) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+  bool HasFresh() const {
+    return (middle_.load(std::memory_order_relaxed) & kFreshBit) != 0;
+  }
+  T& read_slot() { return slots_[front_]; }
+  const T& read_slot() const { return slots_[front_]; }
+
+  // Not thread-safe; for sizing slots before the threads start.
+  T& slot(int i) { return slots_[i]; }
+
+ private:
+  static constexpr uint8_t kIndexMask = 0x3;
+  static constexpr uint8_t kFreshBit = 0x4;
+
+  T slots_[3];
+  uint8_t back_ = 0;
+  std::atomic<uint8_t> middle_{1};
+  uint8_t front_ = 2;
+};
+
+#endif  // TRUELAZER_NATIVE_SRC_TRIPLE_BUFFER_H_
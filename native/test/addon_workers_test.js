@@ -0,0 +1,86 @@
+// Loads the addon in the main thread and in several worker threads at once,
+// each capturing from its own synthetic source, then checks that the main
+// thread's instance still works after the workers have exited and torn
+// their instances down.
+import { createRequire } from 'module';
+import path from 'path';
+import { fileURLToPath } from 'url';
+import { Worker, isMainThread, parentPort, workerData } from 'worker_threads';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const require = createRequire(import.meta.url);
+const addon = require(path.join(__dirname, '..', 'build', 'Release', 'ndi_wrapper.node'));
+
+const sleep = (ms) => new Promise(resolve => setTimeout(resolve, ms));
+
+async function captureOnce(ndi, source) {
+    if (!ndi.createReceiver(source)) return false;
+    ndi.startCapture(source, 32, 32, { pooled: false });
+    let frame = null;
+    for (let i = 0; i < 200 && !frame; i++) {
+        frame = ndi.captureVideo(source);
+        if (!frame) await sleep(5);
+    }
+    ndi.destroyReceiver(source);
+    return !!frame && frame.width === 32 && frame.height === 32 && frame.data.length === 32 * 32 * 4;
+}
+
+// Pooled capture hands out views of a fixed set of ArrayBuffers that the
+// capture thread refills once frameDone() returns them. Only frames written
+// before the buffers existed (the first, and at most the two the capture
+// thread had in hand) are copies.
+async function capturePooled(ndi, source) {
+    if (!ndi.createReceiver(source)) return false;
+    ndi.startCapture(source, 32, 32, { pooled: true });
+    const buffers = new Set();
+    let frames = 0;
+    for (let i = 0; i < 2000 && frames < 20; i++) {
+        const frame = ndi.captureVideo(source);
+        if (!frame) {
+            await sleep(1);
+            continue;
+        }
+        if (frame.data.length !== 32 * 32 * 4) return false;
+        buffers.add(frame.data.buffer);
+        frames++;
+        ndi.frameDone(source);
+    }
+    const stats = ndi.getFramePoolStats(source);
+    ndi.destroyReceiver(source);
+    return frames === 20 && stats.copies <= 3 && buffers.size <= 4 + stats.copies;
+}
+
+async function exercise(index) {
+    const ndi = new addon.NdiWrapper();
+    // Touches the NDI runtime when installed, so workers really share it.
+    const capabilities = ndi.getCapabilities();
+    if (capabilities.ndi) await ndi.findSources();
+    return captureOnce(ndi, `synthetic:pattern=bars,size=${64 + 2 * index}x36,fps=0`);
+}
+
+function report(name, ok) {
+    console.log(`${name.padEnd(40)} ${ok ? 'OK' : 'FAIL'}`);
+    return ok;
+}
+
+if (!isMainThread) {
+    parentPort.postMessage(await exercise(workerData.index));
+} else {
+    const main = new addon.NdiWrapper();
+    main.getCapabilities();
+
+    const workers = [1, 2, 3].map(index => new Promise(resolve => {
+        const worker = new Worker(fileURLToPath(import.meta.url), { workerData: { index } });
+        let ok = false;
+        worker.on('message', result => { ok = result; });
+        worker.on('error', error => { console.error(error); resolve(false); });
+        worker.on('exit', code => resolve(ok && code === 0));
+    }));
+    let ok = report('capture in three worker threads', (await Promise.all(workers)).every(Boolean));
+
+    // Worker teardown must not have destroyed NDI under the main thread.
+    ok = report('main thread capture after workers exit', await captureOnce(main, 'synthetic:size=64x36,fps=0')) && ok;
+    ok = report('second instance on the main thread', await exercise(0)) && ok;
+    ok = report('pooled frames recycle their buffers', await capturePooled(main, 'synthetic:size=64x36,fps=0')) && ok;
+    process.exit(ok ? 0 : 1);
+}
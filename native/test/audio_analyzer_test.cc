@@ -0,0 +1,126 @@
+// Checks that AudioAnalyzer puts tones into the right band and spectrum
+// bin, stays silent on silence, mixes planar channels down, and publishes
+// every analysis to a reader on another thread.
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "audio_analyzer.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+constexpr int kSampleRate = 48000;
+constexpr int kFrameSamples = 1600;  // one 30 fps video frame
+
+// |channels| planes of a sine at |hz|, the second plane inverted if
+// |opposed|, so a downmix cancels it.
+std::vector<float> Tone(double hz, float amplitude, int channels, bool opposed, int frame) {
+  std::vector<float> data(static_cast<size_t>(channels) * kFrameSamples);
+  for (int i = 0; i < kFrameSamples; ++i) {
+    double t = static_cast<double>(frame * kFrameSamples + i) / kSampleRate;
+    float v = amplitude * static_cast<float>(std::sin(2 * 3.14159265358979323846 * hz * t));
+    for (int c = 0; c < channels; ++c) data[c * kFrameSamples + i] = opposed && c == 1 ? -v : v;
+  }
+  return data;
+}
+
+AudioBands Feed(AudioAnalyzer* analyzer, double hz, int frames, float amplitude = 0.5f, int channels = 2,
+                bool opposed = false) {
+  for (int f = 0; f < frames; ++f) {
+    std::vector<float> data = Tone(hz, amplitude, channels, opposed, f);
+    analyzer->Process(data.data(), channels, kFrameSamples, kFrameSamples, kSampleRate, f);
+  }
+  return analyzer->bands();
+}
+
+bool TestBands() {
+  bool ok = true;
+  AudioAnalyzer low;
+  AudioBands bands = Feed(&low, 100, 10);
+  ok = ok && bands.low > 0.5f && bands.low > bands.mid && bands.mid > bands.high;
+  AudioAnalyzer mid;
+  bands = Feed(&mid, 1000, 10);
+  ok = ok && bands.mid > bands.low && bands.mid > bands.high;
+  AudioAnalyzer high;
+  bands = Feed(&high, 9000, 10);
+  ok = ok && bands.high > bands.low && bands.high > bands.mid;
+  // A full-scale 0.5 sine has an RMS of 0.5 / sqrt(2).
+  ok = ok && std::fabs(bands.rms - 0.3536f) < 0.01f && bands.sequence == 10 && bands.timestamp == 9;
+  return Report("tones land in their bands", ok);
+}
+
+bool TestSpectrum() {
+  // Quiet enough to stay under max_db, so the tone's bin stands out.
+  AudioAnalyzer analyzer;
+  Feed(&analyzer, 1500, 10, 0.01f);
+  const AudioLevels& levels = analyzer.Latest();
+  size_t loudest = 0;
+  for (size_t k = 1; k < levels.spectrum.size(); ++k) {
+    if (levels.spectrum[k] > levels.spectrum[loudest]) loudest = k;
+  }
+  // 1500 Hz over 48 kHz / 2048 bins is bin 64.
+  bool ok = levels.spectrum.size() == 1024 && loudest == 64 && levels.sample_rate == kSampleRate &&
+            levels.bands.sequence == 10;
+
+  AudioOptions options;
+  options.fft_size = 512;
+  options.peak = true;
+  analyzer.Configure(options);
+  Feed(&analyzer, 1500, 4, 0.01f);
+  const AudioLevels& smaller = analyzer.Latest();
+  // In peak mode the band is its loudest bin, here the tone's.
+  ok = ok && smaller.spectrum.size() == 256 && smaller.bands.mid > 0.5f && smaller.bands.mid == smaller.spectrum[16];
+  return Report("spectrum bins and options", ok);
+}
+
+bool TestSilence() {
+  AudioAnalyzer analyzer;
+  AudioBands bands = Feed(&analyzer, 0, 5);
+  bool ok = bands.low == 0.0f && bands.mid == 0.0f && bands.high == 0.0f && bands.rms == 0.0f;
+  // Opposite channels cancel in the mono downmix.
+  AudioAnalyzer opposed;
+  bands = Feed(&opposed, 440, 5, 0.5f, 2, true);
+  ok = ok && bands.rms == 0.0f && bands.mid == 0.0f;
+  return Report("silence and downmix", ok);
+}
+
+bool TestPublish() {
+  AudioAnalyzer analyzer;
+  bool ok = analyzer.Latest().bands.sequence == 0;
+  constexpr int kFrames = 2000;
+  std::atomic<bool> done{false};
+  std::thread producer([&] {
+    Feed(&analyzer, 440, kFrames);
+    done = true;
+  });
+  uint64_t last = 0;
+  bool ordered = true;
+  while (!done) {
+    const AudioLevels& levels = analyzer.Latest();
+    ordered = ordered && levels.bands.sequence >= last && (levels.bands.sequence == 0 || levels.spectrum.size() == 1024);
+    last = levels.bands.sequence;
+  }
+  producer.join();
+  ok = ok && ordered && analyzer.Latest().bands.sequence == kFrames;
+  return Report("snapshots reach another thread", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestBands() && ok;
+  ok = TestSpectrum() && ok;
+  ok = TestSilence() && ok;
+  ok = TestPublish() && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Checks that auto bandwidth picks the proxy stream for small targets,
+// switches with hysteresis instead of flapping around a single size, and
+// gives up the proxy when a sender's proxy is smaller than the target.
+
+#include <cstdio>
+
+#include "bandwidth_policy.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+bool TestFixedModes() {
+  BandwidthPolicy policy;
+  bool ok = policy.Update(RecvBandwidth::kLowest, 1920, 1080);
+  ok = ok && !policy.Update(RecvBandwidth::kHighest, 64, 64);
+  return Report("fixed highest/lowest ignore the target", ok);
+}
+
+bool TestSmallTargets() {
+  BandwidthPolicy policy;
+  bool ok = policy.Update(RecvBandwidth::kAuto, 480, 480);
+  ok = ok && policy.proxy();
+  ok = ok && !policy.Update(RecvBandwidth::kAuto, 1280, 720);
+  ok = ok && !policy.Update(RecvBandwidth::kAuto, 0, 0);
+  return Report("480x480 proxy, 720p and native full", ok);
+}
+
+bool TestHysteresis() {
+  BandwidthPolicy policy;
+  // Growing from full bandwidth: 600 is not small enough to enter.
+  bool ok = !policy.Update(RecvBandwidth::kAuto, 600, 600);
+  ok = ok && policy.Update(RecvBandwidth::kAuto, 480, 270);
+  // Once on the proxy, anything up to 640 stays there.
+  ok = ok && policy.Update(RecvBandwidth::kAuto, 600, 600);
+  ok = ok && policy.Update(RecvBandwidth::kAuto, 640, 360);
+  ok = ok && !policy.Update(RecvBandwidth::kAuto, 641, 360);
+  ok = ok && !policy.Update(RecvBandwidth::kAuto, 600, 600);
+  return Report("enter at 480, leave above 640", ok);
+}
+
+bool TestSmallProxy() {
+  BandwidthPolicy policy;
+  bool ok = policy.Update(RecvBandwidth::kAuto, 400, 400);
+  policy.ObserveProxyFrame(320, 180);
+  ok = ok && !policy.Update(RecvBandwidth::kAuto, 400, 400);
+  ok = ok && !policy.Update(RecvBandwidth::kAuto, 400, 400);
+  ok = ok && policy.Update(RecvBandwidth::kAuto, 320, 320);
+  return Report("proxy smaller than the target", ok);
+}
+
+bool TestNames() {
+  RecvBandwidth parsed;
+  bool ok = ParseRecvBandwidth("lowest", &parsed) && parsed == RecvBandwidth::kLowest &&
+            ParseRecvBandwidth("auto", &parsed) && parsed == RecvBandwidth::kAuto &&
+            !ParseRecvBandwidth("proxy", &parsed) &&
+            RecvBandwidthName(RecvBandwidth::kHighest) == std::string("highest");
+  return Report("bandwidth names", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestFixedModes() && ok;
+  ok = TestSmallTargets() && ok;
+  ok = TestHysteresis() && ok;
+  ok = TestSmallProxy() && ok;
+  ok = TestNames() && ok;
+  return ok ? 0 : 1;
+}
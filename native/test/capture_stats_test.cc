@@ -0,0 +1,95 @@
+// Checks the capture telemetry histograms: bucket edges, percentile
+// estimates, merging, and that concurrent recording loses no samples.
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "capture_stats.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+bool TestBuckets() {
+  bool ok = Histogram::BucketFor(0) == 0 && Histogram::BucketFor(1) == 1 &&
+            Histogram::BucketFor(2) == 2 && Histogram::BucketFor(3) == 2 &&
+            Histogram::BucketFor(1024) == 11 && Histogram::BucketFor(UINT64_MAX) == HistogramSnapshot::kBuckets - 1;
+  // Every value lies below its bucket's limit.
+  for (uint64_t v : {0ull, 1ull, 7ull, 8ull, 16666ull, 1ull << 40}) {
+    ok = ok && v < Histogram::BucketLimit(Histogram::BucketFor(v));
+  }
+  return Report("bucket edges", ok);
+}
+
+bool TestPercentiles() {
+  Histogram histogram;
+  bool ok = histogram.Snapshot().Percentile(50) == 0;
+  // 90 fast frames around 0.6 ms, 10 slow ones around 20 ms.
+  for (int i = 0; i < 90; ++i) histogram.Record(600 + i);
+  for (int i = 0; i < 10; ++i) histogram.Record(20000 + i);
+  HistogramSnapshot s = histogram.Snapshot();
+  ok = ok && s.count == 100 && s.max == 20009;
+  ok = ok && s.Percentile(50) == 1024 && s.Percentile(90) == 1024;
+  ok = ok && s.Percentile(99) == 20009;  // capped at the max
+  ok = ok && s.mean() > 2580 && s.mean() < 2581;
+  histogram.Reset();
+  ok = ok && histogram.Snapshot().count == 0 && histogram.Snapshot().max == 0;
+  return Report("percentiles, mean, reset", ok);
+}
+
+bool TestMerge() {
+  CaptureStats a;
+  CaptureStats b;
+  a.AddReceived();
+  a.AddDropped(3);
+  a.SetQueueDepth(2);
+  a.process_us().Record(500);
+  b.AddReceived();
+  b.AddOverwritten();
+  b.AddUnchanged();
+  b.SetQueueDepth(5);
+  b.SetQueueDepth(1);
+  b.process_us().Record(4000);
+  CaptureStatsSnapshot s = a.Snapshot();
+  s.Merge(b.Snapshot());
+  bool ok = s.received == 2 && s.dropped == 3 && s.overwritten == 1 && s.unchanged == 1 && s.queue_depth == 3 &&
+            s.max_queue_depth == 5 && s.process_us.count == 2 && s.process_us.max == 4000;
+  return Report("merge across receivers", ok);
+}
+
+bool TestConcurrentRecord() {
+  // One capture thread records while another reads, as with getStats().
+  Histogram histogram;
+  constexpr int kSamples = 200000;
+  std::thread writer([&] {
+    for (int i = 0; i < kSamples; ++i) histogram.Record(static_cast<uint64_t>(i % 5000));
+  });
+  uint64_t last = 0;
+  bool monotonic = true;
+  for (int i = 0; i < 1000; ++i) {
+    uint64_t count = histogram.Snapshot().count;
+    monotonic = monotonic && count >= last;
+    last = count;
+  }
+  writer.join();
+  HistogramSnapshot s = histogram.Snapshot();
+  uint64_t in_buckets = 0;
+  for (uint64_t bucket : s.buckets) in_buckets += bucket;
+  return Report("concurrent record and read", monotonic && s.count == kSamples && in_buckets == kSamples && s.max == 4999);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestBuckets() && ok;
+  ok = TestPercentiles() && ok;
+  ok = TestMerge() && ok;
+  ok = TestConcurrentRecord() && ok;
+  return ok ? 0 : 1;
+}
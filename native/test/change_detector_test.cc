@@ -0,0 +1,113 @@
+// Checks that ChangeDetector flags first and resized frames whole, ignores
+// repeats and noise under the threshold, reports changed tiles as merged
+// rects, and catches slow drifts against its reference.
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "change_detector.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+constexpr int kWidth = 100;  // not a multiple of the tile size
+constexpr int kHeight = 40;
+
+std::vector<uint8_t> Gradient() {
+  std::vector<uint8_t> frame(kWidth * kHeight * 4);
+  for (size_t i = 0; i < frame.size(); ++i) frame[i] = static_cast<uint8_t>(i * 7);
+  return frame;
+}
+
+void Fill(std::vector<uint8_t>* frame, int x0, int y0, int x1, int y1, uint8_t value) {
+  for (int y = y0; y < y1; ++y) {
+    for (int x = x0 * 4; x < x1 * 4; ++x) (*frame)[y * kWidth * 4 + x] = value;
+  }
+}
+
+bool Same(const DirtyRect& rect, int x, int y, int width, int height) {
+  return rect.x == x && rect.y == y && rect.width == width && rect.height == height;
+}
+
+bool TestStatic() {
+  ChangeDetector detector;
+  std::vector<DirtyRect> dirty;
+  std::vector<uint8_t> frame = Gradient();
+  bool ok = detector.Update(frame.data(), kWidth, kHeight, kWidth * 4, 4, 2, &dirty);
+  ok = ok && dirty.size() == 1 && Same(dirty[0], 0, 0, kWidth, kHeight);
+  ok = ok && !detector.Update(frame.data(), kWidth, kHeight, kWidth * 4, 4, 2, &dirty) && dirty.empty();
+  // Compression noise of +-1 stays under a threshold of 2.
+  for (size_t i = 0; i < frame.size(); i += 3) frame[i] = static_cast<uint8_t>(frame[i] ^ 1);
+  ok = ok && !detector.Update(frame.data(), kWidth, kHeight, kWidth * 4, 4, 2, &dirty);
+  ok = ok && detector.Update(frame.data(), kWidth, kHeight, kWidth * 4, 4, 0, &dirty);
+  // A new size starts over.
+  ok = ok && detector.Update(frame.data(), kWidth / 2, kHeight, kWidth * 4, 4, 2, &dirty) &&
+       dirty.size() == 1 && Same(dirty[0], 0, 0, kWidth / 2, kHeight);
+  return Report("repeats, noise and resizes", ok);
+}
+
+bool TestDirtyRects() {
+  ChangeDetector detector;
+  std::vector<DirtyRect> dirty;
+  std::vector<uint8_t> frame = Gradient();
+  detector.Update(frame.data(), kWidth, kHeight, kWidth * 4, 4, 2, &dirty);
+
+  // A block across tiles 1-2 on tile rows 0-1, and one pixel in the ragged
+  // last tile.
+  Fill(&frame, 20, 5, 40, 20, 255);
+  Fill(&frame, 99, 39, 100, 40, 0);
+  frame[(39 * kWidth + 99) * 4] ^= 0xff;
+  bool ok = detector.Update(frame.data(), kWidth, kHeight, kWidth * 4, 4, 0, &dirty);
+  ok = ok && dirty.size() == 2 && Same(dirty[0], 16, 0, 32, 32) && Same(dirty[1], 96, 32, 4, 8);
+  ok = ok && !detector.Update(frame.data(), kWidth, kHeight, kWidth * 4, 4, 0, &dirty);
+  return Report("dirty tiles merge into rects", ok);
+}
+
+bool TestManyRects() {
+  ChangeDetector detector;
+  std::vector<DirtyRect> dirty;
+  std::vector<uint8_t> mask(256 * 256);
+  detector.Update(mask.data(), 256, 256, 256, 1, 0, &dirty);
+  // A checkerboard of tiles cannot merge and collapses to its bounds.
+  for (int ty = 0; ty < 16; ++ty) {
+    for (int tx = (ty & 1); tx < 16; tx += 2) mask[(ty * 16 + 3) * 256 + tx * 16 + 3] = 200;
+  }
+  bool ok = detector.Update(mask.data(), 256, 256, 256, 1, 0, &dirty);
+  ok = ok && dirty.size() == 1 && Same(dirty[0], 0, 0, 256, 256);
+  return Report("too many rects collapse to bounds", ok);
+}
+
+bool TestDrift() {
+  ChangeDetector detector;
+  std::vector<DirtyRect> dirty;
+  std::vector<uint8_t> mask(64 * 64, 100);
+  detector.Update(mask.data(), 64, 64, 64, 1, 4, &dirty);
+  // One level per frame never crosses the threshold frame to frame, but
+  // does against the reference.
+  bool changed = false;
+  int frames = 0;
+  while (!changed && frames < 10) {
+    for (uint8_t& v : mask) ++v;
+    changed = detector.Update(mask.data(), 64, 64, 64, 1, 4, &dirty);
+    ++frames;
+  }
+  bool ok = changed && frames == 5 && dirty.size() == 1 && Same(dirty[0], 0, 0, 64, 64);
+  ok = ok && !detector.Update(mask.data(), 64, 64, 64, 1, 4, &dirty);
+  return Report("slow drift is caught", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestStatic() && ok;
+  ok = TestDirtyRects() && ok;
+  ok = TestManyRects() && ok;
+  ok = TestDrift() && ok;
+  return ok ? 0 : 1;
+}
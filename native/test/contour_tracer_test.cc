@@ -0,0 +1,217 @@
+// Checks the contour tracer on shapes with a known outline (rectangle, ring,
+// saddle, specks) and that it holds the point budget on a busy frame.
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "contour_tracer.h"
+
+namespace {
+
+struct Mask {
+  int width;
+  int height;
+  std::vector<uint8_t> data;
+
+  Mask(int w, int h) : width(w), height(h), data(static_cast<size_t>(w) * h, 0) {}
+  void Fill(int x0, int y0, int x1, int y1, uint8_t value = 0xFF) {
+    for (int y = y0; y < y1; ++y) {
+      for (int x = x0; x < x1; ++x) data[y * width + x] = value;
+    }
+  }
+  void Disc(float cx, float cy, float r, bool on = true) {
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        float dx = x - cx, dy = y - cy;
+        if (dx * dx + dy * dy <= r * r) data[y * width + x] = on ? 0xFF : 0;
+      }
+    }
+  }
+};
+
+struct Path {
+  std::vector<float> points;
+  TraceStats stats;
+
+  size_t size() const { return points.size() / 8; }
+  const float* at(size_t i) const { return &points[i * 8]; }
+};
+
+Path Trace(const Mask& mask, TraceOptions options = TraceOptions()) {
+  Path path;
+  TraceScratch scratch;
+  path.stats = TraceContours(mask.data.data(), mask.width, mask.height, nullptr, 0, options, &scratch, &path.points);
+  return path;
+}
+
+bool Report(const char* name, bool ok, const Path& path) {
+  std::printf("%-28s contours=%-4d dropped=%-4d points=%-5zu eps=%.2f %s\n", name,
+      path.stats.contours, path.stats.dropped, path.size(), path.stats.epsilon, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+// Layout invariants every path must satisfy: whole points, coordinates in
+// range, only the final point flagged last, visible runs closed.
+bool WellFormed(const Path& path) {
+  if (path.points.size() % 8 != 0) return false;
+  for (size_t i = 0; i < path.size(); ++i) {
+    const float* p = path.at(i);
+    if (std::fabs(p[0]) > 1.0f || std::fabs(p[1]) > 1.0f) return false;
+    bool last = p[7] != 0.0f;
+    if (last != (i + 1 == path.size())) return false;
+    if (p[6] != 0.0f && (p[3] != 0.0f || p[4] != 0.0f || p[5] != 0.0f)) return false;
+  }
+  size_t run_start = 0;
+  for (size_t i = 0; i <= path.size(); ++i) {
+    bool visible = i < path.size() && path.at(i)[6] == 0.0f;
+    if (visible) continue;
+    if (i > run_start) {
+      const float* a = path.at(run_start);
+      const float* b = path.at(i - 1);
+      if (a[0] != b[0] || a[1] != b[1]) return false;
+    }
+    run_start = i + 1;
+  }
+  return true;
+}
+
+size_t VisiblePoints(const Path& path) {
+  size_t n = 0;
+  for (size_t i = 0; i < path.size(); ++i) n += path.at(i)[6] == 0.0f;
+  return n;
+}
+
+bool TestRectangle() {
+  Mask mask(64, 48);
+  mask.Fill(10, 8, 30, 20);
+  Path path = Trace(mask);
+  bool ok = WellFormed(path) && path.stats.contours == 1;
+  // Every vertex must sit on the rectangle outline, half a pixel outside the
+  // filled pixel centres.
+  for (size_t i = 0; ok && i < path.size(); ++i) {
+    float px = (path.at(i)[0] + 1.0f) * mask.width / 2;
+    float py = (1.0f - path.at(i)[1]) * mask.height / 2;
+    bool on_x = px >= 9.0f && px <= 30.0f;
+    bool on_y = py >= 7.0f && py <= 20.0f;
+    ok = on_x && on_y;
+  }
+  // A simplified rectangle has a handful of vertices, not its perimeter.
+  ok = ok && VisiblePoints(path) <= 12;
+  return Report("rectangle", ok, path);
+}
+
+bool TestRing() {
+  Mask mask(80, 80);
+  mask.Disc(40, 40, 30);
+  mask.Disc(40, 40, 15, false);
+  Path path = Trace(mask);
+  return Report("ring (outer + hole)", WellFormed(path) && path.stats.contours == 2, path);
+}
+
+bool TestSaddle() {
+  // Two squares touching only at a corner must stay separate contours.
+  Mask mask(32, 32);
+  mask.Fill(4, 4, 12, 12);
+  mask.Fill(12, 12, 20, 20);
+  Path path = Trace(mask);
+  return Report("corner-touching squares", WellFormed(path) && path.stats.contours == 2, path);
+}
+
+bool TestSpecks() {
+  Mask mask(64, 64);
+  mask.Fill(5, 5, 6, 6);
+  mask.Fill(40, 10, 41, 11);
+  mask.Fill(20, 20, 40, 40);
+  Path path = Trace(mask);
+  bool ok = WellFormed(path) && path.stats.contours == 1 && path.stats.dropped == 2;
+  return Report("specks dropped", ok, path);
+}
+
+bool TestEmptyAndFull() {
+  Mask empty(16, 16);
+  Path none = Trace(empty);
+  Mask full(16, 16);
+  full.Fill(0, 0, 16, 16);
+  Path border = Trace(full);
+  bool ok = none.points.empty() && WellFormed(border) && border.stats.contours == 1;
+  return Report("empty and full frame", ok, border);
+}
+
+bool TestColors() {
+  Mask mask(32, 32);
+  mask.Fill(8, 8, 24, 24);
+  std::vector<uint8_t> bgra(32 * 32 * 4);
+  for (size_t i = 0; i < bgra.size(); i += 4) {
+    bgra[i] = 10;
+    bgra[i + 1] = 20;
+    bgra[i + 2] = 30;
+  }
+  Path path;
+  TraceScratch scratch;
+  path.stats = TraceContours(mask.data.data(), 32, 32, bgra.data(), 32 * 4, TraceOptions(), &scratch, &path.points);
+  bool ok = WellFormed(path);
+  for (size_t i = 0; ok && i < path.size(); ++i) {
+    const float* p = path.at(i);
+    if (p[6] == 0.0f) ok = p[3] == 30.0f && p[4] == 20.0f && p[5] == 10.0f;
+  }
+  return Report("colours from BGRA", ok, path);
+}
+
+Mask BusyMask(int width, int height) {
+  Mask mask(width, height);
+  std::mt19937 rng(7);
+  for (int i = 0; i < 400; ++i) {
+    float cx = static_cast<float>(rng() % width);
+    float cy = static_cast<float>(rng() % height);
+    float r = 2.0f + static_cast<float>(rng() % 20);
+    mask.Disc(cx, cy, r, rng() % 3 != 0);
+  }
+  return mask;
+}
+
+bool TestBudget() {
+  Mask mask = BusyMask(480, 270);
+  bool ok = true;
+  for (int budget : {300, 2000, 8000}) {
+    TraceOptions options;
+    options.max_points = budget;
+    Path path = Trace(mask, options);
+    char name[32];
+    std::snprintf(name, sizeof(name), "busy frame, budget %d", budget);
+    ok = Report(name, WellFormed(path) && path.size() <= static_cast<size_t>(budget) && path.stats.contours > 0, path) && ok;
+  }
+  return ok;
+}
+
+void Benchmark() {
+  Mask mask = BusyMask(480, 480);
+  TraceScratch scratch;
+  std::vector<float> points;
+  TraceOptions options;
+  constexpr int kIterations = 50;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    TraceContours(mask.data.data(), 480, 480, nullptr, 0, options, &scratch, &points);
+  }
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / kIterations;
+  std::printf("480x480 busy frame: %.3f ms per trace, %zu points\n", ms, points.size() / 8);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestRectangle() && ok;
+  ok = TestRing() && ok;
+  ok = TestSaddle() && ok;
+  ok = TestSpecks() && ok;
+  ok = TestEmptyAndFull() && ok;
+  ok = TestColors() && ok;
+  ok = TestBudget() && ok;
+  Benchmark();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+// Checks EffectsEngine's stages against the arithmetic of the JS effects
+// they replace, including the float rounding between stages, across block
+// boundaries, and that malformed programs run nothing.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "effects_engine.h"
+#include "point_optimizer.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+// |count| visible white points along x from -1 to 1.
+std::vector<float> Line(size_t count) {
+  std::vector<float> points(count * kPointStride);
+  for (size_t i = 0; i < count; ++i) {
+    float* p = &points[i * kPointStride];
+    p[0] = static_cast<float>(-1.0 + 2.0 * static_cast<double>(i) / static_cast<double>(count));
+    p[1] = 0.25f;
+    p[2] = 0.5f;
+    p[3] = p[4] = p[5] = 255.0f;
+    p[7] = i + 1 == count ? 1.0f : 0.0f;
+  }
+  return points;
+}
+
+bool Run(const std::vector<double>& program, std::vector<float>* points) {
+  EffectsEngine engine;
+  if (!engine.Load(program.data(), program.size())) return false;
+  engine.Apply(points->data(), points->size() / kPointStride);
+  return true;
+}
+
+bool TestTransforms() {
+  // Rotate by 30 degrees, scale, translate, move: each stage rounds to
+  // float, as the Float32Array between the JS effects did.
+  const double angle = 30 * 3.14159265358979323846 / 180;
+  const double c = std::cos(angle);
+  const double s = std::sin(angle);
+  std::vector<float> points = Line(600);
+  const std::vector<float> original = points;
+  bool ok = Run({1, c, s, 2, 1.5, 0.5, 3, 0.1, -0.2, 11, 0.3, 0.0}, &points);
+  for (size_t i = 0; i < 600 && ok; ++i) {
+    const float* in = &original[i * kPointStride];
+    const float* out = &points[i * kPointStride];
+    float x = static_cast<float>(static_cast<double>(in[0]) * c - static_cast<double>(in[1]) * s);
+    float y = static_cast<float>(static_cast<double>(in[0]) * s + static_cast<double>(in[1]) * c);
+    x = static_cast<float>(x * 1.5);
+    y = static_cast<float>(y * 0.5);
+    x = static_cast<float>(x + 0.1);
+    y = static_cast<float>(y + -0.2);
+    double bx = std::fmod(x + 0.3 + 1, 4.0);
+    if (bx < 0) bx += 4;
+    if (bx > 2) bx = 4 - bx;
+    double by = std::fmod(y + 0.0 + 1, 4.0);
+    if (by < 0) by += 4;
+    if (by > 2) by = 4 - by;
+    ok = out[0] == static_cast<float>(bx - 1) && out[1] == static_cast<float>(by - 1);
+    // z, colour, blanking and the last-point flag are untouched.
+    ok = ok && out[2] == in[2] && out[3] == in[3] && out[6] == in[6] && out[7] == in[7];
+  }
+  return Report("transforms round between stages", ok);
+}
+
+bool TestAlongFrame() {
+  // Rainbow and blanking use the index in the whole frame, not the block.
+  std::vector<float> points = Line(1000);
+  bool ok = Run({5, 1.0, 0.0, 0.0, 12, 2.0, 4.0}, &points);
+  const float* first = &points[0];
+  const float* middle = &points[500 * kPointStride];
+  ok = ok && first[3] == 255.0f && first[4] == 0.0f && first[5] == 0.0f;
+  ok = ok && middle[3] == 0.0f && middle[4] == 255.0f && middle[5] == 255.0f;
+  ok = ok && points[254 * kPointStride + 6] == 1.0f && points[256 * kPointStride + 6] == 0.0f &&
+       points[259 * kPointStride + 6] == 1.0f;
+  return Report("stages along the frame span blocks", ok);
+}
+
+bool TestPalettes() {
+  // Red to blue over four points: the palette wraps back to red, the
+  // gradient does not.
+  std::vector<float> palette = Line(4);
+  bool ok = Run({7, 1.0, 0.0, 0.0, 2, 255, 0, 0, 0, 0, 255}, &palette);
+  ok = ok && palette[3] == 255.0f && palette[5] == 0.0f;
+  ok = ok && palette[kPointStride + 3] == 128.0f && palette[kPointStride + 5] == 128.0f;
+  ok = ok && palette[3 * kPointStride + 3] == 128.0f && palette[3 * kPointStride + 5] == 128.0f;
+
+  std::vector<float> gradient = Line(4);
+  ok = ok && Run({6, 1.0, 0.0, 0.0, 2, 255, 0, 0, 0, 0, 255}, &gradient);
+  ok = ok && gradient[3 * kPointStride + 3] == 64.0f && gradient[3 * kPointStride + 5] == 191.0f;
+
+  // A negative offset wraps rather than reading before the colours.
+  std::vector<float> negative = Line(4);
+  ok = ok && Run({6, 1.0, 0.0, -0.5, 2, 255, 0, 0, 0, 0, 255}, &negative);
+  ok = ok && negative[3] == 128.0f && negative[5] == 128.0f;
+  ok = ok && negative[2 * kPointStride + 3] == 255.0f && negative[2 * kPointStride + 5] == 0.0f;
+  return Report("palettes and gradients", ok);
+}
+
+bool TestWave() {
+  // The engine's own sine, which effects.js repeats bit for bit, stays
+  // within a float step of libm's in every quadrant and far from zero.
+  bool ok = true;
+  for (double shift : {0.0, 1.0, 2.5, -2.5, 4.0, 1000.5, -123456.25}) {
+    std::vector<float> points = Line(600);
+    const std::vector<float> original = points;
+    ok = ok && Run({8, 0, 1.0, 3.0, shift}, &points);
+    for (size_t i = 0; i < 600 && ok; ++i) {
+      const float* in = &original[i * kPointStride];
+      const float* out = &points[i * kPointStride];
+      const float expected = static_cast<float>(in[1] + std::sin(in[0] * 3.0 + shift));
+      ok = std::fabs(out[1] - expected) <= 2.5e-7f && out[0] == in[0];
+    }
+  }
+  return Report("wave sine matches libm", ok);
+}
+
+bool TestMalformed() {
+  const std::vector<std::vector<double>> programs = {
+      {99},                   // unknown opcode
+      {1.5, 0, 0},            // not an opcode
+      {3, 0.1},               // missing an argument
+      {6, 1, 0, 0, 0},        // no colours
+      {7, 1, 0, 0, 2, 1, 2},  // colours cut short
+      {8, 2, 0.1, 1, 0},      // no such axis
+  };
+  bool ok = true;
+  for (const std::vector<double>& program : programs) {
+    EffectsEngine engine;
+    ok = ok && !engine.Load(program.data(), program.size()) && engine.stages() == 0;
+    std::vector<float> points = Line(8);
+    const std::vector<float> original = points;
+    engine.Apply(points.data(), 8);
+    ok = ok && points == original;
+  }
+  EffectsEngine empty;
+  ok = ok && empty.Load(nullptr, 0) && empty.stages() == 0;
+  return Report("malformed programs run nothing", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestTransforms() && ok;
+  ok = TestAlongFrame() && ok;
+  ok = TestPalettes() && ok;
+  ok = TestWave() && ok;
+  ok = TestMalformed() && ok;
+  return ok ? 0 : 1;
+}
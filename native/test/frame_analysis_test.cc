@@ -0,0 +1,154 @@
+// Checks AnalyzeFrame against a straightforward per-pixel implementation of
+// the JS generator's front-end (luma, 3x3 box blur, Sobel magnitude / 4), with
+// and without the row pool and on sizes that exercise the SIMD tails.
+// AnalyzeUyvyFrame is held to the same reference, reading each 4-byte pixel
+// as a U Y0 V Y1 macropixel.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "frame_analysis.h"
+#include "row_pool.h"
+
+namespace {
+
+struct Image {
+  int width;
+  int height;
+  int stride;
+  std::vector<uint8_t> data;
+};
+
+// Smooth gradients with noise and a few hard shapes, so every threshold
+// catches both edges and flat areas.
+Image MakeImage(int width, int height, uint32_t seed) {
+  Image image{width, height, width * 4 + 12, {}};
+  image.data.assign(static_cast<size_t>(image.stride) * height, 0xCD);
+  std::mt19937 rng(seed);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      uint8_t* p = &image.data[static_cast<size_t>(y) * image.stride + x * 4];
+      bool block = ((x / 7) + (y / 5)) % 3 == 0;
+      int base = block ? 220 : (x * 255) / std::max(1, width - 1);
+      p[0] = static_cast<uint8_t>(std::clamp(base + static_cast<int>(rng() % 31) - 15, 0, 255));
+      p[1] = static_cast<uint8_t>(rng() % 4 == 0 ? 0 : base);
+      p[2] = static_cast<uint8_t>(rng());
+      p[3] = 255;
+    }
+  }
+  return image;
+}
+
+std::vector<uint8_t> Reference(const Image& image, FrameAnalysis mode, int threshold, bool uyvy) {
+  const int w = image.width;
+  const int h = image.height;
+  auto pixel = [&](int x, int y) { return &image.data[static_cast<size_t>(y) * image.stride + x * 4]; };
+  auto color = [&](int x, int y) {
+    const uint8_t* p = pixel(x, y);
+    return uyvy ? PackUyvyRgb332(p[0], p[1], p[2], p[3]) : PackRgb332(p[2], p[1], p[0]);
+  };
+
+  std::vector<uint8_t> mask(static_cast<size_t>(w) * h, 0);
+  std::vector<int> luma(mask.size());
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      const uint8_t* p = pixel(x, y);
+      luma[y * w + x] = uyvy ? UyvyLuma(p[1], p[3]) : Luma(p[0], p[1], p[2]);
+    }
+  }
+
+  if (mode == FrameAnalysis::kLuma) {
+    for (int y = 0; y < h; ++y) {
+      for (int x = 0; x < w; ++x) {
+        if (luma[y * w + x] > threshold) mask[y * w + x] = color(x, y);
+      }
+    }
+    return mask;
+  }
+  if (w < 3 || h < 3) return mask;
+
+  std::vector<int> blurred(mask.size());
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      int sum = 0;
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+          int sx = std::clamp(x + dx, 0, w - 1);
+          int sy = std::clamp(y + dy, 0, h - 1);
+          sum += luma[sy * w + sx];
+        }
+      }
+      blurred[y * w + x] = sum / 9;
+    }
+  }
+  for (int y = 1; y < h - 1; ++y) {
+    for (int x = 1; x < w - 1; ++x) {
+      auto at = [&](int dx, int dy) { return blurred[(y + dy) * w + x + dx]; };
+      int gx = (at(1, -1) + 2 * at(1, 0) + at(1, 1)) - (at(-1, -1) + 2 * at(-1, 0) + at(-1, 1));
+      int gy = (at(-1, -1) + 2 * at(0, -1) + at(1, -1)) - (at(-1, 1) + 2 * at(0, 1) + at(1, 1));
+      if (std::sqrt(static_cast<double>(gx * gx + gy * gy)) / 4 > threshold) mask[y * w + x] = color(x, y);
+    }
+  }
+  return mask;
+}
+
+bool CheckCase(int width, int height, FrameAnalysis mode, int threshold, RowPool* pool, bool uyvy) {
+  Image image = MakeImage(width, height, static_cast<uint32_t>(width * 31 + height));
+  std::vector<uint8_t> expected = Reference(image, mode, threshold, uyvy);
+  std::vector<uint8_t> mask(expected.size(), 0x77);
+  AnalysisScratch scratch;
+  if (uyvy) {
+    AnalyzeUyvyFrame(image.data.data(), width, height, image.stride, mode, threshold, pool, &scratch, mask.data());
+  } else {
+    AnalyzeFrame(image.data.data(), width, height, image.stride, mode, threshold, pool, &scratch, mask.data());
+  }
+
+  size_t mismatches = 0;
+  size_t set = 0;
+  for (size_t i = 0; i < mask.size(); ++i) {
+    if (mask[i] != expected[i]) ++mismatches;
+    if (expected[i]) ++set;
+  }
+  bool ok = mismatches == 0;
+  std::printf("%5dx%-5d %-4s %-5s t=%-3d threads=%d set=%-7zu mismatches=%-5zu %s\n",
+      width, height, uyvy ? "uyvy" : "bgra", FrameAnalysisName(mode), threshold, pool ? pool->threads() : 1,
+      set, mismatches, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  struct Size {
+    int width;
+    int height;
+  };
+  const Size sizes[] = {{480, 480}, {641, 359}, {17, 5}, {9, 9}, {3, 3}, {2, 7}, {1000, 3}};
+  const int thresholds[] = {0, 20, 128, 255};
+
+  RowPool pool(4);
+  bool ok = true;
+  for (bool uyvy : {false, true}) {
+    for (const Size& size : sizes) {
+      for (FrameAnalysis mode : {FrameAnalysis::kLuma, FrameAnalysis::kEdges}) {
+        for (int threshold : thresholds) {
+          ok = CheckCase(size.width, size.height, mode, threshold, nullptr, uyvy) && ok;
+          ok = CheckCase(size.width, size.height, mode, threshold, &pool, uyvy) && ok;
+        }
+      }
+    }
+  }
+
+  FrameAnalysis parsed;
+  bool names_ok = ParseFrameAnalysis("edges", &parsed) && parsed == FrameAnalysis::kEdges &&
+                  ParseFrameAnalysis("luma", &parsed) && parsed == FrameAnalysis::kLuma &&
+                  ParseFrameAnalysis("none", &parsed) && parsed == FrameAnalysis::kNone &&
+                  !ParseFrameAnalysis("sobel", &parsed);
+  std::printf("analysis names %s\n", names_ok ? "OK" : "FAIL");
+
+  return ok && names_ok ? 0 : 1;
+}
@@ -0,0 +1,378 @@
+// Runs the whole capture path (source, scaling, analysis, tracing, handoff)
+// on SyntheticFrameSource, so it is covered without NDI: payload formats
+// and sizes per mode, UYVY delivery, cropping, file replay, static-content
+// detection, stats, and the synthetic source name parser.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_receiver.h"
+#include "synthetic_frame_source.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-44s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+std::unique_ptr<FrameReceiver> MakeReceiver(const std::string& name) {
+  SyntheticOptions options;
+  std::string error;
+  if (!ParseSyntheticSourceName(name, &options, &error)) {
+    std::printf("bad source name %s: %s\n", name.c_str(), error.c_str());
+    return nullptr;
+  }
+  auto receiver = std::make_unique<FrameReceiver>(name, std::make_unique<SyntheticFrameSource>(options));
+  return receiver->Connect() ? std::move(receiver) : nullptr;
+}
+
+// Polls for a published copy-mode frame for up to two seconds.
+const CapturedFrame* WaitForFrame(FrameReceiver* receiver) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (const CapturedFrame* frame = receiver->TakeFrame()) return frame;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return nullptr;
+}
+
+bool TestBgra() {
+  auto receiver = MakeReceiver("synthetic:size=64x36,fps=0");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    receiver->SetTargetSize(32, 32);
+    receiver->Start();
+    const CapturedFrame* frame = WaitForFrame(receiver.get());
+    ok = frame && frame->format == FrameFormat::kBgra && frame->width == 32 && frame->height == 32 &&
+         frame->data.size() == 32u * 32 * 4 && frame->timestamp != kNoTimestamp;
+    ok = ok && !receiver->uyvy();
+    receiver->Stop();
+  }
+  return Report("bgra frames, scaled", ok);
+}
+
+bool TestMaskOverUyvy() {
+  auto receiver = MakeReceiver("synthetic:pattern=bars,size=128x72,fps=0");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    receiver->SetTargetSize(64, 36);
+    receiver->SetAnalysis(FrameAnalysis::kLuma);
+    receiver->SetThreshold(128);
+    receiver->Start();
+    const CapturedFrame* frame = WaitForFrame(receiver.get());
+    ok = frame && frame->format == FrameFormat::kLumaMask && frame->data.size() == 64u * 36;
+    // Bars alternate bright and dark, so the mask is neither empty nor full.
+    size_t set = 0;
+    if (ok) {
+      for (uint8_t v : frame->data) set += v != 0;
+    }
+    ok = ok && set > 0 && set < frame->data.size() && receiver->uyvy();
+    receiver->Stop();
+  }
+  return Report("luma mask from uyvy frames", ok);
+}
+
+bool TestTracePooled() {
+  auto receiver = MakeReceiver("synthetic:pattern=bars,size=128x72,fps=0");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    receiver->SetTargetSize(96, 54);
+    receiver->SetTrace(true);
+    receiver->SetPooled(true);
+    receiver->Start();
+    FrameSlab* slab = nullptr;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!slab && std::chrono::steady_clock::now() < deadline) {
+      slab = receiver->TakeSlab();
+      if (!slab) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ok = slab && slab->format == static_cast<int>(FrameFormat::kPath) && slab->size > 0 &&
+         slab->size % (8 * sizeof(float)) == 0;
+    receiver->Stop();
+    if (slab) receiver->frame_pool().Release(slab);
+  }
+  return Report("traced paths through the frame pool", ok);
+}
+
+// Pooled frames written straight into memory the consumer adopted into the
+// pool, as the addon does with ArrayBuffers; retired buffers come back once
+// free.
+bool TestAdoptedBuffers() {
+  auto receiver = MakeReceiver("synthetic:size=64x36,fps=0");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    const size_t bytes = 32 * 32 * 4;
+    std::vector<std::vector<uint8_t>> buffers(4, std::vector<uint8_t>(bytes));
+    FramePool& pool = receiver->frame_pool();
+    for (int i = 0; i < 4; ++i) pool.Adopt(buffers[i].data(), bytes, i);
+    receiver->SetTargetSize(32, 32);
+    receiver->SetPooled(true);
+    receiver->Start();
+    std::vector<FrameSlab*> taken;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (taken.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+      if (FrameSlab* slab = receiver->TakeSlab()) {
+        taken.push_back(slab);
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    ok = taken.size() == 2;
+    for (FrameSlab* slab : taken) {
+      ok = ok && slab->buffer >= 0 && slab->data == buffers[slab->buffer].data() && slab->size == bytes &&
+           !slab->storage;
+    }
+    // Growing past the adopted size retires all four; the ones still held
+    // (taken, or pending when the capture stopped) only once released.
+    receiver->Stop();
+    if (FrameSlab* pending = receiver->TakeSlab()) taken.push_back(pending);
+    pool.RetireSmaller(bytes + 1);
+    ok = ok && pool.TakeRetired().size() == 4 - taken.size();
+    for (FrameSlab* slab : taken) pool.Release(slab);
+    ok = ok && pool.TakeRetired().size() == taken.size() && pool.stats().slabs == 0;
+  }
+  return Report("pooled frames in adopted buffers", ok);
+}
+
+bool TestShared() {
+  auto receiver = MakeReceiver("synthetic:size=64x36,fps=0");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    receiver->SetTargetSize(32, 32);
+    receiver->SetPooled(true);
+    receiver->SetShared(true);
+    receiver->Start();
+    const CapturedFrame* frame = WaitForFrame(receiver.get());
+    ok = frame && frame->data.empty() && frame->shared.sequence != 0 && frame->shared.size == 32u * 32 * 4 &&
+         receiver->TakeSlab() == nullptr;
+    // Another process would open the ring by name and copy the slot out.
+    std::unique_ptr<SharedFrameRing> ring = ok ? SharedFrameRing::Open(frame->shared.ring) : nullptr;
+    std::vector<uint8_t> data(ok ? frame->shared.size : 0);
+    RingFrameInfo info;
+    ok = ring && ring->Read(frame->shared.slot, frame->shared.sequence, data.data(), data.size(), &info) &&
+         info.width == 32 && info.height == 32 && info.format == static_cast<int>(FrameFormat::kBgra) &&
+         info.size == data.size();
+    receiver->Stop();
+  }
+  return Report("frames through shared memory", ok);
+}
+
+bool TestAudio() {
+  auto receiver = MakeReceiver("synthetic:size=32x16,fps=0,tone=100");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    receiver->SetTargetSize(32, 16);
+    receiver->Start();
+    const CapturedFrame* frame = WaitForFrame(receiver.get());
+    // Off by default: the tone is never analysed.
+    ok = frame && frame->audio.sequence == 0;
+    receiver->Stop();
+
+    receiver->SetAudio(true);
+    receiver->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    frame = WaitForFrame(receiver.get());
+    receiver->Stop();
+    const AudioLevels& levels = receiver->LatestAudio();
+    ok = ok && frame && frame->audio.sequence > 0 && frame->audio.low > frame->audio.high &&
+         levels.bands.sequence >= frame->audio.sequence && levels.spectrum.size() == 1024 && levels.sample_rate == 48000;
+  }
+  return Report("audio levels with every frame", ok);
+}
+
+bool TestCrop() {
+  std::vector<uint8_t> pixels(100 * 50 * 4);
+  SourceFrame bgra;
+  bgra.data = pixels.data();
+  bgra.width = 100;
+  bgra.height = 50;
+  bgra.stride = 400;
+  CropRect crop{0.25f, 0.5f, 0.5f, 0.5f};
+  SourceFrame region = bgra;
+  CropSourceFrame(crop, &region);
+  bool ok = region.width == 50 && region.height == 25 && region.stride == 400 &&
+            region.data == pixels.data() + 25 * 400 + 25 * 4;
+
+  // UYVY regions widen to whole pixel pairs.
+  SourceFrame uyvy = bgra;
+  uyvy.layout = PixelLayout::kUyvy;
+  uyvy.stride = 200;
+  region = uyvy;
+  CropSourceFrame(crop, &region);
+  ok = ok && region.width == 52 && region.height == 25 && region.data == pixels.data() + 25 * 200 + 24 * 2;
+
+  // Slivers keep at least one pixel (pair); the whole frame is untouched.
+  region = uyvy;
+  CropSourceFrame(CropRect{1.0f, 1.0f, 0.0f, 0.0f}, &region);
+  ok = ok && region.width == 2 && region.height == 1 && region.data == pixels.data() + 49 * 200 + 98 * 2;
+  region = bgra;
+  CropSourceFrame(CropRect(), &region);
+  ok = ok && region.width == 100 && region.height == 50 && region.data == pixels.data();
+
+  // Without a target size the output is the region at source resolution.
+  auto receiver = MakeReceiver("synthetic:size=64x36,fps=0");
+  ok = ok && receiver != nullptr;
+  if (receiver) {
+    receiver->SetTargetSize(0, 0);
+    receiver->SetCrop(CropRect{0.5f, 0.0f, 0.5f, 0.5f});
+    receiver->Start();
+    const CapturedFrame* frame = WaitForFrame(receiver.get());
+    ok = ok && frame && frame->width == 32 && frame->height == 18 && frame->data.size() == 32u * 18 * 4;
+    receiver->Stop();
+  }
+  return Report("crop before scaling", ok);
+}
+
+bool TestFileReplay() {
+  // Two UYVY frames: white, then black, replayed in turn.
+  const std::string path = (std::filesystem::temp_directory_path() / "frame_receiver_test.uyvy").string();
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (int frame = 0; frame < 2; ++frame) {
+      uint8_t y = frame == 0 ? 235 : 16;
+      for (int i = 0; i < 16 * 8 / 2; ++i) {
+        const char pair[4] = {static_cast<char>(128), static_cast<char>(y), static_cast<char>(128), static_cast<char>(y)};
+        out.write(pair, 4);
+      }
+    }
+  }
+  SyntheticOptions options;
+  std::string error;
+  bool ok = ParseSyntheticSourceName("synthetic:file=" + path + ",layout=uyvy,size=16x8,fps=0", &options, &error);
+  SyntheticFrameSource source(options);
+  CaptureRequest request;
+  request.accepts_uyvy = true;
+  ok = ok && source.Open(request) && source.frame_count() == 2;
+
+  uint8_t luma[3] = {};
+  for (int i = 0; ok && i < 3; ++i) {
+    SourceFrame frame;
+    ok = source.Capture(request, 100, &frame) == CaptureResult::kFrame && frame.layout == PixelLayout::kUyvy &&
+         frame.stride == 32;
+    if (ok) luma[i] = frame.data[1];
+    source.Release(&frame);
+  }
+  ok = ok && luma[0] == 235 && luma[1] == 16 && luma[2] == 235;
+
+  // Asking for BGRA converts the replayed frames once.
+  SourceFrame frame;
+  request.accepts_uyvy = false;
+  ok = ok && source.Capture(request, 100, &frame) == CaptureResult::kFrame && frame.layout == PixelLayout::kBgra &&
+       frame.data[0] < 4 && frame.data[3] == 255;
+  std::remove(path.c_str());
+  return Report("uyvy file replay and conversion", ok);
+}
+
+bool TestStaticFrames() {
+  // One BGRA frame, a white box on black, replayed over and over.
+  const std::string path = (std::filesystem::temp_directory_path() / "frame_receiver_static.bgra").string();
+  {
+    std::vector<char> pixels(32 * 16 * 4, 0);
+    for (int y = 4; y < 12; ++y) {
+      for (int x = 8; x < 24; ++x) {
+        for (int c = 0; c < 4; ++c) pixels[(y * 32 + x) * 4 + c] = static_cast<char>(255);
+      }
+    }
+    std::ofstream out(path, std::ios::binary);
+    out.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+  }
+  auto receiver = MakeReceiver("synthetic:file=" + path + ",size=32x16,fps=0");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    receiver->SetTargetSize(32, 16);
+    receiver->SetTrace(true);
+    receiver->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    receiver->Stop();
+    // Every frame after the first repeats it and reuses the traced path.
+    CaptureStatsSnapshot stats = receiver->stats();
+    const CapturedFrame* frame = receiver->TakeFrame();
+    ok = stats.received >= 2 && stats.unchanged == stats.received - 1 && frame && frame->unchanged &&
+         frame->dirty.empty() && frame->format == FrameFormat::kPath && !frame->data.empty();
+
+    // A new threshold changes the payload, so the next frame is dirty as a whole.
+    receiver->SetThreshold(100);
+    receiver->ResetStats();
+    receiver->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    receiver->Stop();
+    stats = receiver->stats();
+    ok = ok && stats.received >= 2 && stats.unchanged == stats.received - 1;
+
+    // With detection off nothing counts as unchanged.
+    receiver->SetChangeThreshold(-1);
+    receiver->ResetStats();
+    receiver->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    receiver->Stop();
+    frame = receiver->TakeFrame();
+    ok = ok && receiver->stats().received > 0 && receiver->stats().unchanged == 0 && frame && !frame->unchanged &&
+         frame->dirty.size() == 1 && frame->dirty[0].width == 32 && frame->dirty[0].height == 16;
+  }
+  std::remove(path.c_str());
+  return Report("static frames flagged unchanged", ok);
+}
+
+bool TestPacingAndStats() {
+  auto receiver = MakeReceiver("synthetic:size=32x16,fps=200");
+  bool ok = receiver != nullptr;
+  if (ok) {
+    receiver->SetTargetSize(16, 16);
+    receiver->Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    receiver->Stop();
+    CaptureStatsSnapshot stats = receiver->stats();
+    // About 60 frames in 300 ms; wide bounds for loaded machines.
+    ok = stats.received >= 20 && stats.received <= 70 && stats.process_us.count == stats.received &&
+         stats.recv_wait_us.count == stats.received && stats.latency_us.count == stats.received &&
+         stats.overwritten + 1 >= stats.received;  // nobody was taking frames
+    receiver->ResetStats();
+    ok = ok && receiver->stats().received == 0;
+    std::printf("  received=%llu overwritten=%llu wait p50=%lluus\n",
+        static_cast<unsigned long long>(stats.received), static_cast<unsigned long long>(stats.overwritten),
+        static_cast<unsigned long long>(stats.recv_wait_us.Percentile(50)));
+  }
+  return Report("200 fps pacing and capture stats", ok);
+}
+
+bool TestNames() {
+  SyntheticOptions options;
+  std::string error;
+  bool ok = ParseSyntheticSourceName("synthetic:", &options, &error) && options.pattern == "bars";
+  ok = ok && ParseSyntheticSourceName("synthetic:pattern=noise,size=640x360,fps=29.97", &options, &error) &&
+       options.pattern == "noise" && options.width == 640 && options.height == 360 && options.fps > 29.9;
+  ok = ok && !ParseSyntheticSourceName("synthetic:size=641x360", &options, &error);
+  ok = ok && !ParseSyntheticSourceName("synthetic:size=640x360x2", &options, &error);
+  ok = ok && !ParseSyntheticSourceName("synthetic:speed=2", &options, &error);
+  ok = ok && !ParseSyntheticSourceName("synthetic:fps=-1", &options, &error);
+  ok = ok && ParseSyntheticSourceName("synthetic:tone=440", &options, &error) && options.tone_hz == 440;
+  ok = ok && !ParseSyntheticSourceName("synthetic:tone=30000", &options, &error);
+  ok = ok && !IsSyntheticSourceName("STUDIO (synthetic:bars)");
+  return Report("synthetic source names", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestBgra() && ok;
+  ok = TestMaskOverUyvy() && ok;
+  ok = TestTracePooled() && ok;
+  ok = TestAdoptedBuffers() && ok;
+  ok = TestShared() && ok;
+  ok = TestAudio() && ok;
+  ok = TestCrop() && ok;
+  ok = TestFileReplay() && ok;
+  ok = TestStaticFrames() && ok;
+  ok = TestPacingAndStats() && ok;
+  ok = TestNames() && ok;
+  return ok ? 0 : 1;
+}
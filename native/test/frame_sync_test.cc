@@ -0,0 +1,108 @@
+// Checks the frame-sync repeat/drop accounting against known source/output
+// clock ratios, and that the pacer keeps a steady grid without bursting
+// after a stall.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+#include "frame_sync.h"
+
+namespace {
+
+constexpr int64_t kTicksPerSecond = 10000000;  // NDI timestamps are 100 ns
+
+bool Report(const char* name, bool ok, const FrameSyncStats& stats) {
+  std::printf("%-34s pulled=%-5llu repeated=%-5llu dropped=%-5llu %s\n", name,
+      static_cast<unsigned long long>(stats.pulled), static_cast<unsigned long long>(stats.repeated),
+      static_cast<unsigned long long>(stats.dropped), ok ? "OK" : "FAIL");
+  return ok;
+}
+
+// Simulates a frame-sync pulling |ticks| frames at |output_fps| from a
+// source at |source_fps|: every tick gets the newest source frame.
+FrameSyncStats Simulate(double source_fps, double output_fps, int ticks, int64_t jitter = 0) {
+  FrameSyncCounter counter;
+  int64_t interval = static_cast<int64_t>(kTicksPerSecond / source_fps);
+  for (int i = 0; i < ticks; ++i) {
+    double t = i / output_fps;
+    int64_t frame = static_cast<int64_t>(t * source_fps + 1e-9);
+    int64_t stamp = frame * interval + ((frame % 2) ? jitter : -jitter);
+    counter.Add(stamp, interval);
+  }
+  return counter.stats();
+}
+
+bool TestMatchedClocks() {
+  FrameSyncStats stats = Simulate(60, 60, 600, 2000);
+  return Report("matched clocks, jittered stamps", stats.pulled == 600 && stats.repeated == 0 && stats.dropped == 0, stats);
+}
+
+bool TestSlowSource() {
+  // 30 fps source, 60 fps laser: every other tick repeats.
+  FrameSyncStats stats = Simulate(30, 60, 600);
+  return Report("30 fps source, 60 fps output", stats.repeated == 300 && stats.dropped == 0, stats);
+}
+
+bool TestFastSource() {
+  // 60 fps source, 30 fps laser: one frame skipped per tick.
+  FrameSyncStats stats = Simulate(60, 30, 300);
+  return Report("60 fps source, 30 fps output", stats.repeated == 0 && stats.dropped == 299, stats);
+}
+
+bool TestDrift() {
+  // 60.06 vs 60 fps: a tenth of a percent of drift gains one source frame
+  // every 16.7 s, which the frame-sync absorbs as a single skip.
+  FrameSyncStats stats = Simulate(60.06, 60, 1200);
+  return Report("0.1% clock drift over 20 s", stats.repeated == 0 && stats.dropped == 1, stats);
+}
+
+bool TestUnknownInterval() {
+  FrameSyncCounter counter;
+  counter.Add(100, 0);
+  counter.Add(100, 0);
+  counter.Add(900, 0);
+  FrameSyncStats stats = counter.stats();
+  bool ok = stats.pulled == 3 && stats.repeated == 1 && stats.dropped == 0;
+  counter.Reset();
+  ok = ok && counter.stats().pulled == 0;
+  return Report("unknown frame rate, reset", ok, stats);
+}
+
+bool TestPacer() {
+  using Clock = FramePacer::Clock;
+  using std::chrono::milliseconds;
+  FramePacer pacer;
+  pacer.SetRate(50);
+  Clock::time_point start = Clock::now();
+
+  // Keeping up: ticks land exactly 20 ms apart even when woken late.
+  bool ok = pacer.Next(start) == start;
+  ok = ok && pacer.Next(start + milliseconds(5)) == start + milliseconds(20);
+  ok = ok && pacer.Next(start + milliseconds(27)) == start + milliseconds(40);
+
+  // A 200 ms stall restarts the grid instead of owing ten ticks.
+  Clock::time_point late = start + milliseconds(240);
+  ok = ok && pacer.Next(late) == late;
+  ok = ok && pacer.Next(late) == late + milliseconds(20);
+
+  // A new rate restarts the grid too.
+  pacer.SetRate(25);
+  ok = ok && pacer.Next(late + milliseconds(1)) == late + milliseconds(1);
+  ok = ok && pacer.Next(late + milliseconds(1)) == late + milliseconds(41);
+  std::printf("pacer grid and stall recovery %s\n", ok ? "OK" : "FAIL");
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestMatchedClocks() && ok;
+  ok = TestSlowSource() && ok;
+  ok = TestFastSource() && ok;
+  ok = TestDrift() && ok;
+  ok = TestUnknownInterval() && ok;
+  ok = TestPacer() && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Checks GalvoSimulator's step responses against second-order theory
+// (overshoot, time to peak) and its slew limit on large steps, and
+// TraceScorer on traces with known errors.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "galvo_simulator.h"
+#include "point_optimizer.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+// |count| visible samples at (x, 0).
+std::vector<float> Hold(float x, size_t count) {
+  std::vector<float> points(count * kPointStride);
+  for (size_t i = 0; i < count; ++i) {
+    float* p = &points[i * kPointStride];
+    p[0] = x;
+    p[3] = p[4] = p[5] = 1.0f;
+  }
+  return points;
+}
+
+bool TestSmallStep() {
+  GalvoOptions options;
+  options.pps = 100000.0;  // fine sampling to read the peak
+  GalvoSimulator galvo(options);
+  const float origin[kPointStride] = {};
+  galvo.Reset(origin);
+  const float kStep = 0.001f;
+  std::vector<float> step = Hold(kStep, 200);
+  std::vector<float> out(step.size());
+  galvo.Simulate(step.data(), 200, out.data());
+
+  size_t peak = 0;
+  for (size_t i = 0; i < 200; ++i) {
+    if (out[i * kPointStride] > out[peak * kPointStride]) peak = i;
+  }
+  double overshoot = (out[peak * kPointStride] - kStep) / kStep;
+  // Time to peak: pi / (w sqrt(1 - zeta^2)), about 0.19 ms at 3 kHz and 5%.
+  const double kPi = 3.14159265358979323846;
+  double zeta = -std::log(0.05) / std::sqrt(kPi * kPi + std::log(0.05) * std::log(0.05));
+  double expected_peak = kPi / (2 * kPi * 3000.0 * std::sqrt(1 - zeta * zeta)) * options.pps;
+  bool ok = std::fabs(overshoot - 0.05) < 0.005;
+  ok = ok && std::fabs(static_cast<double>(peak + 1) - expected_peak) <= 1.5;
+  ok = ok && std::fabs(out[199 * kPointStride] - kStep) < kStep * 1e-3;
+  // Colour and blanking come from the samples.
+  ok = ok && out[3] == 1.0f && out[6] == 0.0f;
+  return Report("small steps ring as configured", ok);
+}
+
+bool TestLargeStep() {
+  GalvoSimulator galvo;  // 30k, 2400 units per second
+  const float origin[kPointStride] = {-1.0f};
+  galvo.Reset(origin);
+  std::vector<float> step = Hold(1.0f, 60);
+  galvo.Simulate(step.data(), 60, step.data());  // in place
+  // Two units at no more than 0.08 per sample take at least 25 samples.
+  bool ok = true;
+  float previous = -1.0f;
+  size_t arrived = 60;
+  for (size_t i = 0; i < 60; ++i) {
+    float x = step[i * kPointStride];
+    ok = ok && x - previous <= 0.08f + 1e-6f;
+    if (arrived == 60 && std::fabs(x - 1.0f) < 0.01f) arrived = i;
+    previous = x;
+  }
+  ok = ok && arrived >= 24 && arrived < 40;
+  return Report("large steps slew at max_velocity", ok);
+}
+
+bool TestScore() {
+  // A line along x, then the same line drawn 0.01 too high and once
+  // overshooting its end by 0.02.
+  std::vector<float> ideal = Hold(0.0f, 4);
+  for (size_t i = 0; i < 4; ++i) ideal[i * kPointStride] = 0.1f * static_cast<float>(i);
+  TraceScorer scorer;
+  scorer.Add(ideal.data(), ideal.data(), 4);
+  TraceScore exact = scorer.Result();
+  bool ok = exact.samples == 3 && exact.path_error == 0.0 && exact.overshoot == 0.0 &&
+            exact.brightness_variation < 1e-6;
+
+  std::vector<float> beam = ideal;
+  for (size_t i = 0; i < 4; ++i) beam[i * kPointStride + 1] = 0.01f;
+  beam[3 * kPointStride] = 0.32f;
+  scorer.Reset();
+  scorer.Add(ideal.data(), beam.data(), 4);
+  TraceScore off = scorer.Result();
+  ok = ok && std::fabs(off.max_path_error - std::sqrt(0.02 * 0.02 + 0.01 * 0.01)) < 1e-6;
+  ok = ok && std::fabs(off.max_overshoot - 0.02) < 1e-6 && std::fabs(off.overshoot - 0.02 / 3) < 1e-6;
+  ok = ok && off.brightness_variation > 0.0;
+
+  // Blanked samples are not scored.
+  ideal[2 * kPointStride + 6] = 1.0f;
+  scorer.Reset();
+  scorer.Add(ideal.data(), beam.data(), 4);
+  ok = ok && scorer.Result().samples == 2;
+  return Report("trace scores", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestSmallStep() && ok;
+  ok = TestLargeStep() && ok;
+  ok = TestScore() && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// Checks that PathPlanner shortens blanked travel while drawing exactly the
+// same lines, in the same colours, whichever way each segment now runs, and
+// that a frame gets the same order every time.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "path_planner.h"
+#include "point_optimizer.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+using Line = std::array<float, 7>;  // two ends, sorted, then r, g, b
+
+// Every visible point draws a line from the point before it (itself for the
+// first point) in its own colour.
+std::vector<Line> Lines(const std::vector<float>& points) {
+  std::vector<Line> lines;
+  size_t count = points.size() / kPointStride;
+  for (size_t i = 0; i < count; ++i) {
+    const float* p = &points[i * kPointStride];
+    if (p[6] > 0.5f) continue;
+    const float* from = i > 0 ? p - kPointStride : p;
+    std::array<float, 2> a = {from[0], from[1]};
+    std::array<float, 2> b = {p[0], p[1]};
+    if (b < a) std::swap(a, b);
+    lines.push_back({a[0], a[1], b[0], b[1], p[3], p[4], p[5]});
+  }
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+void Add(std::vector<float>* frame, float x, float y, bool blanked, float r = 1.0f, float g = 1.0f, float b = 1.0f) {
+  const float point[kPointStride] = {x, y, 0.0f, r, g, b, blanked ? 1.0f : 0.0f, 0.0f};
+  frame->insert(frame->end(), point, point + kPointStride);
+}
+
+// Short strokes scattered over the frame in random order, each entered
+// with a blanked point at its start.
+std::vector<float> Scatter(int strokes, uint32_t seed) {
+  auto next = [&seed] {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24) * 2.0f - 1.0f;
+  };
+  std::vector<float> frame;
+  for (int s = 0; s < strokes; ++s) {
+    float x = next();
+    float y = next();
+    float dx = next() * 0.05f;
+    float dy = next() * 0.05f;
+    float colour = (next() + 1.0f) / 2.0f;
+    Add(&frame, x, y, true);
+    for (int k = 1; k <= 4; ++k) Add(&frame, x + dx * k, y + dy * k, false, colour, 1.0f - colour, 0.5f);
+  }
+  return frame;
+}
+
+bool TestShortens() {
+  bool ok = true;
+  PathPlanner planner;
+  std::vector<float> out;
+  for (int strokes : {3, 20, 200}) {
+    std::vector<float> frame = Scatter(strokes, static_cast<uint32_t>(strokes));
+    planner.Plan(frame.data(), frame.size() / kPointStride, &out);
+    const PlanStats& stats = planner.stats();
+    ok = ok && stats.segments == static_cast<size_t>(strokes) && Lines(out) == Lines(frame);
+    // Random order is far from the best; the planner should at least halve it.
+    ok = ok && stats.travel_after < stats.travel_before * (strokes > 3 ? 0.5 : 1.0 + 1e-9);
+    ok = ok && out[out.size() - 1] == 1.0f;
+  }
+  return Report("shorter travel, same lines", ok);
+}
+
+bool TestReverse() {
+  std::vector<float> frame;
+  Add(&frame, 0.0f, 0.0f, true);
+  Add(&frame, 0.1f, 0.0f, false, 1, 0, 0);
+  // Drawn towards the first stroke; cheaper backwards.
+  Add(&frame, 1.0f, 0.0f, true);
+  Add(&frame, 0.5f, 0.0f, false, 0, 1, 0);
+  Add(&frame, 0.2f, 0.0f, false, 0, 0, 1);
+  Add(&frame, 1.1f, 0.0f, true);
+  Add(&frame, 1.2f, 0.0f, false, 1, 1, 1);
+
+  PathPlanner planner;
+  std::vector<float> out;
+  size_t count = planner.Plan(frame.data(), frame.size() / kPointStride, &out);
+  auto at = [&](size_t i) { return &out[i * kPointStride]; };
+  bool ok = count == 7 && Lines(out) == Lines(frame);
+  // Blank to 0.2, then 0.5 in blue and 1.0 in green: the lines keep their
+  // colours although they are drawn the other way.
+  ok = ok && at(2)[0] == 0.2f && at(2)[6] == 1.0f;
+  ok = ok && at(3)[0] == 0.5f && at(3)[5] == 1.0f && at(4)[0] == 1.0f && at(4)[4] == 1.0f;
+  ok = ok && planner.stats().travel_after < 1.5 && planner.stats().converged;
+
+  // Without reversal the stroke is moved to the end instead, and still
+  // drawn from 1.0 towards 0.2.
+  PlannerOptions options;
+  options.reverse = false;
+  planner.Configure(options);
+  planner.Plan(frame.data(), frame.size() / kPointStride, &out);
+  ok = ok && Lines(out) == Lines(frame) && planner.stats().travel_after < 1.5;
+  ok = ok && at(4)[0] == 1.0f && at(4)[6] == 1.0f && at(5)[0] == 0.5f && at(5)[4] == 1.0f;
+  return Report("reversed segments keep their colours", ok);
+}
+
+bool TestBudget() {
+  // No time at all still yields a complete frame, just a worse one.
+  PlannerOptions options;
+  options.budget_ms = 0.0;
+  PathPlanner planner(options);
+  std::vector<float> frame = Scatter(500, 99);
+  std::vector<float> out;
+  planner.Plan(frame.data(), frame.size() / kPointStride, &out);
+  bool ok = Lines(out) == Lines(frame) && !planner.stats().converged && planner.stats().timed_out;
+  ok = ok && planner.stats().travel_after <= planner.stats().travel_before;
+  // The same frame again keeps that order rather than finding another.
+  std::vector<float> again;
+  planner.Plan(frame.data(), frame.size() / kPointStride, &again);
+  ok = ok && planner.stats().reused && again == out;
+
+  // Frames starting visible, and fewer than three segments, come through.
+  std::vector<float> small;
+  Add(&small, 0.3f, 0.3f, false);
+  Add(&small, 0.4f, 0.3f, false);
+  planner.Plan(small.data(), 2, &out);
+  ok = ok && out == small;
+  return Report("budget and small frames", ok);
+}
+
+bool TestDeterministic() {
+  // More segments than the evaluations can finish: without the time cap
+  // in the way, two planners stop at the same point with the same order.
+  PlannerOptions options;
+  options.budget_ms = 1e6;
+  PathPlanner first(options);
+  PathPlanner second(options);
+  std::vector<float> frame = Scatter(500, 7);
+  const size_t count = frame.size() / kPointStride;
+  std::vector<float> a;
+  std::vector<float> b;
+  first.Plan(frame.data(), count, &a);
+  second.Plan(frame.data(), count, &b);
+  bool ok = a == b && Lines(a) == Lines(frame) && !first.stats().converged && !first.stats().timed_out;
+  ok = ok && first.stats().evaluations >= options.max_evaluations && !first.stats().reused;
+
+  // Unchanged segments, even in new colours, keep the order found; moved
+  // ones, or new options, are searched again; the same options do not count
+  // as new.
+  for (size_t i = 0; i < count; ++i) frame[i * kPointStride + 4] = 0.25f;
+  first.Plan(frame.data(), count, &a);
+  ok = ok && first.stats().reused && Lines(a) == Lines(frame);
+  for (size_t i = 0; i < a.size(); i += kPointStride) a[i + 4] = b[i + 4];
+  ok = ok && a == b;
+  frame[4 * kPointStride] += 0.01f;  // the end of the first stroke
+  first.Plan(frame.data(), count, &a);
+  ok = ok && !first.stats().reused && Lines(a) == Lines(frame);
+  first.Configure(options);
+  first.Plan(frame.data(), count, &a);
+  ok = ok && first.stats().reused;
+  options.reverse = false;
+  first.Configure(options);
+  first.Plan(frame.data(), count, &a);
+  ok = ok && !first.stats().reused && Lines(a) == Lines(frame);
+  return Report("same frame, same order", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestShortens() && ok;
+  ok = TestReverse() && ok;
+  ok = TestBudget() && ok;
+  ok = TestDeterministic() && ok;
+  return ok ? 0 : 1;
+}
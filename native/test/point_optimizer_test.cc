@@ -0,0 +1,238 @@
+// Checks PointOptimizer against a line-for-line port of optimizePoints() in
+// src/utils/optimizer.js, including frames far beyond the old 4000-point
+// bailout, and the dwell, interpolation and corner holds it adds around
+// simple shapes.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "point_optimizer.h"
+
+namespace {
+
+bool Report(const char* name, bool ok) {
+  std::printf("%-40s %s\n", name, ok ? "OK" : "FAIL");
+  return ok;
+}
+
+// The JS scanner model: segmentSpeed() and cornerDwell().
+const double kPps = 30000;
+const double kMaxVelocity = 2400;
+const double kMaxAcceleration = 2.5e7;
+const int kCornerDwell = 8;
+
+int JumpSteps(double dist, double step) {
+  return dist > step ? static_cast<int>(std::fmin(std::floor(dist / step), 1024)) : 0;
+}
+
+double SegmentSpeed(double length, int steps) {
+  return std::fmin((steps > 1 ? length / steps : length) * kPps, kMaxVelocity);
+}
+
+int CornerDwell(double ax, double ay, int steps_in, double bx, double by, int steps_out) {
+  double la = std::sqrt(ax * ax + ay * ay);
+  double lb = std::sqrt(bx * bx + by * by);
+  if (!(la > 0) || !(lb > 0)) return 0;
+  double vi = SegmentSpeed(la, steps_in);
+  double vo = SegmentSpeed(lb, steps_out);
+  double dvx = bx / lb * vo - ax / la * vi;
+  double dvy = by / lb * vo - ay / la * vi;
+  return static_cast<int>(std::fmin(std::floor(std::sqrt(dvx * dvx + dvy * dvy) / kMaxAcceleration * kPps), kCornerDwell));
+}
+
+// The JS, with its doubles: push() black-outs blanked colours and clears the
+// last-point flag.
+std::vector<float> Reference(const std::vector<float>& points) {
+  const double kMaxDist = std::fmin(0.08, kMaxVelocity / kPps);
+  const int kPathDwell = 4;
+  std::vector<float> result;
+  auto push = [&](double x, double y, double z, double r, double g, double b, bool blk) {
+    const float values[8] = {static_cast<float>(x), static_cast<float>(y), static_cast<float>(z),
+                             static_cast<float>(blk ? 0 : r), static_cast<float>(blk ? 0 : g),
+                             static_cast<float>(blk ? 0 : b), blk ? 1.0f : 0.0f, 0.0f};
+    result.insert(result.end(), values, values + 8);
+  };
+  size_t count = points.size() / 8;
+  if (count == 0) return result;
+  const float* prev = points.data();
+  for (size_t i = 0; i < count; ++i) {
+    const float* curr = points.data() + i * 8;
+    bool prev_blk = prev[6] > 0.5f;
+    bool curr_blk = curr[6] > 0.5f;
+    if (prev_blk != curr_blk) {
+      if (curr_blk) {
+        for (int d = 0; d < kPathDwell; ++d) push(prev[0], prev[1], prev[2], 0, 0, 0, true);
+      } else {
+        push(curr[0], curr[1], curr[2], 0, 0, 0, true);
+        for (int d = 0; d < kPathDwell; ++d) push(curr[0], curr[1], curr[2], 0, 0, 0, true);
+      }
+    }
+    double dx = static_cast<double>(curr[0]) - prev[0];
+    double dy = static_cast<double>(curr[1]) - prev[1];
+    double dist = std::sqrt(dx * dx + dy * dy);
+    if (dist > kMaxDist) {
+      int steps = JumpSteps(dist, kMaxDist);
+      for (int s = 1; s < steps; ++s) {
+        double t = static_cast<double>(s) / steps;
+        push(prev[0] + dx * t, prev[1] + dy * t, prev[2] + (static_cast<double>(curr[2]) - prev[2]) * t,
+             curr_blk ? 0 : curr[3], curr_blk ? 0 : curr[4], curr_blk ? 0 : curr[5], curr_blk);
+      }
+    }
+    push(curr[0], curr[1], curr[2], curr[3], curr[4], curr[5], curr_blk);
+    // A visible point between two drawn segments holds for the turn.
+    const float* next = i + 1 < count ? curr + 8 : nullptr;
+    if (i > 0 && next && !prev_blk && !curr_blk && !(next[6] > 0.5f)) {
+      double bx = static_cast<double>(next[0]) - curr[0];
+      double by = static_cast<double>(next[1]) - curr[1];
+      int hold = CornerDwell(dx, dy, JumpSteps(dist, kMaxDist), bx, by, JumpSteps(std::sqrt(bx * bx + by * by), kMaxDist));
+      for (int h = 0; h < hold; ++h) push(curr[0], curr[1], curr[2], curr[3], curr[4], curr[5], false);
+    }
+    prev = curr;
+  }
+  return result;
+}
+
+// Random walk with occasional long jumps and blanked runs, like an ILDA
+// frame with several shapes.
+std::vector<float> MakeFrame(size_t count, uint32_t seed) {
+  auto next = [&seed] {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8) / static_cast<float>(1u << 24);
+  };
+  std::vector<float> points(count * 8);
+  float x = 0.0f;
+  float y = 0.0f;
+  bool blanked = false;
+  for (size_t i = 0; i < count; ++i) {
+    float jump = next() < 0.02f ? 1.5f : 0.03f;
+    x = std::fmin(std::fmax(x + (next() - 0.5f) * jump, -1.0f), 1.0f);
+    y = std::fmin(std::fmax(y + (next() - 0.5f) * jump, -1.0f), 1.0f);
+    if (next() < 0.03f) blanked = !blanked;
+    float* p = &points[i * 8];
+    p[0] = x;
+    p[1] = y;
+    p[2] = next() * 0.1f;
+    p[3] = next();
+    p[4] = next();
+    p[5] = next();
+    p[6] = blanked ? 1.0f : 0.0f;
+    p[7] = i + 1 == count ? 1.0f : 0.0f;
+  }
+  return points;
+}
+
+bool SameBits(const std::vector<float>& a, const std::vector<float>& b) {
+  return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0);
+}
+
+bool TestMatchesJs() {
+  bool ok = true;
+  PointOptimizer optimizer;
+  std::vector<float> out;
+  for (size_t count : {0, 1, 2, 17, 500, 3999, 4001, 40000}) {
+    std::vector<float> frame = MakeFrame(count, static_cast<uint32_t>(count) + 7);
+    size_t planned = optimizer.Plan(frame.data(), count);
+    size_t total = optimizer.Optimize(frame.data(), count, &out);
+    std::vector<float> expected = Reference(frame);
+    ok = ok && planned == total && total * kPointStride == expected.size() && SameBits(out, expected);
+    // Large frames are optimised too, not passed through.
+    if (count == 40000) ok = ok && total > count;
+  }
+  return Report("matches optimizer.js at every size", ok);
+}
+
+bool TestShapes() {
+  PointOptimizer optimizer;
+  std::vector<float> out;
+  // A visible point, a blanked jump of 0.5 and a visible point there.
+  const std::vector<float> frame = {
+    0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+    0.5f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+    0.5f, 0.0f, 0.0f, 0.2f, 0.3f, 0.4f, 0.0f, 1.0f,
+  };
+  size_t total = optimizer.Optimize(frame.data(), 3, &out);
+  // 1 + (4 dwell + 5 steps + 1 blanked) + (1 + 4 dwell + 1) = 17.
+  bool ok = total == 17;
+  ok = ok && out[1 * 8 + 0] == 0.0f && out[1 * 8 + 6] == 1.0f && out[1 * 8 + 3] == 0.0f;
+  ok = ok && std::fabs(out[5 * 8 + 0] - 0.5f / 6) < 1e-6f && out[5 * 8 + 6] == 1.0f;
+  ok = ok && out[16 * 8 + 3] == 0.2f && out[16 * 8 + 6] == 0.0f && out[16 * 8 + 7] == 0.0f;
+
+  OptimizerOptions options;
+  options.path_dwell = 0;
+  options.max_distance = 0.25;
+  options.max_velocity = 0.0;  // steps follow max_distance alone
+  optimizer.Configure(options);
+  total = optimizer.Optimize(frame.data(), 3, &out);
+  // 1 + (1 step + 1 blanked) + (1 + 1).
+  ok = ok && total == 5;
+
+  // Garbage coordinates cap out instead of allocating without bound.
+  const std::vector<float> wild = {
+    0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+    1e30f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+  };
+  total = optimizer.Optimize(wild.data(), 2, &out);
+  ok = ok && total == 1 + OptimizerOptions::kMaxSteps;
+  return Report("dwell, steps and limits", ok);
+}
+
+// A square traced fast at 30k points per second: every corner is a right
+// angle at full speed and holds; a square drawn slowly, or the model
+// switched off, does not.
+bool TestCorners() {
+  auto square = [](float side, int per_edge) {
+    const float corners[5][2] = {{0, 0}, {side, 0}, {side, side}, {0, side}, {0, 0}};
+    std::vector<float> points;
+    for (int e = 0; e < 4; ++e) {
+      for (int k = 0; k < per_edge; ++k) {
+        float t = static_cast<float>(k) / per_edge;
+        const float p[8] = {corners[e][0] + (corners[e + 1][0] - corners[e][0]) * t,
+                            corners[e][1] + (corners[e + 1][1] - corners[e][1]) * t, 0, 1, 1, 1, 0, 0};
+        points.insert(points.end(), p, p + 8);
+      }
+    }
+    const float end[8] = {0, 0, 0, 1, 1, 1, 0, 1};
+    points.insert(points.end(), end, end + 8);
+    return points;
+  };
+  PointOptimizer optimizer;
+  std::vector<float> out;
+  // Edges of 0.8 in 10 points of 0.08: full speed into each corner.
+  std::vector<float> fast = square(0.8f, 10);
+  size_t count = fast.size() / 8;
+  size_t total = optimizer.Optimize(fast.data(), count, &out);
+  // |dv| = 2400 * sqrt(2) units per second takes 4.07 samples at 2.5e7.
+  bool ok = total == count + 3 * 4;
+  // The corner at point 10, then four visible copies of it.
+  ok = ok && out[10 * 8] == 0.8f && out[14 * 8] == 0.8f && out[14 * 8 + 1] == 0.0f && out[14 * 8 + 3] == 1.0f &&
+       out[14 * 8 + 6] == 0.0f && out[15 * 8 + 1] > 0.0f;
+  std::vector<float> expected = Reference(fast);
+  ok = ok && SameBits(out, expected);
+
+  // Edges of 0.08 in 10 points: 240 units per second turns in under a sample.
+  std::vector<float> slow = square(0.08f, 10);
+  ok = ok && optimizer.Optimize(slow.data(), count, &out) == count;
+
+  OptimizerOptions options;
+  options.max_acceleration = 0.0;
+  optimizer.Configure(options);
+  ok = ok && optimizer.Optimize(fast.data(), count, &out) == count;
+  options = OptimizerOptions();
+  options.max_corner_dwell = 2;
+  optimizer.Configure(options);
+  ok = ok && optimizer.Optimize(fast.data(), count, &out) == count + 3 * 2;
+  return Report("corners hold for the scanner model", ok);
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  ok = TestMatchesJs() && ok;
+  ok = TestShapes() && ok;
+  ok = TestCorners() && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+// Runs the standalone native test executables built by `npm run build-native`.
+import { spawnSync } from 'child_process';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+const __dirname = path.dirname(fileURLToPath(import.meta.url));
+const buildDir = path.join(__dirname, '..', 'build', 'Release');
+const exe = process.platform === 'win32' ? '.exe' : '';
+
+const tests = [
+    'triple_buffer_stress',
+    'frame_scaler_test',
+    'frame_analysis_test',
+    'contour_tracer_test',
+    'frame_sync_test',
+    'bandwidth_policy_test',
+    'capture_stats_test',
+    'change_detector_test',
+    'audio_analyzer_test',
+    'shared_frame_ring_test',
+    'frame_receiver_test',
+    'point_optimizer_test',
+    'path_planner_test',
+    'galvo_simulator_test',
+    'effects_engine_test',
+];
+
+let failed = 0;
+for (const name of tests) {
+    console.log(`--- ${name} ---`);
+    const result = spawnSync(path.join(buildDir, name + exe), [], { stdio: 'inherit' });
+    if (result.error) {
+        console.error(`Failed to run ${name}:`, result.error.message);
+        failed++;
+    } else if (result.status !== 0) {
+        failed++;
+    }
+}
+
+// The addon itself, loaded from several worker threads at once.
+console.log('--- addon_workers_test ---');
+const workers = spawnSync(process.execPath, [path.join(__dirname, 'addon_workers_test.js')], { stdio: 'inherit' });
+if (workers.error || workers.status !== 0) failed++;
+
+console.log(failed === 0 ? 'All native tests passed.' : `${failed} native test(s) failed.`);
+process.exit(failed === 0 ? 0 : 1);
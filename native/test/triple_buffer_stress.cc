@@ -0,0 +1,200 @@
+// Stress test for TripleBuffer: a producer and a consumer run at mismatched
+// rates and every frame the consumer sees must be complete (no tearing) and
+// newer than the previous one. A second test stalls the producer in the middle
+// of a write and checks the consumer keeps making progress, i.e. never waits
+// on the producer.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "triple_buffer.h"
+
+namespace {
+
+struct TestFrame {
+  std::vector<uint32_t> data;
+  uint32_t sequence = 0;
+};
+
+using Clock = std::chrono::steady_clock;
+
+struct PhaseResult {
+  uint64_t published = 0;
+  uint64_t consumed = 0;
+  uint64_t torn = 0;
+  uint64_t out_of_order = 0;
+  double p99_read_us = 0.0;
+};
+
+void Spin(std::chrono::microseconds duration) {
+  if (duration.count() == 0) return;
+  auto until = Clock::now() + duration;
+  while (Clock::now() < until) {
+    std::this_thread::yield();
+  }
+}
+
+PhaseResult RunPhase(std::chrono::microseconds producer_period,
+                     std::chrono::microseconds consumer_period,
+                     std::chrono::milliseconds duration) {
+  TripleBuffer<TestFrame> buffer;
+  std::atomic<bool> stop{false};
+  PhaseResult result;
+
+  std::thread producer([&] {
+    uint32_t sequence = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      ++sequence;
+      TestFrame& frame = buffer.write_slot();
+      // Vary the size so reallocation races would show up as well.
+      frame.data.resize(4096 + (sequence % 7) * 512);
+      for (size_t i = 0; i < frame.data.size(); ++i) {
+        frame.data[i] = sequence;
+        // Stretch the write out so a reader sharing the slot would catch it
+        // half-finished.
+        if (i == frame.data.size() / 2) Spin(producer_period / 2);
+      }
+      frame.sequence = sequence;
+      buffer.Publish();
+      ++result.published;
+      Spin(producer_period / 2);
+    }
+  });
+
+  std::thread consumer([&] {
+    uint32_t last_sequence = 0;
+    std::vector<double> read_us;
+    read_us.reserve(1 << 20);
+    while (!stop.load(std::memory_order_relaxed)) {
+      auto start = Clock::now();
+      bool fresh = buffer.Update();
+      if (read_us.size() < read_us.capacity()) {
+        read_us.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+      }
+
+      if (fresh) {
+        const TestFrame& frame = buffer.read_slot();
+        for (uint32_t value : frame.data) {
+          if (value != frame.sequence) {
+            ++result.torn;
+            break;
+          }
+        }
+        if (frame.sequence <= last_sequence) ++result.out_of_order;
+        last_sequence = frame.sequence;
+        ++result.consumed;
+        // Hold the slot while "processing" to give the producer a chance to
+        // write into it if the swap logic were wrong.
+        Spin(consumer_period);
+        for (uint32_t value : frame.data) {
+          if (value != frame.sequence) {
+            ++result.torn;
+            break;
+          }
+        }
+      }
+    }
+    if (!read_us.empty()) {
+      size_t p99 = read_us.size() * 99 / 100;
+      std::nth_element(read_us.begin(), read_us.begin() + p99, read_us.end());
+      result.p99_read_us = read_us[p99];
+    }
+  });
+
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  producer.join();
+  consumer.join();
+  return result;
+}
+
+// The producer publishes one frame, then parks in the middle of writing the
+// next one until the consumer has completed kReads updates. If Update() ever
+// waited for the producer this would deadlock, which the watchdog reports.
+bool RunStalledProducer() {
+  constexpr uint64_t kReads = 1000000;
+  TripleBuffer<TestFrame> buffer;
+  std::atomic<bool> writing{false};
+  std::atomic<bool> release_producer{false};
+  std::atomic<uint64_t> reads{0};
+  std::atomic<bool> saw_first_frame{false};
+
+  std::thread producer([&] {
+    buffer.write_slot().sequence = 1;
+    buffer.Publish();
+    buffer.write_slot().sequence = 2;
+    writing = true;
+    while (!release_producer.load()) {
+      std::this_thread::yield();
+    }
+    buffer.Publish();
+  });
+
+  std::thread consumer([&] {
+    while (!writing.load()) {
+      std::this_thread::yield();
+    }
+    for (uint64_t i = 0; i < kReads; ++i) {
+      if (buffer.Update() && buffer.read_slot().sequence == 1) saw_first_frame = true;
+      reads.fetch_add(1, std::memory_order_relaxed);
+    }
+    release_producer = true;
+  });
+
+  auto deadline = Clock::now() + std::chrono::seconds(10);
+  while (!release_producer.load() && Clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bool ok = release_producer.load() && saw_first_frame.load();
+  std::printf("%-36s reads=%-8llu %s\n", "stalled producer",
+      static_cast<unsigned long long>(reads.load()), ok ? "OK" : "FAIL");
+  if (!ok) {
+    // The threads are wedged; there is nothing left to clean up safely.
+    std::fflush(stdout);
+    std::_Exit(1);
+  }
+  producer.join();
+  consumer.join();
+  return ok;
+}
+
+}  // namespace
+
+int main() {
+  struct Phase {
+    const char* name;
+    std::chrono::microseconds producer_period;
+    std::chrono::microseconds consumer_period;
+  };
+  const Phase phases[] = {
+    {"fast producer / slow consumer", std::chrono::microseconds(0), std::chrono::microseconds(2000)},
+    {"slow producer / fast consumer", std::chrono::microseconds(2000), std::chrono::microseconds(0)},
+    {"60 fps producer / 144 fps consumer", std::chrono::microseconds(16667), std::chrono::microseconds(6944)},
+    {"unthrottled both sides", std::chrono::microseconds(0), std::chrono::microseconds(0)},
+  };
+
+  bool ok = true;
+
+  for (const Phase& phase : phases) {
+    PhaseResult r = RunPhase(phase.producer_period, phase.consumer_period, std::chrono::milliseconds(500));
+    bool phase_ok = r.torn == 0 && r.out_of_order == 0 && r.consumed > 0;
+    std::printf("%-36s published=%-8llu consumed=%-8llu torn=%llu out_of_order=%llu p99_read=%.2fus %s\n",
+        phase.name,
+        static_cast<unsigned long long>(r.published),
+        static_cast<unsigned long long>(r.consumed),
+        static_cast<unsigned long long>(r.torn),
+        static_cast<unsigned long long>(r.out_of_order),
+        r.p99_read_us,
+        phase_ok ? "OK" : "FAIL");
+    ok = ok && phase_ok;
+  }
+  ok = RunStalledProducer() && ok;
+
+  return ok ? 0 : 1;
+}
@@ -44,6 +44,9 @@ import { generateCircle, generateSquare, generateLine, generateStar, generateTex
 
 const generateId = () => Math.random().toString(36).substr(2, 9);
 
+// Laser output rate. NDI sources in frame-sync mode are pulled at the same rate.
+const OUTPUT_FPS = 60;
+
 const MasterSpeedSlider = React.memo(({ playbackFps, onSpeedChange }) => {
   const handleDragStart = (e) => {
     e.dataTransfer.setData('application/x-truelazer-param', JSON.stringify({
@@ -135,6 +138,7 @@ const getInitialState = (initialSettings) => ({
   worldShowBeamEffect: initialSettings?.renderSettings?.worldShowBeamEffect ?? true,
   worldBeamRenderMode: initialSettings?.renderSettings?.worldBeamRenderMode ?? 'both',
   optimizationEnabled: initialSettings?.renderSettings?.optimizationEnabled ?? true,
+  reorderEnabled: initialSettings?.renderSettings?.reorderEnabled ?? false,
   activeClipIndexes: Array(5).fill(null),
   isPlaying: false,
   isStopped: true, // Add this
@@ -1549,7 +1553,7 @@ function App() {
   const ildaParserWorker = useIldaParserWorker();
   const thumbnailWorker = useThumbnailWorker();
     const generatorWorker = useGeneratorWorker();
-    const { fftLevels, getFftLevels, fftDataRef, timeDataRef } = useAudio() || {};
+    const { fftLevels, getFftLevels, fftDataRef, timeDataRef, fftSettings } = useAudio() || {};
 
   const {
     devices: audioDevices,
@@ -1644,6 +1648,7 @@ function App() {
     worldShowBeamEffect,
     worldBeamRenderMode,
     optimizationEnabled,
+    reorderEnabled,
     activeClipIndexes,
     isPlaying,
     isWorldOutputActive,
@@ -1763,6 +1768,7 @@ function App() {
     const selectedClipRef = useRef(null);
     const getAudioInfoRef = useRef(getAudioInfo);
     const optimizationEnabledRef = useRef(optimizationEnabled);
+    const reorderEnabledRef = useRef(reorderEnabled);
 
     useEffect(() => { isPlayingRef.current = isPlaying; }, [isPlaying]);
     useEffect(() => { isWorldOutputActiveRef.current = isWorldOutputActive; }, [isWorldOutputActive]);
@@ -1772,6 +1778,7 @@ function App() {
     useEffect(() => { selectedColIndexRef.current = selectedColIndex; }, [selectedColIndex]);
     useEffect(() => { getAudioInfoRef.current = getAudioInfo; }, [getAudioInfo]);
     useEffect(() => { optimizationEnabledRef.current = optimizationEnabled; }, [optimizationEnabled]);
+    useEffect(() => { reorderEnabledRef.current = reorderEnabled; }, [reorderEnabled]);
 
     const playbackFpsRef = useRef(playbackFps);
     useEffect(() => { playbackFpsRef.current = playbackFps; }, [playbackFps]);
@@ -1800,7 +1807,7 @@ function App() {
     const prevWorkerIdsRef = useRef(new Map()); // Add this
     const fontBufferCacheRef = useRef(new Map()); // Cache for font buffers to prevent 60fps disk reads
 
-        const lastNdiSourceNameRef = useRef(null); // Ref to track NDI source name across renders
+        const ndiReceiverSourcesRef = useRef(new Set()); // NDI sources we currently hold a receiver reference for
     
         const accumulatedTimeRef = useRef({}); // Add accumulatedTimeRef
         
@@ -1810,6 +1817,8 @@ function App() {
   const latestProcessedSeqRef = useRef(new Map()); // Track latest processed response ID per clip
   const generatorProcessingMap = useRef(new Map()); // key: "layer-col", val: boolean
   const generatorPendingMap = useRef(new Map()); // key: "layer-col", val: { message, transferables }
+  const ndiPendingJobsRef = useRef(new Map()); // key: NDI source, val: { frameId, remaining } jobs for its current frame
+  const ndiFrameIdRef = useRef(0);
   const previewTimeRef = useRef(performance.now());
       
             useEffect(() => {  
@@ -2049,7 +2058,6 @@ function App() {
     let animationFrameId;
     let dacRefreshAnimationFrameId;
     let lastFrameTime = 0;
-    const OUTPUT_FPS = 60;
     const dacFrameInterval = 1000 / OUTPUT_FPS;
 
     // Helper to merge multiple frames into one for a single DAC channel
@@ -2296,9 +2304,10 @@ function App() {
                   fftLevels: getFftLevels ? getFftLevels() : fftLevels // Use helper for fresh data
               });
 
-              // Optimization AFTER effects ensures all transitions (Mirror, Delay, Blanking) are handled
+              // Optimization AFTER effects ensures all transitions (Mirror, Delay, Blanking) are handled.
+              // With reordering on, output frames also get their segments redrawn for the least blanked travel.
               if (optimizationEnabledRef.current) {
-                  const optimizedPts = optimizePoints(modifiedFrame.points);
+                  const optimizedPts = optimizePoints(modifiedFrame.points, { reorder: reorderEnabledRef.current });
                   modifiedFrame.points = optimizedPts;
                   modifiedFrame.isTypedArray = true;
               }
@@ -3489,6 +3498,18 @@ function App() {
             }
         }
 
+        // An NDI frame is acknowledged once, when the last job posted for it comes back (done or failed), so
+        // several clips showing one source still leave a single frame in flight.
+        if (e.data.isNdi) {
+            const pending = ndiPendingJobsRef.current.get(e.data.ndiSource);
+            if (pending && pending.frameId === e.data.ndiFrameId && --pending.remaining === 0) {
+                ndiPendingJobsRef.current.delete(e.data.ndiSource);
+                if (window.electronAPI && window.electronAPI.ndiRendererReady) {
+                    window.electronAPI.ndiRendererReady(e.data.ndiSource);
+                }
+            }
+        }
+
         if (e.data.success) {
             const { layerIndex, colIndex, frames, generatorDefinition, currentParams, isLive, isAutoUpdate, seq } = e.data;
 
@@ -3537,11 +3558,6 @@ function App() {
                 if (currentName === defaultPattern) {
                     dispatch({ type: 'SET_CLIP_NAME', payload: { layerIndex, colIndex, name: generatorDefinition.name } });
                 }
-            } else if (e.data.isNdi) {
-                // If it's a live NDI frame update, signal ready for the next one
-                if (window.electronAPI && window.electronAPI.ndiRendererReady) {
-                    window.electronAPI.ndiRendererReady();
-                }
             }
         } else {
             showNotification(`Error generating frames: ${e.data.error}`);
@@ -3993,56 +4009,72 @@ function App() {
     ? clipContents[selectedLayerIndex][selectedColIndex]
     : null;
 
+  // Active NDI clips plus the selected one, which is previewed even when not playing
+  const activeNdiClips = () => {
+      const isNdiClip = (clip) => clip?.type === 'generator' && clip?.generatorDefinition?.id === 'ndi-source';
+      const clips = [];
+      layers.forEach((_, layerIndex) => {
+          const activeColIndex = activeClipIndexes[layerIndex];
+          if (activeColIndex !== null) {
+              const clip = clipContents[layerIndex][activeColIndex];
+              if (isNdiClip(clip)) clips.push(clip);
+          }
+      });
+      if (isNdiClip(selectedClip)) clips.push(selectedClip);
+      return clips;
+  };
+
   // NDI Lifecycle Management
   useEffect(() => {
       if (!window.electronAPI || !generatorWorker) return;
 
       const checkNdiClips = async () => {
-          // Find any active NDI clip
-          let activeNdiClip = null;
-          layers.forEach((_, layerIndex) => {
-              const activeColIndex = activeClipIndexes[layerIndex];
-              if (activeColIndex !== null) {
-                  const clip = clipContents[layerIndex][activeColIndex];
-                  if (clip && clip.type === 'generator' && clip.generatorDefinition?.id === 'ndi-source') {
-                      activeNdiClip = clip;
-                  }
-              }
-          });
-
-          // Also check selected clip for preview
-          if (!activeNdiClip && selectedClip?.type === 'generator' && selectedClip?.generatorDefinition?.id === 'ndi-source') {
-              activeNdiClip = selectedClip;
+          // Every source used by an active NDI clip (or the selected one, for preview) gets its own receiver
+          const wanted = new Set(activeNdiClips().map(clip => clip.currentParams?.sourceName).filter(name => name && name !== 'No Source'));
+          const held = ndiReceiverSourcesRef.current;
+
+          for (const sourceName of wanted) {
+              if (held.has(sourceName)) continue;
+              console.log(`[NDI] Connecting to source: ${sourceName}`);
+              held.add(sourceName);
+              if (!(await window.electronAPI.ndiCreateReceiver(sourceName))) held.delete(sourceName);
           }
-
-          const currentSourceName = activeNdiClip?.currentParams?.sourceName;
-
-          if (currentSourceName && currentSourceName !== 'No Source') {
-              if (currentSourceName !== lastNdiSourceNameRef.current) {
-                  console.log(`[NDI] Switching to source: ${currentSourceName}`);
-                  await window.electronAPI.ndiCreateReceiver(currentSourceName);
-                  lastNdiSourceNameRef.current = currentSourceName;
-              }
-          } else if (lastNdiSourceNameRef.current) {
-              console.log(`[NDI] Destroying receiver`);
-              await window.electronAPI.ndiDestroyReceiver();
-              lastNdiSourceNameRef.current = null;
+          for (const sourceName of [...held]) {
+              if (wanted.has(sourceName)) continue;
+              console.log(`[NDI] Releasing source: ${sourceName}`);
+              held.delete(sourceName);
+              await window.electronAPI.ndiDestroyReceiver(sourceName);
           }
       };
 
       checkNdiClips();
   }, [activeClipIndexes, clipContents, selectedClip, layers]);
 
-  // Sync NDI Settings (Resolution)
+  // Sync NDI Settings (Resolution), per source
   useEffect(() => {
-      const activeNdiClip = [...activeClipsData, selectedClip].find(c => c?.type === 'generator' && c?.generatorDefinition?.id === 'ndi-source');
-      if (activeNdiClip && window.electronAPI?.ndiUpdateSettings) {
-          const { captureWidth, captureHeight } = activeNdiClip.currentParams || {};
-          if (captureWidth && captureHeight) {
-              window.electronAPI.ndiUpdateSettings({ width: captureWidth, height: captureHeight });
+      if (!window.electronAPI?.ndiUpdateSettings) return;
+      const ndiClips = [...activeClipsData, selectedClip].filter(c => c?.type === 'generator' && c?.generatorDefinition?.id === 'ndi-source');
+      ndiClips.forEach(ndiClip => {
+          const { sourceName, captureWidth, captureHeight, scaleFilter, nativeAnalysis, nativeTrace, pointBudget, edgeDetection, threshold, frameSync, cropX = 0, cropY = 0, cropWidth = 1, cropHeight = 1 } = ndiClip.currentParams || {};
+          if (sourceName && sourceName !== 'No Source' && captureWidth && captureHeight) {
+              // Let the capture thread do luma/edge extraction so only a 1-byte mask crosses IPC,
+              // and optionally trace it into the laser path as well.
+              const analysis = nativeAnalysis === false ? 'none' : (edgeDetection ? 'edges' : 'luma');
+              const trace = analysis !== 'none' && nativeTrace !== false ? { maxPoints: pointBudget || 2000 } : false;
+              // Only the cropped region of the source is read and scaled to the capture size.
+              const x = Math.min(Math.max(cropX, 0), 0.99);
+              const y = Math.min(Math.max(cropY, 0), 0.99);
+              const crop = { x, y, width: Math.min(Math.max(cropWidth, 0.01), 1 - x), height: Math.min(Math.max(cropHeight, 0.01), 1 - y) };
+              // With the FFT source set to NDI, the capture threads analyse the embedded audio with the same bands.
+              const audio = fftSettings?.source === 'ndi' ? {
+                  lowRange: fftSettings.lowRange, midRange: fftSettings.midRange, highRange: fftSettings.highRange,
+                  peak: fftSettings.calculationMode === 'peak', smoothing: fftSettings.smoothingTimeConstant
+              } : false;
+              // Frame-sync pulls exactly one time-corrected frame per DAC frame.
+              window.electronAPI.ndiUpdateSettings({ source: sourceName, width: captureWidth, height: captureHeight, filter: scaleFilter, analysis, threshold, trace, frameSync: frameSync ? OUTPUT_FPS : false, crop, sharedMemory: !!window.electronAPI.ndiSharedMemory, audio });
           }
-      }
-  }, [activeClipsData, selectedClip]);
+      });
+  }, [activeClipsData, selectedClip, fftSettings]);
 
   // NDI Frame Handling
   // Dedicated high-frequency NDI frame handler
@@ -4050,13 +4082,15 @@ function App() {
       if (!window.electronAPI || !generatorWorker) return;
 
       const handleNdiFrame = (frame) => {
-          let hasProcessed = false;
+          const frameId = ++ndiFrameIdRef.current;
+          let jobs = 0;
           
-          // Forward frame to generator worker for processing
+          // Forward frame to the generator worker, only for clips showing this frame's source
+          const showsSource = (clip) => clip?.type === 'generator' && clip.generatorDefinition?.id === 'ndi-source' && clip.currentParams?.sourceName === frame.source;
           activeClipIndexesRef.current.forEach((activeColIndex, layerIndex) => {
               if (activeColIndex === null) return;
               const clip = clipContentsRef.current[layerIndex][activeColIndex];
-              if (clip && clip.type === 'generator' && clip.generatorDefinition?.id === 'ndi-source') {
+              if (showsSource(clip)) {
                   generatorWorker.postMessage({
                       type: 'generate',
                       layerIndex,
@@ -4065,14 +4099,16 @@ function App() {
                       params: { ...clip.generatorDefinition.defaultParams, ...clip.currentParams },
                       ndiFrame: frame,
                       isLive: true,
-                      isNdi: true // Mark as NDI task
+                      isNdi: true, // Mark as NDI task
+                      ndiSource: frame.source,
+                      ndiFrameId: frameId
                   });
-                  hasProcessed = true;
+                  jobs++;
               }
           });
 
           // Handle selected clip preview
-          if (selectedClipRef.current?.type === 'generator' && selectedClipRef.current?.generatorDefinition?.id === 'ndi-source') {
+          if (showsSource(selectedClipRef.current)) {
               generatorWorker.postMessage({
                   type: 'generate',
                   layerIndex: selectedLayerIndexRef.current,
@@ -4081,16 +4117,20 @@ function App() {
                   params: { ...selectedClipRef.current.generatorDefinition.defaultParams, ...selectedClipRef.current.currentParams },
                   ndiFrame: frame,
                   isLive: true,
-                  isNdi: true // Mark as NDI task
+                  isNdi: true, // Mark as NDI task
+                  ndiSource: frame.source,
+                  ndiFrameId: frameId
               });
-              hasProcessed = true;
+              jobs++;
           }
 
           // CRITICAL: Signal that we are ready for the next frame
-          // If we processed any NDI clips, the worker's 'onmessage' listener will call ndiRendererReady
-          // once it finishes generating the frame. This provides true back-pressure.
-          if (!hasProcessed) {
-              window.electronAPI.ndiRendererReady();
+          // With jobs posted, the worker's message listener calls ndiRendererReady once the last of them is
+          // done. This provides true back-pressure.
+          if (jobs > 0) {
+              ndiPendingJobsRef.current.set(frame.source, { frameId, remaining: jobs });
+          } else {
+              window.electronAPI.ndiRendererReady(frame.source);
           }
       };
 
@@ -5046,7 +5086,8 @@ function App() {
                   worldShowBeamEffect,
                   worldBeamRenderMode,
                   settingsPanelCollapsed: state.settingsPanelCollapsed,
-                  optimizationEnabled: state.optimizationEnabled
+                  optimizationEnabled: state.optimizationEnabled,
+                  reorderEnabled: state.reorderEnabled
               }}
               onSetRenderSetting={(setting, value) => {
                   if (setting === 'optimizationEnabled') {
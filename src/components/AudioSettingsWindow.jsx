@@ -122,6 +122,7 @@ const AudioSettingsWindow = ({ show, onClose, initialTab = 'output' }) => {
                                     <option value="external">External (Microphone/Loopback)</option>
                                     <option value="system">System Audio (Loopback)</option>
                                     <option value="clip">Clip FFT (Audio from active clips)</option>
+                                    <option value="ndi">NDI Source Audio (analysed natively)</option>
                                 </select>
                             </div>
 
@@ -3,8 +3,12 @@ import { generatorDefinitions } from '../utils/generatorDefinitions'; // Import
 
 const GeneratorPanel = () => {
   const [ndiSources, setNdiSources] = useState([]);
+  const [ndiAvailable, setNdiAvailable] = useState(true);
 
   useEffect(() => {
+    if (window.electronAPI && window.electronAPI.ndiGetCapabilities) {
+      window.electronAPI.ndiGetCapabilities().then((caps) => setNdiAvailable(!!(caps && caps.ndi)));
+    }
     const discoverSources = async () => {
       if (window.electronAPI && window.electronAPI.ndiFindSources) {
         const sources = await window.electronAPI.ndiFindSources();
@@ -13,6 +17,10 @@ const GeneratorPanel = () => {
     };
 
     discoverSources();
+    // Discovery pushes changes; poll only if the bridge cannot.
+    if (window.electronAPI && window.electronAPI.onNdiSourcesChanged) {
+      return window.electronAPI.onNdiSourcesChanged((sources) => setNdiSources(sources || []));
+    }
     const interval = setInterval(discoverSources, 5000); // Refresh every 5s
     return () => clearInterval(interval);
   }, []);
@@ -63,7 +71,7 @@ const GeneratorPanel = () => {
             </div>
           ))
         ) : (
-          <div className="empty-msg">No NDI sources found</div>
+          <div className="empty-msg">{ndiAvailable ? 'No NDI sources found' : 'NDI runtime not installed'}</div>
         )}
       </div>
     </div>
@@ -168,6 +168,18 @@ const SettingsPanel = ({
           <p className="info-text" style={{ fontSize: '9px', color: '#666', marginTop: '5px' }}>
               Optimizes geometry (interpolation/dwell) before applying effects. Fixes lines in Delay effect but increases point count.
           </p>
+          <div className="param-editor" style={{ display: 'flex', alignItems: 'center', justifyContent: 'space-between' }}>
+              <label className="param-label" style={{ fontSize: '11px' }}>Segment Reordering</label>
+              <input 
+                type="checkbox" 
+                checked={renderSettings.reorderEnabled} 
+                disabled={!renderSettings.optimizationEnabled}
+                onChange={(e) => onSetRenderSetting('reorderEnabled', e.target.checked)}
+              />
+          </div>
+          <p className="info-text" style={{ fontSize: '9px', color: '#666', marginTop: '5px' }}>
+              Redraws output frames in the order (and direction) with the least blanked travel. Needs the native addon; changes the drawing order of shapes.
+          </p>
       </CollapsiblePanel>
 
       {/* Shortcuts Settings Section */}
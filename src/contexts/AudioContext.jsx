@@ -9,7 +9,7 @@ export const AudioProvider = ({ children }) => {
     const [analyser, setAnalyser] = useState(null);
     const [externalSource, setExternalSource] = useState(null);
     const [fftSettings, setFftSettings] = useState({
-        source: 'external', // 'clip', 'external' or 'system'
+        source: 'external', // 'clip', 'external', 'system' or 'ndi'
         lowRange: [20, 250],
         midRange: [250, 4000],
         highRange: [4000, 20000],
@@ -354,16 +354,22 @@ export const AudioProvider = ({ children }) => {
 
     // FFT Analysis Loop
     useEffect(() => {
-        if (!analyser) return;
+        // NDI audio is analysed on the addon's capture threads, which apply the
+        // ranges and calculation mode themselves; only gain, hold and fall happen here.
+        const ndiAudio = fftSettings.source === 'ndi';
+        if (!analyser && !ndiAudio) return;
 
         let animationFrameId;
         const analyze = () => {
-            analyser.getByteFrequencyData(fftDataRef.current);
-            analyser.getByteTimeDomainData(timeDataRef.current);
-            
-            const sampleRate = audioCtx.sampleRate;
-            const binCount = analyser.frequencyBinCount;
-            const freqPerBin = sampleRate / analyser.fftSize;
+            if (analyser) {
+                analyser.getByteFrequencyData(fftDataRef.current);
+                analyser.getByteTimeDomainData(timeDataRef.current);
+            }
+
+            const sampleRate = audioCtx?.sampleRate || 48000;
+            const binCount = analyser ? analyser.frequencyBinCount : 0;
+            const freqPerBin = analyser ? sampleRate / analyser.fftSize : 1;
+            const ndiLevels = ndiAudio ? window.electronAPI?.ndiGetAudioLevels?.() : null;
 
             const getValue = (range) => {
                 const startBin = Math.floor(range[0] / freqPerBin);
@@ -387,9 +393,9 @@ export const AudioProvider = ({ children }) => {
                 }
             };
 
-            const rawLow = getValue(fftSettings.lowRange);
-            const rawMid = getValue(fftSettings.midRange);
-            const rawHigh = getValue(fftSettings.highRange);
+            const rawLow = ndiAudio ? (ndiLevels?.low || 0) : getValue(fftSettings.lowRange);
+            const rawMid = ndiAudio ? (ndiLevels?.mid || 0) : getValue(fftSettings.midRange);
+            const rawHigh = ndiAudio ? (ndiLevels?.high || 0) : getValue(fftSettings.highRange);
 
             const now = Date.now();
             const dt = Math.max(0, now - lastLevelsRef.current.lastUpdateTime);
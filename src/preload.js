@@ -1,4 +1,51 @@
 import { contextBridge, ipcRenderer } from 'electron';
+import { createRequire } from 'module';
+import path from 'path';
+import { fileURLToPath } from 'url';
+
+// NDI frames captured with sharedMemory stay in a shared-memory ring owned by
+// the main process; only { ring, slot, sequence, size } comes over IPC and the
+// pixels are read here. Without the addon, frames carry their data as before.
+// The addon's point optimizer, galvo simulator and effects engine stand in for
+// the JS ones in src/utils/optimizer.js, galvo.js and effects.js.
+let sharedFrameReader = null;
+let pointOptimizer = null;
+let galvoSimulator = null;
+let effectsEngine = null;
+try {
+    const require = createRequire(import.meta.url);
+    const nativeModulePath = path.join(path.dirname(fileURLToPath(import.meta.url)), '..', 'native', 'build', 'Release')
+        .replace(`app.asar${path.sep}`, `app.asar.unpacked${path.sep}`);
+    const addon = require(path.join(nativeModulePath, 'ndi_wrapper.node'));
+    sharedFrameReader = new addon.SharedFrameReader();
+    if (addon.PointOptimizer) pointOptimizer = new addon.PointOptimizer();
+    if (addon.GalvoSimulator) galvoSimulator = new addon.GalvoSimulator();
+    if (addon.EffectsEngine) effectsEngine = new addon.EffectsEngine();
+} catch (e) {
+    console.warn('NDI shared-memory frames unavailable:', e.message);
+}
+
+// The context bridge copies the result's whole buffer into the page, so the
+// frame is written straight into one of exactly the optimised length rather
+// than the optimizer's reused, larger one.
+const optimizePointsNative = (points, options) => {
+    if (options) pointOptimizer.configure(options);
+    return pointOptimizer.optimize(points, new Float32Array(pointOptimizer.outputLength(points)));
+};
+
+// Band levels that came with the newest NDI frame carrying audio, for the
+// FFT loop; read synchronously, without IPC.
+let latestNdiAudio = null;
+
+// Replaces frame.shared with the frame's data; null if the ring has already
+// reused the slot, in which case the frame is simply skipped.
+const resolveNdiFrame = (frame) => {
+    if (!frame?.shared) return frame;
+    const data = sharedFrameReader ? sharedFrameReader.read(frame.shared) : null;
+    if (!data) return null;
+    const { shared, ...rest } = frame;
+    return { ...rest, data };
+};
 
 contextBridge.exposeInMainWorld(
   'electronAPI', {
@@ -139,15 +186,42 @@ contextBridge.exposeInMainWorld(
                                                 ipcRenderer.on('osc-message-received', listener);
                                                 return () => ipcRenderer.removeListener('osc-message-received', listener);
                                             },
+                                            // Native optimizePoints(Float32Array, { maxDistance, pathDwell, pps, maxVelocity, maxAcceleration, maxCornerDwell, reorder, reorderBudgetMs, reorderEvaluations }); null without the addon
+                                            optimizePoints: pointOptimizer ? optimizePointsNative : null,
+                                            // Native simulateGalvo(Float32Array, { pps, bandwidthHz, overshoot, maxVelocity, maxAcceleration, substeps }); null without the addon
+                                            simulateGalvo: galvoSimulator ? (points, options) => {
+                                                if (options) galvoSimulator.configure(options);
+                                                return galvoSimulator.simulate(points);
+                                            } : null,
+                                            // Native applyEffectStages(Float32Array, Float64Array program compiled by effects.js); null without the addon
+                                            applyEffectStages: effectsEngine ? (points, program) => effectsEngine.apply(points, program) : null,
                                             // NDI
+                                            ndiGetCapabilities: () => ipcRenderer.invoke('ndi-get-capabilities'),
                                             ndiFindSources: () => ipcRenderer.invoke('ndi-find-sources'),
                                             ndiUpdateSettings: (settings) => ipcRenderer.invoke('ndi-update-settings', settings),
                                             ndiCreateReceiver: (sourceName) => ipcRenderer.invoke('ndi-create-receiver', sourceName),
-                                            ndiCaptureVideo: () => ipcRenderer.invoke('ndi-capture-video'),
-                                            ndiDestroyReceiver: () => ipcRenderer.invoke('ndi-destroy-receiver'),
-                                            ndiRendererReady: () => ipcRenderer.send('ndi-renderer-ready'),
+                                            ndiCaptureVideo: async (sourceName) => resolveNdiFrame(await ipcRenderer.invoke('ndi-capture-video', sourceName)),
+                                            ndiDestroyReceiver: (sourceName) => ipcRenderer.invoke('ndi-destroy-receiver', sourceName),
+                                            ndiRendererReady: (sourceName) => ipcRenderer.send('ndi-renderer-ready', sourceName),
+                                            ndiSharedMemory: sharedFrameReader !== null,
+                                            ndiGetAudio: (sourceName) => ipcRenderer.invoke('ndi-get-audio', sourceName),
+                                            ndiGetAudioLevels: () => latestNdiAudio,
+                                            onNdiSourcesChanged: (callback) => {
+                                                const listener = (event, sources) => callback(sources);
+                                                ipcRenderer.on('ndi-sources-changed', listener);
+                                                return () => ipcRenderer.removeListener('ndi-sources-changed', listener);
+                                            },
                                             onNdiFrame: (callback) => {
-                                                const listener = (event, frame) => callback(frame);
+                                                const listener = (event, frame) => {
+                                                    if (frame.audio) latestNdiAudio = frame.audio;
+                                                    const resolved = resolveNdiFrame(frame);
+                                                    if (resolved) {
+                                                        callback(resolved);
+                                                    } else {
+                                                        // Overwritten before it was read; ask for the next one.
+                                                        ipcRenderer.send('ndi-renderer-ready', frame.source);
+                                                    }
+                                                };
                                                 ipcRenderer.on('ndi-frame', listener);
                                                 return () => ipcRenderer.removeListener('ndi-frame', listener);
                                             },
@@ -1,6 +1,7 @@
 import { applyEffects, applyOutputProcessing } from './effects.js';
 import { effectDefinitions } from './effectDefinitions';
 import { optimizePoints } from './optimizer.js';
+import { simulateGalvo } from './galvo.js';
 
 export class WebGLRenderer {
   constructor(canvas, type) {
@@ -344,8 +345,9 @@ export class WebGLRenderer {
     // Apply effects before drawing
     // We pass syncSettings and bpm in the context
     const modifiedFrame = applyEffects(frameToProcess, effects, { progress, time, syncSettings, bpm, clipDuration, fftLevels, effectStates });
-    const points = modifiedFrame.points;
     const isTyped = modifiedFrame.isTypedArray;
+    // 'galvo' draws where the scanners would actually take the beam for these samples, not the ideal polyline.
+    const points = beamRenderMode === 'galvo' && isTyped ? simulateGalvo(modifiedFrame.points) : modifiedFrame.points;
     const numPoints = isTyped ? (points.length / 8) : points.length;
     
     if (numPoints === 0) return;
@@ -384,7 +386,7 @@ export class WebGLRenderer {
     const drawNormalFrame = () => {
       // Modes: 'points' (dots), 'lines' (strip), 'both' (strip + dots)
       const drawPoints = beamRenderMode === 'points' || beamRenderMode === 'both';
-      const drawLines = beamRenderMode === 'lines' || beamRenderMode === 'both';
+      const drawLines = beamRenderMode === 'lines' || beamRenderMode === 'both' || beamRenderMode === 'galvo';
       
       if (drawLines) {
           let currentSegmentPositions = [];
@@ -496,7 +498,7 @@ export class WebGLRenderer {
     if (showBeamEffect) {
       if (beamRenderMode === 'points') {
         drawPointsEffect();
-      } else if (beamRenderMode === 'lines') {
+      } else if (beamRenderMode === 'lines' || beamRenderMode === 'galvo') {
         drawLinesEffect();
       } else if (beamRenderMode === 'both') {
         drawLinesEffect();
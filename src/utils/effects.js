@@ -165,6 +165,14 @@ export function applyEffects(frame, effects, context = {}) {
   }
 
   let activePoints = currentPoints;
+  // Per-point effects queue up here and run together, in one pass, before the next effect that
+  // reshapes the frame (mirror, delay, chase) and at the end.
+  let program = [];
+  const runProgram = () => {
+    if (program.length === 0) return;
+    activePoints = runEffectStages(activePoints, program);
+    program = [];
+  };
 
   for (const effect of effects) {
     const params = effect.params;
@@ -173,9 +181,6 @@ export function applyEffects(frame, effects, context = {}) {
     const definition = definitionsById[effect.id];
     if (!definition) continue;
 
-    // Resolve current number of points based on current buffer
-    const currentNumPoints = activePoints.length / 8;
-
     // Optimization: only resolve params if sync settings exist for this effect
     let resolvedParams = params;
     const instancePrefix = effect.instanceId ? `${effect.instanceId}.` : `${effect.id}.`;
@@ -201,89 +206,288 @@ export function applyEffects(frame, effects, context = {}) {
 
     switch (effect.id) {
       case 'rotate':
-        applyRotate(activePoints, currentNumPoints, resolvedParams, progress, time);
+        stageRotate(program, resolvedParams, time);
         break;
       case 'scale':
-        applyScale(activePoints, currentNumPoints, resolvedParams);
+        stageScale(program, resolvedParams);
         break;
       case 'translate':
-        applyTranslate(activePoints, currentNumPoints, resolvedParams);
+        stageTranslate(program, resolvedParams);
         break;
       case 'color':
-        applyColor(activePoints, currentNumPoints, resolvedParams, time);
+        stageColor(program, resolvedParams, time);
         break;
       case 'wave':
-        applyWave(activePoints, currentNumPoints, resolvedParams, time);
+        stageWave(program, resolvedParams, time);
         break;
       case 'blanking':
-        applyBlanking(activePoints, currentNumPoints, resolvedParams);
+        stageBlanking(program, resolvedParams);
         break;
       case 'strobe':
-        applyStrobe(activePoints, currentNumPoints, resolvedParams, time);
+        stageStrobe(program, resolvedParams, time);
         break;
       case 'mirror':
-        activePoints = applyMirror(activePoints, currentNumPoints, resolvedParams);
+        runProgram();
+        activePoints = applyMirror(activePoints, activePoints.length / 8, resolvedParams);
         break;
       case 'warp':
-        applyWarp(activePoints, currentNumPoints, resolvedParams, time);
+        stageWarp(program, resolvedParams, time);
         break;
       case 'distortion':
-        applyDistortion(activePoints, currentNumPoints, resolvedParams, time);
+        stageDistortion(program, resolvedParams, time);
         break;
       case 'move':
-        applyMove(activePoints, currentNumPoints, resolvedParams, time);
+        stageMove(program, resolvedParams, time);
         break;
       case 'delay':
         if (effectStates && effect.instanceId) {
-            activePoints = applyDelay(activePoints, currentNumPoints, resolvedParams, effectStates, effect.instanceId, context);
+            runProgram();
+            activePoints = applyDelay(activePoints, activePoints.length / 8, resolvedParams, effectStates, effect.instanceId, context);
         }
         break;
       case 'chase':
-        activePoints = applyChase(activePoints, currentNumPoints, resolvedParams, time, context);
+        runProgram();
+        activePoints = applyChase(activePoints, activePoints.length / 8, resolvedParams, time, context);
         break;
     }
   }
+  runProgram();
 
-  // Final result must be a NEW buffer because it's passed around, but we've reduced intermediate ones
-  const finalPoints = new Float32Array(activePoints);
+  // Final result must be a NEW buffer because it's passed around, but we've reduced intermediate ones.
+  // Only the in-place stages leave the frame in the shared processing buffer.
+  const finalPoints = activePoints.buffer === processingBuffer.buffer ? new Float32Array(activePoints) : activePoints;
   if (activePoints._channelDistributions) {
       finalPoints._channelDistributions = activePoints._channelDistributions;
   }
   return { ...frame, points: finalPoints, isTypedArray: true };
 }
 
-function applyRotate(points, numPoints, params, progress, time) {
+// Opcodes of EffectOp in native/src/effects_engine.h. The per-point effects compile, with their parameters
+// resolved for the frame, into a program of opcodes each followed by its arguments, which runs in one pass.
+const OP_ROTATE = 1;
+const OP_SCALE = 2;
+const OP_TRANSLATE = 3;
+const OP_FILL = 4;
+const OP_RAINBOW = 5;
+const OP_GRADIENT = 6;
+const OP_PALETTE = 7;
+const OP_WAVE = 8;
+const OP_WARP = 9;
+const OP_DISTORTION = 10;
+const OP_MOVE = 11;
+const OP_BLANK_EVERY = 12;
+const OP_BLANK_ALL = 13;
+
+// A channel of hslToRgb(h, 1, 0.5), whose p and q are exactly 0 and 1.
+function hueChannel(t) {
+    if (t < 0) t += 1;
+    if (t > 1) t -= 1;
+    if (t < 1/6) return 6 * t;
+    if (t < 1/2) return 1;
+    if (t < 2/3) return (2/3 - t) * 6;
+    return 0;
+}
+
+// sin and cos as SinCos() in native/src/effects_engine.cc computes them, step for step, so both give the same
+// bits where Math.sin and libm's sin can differ in the last one: reduced by the nearest multiple of pi/2 in three
+// parts, then fdlibm's kernel polynomials.
+const TWO_OVER_PI = 6.36619772367581382433e-01;
+const PI_OVER_2_HI = 1.57079632673412561417e+00;
+const PI_OVER_2_MID = 6.07710050630396597660e-11;
+const PI_OVER_2_LO = 2.02226624879595063154e-21;
+
+function sinKernel(r) {
+    const z = r * r;
+    const p = 8.33333333332248946124e-03 +
+        z * (-1.98412698298579493134e-04 +
+            z * (2.75573137070700676789e-06 +
+                z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+    return r + z * r * (-1.66666666666666324348e-01 + z * p);
+}
+
+function cosKernel(r) {
+    const z = r * r;
+    const p = z * (4.16666666666666019037e-02 +
+        z * (-1.38888888888741095749e-03 +
+            z * (2.48015872894767294178e-05 +
+                z * (-2.75573143513906633035e-07 +
+                    z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+    const half = 0.5 * z;
+    const w = 1.0 - half;
+    return w + (((1.0 - w) - half) + z * p);
+}
+
+function detSinCos(value, cosine) {
+    const k = Math.floor(value * TWO_OVER_PI + 0.5);
+    const r = ((value - k * PI_OVER_2_HI) - k * PI_OVER_2_MID) - k * PI_OVER_2_LO;
+    let quadrant = k - Math.floor(k / 4) * 4;
+    if (cosine) quadrant = quadrant === 3 ? 0 : quadrant + 1;
+    if (quadrant === 0) return sinKernel(r);
+    if (quadrant === 1) return cosKernel(r);
+    if (quadrant === 2) return -sinKernel(r);
+    return -cosKernel(r);
+}
+
+const detSin = (value) => detSinCos(value, false);
+const detCos = (value) => detSinCos(value, true);
+
+// Same stages as EffectsEngine in native/src/effects_engine.cc, in place, for contexts without the addon:
+// each stage over the whole frame, rounding to float between them as the native one does, so the two give
+// the same bits.
+function runStagesTyped(points, numPoints, stages) {
+    let at = 0;
+    while (at < stages.length) {
+        const op = stages[at];
+        if (op === OP_ROTATE) {
+            const cos = stages[at + 1], sin = stages[at + 2];
+            for (let i = 0; i < numPoints; i++) {
+                const offset = i * 8;
+                const x = points[offset];
+                const y = points[offset + 1];
+                points[offset] = x * cos - y * sin;
+                points[offset + 1] = x * sin + y * cos;
+            }
+            at += 3;
+        } else if (op === OP_SCALE || op === OP_TRANSLATE) {
+            const ax = stages[at + 1], ay = stages[at + 2];
+            for (let i = 0; i < numPoints; i++) {
+                const offset = i * 8;
+                if (op === OP_SCALE) {
+                    points[offset] *= ax;
+                    points[offset + 1] *= ay;
+                } else {
+                    points[offset] += ax;
+                    points[offset + 1] += ay;
+                }
+            }
+            at += 3;
+        } else if (op === OP_FILL) {
+            for (let i = 0; i < numPoints; i++) {
+                const offset = i * 8;
+                points[offset + 3] = stages[at + 1];
+                points[offset + 4] = stages[at + 2];
+                points[offset + 5] = stages[at + 3];
+            }
+            at += 4;
+        } else if (op === OP_RAINBOW) {
+            const spread = stages[at + 1], phase = stages[at + 2], shift = stages[at + 3];
+            for (let i = 0; i < numPoints; i++) {
+                const offset = i * 8;
+                const pos = ((i / numPoints * spread) + phase + shift) % 1.0;
+                points[offset + 3] = Math.round(hueChannel(pos + 1/3) * 255);
+                points[offset + 4] = Math.round(hueChannel(pos) * 255);
+                points[offset + 5] = Math.round(hueChannel(pos - 1/3) * 255);
+            }
+            at += 4;
+        } else if (op === OP_GRADIENT || op === OP_PALETTE) {
+            const spread = stages[at + 1], phase = stages[at + 2], shift = stages[at + 3];
+            const count = stages[at + 4];
+            const colors = at + 5;
+            const wrap = op === OP_PALETTE;
+            const span = wrap ? count : count - 1;
+            for (let i = 0; i < numPoints; i++) {
+                const offset = i * 8;
+                let pos = ((i / numPoints * spread) + phase + shift) % 1.0;
+                // A negative offset wraps round rather than reading before the colours.
+                if (pos < 0) pos += 1;
+                const scaledPos = pos * span;
+                const floor = Math.floor(scaledPos);
+                const factor = scaledPos - floor;
+                let from = floor >= 0 ? floor : 0;
+                if (from >= count) from = 0;
+                let to = from + 1;
+                if (to === count) to = wrap ? 0 : from;
+                const c1 = colors + from * 3, c2 = colors + to * 3;
+                points[offset + 3] = Math.round(stages[c1] + (stages[c2] - stages[c1]) * factor);
+                points[offset + 4] = Math.round(stages[c1 + 1] + (stages[c2 + 1] - stages[c1 + 1]) * factor);
+                points[offset + 5] = Math.round(stages[c1 + 2] + (stages[c2 + 2] - stages[c1 + 2]) * factor);
+            }
+            at += 5 + count * 3;
+        } else if (op === OP_WAVE) {
+            // The axis that is read; the other one bends.
+            const along = stages[at + 1] === 0 ? 0 : 1;
+            const amplitude = stages[at + 2], frequency = stages[at + 3], timeShift = stages[at + 4];
+            for (let i = 0; i < numPoints; i++) {
+                const offset = i * 8;
+                points[offset + 1 - along] += amplitude * detSin(points[offset + along] * frequency + timeShift);
+            }
+            at += 5;
+        } else if (op === OP_WARP) {
+            const amount = stages[at + 1], chaos = stages[at + 2], t = stages[at + 3];
+            for (let i = 0; i < numPoints; i++) {
+                const off = i * 8;
+                const x = points[off]; const y = points[off + 1];
+                points[off] += detSin(Math.abs(y) * 10 * (1 + chaos) + t) * amount * detCos(t * chaos);
+                points[off + 1] += detCos(Math.abs(x) * 10 * (1 + chaos) + t) * amount * detSin(t * chaos);
+            }
+            at += 4;
+        } else if (op === OP_DISTORTION) {
+            const amount = stages[at + 1], scale = stages[at + 2], t = stages[at + 3];
+            for (let i = 0; i < numPoints; i++) {
+                const off = i * 8;
+                const noiseX = detSin(points[off] * scale + t) * detCos(points[off + 1] * scale - t);
+                const noiseY = detCos(points[off] * scale - t) * detSin(points[off + 1] * scale + t);
+                points[off] += noiseX * amount;
+                points[off + 1] += noiseY * amount;
+            }
+            at += 4;
+        } else if (op === OP_MOVE) {
+            const offsetX = stages[at + 1], offsetY = stages[at + 2];
+            const cycle = 4;
+            for (let i = 0; i < numPoints; i++) {
+                const off = i * 8;
+                let valX = (points[off] + offsetX + 1) % cycle;
+                if (valX < 0) valX += cycle;
+                if (valX > 2) valX = 4 - valX;
+                let valY = (points[off + 1] + offsetY + 1) % cycle;
+                if (valY < 0) valY += cycle;
+                if (valY > 2) valY = 4 - valY;
+                points[off] = valX - 1; points[off + 1] = valY - 1;
+            }
+            at += 3;
+        } else if (op === OP_BLANK_EVERY) {
+            const interval = stages[at + 1], step = stages[at + 2];
+            for (let i = 0; i < numPoints; i++) {
+                if ((i % step) >= interval) points[i * 8 + 6] = 1;
+            }
+            at += 3;
+        } else if (op === OP_BLANK_ALL) {
+            for (let i = 0; i < numPoints; i++) points[i * 8 + 6] = 1;
+            at += 1;
+        } else {
+            break;
+        }
+    }
+    return points;
+}
+
+// Runs a compiled program over the frame: with the addon's engine (exposed by the preload) when present,
+// which returns a new buffer, otherwise in place.
+function runEffectStages(points, program) {
+    const stages = Float64Array.from(program);
+    const nativeRun = globalThis.electronAPI?.applyEffectStages;
+    if (!nativeRun) return runStagesTyped(points, points.length / 8, stages);
+    const result = nativeRun(points, stages);
+    if (points._channelDistributions) result._channelDistributions = points._channelDistributions;
+    return result;
+}
+
+function stageRotate(program, params, time) {
   const { angle, speed, direction } = params;
   const dirMult = direction === 'CCW' ? -1 : 1;
   const continuousRotation = (time * 0.001) * speed * dirMult;
   const currentAngle = (angle * Math.PI / 180) + continuousRotation;
-  const sin = Math.sin(currentAngle);
-  const cos = Math.cos(currentAngle);
-  for (let i = 0; i < numPoints; i++) {
-    const offset = i * 8;
-    const x = points[offset];
-    const y = points[offset + 1];
-    points[offset] = x * cos - y * sin;
-    points[offset + 1] = x * sin + y * cos;
-  }
+  program.push(OP_ROTATE, Math.cos(currentAngle), Math.sin(currentAngle));
 }
 
-function applyScale(points, numPoints, params) {
+function stageScale(program, params) {
   const { scaleX, scaleY } = params;
-  for (let i = 0; i < numPoints; i++) {
-    const offset = i * 8;
-    points[offset] *= scaleX;
-    points[offset + 1] *= scaleY;
-  }
+  program.push(OP_SCALE, scaleX, scaleY);
 }
 
-function applyTranslate(points, numPoints, params) {
+function stageTranslate(program, params) {
   const { translateX, translateY } = params;
-  for (let i = 0; i < numPoints; i++) {
-    const offset = i * 8;
-    points[offset] += translateX;
-    points[offset + 1] += translateY;
-  }
+  program.push(OP_TRANSLATE, translateX, translateY);
 }
 
 function hexToRgb(hex) {
@@ -333,7 +537,7 @@ function rgbToHsv(r, g, b) {
     return { h, s, v };
 }
 
-function applyColor(points, numPoints, params, time) {
+function stageColor(program, params, time) {
   const { 
       mode, r, g, b, color, 
       hue, saturation, brightness,
@@ -343,42 +547,19 @@ function applyColor(points, numPoints, params, time) {
   const cycleTime = time * 0.001 * cycleSpeed;
 
   if (mode === 'palette') {
-      // ... existing palette logic ...
       const activeCount = Math.min(paletteColors.length, paletteSize);
       const colors = paletteColors.slice(0, activeCount).map(hexToRgb);
       if (colors.length === 0) colors.push({r:255, g:255, b:255});
-      
-      for (let i = 0; i < numPoints; i++) {
-          const offset = i * 8;
-          const normalizedPos = ((i / numPoints * paletteSpread) + (cycleTime * 0.5) + (rainbowOffset / 360)) % 1.0;
-          
-          const scaledPos = normalizedPos * (colors.length);
-          const index = Math.floor(scaledPos) % colors.length;
-          const nextIndex = (index + 1) % colors.length;
-          const factor = scaledPos - Math.floor(scaledPos);
-          
-          const c1 = colors[index];
-          const c2 = colors[nextIndex];
-          
-          points[offset + 3] = Math.round(c1.r + (c2.r - c1.r) * factor);
-          points[offset + 4] = Math.round(c1.g + (c2.g - c1.g) * factor);
-          points[offset + 5] = Math.round(c1.b + (c2.b - c1.b) * factor);
-      }
+      program.push(OP_PALETTE, paletteSpread, cycleTime * 0.5, rainbowOffset / 360, colors.length);
+      for (const c of colors) program.push(c.r, c.g, c.b);
   } else if (mode === 'rainbow') {
-    // ... existing rainbow logic ...
     const palette = rainbowPalette || 'rainbow';
-    for (let i = 0; i < numPoints; i++) {
-      const offset = i * 8;
-      const normalizedPos = ((i / numPoints * rainbowSpread) + (cycleTime * 0.5) + (rainbowOffset / 360)) % 1.0;
-      let cr, cg, cb;
-      if (palette === 'rainbow') {
-        [cr, cg, cb] = hslToRgb(normalizedPos, 1, 0.5);
-      } else {
-        [cr, cg, cb] = getPaletteColor(palette, normalizedPos);
-      }
-      points[offset + 3] = cr;
-      points[offset + 4] = cg;
-      points[offset + 5] = cb;
+    if (palette === 'rainbow') {
+      program.push(OP_RAINBOW, rainbowSpread, cycleTime * 0.5, rainbowOffset / 360);
+    } else {
+      const colors = gradientPalettes[palette] || gradientPalettes['fire'];
+      program.push(OP_GRADIENT, rainbowSpread, cycleTime * 0.5, rainbowOffset / 360, colors.length);
+      for (const c of colors) program.push(c.r, c.g, c.b);
     }
   } else {
     let fr = r, fg = g, fb = b;
@@ -394,37 +575,19 @@ function applyColor(points, numPoints, params, time) {
     if (cycleSpeed > 0) {
       const hueCycle = (cycleTime * 50) % 360;
       const [cr, cg, cb] = hslToRgb(hueCycle / 360, 1, 0.5);
-      for (let i = 0; i < numPoints; i++) {
-        const offset = i * 8;
-        points[offset + 3] = cr;
-        points[offset + 4] = cg;
-        points[offset + 5] = cb;
-      }
+      program.push(OP_FILL, cr, cg, cb);
     } else {
-      for (let i = 0; i < numPoints; i++) {
-        const offset = i * 8;
-        points[offset + 3] = fr;
-        points[offset + 4] = fg;
-        points[offset + 5] = fb;
-      }
+      program.push(OP_FILL, fr, fg, fb);
     }
   }
 }
 
-function getPaletteColor(paletteName, pos) {
-  const palettes = {
-    'fire': [{ r: 255, g: 0, b: 0 }, { r: 255, g: 128, b: 0 }, { r: 255, g: 255, b: 0 }, { r: 255, g: 0, b: 0 }],
-    'ice': [{ r: 0, g: 0, b: 255 }, { r: 0, g: 255, b: 255 }, { r: 255, g: 255, b: 255 }, { r: 0, g: 0, b: 255 }],
-    'cyber': [{ r: 255, g: 0, b: 255 }, { r: 0, g: 255, b: 255 }, { r: 0, g: 0, b: 255 }, { r: 255, g: 0, b: 255 }]
-  };
-  const colors = palettes[paletteName] || palettes['fire'];
-  const scaledPos = pos * (colors.length - 1);
-  const index = Math.floor(scaledPos);
-  const factor = scaledPos - index;
-  const c1 = colors[index];
-  const c2 = colors[index + 1] || colors[index];
-  return [Math.round(c1.r + (c2.r - c1.r) * factor), Math.round(c1.g + (c2.g - c1.g) * factor), Math.round(c1.b + (c2.b - c1.b) * factor)];
-}
+// The rainbow presets other than 'rainbow' itself: gradients across the frame.
+const gradientPalettes = {
+  'fire': [{ r: 255, g: 0, b: 0 }, { r: 255, g: 128, b: 0 }, { r: 255, g: 255, b: 0 }, { r: 255, g: 0, b: 0 }],
+  'ice': [{ r: 0, g: 0, b: 255 }, { r: 0, g: 255, b: 255 }, { r: 255, g: 255, b: 255 }, { r: 0, g: 0, b: 255 }],
+  'cyber': [{ r: 255, g: 0, b: 255 }, { r: 0, g: 255, b: 255 }, { r: 0, g: 0, b: 255 }, { r: 255, g: 0, b: 255 }]
+};
 
 function hslToRgb(h, s, l) {
   let r, g, b;
@@ -448,38 +611,24 @@ function hslToRgb(h, s, l) {
   return [Math.round(r * 255), Math.round(g * 255), Math.round(b * 255)];
 }
 
-function applyWave(points, numPoints, params, time) {
+function stageWave(program, params, time) {
   const { amplitude, frequency, speed, direction } = params;
   const timeShift = time * 0.001 * speed;
-  for (let i = 0; i < numPoints; i++) {
-    const offset = i * 8;
-    if (direction === 'x') {
-      points[offset + 1] += amplitude * Math.sin(points[offset] * frequency + timeShift);
-    } else if (direction === 'y') {
-      points[offset] += amplitude * Math.sin(points[offset + 1] * frequency + timeShift);
-    }
-  }
+  if (direction === 'x') program.push(OP_WAVE, 0, amplitude, frequency, timeShift);
+  else if (direction === 'y') program.push(OP_WAVE, 1, amplitude, frequency, timeShift);
 }
 
-function applyBlanking(points, numPoints, params) {
+function stageBlanking(program, params) {
   const { blankingInterval, spacing = 0 } = params;
   if (blankingInterval <= 0) return;
   const step = blankingInterval + 1 + spacing;
-  for (let i = 0; i < numPoints; i++) {
-    if ((i % step) >= blankingInterval) {
-        points[i * 8 + 6] = 1;
-    }
-  }
+  program.push(OP_BLANK_EVERY, blankingInterval, step);
 }
 
-function applyStrobe(points, numPoints, params, time) {
+function stageStrobe(program, params, time) {
   const { strobeSpeed, strobeAmount } = params;
   const cyclePosition = (time % strobeSpeed) / strobeSpeed;
-  if (cyclePosition < strobeAmount) {
-    for (let i = 0; i < numPoints; i++) {
-        points[i * 8 + 6] = 1;
-    }
-  }
+  if (cyclePosition < strobeAmount) program.push(OP_BLANK_ALL);
 }
 
 function applyMirror(points, numPoints, params) {
@@ -685,50 +834,20 @@ function applyMirror(points, numPoints, params) {
   }
 }
 
-function applyWarp(points, numPoints, params, time) {
+function stageWarp(program, params, time) {
     const { amount, chaos, speed } = params;
-    const t = time * 0.001 * speed;
-    for(let i=0; i<numPoints; i++) {
-        const off = i*8;
-        const x = points[off]; const y = points[off+1];
-        const symY = Math.abs(y);
-        points[off] += Math.sin(symY * 10 * (1+chaos) + t) * amount * Math.cos(t * chaos);
-        points[off+1] += Math.cos(Math.abs(x) * 10 * (1+chaos) + t) * amount * Math.sin(t * chaos);
-    }
+    program.push(OP_WARP, amount, chaos, time * 0.001 * speed);
 }
 
-function applyDistortion(points, numPoints, params, time) {
+function stageDistortion(program, params, time) {
    const { amount, scale, speed } = params;
-   const t = time * 0.001 * speed;
-   for(let i=0; i<numPoints; i++) {
-       const off = i*8;
-       const noiseX = Math.sin(points[off] * scale + t) * Math.cos(points[off+1] * scale - t);
-       const noiseY = Math.cos(points[off] * scale - t) * Math.sin(points[off+1] * scale + t);
-       points[off] += noiseX * amount;
-       points[off+1] += noiseY * amount;
-   }
+   program.push(OP_DISTORTION, amount, scale, time * 0.001 * speed);
 }
 
-function applyMove(points, numPoints, params, time) {
+function stageMove(program, params, time) {
     const { speedX, speedY } = params;
     const t = time * 0.001;
-    const offsetX = t * speedX;
-    const offsetY = t * speedY;
-    const cycle = 4;
-    for(let i=0; i<numPoints; i++) {
-        const off = i*8;
-        let x = points[off] + offsetX;
-        let y = points[off+1] + offsetY;
-        let valX = (x + 1) % cycle;
-        if (valX < 0) valX += cycle;
-        if (valX > 2) valX = 4 - valX;
-        x = valX - 1;
-        let valY = (y + 1) % cycle;
-        if (valY < 0) valY += cycle;
-        if (valY > 2) valY = 4 - valY;
-        y = valY - 1;
-        points[off] = x; points[off+1] = y;
-    }
+    program.push(OP_MOVE, t * speedX, t * speedY);
 }
 
 function applyDelay(points, numPoints, params, effectStates, instanceId, context) {
@@ -1,6 +1,18 @@
+import { createRequire } from 'module';
 import { describe, it, expect } from 'vitest';
 import { applyEffects } from './effects';
 
+// The addon's effects engine, when it has been built, to run the stages as
+// the preload's applyEffectStages does.
+let nativeEngine = null;
+try {
+  const require = createRequire(import.meta.url);
+  const addon = require('../../native/build/Release/ndi_wrapper.node');
+  if (addon.EffectsEngine) nativeEngine = new addon.EffectsEngine();
+} catch (e) {
+  // Not built; the comparison below is skipped.
+}
+
 describe('applyMirror', () => {
   const mockFrame = (points) => ({
     points: new Float32Array(points.flatMap(p => [p.x, p.y, 0, 255, 255, 255, 0, 0])),
@@ -114,3 +126,77 @@ describe('applyDelay', () => {
     expect(pts[2].x).toBeCloseTo(0); 
   });
 });
+
+describe('per-point effects', () => {
+  const mockFrame = (points) => ({
+    points: new Float32Array(points.flatMap(p => [p.x, p.y, 0, 255, 255, 255, 0, 0])),
+    isTypedArray: true
+  });
+
+  it('should run in order around effects that reshape the frame', () => {
+    const frame = mockFrame([{ x: 0.5, y: 0.25 }]);
+    const effects = [
+      { id: 'scale', params: { scaleX: 2, scaleY: 2 } },
+      { id: 'translate', params: { translateX: -0.5, translateY: 0 } },
+      { id: 'mirror', params: { mode: 'x+', axisOffset: 0, additive: true } },
+      { id: 'color', params: { mode: 'solid', r: 10, g: 20, b: 30, cycleSpeed: 0 } },
+      { id: 'blanking', params: { blankingInterval: 1, spacing: 0 } }
+    ];
+
+    const points = applyEffects(frame, effects).points;
+
+    // (0.5, 0.5), the blanked bridge, then its mirror image.
+    expect(points.length).toBe(3 * 8);
+    expect(points[0]).toBeCloseTo(0.5);
+    expect(points[1]).toBeCloseTo(0.5);
+    expect(points[16]).toBeCloseTo(-0.5);
+    // The colour reaches the mirrored points too; every second point is blanked.
+    for (let i = 0; i < 3; i++) {
+      expect(points[i * 8 + 3]).toBe(10);
+      expect(points[i * 8 + 5]).toBe(30);
+    }
+    expect(points[6]).toBe(0);
+    expect(points[14]).toBe(1);
+    // Input frames are left alone.
+    expect(frame.points[0]).toBe(0.5);
+  });
+});
+
+// The native stages round to float as the JS ones do and share their sin
+// and cos, so every lane must come out the same.
+describe.skipIf(!nativeEngine)('per-point effects, native against JS', () => {
+  const frame = () => {
+    const points = new Float32Array(300 * 8);
+    for (let i = 0; i < 300; i++) {
+      points.set([Math.cos(i * 0.07) * 0.8, Math.sin(i * 0.11) * 0.8, 0, 255, 255, 255, 0, 0], i * 8);
+    }
+    return { points, isTypedArray: true };
+  };
+  const run = (effects, native) => {
+    globalThis.electronAPI = native ? { applyEffectStages: (points, program) => nativeEngine.apply(points, program) } : undefined;
+    try {
+      return applyEffects(frame(), effects, { time: 1234 }).points;
+    } finally {
+      delete globalThis.electronAPI;
+    }
+  };
+
+  it('should match exactly', () => {
+    for (const effects of [
+      [
+        { id: 'rotate', params: { angle: 30, speed: 0.5, direction: 'CW' } },
+        { id: 'scale', params: { scaleX: 0.9, scaleY: 1.1 } },
+        { id: 'translate', params: { translateX: 0.05, translateY: -0.05 } },
+        { id: 'blanking', params: { blankingInterval: 3, spacing: 1 } }
+      ],
+      [{ id: 'wave', params: { amplitude: 0.1, frequency: 12, speed: 1.7, direction: 'x' } }],
+      [{ id: 'warp', params: { amount: 0.05, chaos: 0.3, speed: 1 } }],
+      [{ id: 'distortion', params: { amount: 0.05, scale: 4, speed: 2 } }]
+    ]) {
+      const native = run(effects, true);
+      const js = run(effects, false);
+      expect(native.length).toBe(js.length);
+      for (let i = 0; i < js.length; i++) expect(native[i]).toBe(js[i]);
+    }
+  });
+});
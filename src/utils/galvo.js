@@ -0,0 +1,62 @@
+// Defaults of GalvoOptions in native/src/galvo_simulator.h: the same 30k scanner the optimizer plans for.
+const GALVO_DEFAULTS = {
+    pps: 30000,
+    bandwidthHz: 3000,
+    overshoot: 0.05,
+    maxVelocity: 2400,
+    maxAcceleration: 2.5e7,
+    substeps: 8,
+};
+
+// Damping ratio giving `overshoot` on a step response.
+const dampingRatio = (overshoot) => {
+    if (!(overshoot > 0)) return 1;
+    if (overshoot >= 1) return 0;
+    const log = Math.log(overshoot);
+    return -log / Math.sqrt(Math.PI * Math.PI + log * log);
+};
+
+// Same second-order model as GalvoSimulator in native/src/galvo_simulator.cc, for contexts without the
+// addon (the preview worker, tests): each axis is pulled towards the held sample with
+// a = w^2 (target - x) - 2 zeta w v, clamped to maxAcceleration, its velocity to maxVelocity.
+function simulateTyped(points, options) {
+    const { pps, bandwidthHz, overshoot, maxVelocity, maxAcceleration } = { ...GALVO_DEFAULTS, ...options };
+    const substeps = Math.min(Math.max(Math.floor(options?.substeps ?? GALVO_DEFAULTS.substeps), 1), 256);
+    const omega = 2 * Math.PI * Math.max(bandwidthHz, 0);
+    const omega2 = omega * omega;
+    const damping = 2 * dampingRatio(overshoot) * omega;
+    const dt = pps > 0 ? 1 / (pps * substeps) : 0;
+    const vMax = maxVelocity > 0 ? maxVelocity : Infinity;
+    const aMax = maxAcceleration > 0 ? maxAcceleration : Infinity;
+
+    const count = Math.floor(points.length / 8);
+    const out = new Float32Array(count * 8);
+    if (count === 0) return out;
+    // Frames repeat, so the mirrors start at rest on the last point.
+    let x = points[(count - 1) * 8], y = points[(count - 1) * 8 + 1], vx = 0, vy = 0;
+    for (let i = 0; i < count; i++) {
+        const off = i * 8;
+        const tx = points[off], ty = points[off + 1];
+        for (let s = 0; s < substeps; s++) {
+            const ax = Math.min(Math.max(omega2 * (tx - x) - damping * vx, -aMax), aMax);
+            vx = Math.min(Math.max(vx + ax * dt, -vMax), vMax);
+            x += vx * dt;
+            const ay = Math.min(Math.max(omega2 * (ty - y) - damping * vy, -aMax), aMax);
+            vy = Math.min(Math.max(vy + ay * dt, -vMax), vMax);
+            y += vy * dt;
+        }
+        out.set(points.subarray(off, off + 8), off);
+        out[off] = x;
+        out[off + 1] = y;
+    }
+    return out;
+}
+
+// Where the scanners would take the beam for a frame of 8-float samples (the stream sent to the DAC): one
+// point per sample at the simulated position, with the sample's colour and blanking. The addon's
+// simulator (exposed by the preload) runs it when present.
+export function simulateGalvo(points, options = {}) {
+    if (!(points instanceof Float32Array)) return new Float32Array(0);
+    const nativeSimulate = globalThis.electronAPI?.simulateGalvo;
+    return nativeSimulate ? nativeSimulate(points, options) : simulateTyped(points, options);
+}
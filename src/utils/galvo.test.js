@@ -0,0 +1,34 @@
+import { describe, it, expect } from 'vitest';
+import { simulateGalvo } from './galvo';
+
+// `count` visible samples at (x, 0), then one back at the origin: frames repeat, so the mirrors start
+// at rest there and the frame is a step.
+const step = (x, count) => {
+  const points = new Float32Array((count + 1) * 8);
+  for (let i = 0; i < count; i++) points.set([x, 0, 0, 1, 0.5, 0.25, 0, 0], i * 8);
+  return points;
+};
+
+describe('simulateGalvo', () => {
+  it('rings on small steps as configured', () => {
+    const trace = simulateGalvo(step(0.001, 200), { pps: 100000 });
+    let peak = 0;
+    for (let i = 0; i < 200; i++) peak = Math.max(peak, trace[i * 8]);
+    expect((peak - 0.001) / 0.001).toBeCloseTo(0.05, 2);
+    expect(trace[199 * 8]).toBeCloseTo(0.001, 5);
+    // Colour and blanking come from the samples.
+    expect(trace[3]).toBe(1);
+    expect(trace[5]).toBe(0.25);
+    expect(trace[6]).toBe(0);
+  });
+
+  it('slews large steps at maxVelocity', () => {
+    const trace = simulateGalvo(step(1, 60));
+    let previous = 0;
+    for (let i = 0; i < 60; i++) {
+      expect(trace[i * 8] - previous).toBeLessThanOrEqual(0.08 + 1e-6);
+      previous = trace[i * 8];
+    }
+    expect(trace[59 * 8]).toBeCloseTo(1, 3);
+  });
+});
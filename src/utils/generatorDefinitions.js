@@ -223,8 +223,17 @@ export const generatorDefinitions = [
       sourceName: 'No Source',
       threshold: 128,
       edgeDetection: false,
+      nativeAnalysis: true,
+      nativeTrace: true,
+      pointBudget: 2000,
+      frameSync: false,
       captureWidth: 480,
       captureHeight: 480,
+      scaleFilter: 'nearest',
+      cropX: 0,
+      cropY: 0,
+      cropWidth: 1,
+      cropHeight: 1,
       x: 0,
       y: 0,
       scale: 1,
@@ -239,8 +248,21 @@ export const generatorDefinitions = [
       { id: 'sourceName', label: 'Source Name', type: 'text' },
       { id: 'captureWidth', label: 'Width', type: 'range', min: 128, max: 1280, step: 1 },
       { id: 'captureHeight', label: 'Height', type: 'range', min: 128, max: 1280, step: 1 },
+      { id: 'scaleFilter', label: 'Scaling', type: 'select', options: [
+          { label: 'Nearest', value: 'nearest' },
+          { label: 'Box (Area)', value: 'box' },
+          { label: 'Bilinear', value: 'bilinear' }
+      ]},
+      { id: 'cropX', label: 'Crop Left', type: 'range', min: 0, max: 0.99, step: 0.01 },
+      { id: 'cropY', label: 'Crop Top', type: 'range', min: 0, max: 0.99, step: 0.01 },
+      { id: 'cropWidth', label: 'Crop Width', type: 'range', min: 0.01, max: 1, step: 0.01 },
+      { id: 'cropHeight', label: 'Crop Height', type: 'range', min: 0.01, max: 1, step: 0.01 },
       { id: 'threshold', label: 'Threshold', type: 'range', min: 0, max: 255, step: 1 },
       { id: 'edgeDetection', label: 'Edge Detection', type: 'checkbox' },
+      { id: 'nativeAnalysis', label: 'Native Edge Pass', type: 'checkbox' },
+      { id: 'nativeTrace', label: 'Trace Contours', type: 'checkbox', condition: (p) => p.nativeAnalysis !== false },
+      { id: 'pointBudget', label: 'Point Budget', type: 'range', min: 200, max: 8000, step: 100, condition: (p) => p.nativeAnalysis !== false && p.nativeTrace !== false },
+      { id: 'frameSync', label: 'Sync to Laser Clock', type: 'checkbox' },
       { id: 'renderingStyle', label: 'Beam Style', type: 'select', options: [
           { label: 'Normal', value: 'normal' },
           { label: 'Dotted', value: 'dotted' },
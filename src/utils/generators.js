@@ -387,6 +387,154 @@ export function generateStar(params) {
   }
 }
 
+function collectNdiBgraCandidates(ndiFrame, { threshold, edgeDetection, x, y, scale, r, g, b }) {
+    const { width: srcW, height: srcH, data: srcData } = ndiFrame;
+    const workingWidth = Math.min(srcW, 640);
+    const workingScale = workingWidth / srcW;
+    const w = workingWidth;
+    const h = Math.floor(srcH * workingScale);
+    const workingGray = new Uint8Array(w * h);
+    const blurred = new Uint8Array(w * h);
+
+    for (let py = 0; py < h; py++) {
+        const srcY = Math.floor(py / workingScale);
+        const pyW = py * w;
+        const srcYW = srcY * srcW;
+        for (let px = 0; px < w; px++) {
+            const srcX = Math.floor(px / workingScale);
+            const srcIdx = (srcYW + srcX) * 4;
+            workingGray[pyW + px] = (srcData[srcIdx] * 0.114 + srcData[srcIdx + 1] * 0.587 + srcData[srcIdx + 2] * 0.299);
+        }
+    }
+
+    for (let py = 1; py < h - 1; py++) {
+        const pyW = py * w;
+        for (let px = 1; px < w - 1; px++) {
+            const idx = pyW + px;
+            blurred[idx] = (
+                workingGray[idx - w - 1] + workingGray[idx - w] + workingGray[idx - w + 1] +
+                workingGray[idx - 1]     + workingGray[idx]     + workingGray[idx + 1]     +
+                workingGray[idx + w - 1] + workingGray[idx + w] + workingGray[idx + w + 1]
+            ) / 9;
+        }
+    }
+
+    const candidatePoints = [];
+    const skip = edgeDetection ? 1 : 2;
+
+    if (edgeDetection) {
+        for (let py = 1; py < h - 1; py += skip) {
+            const pyW = py * w;
+            for (let px = 1; px < w - 1; px += skip) {
+                const idx = pyW + px;
+                const gx = (blurred[idx - w + 1] + 2 * blurred[idx + 1] + blurred[idx + w + 1]) - 
+                           (blurred[idx - w - 1] + 2 * blurred[idx - 1] + blurred[idx + w - 1]);
+                const gy = (blurred[idx - w - 1] + 2 * blurred[idx - w] + blurred[idx - w + 1]) - 
+                           (blurred[idx + w - 1] + 2 * blurred[idx + w] + blurred[idx + w + 1]);
+                const magnitude = Math.sqrt(gx * gx + gy * gy) / 4;
+                if (magnitude > threshold) {
+                    const lx = (px / w * 2 - 1) * scale + x;
+                    const ly = (1 - py / h * 2) * scale + y;
+                    const srcX = Math.floor(px / workingScale);
+                    const srcY = Math.floor(py / workingScale);
+                    const dIdx = (srcY * srcW + srcX) * 4;
+                    candidatePoints.push({
+                        x: lx, y: ly,
+                        px: px, py: py,
+                        r: Math.round(srcData[dIdx + 2] * (r / 255)),
+                        g: Math.round(srcData[dIdx + 1] * (g / 255)),
+                        b: Math.round(srcData[dIdx] * (b / 255)),
+                        blanking: false
+                    });
+                }
+            }
+        }
+    } else {
+        for (let py = 0; py < h; py += 2) {
+            const pyW = py * w;
+            for (let px = 0; px < w; px += 2) {
+                const idx = pyW + px;
+                if (workingGray[idx] > threshold) {
+                    const lx = (px / w * 2 - 1) * scale + x;
+                    const ly = (1 - py / h * 2) * scale + y;
+                    const srcX = Math.floor(px / workingScale);
+                    const srcY = Math.floor(py / workingScale);
+                    const dIdx = (srcY * srcW + srcX) * 4;
+                    candidatePoints.push({
+                        x: lx, y: ly,
+                        px: px, py: py,
+                        r: Math.round(srcData[dIdx + 2] * (r / 255)),
+                        g: Math.round(srcData[dIdx + 1] * (g / 255)),
+                        b: Math.round(srcData[dIdx] * (b / 255)),
+                        blanking: false
+                    });
+                }
+            }
+        }
+    }
+    return { candidatePoints, w };
+}
+
+// Frames from the native analysis pass ('mask' format) carry one byte per pixel:
+// 0 when the pixel failed the threshold, otherwise its colour as RGB332.
+function collectNdiMaskCandidates(ndiFrame, { x, y, scale, r, g, b }) {
+    const { width: w, height: h, data: mask } = ndiFrame;
+    const candidatePoints = [];
+    const edges = ndiFrame.analysis === 'edges';
+    const skip = edges ? 1 : 2;
+    const border = edges ? 1 : 0;
+
+    for (let py = border; py < h - border; py += skip) {
+        const pyW = py * w;
+        for (let px = border; px < w - border; px += skip) {
+            const c = mask[pyW + px];
+            if (c !== 0) {
+                candidatePoints.push({
+                    x: (px / w * 2 - 1) * scale + x,
+                    y: (1 - py / h * 2) * scale + y,
+                    px: px, py: py,
+                    r: Math.round(((c >> 5) * 255 / 7) * (r / 255)),
+                    g: Math.round((((c >> 2) & 7) * 255 / 7) * (g / 255)),
+                    b: Math.round(((c & 3) * 255 / 3) * (b / 255)),
+                    blanking: false
+                });
+            }
+        }
+    }
+    return { candidatePoints, w };
+}
+
+// 'path' frames were traced by the addon (contour_tracer.cc) into normalised
+// 8-float points; only placement and tint are left to apply here.
+function placeNdiPath(ndiFrame, { x, y, scale, r, g, b }) {
+    const src = ndiFrame.data;
+    const points = new Float32Array(src.length);
+    const rScale = r / 255, gScale = g / 255, bScale = b / 255;
+    for (let i = 0; i < src.length; i += 8) {
+        points[i] = src[i] * scale + x;
+        points[i + 1] = src[i + 1] * scale + y;
+        points[i + 2] = src[i + 2];
+        points[i + 3] = Math.round(src[i + 3] * rScale);
+        points[i + 4] = Math.round(src[i + 4] * gScale);
+        points[i + 5] = Math.round(src[i + 5] * bScale);
+        points[i + 6] = src[i + 6];
+        points[i + 7] = src[i + 7];
+    }
+    return points;
+}
+
+function pathToPointObjects(points) {
+    const result = [];
+    for (let i = 0; i < points.length; i += 8) {
+        result.push({
+            x: points[i], y: points[i + 1],
+            r: points[i + 3], g: points[i + 4], b: points[i + 5],
+            blanking: points[i + 6] > 0.5
+        });
+    }
+    return result;
+}
+
 export async function generateNdiSource(params, fontBuffer, ndiFrame = null) {
     try {
         const { sourceName, threshold, edgeDetection, x, y, scale, r, g, b } = withDefaults(params, {
@@ -405,90 +553,20 @@ export async function generateNdiSource(params, fontBuffer, ndiFrame = null) {
             return { points: [{ x: 0, y: 0, r: 0, g: 0, b: 0, blanking: true }] };
         }
 
-        const { width: srcW, height: srcH, data: srcData } = ndiFrame;
-        const workingWidth = Math.min(srcW, 640);
-        const workingScale = workingWidth / srcW;
-        const w = workingWidth;
-        const h = Math.floor(srcH * workingScale);
-        const workingGray = new Uint8Array(w * h);
-        const blurred = new Uint8Array(w * h);
-
-        for (let py = 0; py < h; py++) {
-            const srcY = Math.floor(py / workingScale);
-            const pyW = py * w;
-            const srcYW = srcY * srcW;
-            for (let px = 0; px < w; px++) {
-                const srcX = Math.floor(px / workingScale);
-                const srcIdx = (srcYW + srcX) * 4;
-                workingGray[pyW + px] = (srcData[srcIdx] * 0.114 + srcData[srcIdx + 1] * 0.587 + srcData[srcIdx + 2] * 0.299);
+        if (ndiFrame.format === 'path') {
+            if (ndiFrame.data.length === 0) {
+                return { points: [{ x: 0, y: 0, r: 0, g: 0, b: 0, blanking: true }] };
             }
-        }
-
-        for (let py = 1; py < h - 1; py++) {
-            const pyW = py * w;
-            for (let px = 1; px < w - 1; px++) {
-                const idx = pyW + px;
-                blurred[idx] = (
-                    workingGray[idx - w - 1] + workingGray[idx - w] + workingGray[idx - w + 1] +
-                    workingGray[idx - 1]     + workingGray[idx]     + workingGray[idx + 1]     +
-                    workingGray[idx + w - 1] + workingGray[idx + w] + workingGray[idx + w + 1]
-                ) / 9;
+            const points = placeNdiPath(ndiFrame, { x, y, scale, r, g, b });
+            if ((params.renderingStyle || 'normal') === 'normal') {
+                return { points, isTypedArray: true };
             }
+            return { points: applyRenderingStyle(pathToPointObjects(points), params) };
         }
 
-        const candidatePoints = [];
-        const skip = edgeDetection ? 1 : 2;
-
-        if (edgeDetection) {
-            for (let py = 1; py < h - 1; py += skip) {
-                const pyW = py * w;
-                for (let px = 1; px < w - 1; px += skip) {
-                    const idx = pyW + px;
-                    const gx = (blurred[idx - w + 1] + 2 * blurred[idx + 1] + blurred[idx + w + 1]) - 
-                               (blurred[idx - w - 1] + 2 * blurred[idx - 1] + blurred[idx + w - 1]);
-                    const gy = (blurred[idx - w - 1] + 2 * blurred[idx - w] + blurred[idx - w + 1]) - 
-                               (blurred[idx + w - 1] + 2 * blurred[idx + w] + blurred[idx + w + 1]);
-                    const magnitude = Math.sqrt(gx * gx + gy * gy) / 4;
-                    if (magnitude > threshold) {
-                        const lx = (px / w * 2 - 1) * scale + x;
-                        const ly = (1 - py / h * 2) * scale + y;
-                        const srcX = Math.floor(px / workingScale);
-                        const srcY = Math.floor(py / workingScale);
-                        const dIdx = (srcY * srcW + srcX) * 4;
-                        candidatePoints.push({
-                            x: lx, y: ly,
-                            px: px, py: py,
-                            r: Math.round(srcData[dIdx + 2] * (r / 255)),
-                            g: Math.round(srcData[dIdx + 1] * (g / 255)),
-                            b: Math.round(srcData[dIdx] * (b / 255)),
-                            blanking: false
-                        });
-                    }
-                }
-            }
-        } else {
-            for (let py = 0; py < h; py += 2) {
-                const pyW = py * w;
-                for (let px = 0; px < w; px += 2) {
-                    const idx = pyW + px;
-                    if (workingGray[idx] > threshold) {
-                        const lx = (px / w * 2 - 1) * scale + x;
-                        const ly = (1 - py / h * 2) * scale + y;
-                        const srcX = Math.floor(px / workingScale);
-                        const srcY = Math.floor(py / workingScale);
-                        const dIdx = (srcY * srcW + srcX) * 4;
-                        candidatePoints.push({
-                            x: lx, y: ly,
-                            px: px, py: py,
-                            r: Math.round(srcData[dIdx + 2] * (r / 255)),
-                            g: Math.round(srcData[dIdx + 1] * (g / 255)),
-                            b: Math.round(srcData[dIdx] * (b / 255)),
-                            blanking: false
-                        });
-                    }
-                }
-            }
-        }
+        const { candidatePoints, w } = ndiFrame.format === 'mask'
+            ? collectNdiMaskCandidates(ndiFrame, { x, y, scale, r, g, b })
+            : collectNdiBgraCandidates(ndiFrame, { threshold, edgeDetection, x, y, scale, r, g, b });
 
         if (candidatePoints.length === 0) {
             return { points: [{ x: 0, y: 0, r: 0, g: 0, b: 0, blanking: true }] };
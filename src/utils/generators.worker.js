@@ -1,6 +1,8 @@
 import { generateCircle, generateSquare, generateTriangle, generateLine, generateText, generateStar, generateNdiSource, generateSpoutReceiver, generateSinewave, generateWaveform, generateTimer } from './generators.js';
 
 const fontCache = new Map(); // Cache font buffers by URL to avoid redundant copies
+// Last NDI result per clip slot; reused while the addon flags frames as unchanged
+const ndiResultCache = new Map();
 
 self.onmessage = async (event) => {
   const { type, layerIndex, colIndex, generator, params, audioData, context, fontBuffer } = event.data;
@@ -41,9 +43,19 @@ self.onmessage = async (event) => {
             case 'star':
               frames = [generateStar(currentParams)];
               break;
-            case 'ndi-source':
-              frames = [await generateNdiSource(currentParams, activeFontBuffer, event.data.ndiFrame)];
+            case 'ndi-source': {
+              const ndiFrame = event.data.ndiFrame;
+              const slot = `${layerIndex}:${colIndex}`;
+              const paramsKey = JSON.stringify(currentParams);
+              const cached = ndiResultCache.get(slot);
+              if (ndiFrame?.unchanged && cached && cached.source === ndiFrame.source && cached.paramsKey === paramsKey) {
+                frames = cached.frames;
+              } else {
+                frames = [await generateNdiSource(currentParams, activeFontBuffer, ndiFrame)];
+                if (ndiFrame) ndiResultCache.set(slot, { source: ndiFrame.source, paramsKey, frames });
+              }
               break;
+            }
             case 'spout-receiver':
               frames = [await generateSpoutReceiver(currentParams, activeFontBuffer)];
               break;
@@ -62,7 +74,7 @@ self.onmessage = async (event) => {
         } catch (generatorError) {
           console.error(`Error generating frames for ${generator.name}:`, generatorError);
           frames = [{ points: [] }]; // Ensure frames array is still returned, even on error
-          self.postMessage({ success: false, error: generatorError.message, layerIndex, colIndex });
+          self.postMessage({ success: false, error: generatorError.message, layerIndex, colIndex, isNdi: event.data.isNdi, ndiSource: event.data.ndiSource, ndiFrameId: event.data.ndiFrameId });
           return;
         }
         self.postMessage({
@@ -74,6 +86,8 @@ self.onmessage = async (event) => {
           currentParams: currentParams, // Send back the params used for generation
           isLive: event.data.isLive, // Pass through the live flag
           isNdi: event.data.isNdi, // Pass through NDI flag
+          ndiSource: event.data.ndiSource, // Source to acknowledge once the frame is done
+          ndiFrameId: event.data.ndiFrameId, // Frame this job belongs to
           isAutoUpdate: event.data.isAutoUpdate, // Pass through auto update flag
           seq: event.data.seq // Pass back sequence number
         });
@@ -84,6 +98,6 @@ self.onmessage = async (event) => {
     }
   } catch (error) {
     console.error('Worker: Uncaught error in onmessage handler:', error);
-    self.postMessage({ success: false, error: error.message, layerIndex, colIndex });
+    self.postMessage({ success: false, error: error.message, layerIndex, colIndex, isNdi: event.data.isNdi, ndiSource: event.data.ndiSource, ndiFrameId: event.data.ndiFrameId });
   }
 };
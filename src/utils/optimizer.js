@@ -1,106 +1,133 @@
-const OPT_MAX_DIST = 0.08; 
-const OPT_CORNER_DWELL = 3; 
-const OPT_PATH_DWELL = 4;   
+const OPT_MAX_DIST = 0.08;
+const OPT_PATH_DWELL = 4;
+// Cap on intermediate points for one jump; only garbage coordinates reach it.
+const OPT_MAX_STEPS = 1024;
+// Scanner model for corner dwell, in -1..1 units at OPT_PPS points per second: the defaults of
+// OptimizerOptions in native/src/point_optimizer.h, where the model is described.
+const OPT_PPS = 30000;
+const OPT_MAX_VELOCITY = 2400;
+const OPT_MAX_ACCELERATION = 2.5e7;
+const OPT_CORNER_DWELL = 8; // most extra points held at one corner
+const OPT_STEP = Math.min(OPT_MAX_DIST, OPT_MAX_VELOCITY / OPT_PPS);
 
-export function optimizePoints(points) {
-    if (!points) return new Float32Array(0);
-    
-    const isTyped = (points instanceof Float32Array) || points.isTypedArray;
-    const numPoints = isTyped ? (points.length / 8) : points.length;
-
-    // Passthrough if extremely large to prevent freezing
-    if (numPoints > 4000) {
-        if (points instanceof Float32Array) return points;
-        const res = new Float32Array(numPoints * 8);
-        for(let i=0; i<numPoints; i++) {
-             const p = points[i];
-             res[i*8] = p.x; res[i*8+1] = p.y; res[i*8+2] = p.z||0;
-             res[i*8+3] = p.r; res[i*8+4] = p.g; res[i*8+5] = p.b;
-             res[i*8+6] = p.blanking ? 1 : 0;
-             res[i*8+7] = p.lastPoint ? 1 : 0;
-        }
-        return res;
+// Point objects ({ x, y, z, r, g, b, blanking }) and flat number arrays to the 8-float layout.
+const toTyped = (points) => {
+    if (points.isTypedArray) return Float32Array.from(points);
+    const res = new Float32Array(points.length * 8);
+    for (let i = 0; i < points.length; i++) {
+        const p = points[i];
+        res[i*8] = p.x||0; res[i*8+1] = p.y||0; res[i*8+2] = p.z||0;
+        res[i*8+3] = p.r||0; res[i*8+4] = p.g||0; res[i*8+5] = p.b||0;
+        res[i*8+6] = p.blanking ? 1 : 0;
     }
+    return res;
+};
 
-    const result = [];
-    
-    const push = (x, y, z, r, g, b, blk) => {
-        // Ensure color is 0 if blanked
-        const finalR = blk ? 0 : r;
-        const finalG = blk ? 0 : g;
-        const finalB = blk ? 0 : b;
-        result.push(x, y, z, finalR, finalG, finalB, blk ? 1 : 0, 0);
-    };
+const jumpSteps = (dist) => dist > OPT_STEP ? Math.min(Math.floor(dist / OPT_STEP), OPT_MAX_STEPS) : 0;
 
-    const get = (i) => {
-        if (isTyped) {
-            const off = i * 8;
-            return {
-                x: points[off], y: points[off+1], z: points[off+2],
-                r: points[off+3], g: points[off+4], b: points[off+5],
-                blanking: points[off+6] > 0.5
-            };
-        } else {
-            const p = points[i];
-            return {
-                x: p.x||0, y: p.y||0, z: p.z||0,
-                r: p.r||0, g: p.g||0, b: p.b||0,
-                blanking: !!p.blanking
-            };
-        }
-    };
+// Beam speed along a segment drawn in `steps` points, capped by the scanner's top speed.
+const segmentSpeed = (length, steps) => Math.min((steps > 1 ? length / steps : length) * OPT_PPS, OPT_MAX_VELOCITY);
 
-    if (numPoints === 0) return new Float32Array(0);
+// Extra samples the scanner needs to turn from segment (ax, ay) into (bx, by): the velocity change over
+// the acceleration limit.
+const cornerDwell = (ax, ay, stepsIn, bx, by, stepsOut) => {
+    const la = Math.sqrt(ax*ax + ay*ay);
+    const lb = Math.sqrt(bx*bx + by*by);
+    if (!(la > 0) || !(lb > 0)) return 0;
+    const vi = segmentSpeed(la, stepsIn);
+    const vo = segmentSpeed(lb, stepsOut);
+    const dvx = bx / lb * vo - ax / la * vi;
+    const dvy = by / lb * vo - ay / la * vi;
+    return Math.min(Math.floor(Math.sqrt(dvx*dvx + dvy*dvy) / OPT_MAX_ACCELERATION * OPT_PPS), OPT_CORNER_DWELL);
+};
 
-    let prevPoint = get(0);
+// Same output as PointOptimizer in native/src/point_optimizer.cc, for contexts without the addon
+// (workers, tests). The first pass sizes the output so the second writes straight into one Float32Array.
+function optimizeTyped(points) {
+    const numPoints = Math.floor(points.length / 8);
+
+    let total = numPoints;
+    // Per point: corner dwell, held after the point itself.
+    const corners = new Uint8Array(numPoints);
+    let prevDx = 0, prevDy = 0, prevSteps = 0;
+    for (let i = 1; i < numPoints; i++) {
+        const off = i * 8;
+        const blanked = points[off+6] > 0.5;
+        if (blanked !== (points[off-2] > 0.5)) total += blanked ? OPT_PATH_DWELL : OPT_PATH_DWELL + 1;
+        const dx = points[off] - points[off-8];
+        const dy = points[off+1] - points[off-7];
+        const steps = jumpSteps(Math.sqrt(dx*dx + dy*dy));
+        total += Math.max(steps - 1, 0);
+        // The corner at the previous point, between two drawn segments.
+        if (i >= 2 && !blanked && !(points[off-2] > 0.5) && !(points[off-10] > 0.5)) {
+            corners[i-1] = cornerDwell(prevDx, prevDy, prevSteps, dx, dy, steps);
+            total += corners[i-1];
+        }
+        prevDx = dx; prevDy = dy; prevSteps = steps;
+    }
+
+    const result = new Float32Array(total * 8);
+    let o = 0;
+    // Blanked points are black; the last-point flag stays 0.
+    const push = (x, y, z, r, g, b, blk) => {
+        result[o] = x; result[o+1] = y; result[o+2] = z;
+        result[o+3] = r; result[o+4] = g; result[o+5] = b;
+        result[o+6] = blk ? 1 : 0;
+        o += 8;
+    };
 
     for (let i = 0; i < numPoints; i++) {
-        const currPoint = get(i);
-
-        // Blanking dwells
-        if (prevPoint.blanking !== currPoint.blanking) {
-            if (currPoint.blanking) {
-                // Moving into blanking
-                for (let d = 0; d < OPT_PATH_DWELL; d++) push(prevPoint.x, prevPoint.y, prevPoint.z, 0, 0, 0, true);
-            } else {
-                // Moving into visible
-                push(currPoint.x, currPoint.y, currPoint.z, 0, 0, 0, true);
-                for (let d = 0; d < OPT_PATH_DWELL; d++) push(currPoint.x, currPoint.y, currPoint.z, 0, 0, 0, true);
-            }
+        const off = i * 8;
+        const prev = i > 0 ? off - 8 : off;
+        const blanked = points[off+6] > 0.5;
+
+        // Blanking dwells: at the last visible point moving into blanking,
+        // one extra at the first visible point moving out of it.
+        if (blanked !== (points[prev+6] > 0.5)) {
+            const at = blanked ? prev : off;
+            for (let d = blanked ? 0 : -1; d < OPT_PATH_DWELL; d++) push(points[at], points[at+1], points[at+2], 0, 0, 0, true);
         }
 
-        const dx = currPoint.x - prevPoint.x;
-        const dy = currPoint.y - prevPoint.y;
-        const dist = Math.sqrt(dx*dx + dy*dy);
+        const r = blanked ? 0 : points[off+3];
+        const g = blanked ? 0 : points[off+4];
+        const b = blanked ? 0 : points[off+5];
 
         // Interpolate long jumps
-        if (dist > OPT_MAX_DIST) {
-            const steps = Math.floor(dist / OPT_MAX_DIST);
-            for (let s = 1; s < steps; s++) {
-                const t = s / steps;
-                push(
-                    prevPoint.x + dx * t, 
-                    prevPoint.y + dy * t, 
-                    prevPoint.z + (currPoint.z - prevPoint.z) * t, 
-                    currPoint.blanking ? 0 : currPoint.r, 
-                    currPoint.blanking ? 0 : currPoint.g, 
-                    currPoint.blanking ? 0 : currPoint.b, 
-                    currPoint.blanking
-                );
-            }
+        const dx = points[off] - points[prev];
+        const dy = points[off+1] - points[prev+1];
+        const dz = points[off+2] - points[prev+2];
+        const steps = jumpSteps(Math.sqrt(dx*dx + dy*dy));
+        for (let s = 1; s < steps; s++) {
+            const t = s / steps;
+            push(points[prev] + dx * t, points[prev+1] + dy * t, points[prev+2] + dz * t, r, g, b, blanked);
         }
-        
-        push(currPoint.x, currPoint.y, currPoint.z, currPoint.r, currPoint.g, currPoint.b, currPoint.blanking);
-        prevPoint = currPoint;
+
+        push(points[off], points[off+1], points[off+2], r, g, b, blanked);
+        for (let c = 0; c < corners[i]; c++) push(points[off], points[off+1], points[off+2], r, g, b, blanked);
     }
 
     // REMOVED intelligent loop closure to prevent unwanted lines on opened shapes.
     // Laser data should represent exactly what's in the buffer.
+    return result;
+}
 
-    const finalBuffer = new Float32Array(result);
+// Frames of every size are optimised; the addon's optimizer (exposed by the preload) runs it when present.
+// reorder: with the addon, first redraw the frame's visible segments in the order (and direction) that
+// needs the least blanked travel, within a fixed amount of search (the same frame always gets the same
+// order) and at most reorderBudgetMs. Frames split into per-DAC
+// channel ranges keep their order, since reordering would scramble the ranges.
+export function optimizePoints(points, { reorder = false, reorderBudgetMs = 1 } = {}) {
+    if (!points) return new Float32Array(0);
+
+    const typed = (points instanceof Float32Array) ? points : toTyped(points);
+    if (typed.length < 8) return new Float32Array(0);
+
+    const nativeOptimize = globalThis.electronAPI?.optimizePoints;
+    const options = { reorder: reorder && !points._channelDistributions, reorderBudgetMs };
+    const finalBuffer = nativeOptimize ? nativeOptimize(typed, options) : optimizeTyped(typed);
     if (points._channelDistributions) {
         finalBuffer._channelDistributions = points._channelDistributions;
     }
-    
+
     return finalBuffer;
 }
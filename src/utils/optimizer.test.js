@@ -0,0 +1,48 @@
+import { describe, it, expect } from 'vitest';
+import { optimizePoints } from './optimizer';
+
+const point = (x, y, blanking, r = 1) => [x, y, 0, r, r, r, blanking ? 1 : 0, 0];
+
+describe('optimizePoints', () => {
+  it('adds blanking dwell and splits long jumps', () => {
+    // A visible point, a blanked jump of 0.5 and a visible point there.
+    const frame = new Float32Array([...point(0, 0, false), ...point(0.5, 0, true), ...point(0.5, 0, false, 0.2)]);
+    const result = optimizePoints(frame);
+    // 1 + (4 dwell + 5 steps + 1 blanked) + (1 + 4 dwell + 1)
+    expect(result.length).toBe(17 * 8);
+    expect(result[1 * 8 + 6]).toBe(1);
+    expect(result[1 * 8 + 3]).toBe(0);
+    expect(result[5 * 8]).toBeCloseTo(0.5 / 6, 6);
+    expect(result[16 * 8 + 3]).toBeCloseTo(0.2, 6);
+    expect(result[16 * 8 + 6]).toBe(0);
+  });
+
+  it('optimises frames beyond 4000 points instead of passing them through', () => {
+    const count = 10000;
+    const frame = new Float32Array(count * 8);
+    for (let i = 0; i < count; i++) frame.set(point((i % 2) * 0.5, 0, i % 100 === 0), i * 8);
+    const result = optimizePoints(frame);
+    expect(result).not.toBe(frame);
+    expect(result.length).toBeGreaterThan(frame.length);
+  });
+
+  it('holds sharp corners for the scanner to turn', () => {
+    // Right angles at 0.08 per point (full speed at 30k pps) hold for 4 extra points; corners next to
+    // blanking and a finely sampled corner get none.
+    const frame = new Float32Array([
+      ...point(0, 0, false), ...point(0.08, 0, false), ...point(0.08, 0.08, false), ...point(0, 0.08, false),
+      ...point(0, 0, true), ...point(0.01, 0, false), ...point(0.01, 0.01, false), ...point(0, 0.01, false),
+    ]);
+    const result = optimizePoints(frame);
+    // 4 + 8 held + (4 dwell + 1 blanked) + (1 + 4 dwell + 1) + 2
+    expect(result.length).toBe(25 * 8);
+    for (let i = 2; i <= 5; i++) expect(Array.from(result.subarray(i * 8, i * 8 + 8))).toEqual(Array.from(result.subarray(8, 16)));
+    expect(result[6 * 8 + 1]).toBeCloseTo(0.08, 6);
+  });
+
+  it('accepts point objects', () => {
+    const objects = [{ x: 0, y: 0, r: 1, g: 1, b: 1 }, { x: 0.5, y: 0, r: 1, g: 1, b: 1, blanking: true }];
+    const typed = new Float32Array([...point(0, 0, false), ...point(0.5, 0, true)]);
+    expect(Array.from(optimizePoints(objects))).toEqual(Array.from(optimizePoints(typed)));
+  });
+});